@@ -64,4 +64,29 @@ namespace proto
     {
         // No hace nada en la clase base, ya que no contiene referencias a otros objetos.
     };
+
+    CollectionCell::CollectionCell(ProtoContext* context, unsigned long kind)
+        : Cell(context), kind(kind)
+    {
+    }
+
+    ProtoObject* CollectionCell::implAsObject(ProtoContext* context)
+    {
+        ProtoObjectPointer p{};
+        p.oid.oid = reinterpret_cast<ProtoObject*>(this);
+        p.op.pointer_tag = POINTER_TAG_COLLECTION;
+        return p.oid.oid;
+    }
+
+    CollectionCell* CollectionCell::fromObject(ProtoObject* object, unsigned long kind)
+    {
+        ProtoObjectPointer p{};
+        p.oid.oid = object;
+        if (p.op.pointer_tag != POINTER_TAG_COLLECTION)
+            return nullptr;
+
+        p.op.pointer_tag = POINTER_TAG_OBJECT;
+        auto* collection = reinterpret_cast<CollectionCell*>(p.oc.objectCell);
+        return collection->kind == kind ? collection : nullptr;
+    }
 };
@@ -0,0 +1,301 @@
+/*
+ * ObjectShape.cpp
+ *
+ *  Created on: October, 2026
+ *      Author: gamarino
+ */
+
+#include "../headers/proto_internal.h"
+
+namespace proto
+{
+    // --- ObjectShape ---
+
+    ObjectShape::ObjectShape(
+        ProtoContext* context,
+        ObjectShape* previous,
+        unsigned long key,
+        ProtoSparseListImplementation* slotIndex
+    ) : Cell(context), previous(previous), key(key),
+        slotCount(previous ? previous->slotCount + 1 : 0),
+        slotIndex(slotIndex), transitions(nullptr)
+    {
+    }
+
+    ObjectShape::~ObjectShape() = default;
+
+    long ObjectShape::implGetSlot(ProtoContext* context, unsigned long key)
+    {
+        if (!this->slotIndex)
+            return -1;
+
+        ProtoObject* slot = this->slotIndex->implGetAt(context, key);
+        if (slot == PROTO_NONE)
+            return -1;
+
+        return slot->asInteger(context);
+    }
+
+    ObjectShape* ObjectShape::implAddKey(ProtoContext* context, unsigned long key)
+    {
+        ObjectShape* newShape = nullptr;
+
+        while (true)
+        {
+            ProtoSparseListImplementation* currentTransitions = this->transitions.load();
+
+            // Si otro objeto ya hizo la misma transición, se comparte su forma.
+            if (currentTransitions)
+            {
+                ProtoObject* existing = currentTransitions->implGetAt(context, key);
+                if (existing != PROTO_NONE)
+                    return reinterpret_cast<ObjectShape*>(existing);
+            }
+
+            if (this->slotCount >= SHAPE_MAX_SLOTS)
+                return nullptr;
+
+            if (!newShape)
+            {
+                ProtoObject* slot = context->fromInteger((int) this->slotCount);
+                newShape = new(context) ObjectShape(
+                    context,
+                    this,
+                    key,
+                    this->slotIndex
+                        ? this->slotIndex->implSetAt(context, key, slot)
+                        : new(context) ProtoSparseListImplementation(context, key, slot)
+                );
+            }
+
+            ProtoSparseListImplementation* newTransitions = currentTransitions
+                ? currentTransitions->implSetAt(context, key, reinterpret_cast<ProtoObject*>(newShape))
+                : new(context) ProtoSparseListImplementation(context, key, reinterpret_cast<ProtoObject*>(newShape));
+
+            if (this->transitions.compare_exchange_strong(currentTransitions, newTransitions))
+            {
+                if (context->space)
+                    context->space->rememberReference(context, this, newTransitions);
+                return newShape;
+            }
+        }
+    }
+
+    unsigned long ObjectShape::getHash(ProtoContext* context)
+    {
+        return Cell::getHash(context);
+    }
+
+    ProtoObject* ObjectShape::asObject(ProtoContext* context)
+    {
+        return Cell::asObject(context);
+    }
+
+    void ObjectShape::finalize(ProtoContext* context)
+    {
+    }
+
+    void ObjectShape::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        if (this->previous)
+            method(context, self, this->previous);
+
+        if (this->slotIndex)
+            method(context, self, this->slotIndex);
+
+        ProtoSparseListImplementation* currentTransitions = this->transitions.load();
+        if (currentTransitions)
+            method(context, self, currentTransitions);
+    }
+
+
+    // --- AttributeSlots ---
+
+    AttributeSlots::AttributeSlots(
+        ProtoContext* context,
+        unsigned long height,
+        Cell** pointers
+    ) : Cell(context), height(height)
+    {
+        for (int i = 0; i < SLOTS_SIZE; i++)
+            this->pointers.values[i] = pointers ? reinterpret_cast<ProtoObject*>(pointers[i]) : PROTO_NONE;
+    }
+
+    AttributeSlots::~AttributeSlots() = default;
+
+    namespace
+    {
+        // Cantidad de posiciones que puede direccionar un vector de la altura dada.
+        unsigned long slotsCapacity(unsigned long height)
+        {
+            unsigned long capacity = SLOTS_SIZE;
+            while (height--)
+                capacity *= SLOTS_SIZE;
+            return capacity;
+        }
+    }
+
+    ProtoObject* AttributeSlots::implGetAt(AttributeSlots* slots, unsigned long index)
+    {
+        if (!slots)
+            return PROTO_NONE;
+
+        // Cada hijo tiene la altura de su padre menos uno, así que la
+        // capacidad se calcula una sola vez.
+        unsigned long capacity = slotsCapacity(slots->height);
+        if (index >= capacity)
+            return PROTO_NONE;
+
+        while (slots->height)
+        {
+            capacity /= SLOTS_SIZE;
+            slots = slots->pointers.children[index / capacity];
+            if (!slots)
+                return PROTO_NONE;
+            index %= capacity;
+        }
+
+        return slots->pointers.values[index];
+    }
+
+    AttributeSlots* AttributeSlots::implSetAt(
+        ProtoContext* context,
+        AttributeSlots* slots,
+        unsigned long index,
+        ProtoObject* value
+    )
+    {
+        // Borrar una posición vacía no cambia nada; en particular, no hace
+        // crecer el vector.
+        if (value == PROTO_NONE && implGetAt(slots, index) == PROTO_NONE)
+            return slots;
+
+        if (!slots)
+            slots = new(context) AttributeSlots(context, 0);
+
+        // Crecer en altura hasta que la posición quede direccionable.
+        while (index >= slotsCapacity(slots->height))
+        {
+            Cell* pointers[SLOTS_SIZE] = {slots};
+            slots = new(context) AttributeSlots(context, slots->height + 1, pointers);
+        }
+
+        Cell* pointers[SLOTS_SIZE];
+        for (int i = 0; i < SLOTS_SIZE; i++)
+            pointers[i] = reinterpret_cast<Cell*>(slots->pointers.values[i]);
+
+        if (slots->height == 0)
+        {
+            pointers[index] = reinterpret_cast<Cell*>(value);
+        }
+        else
+        {
+            // Un hijo que falta se crea con la altura que le corresponde: los
+            // recorridos calculan la capacidad de cada hijo por su posición.
+            unsigned long childCapacity = slotsCapacity(slots->height - 1);
+            AttributeSlots* child = slots->pointers.children[index / childCapacity];
+            if (!child)
+                child = new(context) AttributeSlots(context, slots->height - 1);
+            pointers[index / childCapacity] = implSetAt(context, child, index % childCapacity, value);
+        }
+
+        // Un nodo que queda vacío se descarta, así que los prefijos ya
+        // borrados no ocupan celdas.
+        if (value == PROTO_NONE)
+        {
+            bool empty = true;
+            for (int i = 0; i < SLOTS_SIZE; i++)
+                empty = empty && pointers[i] == nullptr;
+            if (empty)
+                return nullptr;
+        }
+
+        return new(context) AttributeSlots(context, slots->height, pointers);
+    }
+
+    AttributeSlots* AttributeSlots::implFromArray(
+        ProtoContext* context,
+        unsigned long count,
+        ProtoObject** values
+    )
+    {
+        if (!count)
+            return nullptr;
+
+        // Primero las hojas; luego cada nivel agrupa hasta SLOTS_SIZE nodos del anterior.
+        std::vector<AttributeSlots*> level((count + SLOTS_SIZE - 1) / SLOTS_SIZE);
+        unsigned long levelCount = 0;
+        for (unsigned long i = 0; i < count; i += SLOTS_SIZE)
+        {
+            Cell* pointers[SLOTS_SIZE];
+            for (unsigned long j = 0; j < SLOTS_SIZE; j++)
+                pointers[j] = reinterpret_cast<Cell*>(i + j < count ? values[i + j] : PROTO_NONE);
+            level[levelCount++] = new(context) AttributeSlots(context, 0, pointers);
+        }
+
+        unsigned long height = 0;
+        while (levelCount > 1)
+        {
+            height++;
+            unsigned long parentCount = 0;
+            for (unsigned long i = 0; i < levelCount; i += SLOTS_SIZE)
+            {
+                Cell* pointers[SLOTS_SIZE];
+                for (unsigned long j = 0; j < SLOTS_SIZE; j++)
+                    pointers[j] = i + j < levelCount ? level[i + j] : nullptr;
+                level[parentCount++] = new(context) AttributeSlots(context, height, pointers);
+            }
+            levelCount = parentCount;
+        }
+
+        return level[0];
+    }
+
+    unsigned long AttributeSlots::getHash(ProtoContext* context)
+    {
+        return Cell::getHash(context);
+    }
+
+    ProtoObject* AttributeSlots::asObject(ProtoContext* context)
+    {
+        return Cell::asObject(context);
+    }
+
+    void AttributeSlots::finalize(ProtoContext* context)
+    {
+    }
+
+    void AttributeSlots::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        for (int i = 0; i < SLOTS_SIZE; i++)
+        {
+            if (this->height)
+            {
+                if (this->pointers.children[i])
+                    method(context, self, this->pointers.children[i]);
+            }
+            else
+            {
+                ProtoObject* value = this->pointers.values[i];
+                if (value && value->isCell(context))
+                    method(context, self, value->asCell(context));
+            }
+        }
+    }
+} // namespace proto
@@ -7,6 +7,9 @@
 
 #include "../headers/proto_internal.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace proto
 {
     // Usar la lista de inicialización de miembros es más idiomático y eficiente en C++.
@@ -14,9 +17,25 @@ namespace proto
         ProtoContext* context,
         ParentLinkImplementation* parent,
         ProtoObjectCellImplementation* object
-    ) : Cell(context), parent(parent), object(object)
+    ) : Cell(context), parent(parent), object(object), order(nullptr), display(nullptr)
     {
-        // El cuerpo del constructor ahora puede estar vacío.
+        // Profundidad, linealidad y máscara se derivan en O(1) de las cadenas ya existentes.
+        ParentLinkImplementation* lineage = object ? object->parent : nullptr;
+        this->depth = (lineage ? lineage->depth : 0) + 1;
+        this->linear = parent == lineage && (!parent || parent->linear);
+
+        // En una cadena lineal corta el linaje también lo es, así que su
+        // display está en su celda y se copia entero.
+        if (this->implHasInlineDisplay())
+        {
+            this->rootAncestor = this->depth > 1 ? lineage->implGetInlineAncestor(0) : nullptr;
+            this->middleAncestor = this->depth > 2 ? lineage->implGetInlineAncestor(1) : nullptr;
+            return;
+        }
+
+        this->ancestorMask = implAncestorBit(object)
+            | (parent ? parent->implGetAncestorMask() : 0)
+            | (lineage ? lineage->implGetAncestorMask() : 0);
     };
 
     // El destructor no necesita realizar ninguna acción.
@@ -50,6 +69,30 @@ namespace proto
             method(context, self, reinterpret_cast<Cell*>(this->object));
         }
 
+        // 3. Procesar el orden de resolución, si ya fue calculado.
+        ResolutionOrder* currentOrder = this->order.load();
+        if (currentOrder)
+        {
+            method(context, self, currentOrder);
+        }
+
+        if (this->implHasInlineDisplay())
+        {
+            for (auto* ancestor : {this->rootAncestor, this->middleAncestor})
+            {
+                if (ancestor)
+                    method(context, self, reinterpret_cast<Cell*>(ancestor));
+            }
+        }
+        else
+        {
+            AttributeSlots* currentDisplay = this->display.load();
+            if (currentDisplay)
+            {
+                method(context, self, currentDisplay);
+            }
+        }
+
         // NOTA: La llamada a 'method(context, self, this)' fue eliminada.
         // El recolector de basura ya está procesando 'this' cuando llama a este método.
         // Volver a pasárselo a sí mismo causaría un bucle infinito durante la recolección.
@@ -78,4 +121,379 @@ namespace proto
         // Devolver 0 o algún otro valor por defecto si no hay objeto.
         return 0;
     }
+
+    namespace
+    {
+        typedef std::vector<ProtoObjectCellImplementation*> ObjectSequence;
+
+        void appendOrder(ObjectSequence& sequence, ResolutionOrder* order)
+        {
+            for (; order; order = order->next)
+                sequence.insert(sequence.end(), order->objects, order->objects + order->count);
+        }
+
+        bool inTail(const ObjectSequence& sequence, size_t head, ProtoObjectCellImplementation* object)
+        {
+            for (size_t i = head + 1; i < sequence.size(); i++)
+                if (sequence[i] == object)
+                    return true;
+            return false;
+        }
+
+        // Mezcla C3: toma el primer candidato que no aparezca en la cola de ninguna
+        // secuencia. Devuelve false si las secuencias no tienen un orden consistente.
+        bool mergeC3(std::vector<ObjectSequence>& sequences, ObjectSequence& result)
+        {
+            std::vector<size_t> heads(sequences.size(), 0);
+
+            while (true)
+            {
+                ProtoObjectCellImplementation* candidate = nullptr;
+                bool pending = false;
+
+                for (size_t i = 0; i < sequences.size() && !candidate; i++)
+                {
+                    if (heads[i] >= sequences[i].size())
+                        continue;
+                    pending = true;
+
+                    ProtoObjectCellImplementation* head = sequences[i][heads[i]];
+                    bool blocked = false;
+                    for (size_t j = 0; j < sequences.size() && !blocked; j++)
+                        blocked = inTail(sequences[j], heads[j], head);
+                    if (!blocked)
+                        candidate = head;
+                }
+
+                if (!pending)
+                    return true;
+                if (!candidate)
+                    return false;
+
+                result.push_back(candidate);
+                for (size_t i = 0; i < sequences.size(); i++)
+                    if (heads[i] < sequences[i].size() && sequences[i][heads[i]] == candidate)
+                        heads[i]++;
+            }
+        }
+    }
+
+    ResolutionOrder* ParentLinkImplementation::implGetResolutionOrder(ProtoContext* context)
+    {
+        ResolutionOrder* currentOrder = this->order.load();
+        if (currentOrder)
+            return currentOrder;
+
+        ResolutionOrder* newOrder;
+        if (this->parent == this->object->parent)
+        {
+            // Eslabón creado por newChild: el orden es el objeto seguido del
+            // orden de su propia cadena, y se comparten sus bloques.
+            newOrder = ResolutionOrder::implPrepend(
+                context,
+                this->object,
+                this->parent ? this->parent->implGetResolutionOrder(context) : nullptr
+            );
+        }
+        else
+        {
+            // L(cadena) = merge(L(p1), ..., L(pn), [p1, ..., pn])
+            std::vector<ObjectSequence> sequences;
+            ObjectSequence direct;
+            for (ParentLinkImplementation* link = this; link; link = link->parent)
+            {
+                ObjectSequence linearization{link->object};
+                if (link->object->parent)
+                    appendOrder(linearization, link->object->parent->implGetResolutionOrder(context));
+                sequences.push_back(std::move(linearization));
+                direct.push_back(link->object);
+            }
+            sequences.push_back(direct);
+
+            ObjectSequence merged;
+            if (!mergeC3(sequences, merged))
+            {
+                // Jerarquía inconsistente: recorrido en profundidad sin repetidos.
+                merged.clear();
+                for (size_t i = 0; i + 1 < sequences.size(); i++)
+                    for (auto* object : sequences[i])
+                        if (std::find(merged.begin(), merged.end(), object) == merged.end())
+                            merged.push_back(object);
+            }
+
+            newOrder = ResolutionOrder::implFromArray(context, merged.size(), merged.data());
+        }
+
+        // Si otro hilo ya lo calculó, se usa el suyo.
+        if (!this->order.compare_exchange_strong(currentOrder, newOrder))
+            return currentOrder;
+        if (context->space)
+            context->space->rememberReference(context, this, newOrder);
+        return newOrder;
+    }
+
+    ProtoObject* ParentLinkImplementation::implLookupAttribute(
+        ProtoContext* context,
+        unsigned long key,
+        ProtoObjectCellImplementation** holder,
+        ProtoAttributeCache::Entry* dependencies
+    )
+    {
+        for (ResolutionOrder* order = this->implGetResolutionOrder(context); order; order = order->next)
+        {
+            for (unsigned long i = 0; i < order->count; i++)
+            {
+                // La versión se lee antes que el estado que se consulta, así
+                // una escritura concurrente invalida la entrada que se guarde.
+                // Un objeto congelado ya no cambia y no cuenta.
+                ProtoObjectCellImplementation* object = order->objects[i];
+                ProtoObjectCellImplementation* oc = object->implGetCurrent(context);
+                if (dependencies && object->mutable_ref && !oc->frozen)
+                {
+                    unsigned int n = dependencies->dependencyCount++;
+                    if (n < PROTO_ATTRIBUTE_CACHE_DEPENDENCIES)
+                    {
+                        dependencies->versions[n] = getMutableVersion(context->space, object->mutable_ref);
+                        dependencies->expected[n] = dependencies->versions[n]->load();
+                    }
+                    oc = object->implGetCurrent(context);
+                }
+
+                ProtoObject* value = oc->implGetOwnAttribute(context, key);
+                if (value != PROTO_NONE)
+                {
+                    if (holder)
+                        *holder = oc;
+                    return value;
+                }
+
+                // En una cadena lineal, lo que sigue son los ancestros del objeto
+                // congelado, que ya están incluidos en su tabla plana.
+                if (oc->flat && this->linear)
+                {
+                    value = oc->implLookupAttribute(context, key);
+                    if (holder && value != PROTO_NONE)
+                        *holder = oc;
+                    return value;
+                }
+
+                // Tampoco siguen los ancestros con que se creó un objeto mutable
+                // que después cambió de padres: se continúa por los actuales.
+                if (this->linear && oc->parent != object->parent)
+                    return oc->parent ? oc->parent->implLookupAttribute(context, key, holder, dependencies) : PROTO_NONE;
+            }
+        }
+
+        return PROTO_NONE;
+    }
+
+    ParentLinkImplementation* ParentLinkImplementation::implGetNextAfter(
+        ProtoContext* context,
+        ProtoObjectCellImplementation* holder
+    )
+    {
+        if (this->linear)
+            return holder->parent;
+
+        // 'holder' puede ser la versión actual de un objeto mutable del orden.
+        ResolutionOrder* order = this->implGetResolutionOrder(context);
+        unsigned long position = 0;
+        for (; order; order = order->next)
+        {
+            for (position = 0; position < order->count; position++)
+            {
+                ProtoObjectCellImplementation* object = order->objects[position];
+                if (object == holder || object->implGetCurrent(context) == holder)
+                    break;
+            }
+            if (position < order->count)
+                break;
+        }
+        if (!order)
+            return holder->parent;
+
+        ResolutionOrder* rest = ResolutionOrder::implFromArray(
+            context,
+            order->count - position - 1,
+            order->objects + position + 1,
+            order->next
+        );
+        if (!rest)
+            return nullptr;
+
+        ObjectSequence objects;
+        appendOrder(objects, rest);
+        ParentLinkImplementation* link = nullptr;
+        for (auto it = objects.rbegin(); it != objects.rend(); ++it)
+            link = new(context) ParentLinkImplementation(context, link, *it);
+
+        // Todavía no es visible para otro hilo: el orden se fija sin CAS.
+        link->order.store(rest);
+        return link;
+    }
+
+
+    unsigned long ParentLinkImplementation::implDepthOf(ProtoObjectCellImplementation* object)
+    {
+        return object->parent ? object->parent->depth : 0;
+    }
+
+    unsigned long ParentLinkImplementation::implAncestorBit(ProtoObjectCellImplementation* object)
+    {
+        // Las celdas están alineadas a 64 bytes: los bits bajos no aportan nada.
+        return object ? 1UL << ((reinterpret_cast<unsigned long>(object) >> 6) & 63) : 0;
+    }
+
+    unsigned long ParentLinkImplementation::implGetAncestorMask() const
+    {
+        if (!this->implHasInlineDisplay())
+            return this->ancestorMask;
+
+        unsigned long mask = 0;
+        for (unsigned long i = 0; i < this->depth; i++)
+            mask |= implAncestorBit(this->implGetInlineAncestor(i));
+        return mask;
+    }
+
+    AttributeSlots* ParentLinkImplementation::implGetDisplay(ProtoContext* context)
+    {
+        // Sólo se pide para armar el display de un eslabón más profundo o no
+        // lineal, que es el que lo guarda.
+        if (this->implHasInlineDisplay())
+        {
+            ProtoObject* ancestors[PARENT_LINK_INLINE_DEPTH];
+            for (unsigned long i = 0; i < this->depth; i++)
+                ancestors[i] = this->implGetInlineAncestor(i)->implAsObject(context);
+            return AttributeSlots::implFromArray(context, this->depth, ancestors);
+        }
+
+        AttributeSlots* currentDisplay = this->display.load();
+        if (currentDisplay)
+            return currentDisplay;
+
+        // El display del linaje principal más este objeto en su profundidad.
+        ParentLinkImplementation* lineage = this->object->parent;
+        AttributeSlots* newDisplay = AttributeSlots::implSetAt(
+            context,
+            lineage ? lineage->implGetDisplay(context) : nullptr,
+            this->depth - 1,
+            this->object->implAsObject(context)
+        );
+
+        if (!this->display.compare_exchange_strong(currentDisplay, newDisplay))
+            return currentDisplay;
+        if (context->space)
+            context->space->rememberReference(context, this, newDisplay);
+        return newDisplay;
+    }
+
+    bool ParentLinkImplementation::implHasAncestor(ProtoContext* context, ProtoObjectCellImplementation* prototype)
+    {
+        unsigned long prototypeDepth = implDepthOf(prototype);
+        if (prototypeDepth < this->depth)
+        {
+            if (this->implHasInlineDisplay())
+                return this->implGetInlineAncestor(prototypeDepth) == prototype;
+            if (AttributeSlots::implGetAt(this->implGetDisplay(context), prototypeDepth) == prototype->implAsObject(context))
+                return true;
+        }
+
+        // En una cadena lineal el display contiene a todos los ancestros.
+        if (this->linear || !(this->ancestorMask & implAncestorBit(prototype)))
+            return false;
+
+        for (ResolutionOrder* order = this->implGetResolutionOrder(context); order; order = order->next)
+        {
+            for (unsigned long i = 0; i < order->count; i++)
+                if (order->objects[i] == prototype)
+                    return true;
+        }
+        return false;
+    }
+
+
+    // --- ResolutionOrder ---
+
+    ResolutionOrder::ResolutionOrder(
+        ProtoContext* context,
+        ResolutionOrder* next,
+        unsigned long count,
+        ProtoObjectCellImplementation** objects
+    ) : Cell(context), next(next), count(count)
+    {
+        for (unsigned long i = 0; i < RESOLUTION_ORDER_SIZE; i++)
+            this->objects[i] = i < count ? objects[i] : nullptr;
+    }
+
+    ResolutionOrder::~ResolutionOrder() = default;
+
+    ResolutionOrder* ResolutionOrder::implFromArray(
+        ProtoContext* context,
+        unsigned long count,
+        ProtoObjectCellImplementation** objects,
+        ResolutionOrder* tail
+    )
+    {
+        // Se construye desde el final para que cada bloque apunte al siguiente.
+        ResolutionOrder* order = tail;
+        unsigned long end = count;
+        while (end > 0)
+        {
+            unsigned long start = end > RESOLUTION_ORDER_SIZE ? end - RESOLUTION_ORDER_SIZE : 0;
+            order = new(context) ResolutionOrder(context, order, end - start, objects + start);
+            end = start;
+        }
+        return order;
+    }
+
+    ResolutionOrder* ResolutionOrder::implPrepend(
+        ProtoContext* context,
+        ProtoObjectCellImplementation* object,
+        ResolutionOrder* order
+    )
+    {
+        // Si el primer bloque tiene lugar se copia con el objeto agregado al frente;
+        // si no, se encadena un bloque nuevo.
+        if (order && order->count < RESOLUTION_ORDER_SIZE)
+        {
+            ProtoObjectCellImplementation* objects[RESOLUTION_ORDER_SIZE];
+            objects[0] = object;
+            for (unsigned long i = 0; i < order->count; i++)
+                objects[i + 1] = order->objects[i];
+            return new(context) ResolutionOrder(context, order->next, order->count + 1, objects);
+        }
+
+        return new(context) ResolutionOrder(context, order, 1, &object);
+    }
+
+    unsigned long ResolutionOrder::getHash(ProtoContext* context)
+    {
+        return Cell::getHash(context);
+    }
+
+    ProtoObject* ResolutionOrder::asObject(ProtoContext* context)
+    {
+        return Cell::asObject(context);
+    }
+
+    void ResolutionOrder::finalize(ProtoContext* context)
+    {
+    }
+
+    void ResolutionOrder::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        if (this->next)
+            method(context, self, this->next);
+
+        for (unsigned long i = 0; i < this->count; i++)
+            method(context, self, reinterpret_cast<Cell*>(this->objects[i]));
+    }
 };
@@ -7,6 +7,8 @@
 
 #include "../headers/proto_internal.h"
 #include <random>
+#include <unordered_set>
+#include <vector>
 
 using namespace std;
 
@@ -62,8 +64,25 @@ namespace proto
             return context->space->tupleIteratorPrototype;
         case POINTER_TAG_SPARSE_LIST_ITERATOR:
             return context->space->sparseListIteratorPrototype;
+        case POINTER_TAG_DICTIONARY:
+            return context->space->dictionaryPrototype;
         case POINTER_TAG_STRING_ITERATOR:
             return context->space->stringIteratorPrototype;
+        case POINTER_TAG_COLLECTION:
+            {
+                pa.op.pointer_tag = POINTER_TAG_OBJECT;
+                switch (reinterpret_cast<CollectionCell*>(pa.oc.objectCell)->kind)
+                {
+                case COLLECTION_SORTED_MAP:
+                    return context->space->sortedMapPrototype;
+                case COLLECTION_DEQUE:
+                    return context->space->dequePrototype;
+                case COLLECTION_PRIORITY_QUEUE:
+                    return context->space->priorityQueuePrototype;
+                default:
+                    return nullptr;
+                }
+            }
         default:
             return nullptr;
         }
@@ -77,37 +96,23 @@ namespace proto
 
         if (pa.op.pointer_tag == POINTER_TAG_OBJECT)
         {
-            auto* oc = pa.oc.objectCell;
-
-            ProtoObject* newObject = (new(context) ProtoObjectCellImplementation(
-                context,
-                oc->parent,
-                0,
-                oc->attributes
-            ))->implAsObject(context);
+            // La copia parte de la versión actual: en un objeto mutable, la
+            // celda original no tiene lo escrito después de crearlo.
+            auto* oc = pa.oc.objectCell->implGetCurrent(context);
 
+            unsigned long mutable_ref = 0;
             if (isMutable)
             {
-                ProtoSparseList* currentRoot;
-                unsigned long randomId = 0;
-                do
-                {
-                    currentRoot = context->space->mutableRoot.load();
+                mutable_ref = generate_mutable_ref(context);
+                if (!mutable_ref)
+                    return PROTO_NONE;
+            }
 
-                    randomId = generate_mutable_ref();
+            ProtoObject* newObject = oc->implWithParent(context, oc->parent, mutable_ref)->implAsObject(context);
+
+            if (mutable_ref)
+                getMutableSlot(context->space, mutable_ref)->store(newObject);
 
-                    if (currentRoot->has(context, randomId))
-                        continue;
-                }
-                while (!context->space->mutableRoot.compare_exchange_strong(
-                    currentRoot,
-                    (ProtoSparseList*)currentRoot->setAt(
-                        context,
-                        randomId,
-                        newObject
-                    )
-                ));
-            }
             return newObject;
         }
         return PROTO_NONE;
@@ -123,39 +128,28 @@ namespace proto
         {
             auto* oc = pa.oc.objectCell;
 
-            auto* newObject = new(context) ProtoObjectCellImplementation(
+            unsigned long mutable_ref = 0;
+            if (isMutable)
+            {
+                mutable_ref = generate_mutable_ref(context);
+                if (!mutable_ref)
+                    return PROTO_NONE;
+            }
+
+            ProtoObject* newObject = (new(context) ProtoObjectCellImplementation(
                 context,
                 new(context) ParentLinkImplementation(
                     context,
                     oc->parent,
                     oc
                 ),
-                0,
-                new(context) ProtoSparseListImplementation(context)
-            );
-
-            if (isMutable)
-            {
-                ProtoSparseList* currentRoot;
-                unsigned long randomId = 0;
-                do
-                {
-                    currentRoot = context->space->mutableRoot.load();
+                mutable_ref,
+                context->space ? context->space->rootShape : nullptr
+            ))->implAsObject(context);
 
-                    randomId = generate_mutable_ref();
+            if (mutable_ref)
+                getMutableSlot(context->space, mutable_ref)->store(newObject);
 
-                    if (currentRoot->has(context, (unsigned long)randomId))
-                        continue;
-                }
-                while (!context->space->mutableRoot.compare_exchange_strong(
-                    currentRoot,
-                    (ProtoSparseList*)currentRoot->setAt(
-                        context,
-                        randomId,
-                        newObject
-                    )
-                ));
-            }
             return newObject;
         }
         return PROTO_NONE;
@@ -169,20 +163,31 @@ namespace proto
 
         if (pa.op.pointer_tag == POINTER_TAG_OBJECT)
         {
-            auto* oc = pa.oc.objectCell;
+            auto* oc = pa.oc.objectCell->implGetCurrent(c);
 
-            ParentLinkImplementation* currentParent = oc->parent;
-            while (currentParent)
-            {
-                if (currentParent->object->asObject(c) == prototype)
-                    return PROTO_TRUE;
-                currentParent = currentParent->parent;
-            }
+            ProtoObjectPointer pp;
+            pp.oid.oid = const_cast<ProtoObject*>(prototype);
+            if (oc->parent && pp.oid.oid && pp.op.pointer_tag == POINTER_TAG_OBJECT &&
+                oc->parent->implHasAncestor(c, pp.oc.objectCell))
+                return PROTO_TRUE;
         }
         return PROTO_FALSE;
     }
 
-    ProtoObject* ProtoObject::getAttribute(ProtoContext* context, ProtoString* name)
+    ProtoAttributeCache::ProtoAttributeCache()
+    {
+        this->reset();
+    }
+
+    void ProtoAttributeCache::reset()
+    {
+        this->key = 0;
+        this->nextVictim = 0;
+        for (auto& entry : this->entries)
+            entry = Entry{nullptr, nullptr, nullptr, nullptr, -1, PROTO_NONE, 0, {}, {}};
+    }
+
+    ProtoObject* ProtoObject::getAttribute(ProtoContext* context, ProtoString* name, ProtoAttributeCache* cache)
     {
         ProtoObjectPointer pa;
 
@@ -190,28 +195,14 @@ namespace proto
 
         if (pa.op.pointer_tag == POINTER_TAG_OBJECT)
         {
-            auto* oc = pa.oc.objectCell;
-            if (oc->mutable_ref)
-                oc = static_cast<ProtoObjectCellImplementation*>(context->space->mutableRoot.load()->getAt(
-                    context, oc->mutable_ref));
-
-            unsigned long hash = name->getHash(context);
-            do
-            {
-                if (oc->attributes->has(context, hash))
-                    return oc->attributes->getAt(context, hash);
-                if (oc->parent && oc->parent->object)
-                    oc = oc->parent->object;
-                else
-                    break;
-            }
-            while (oc);
+            auto* oc = pa.oc.objectCell->implGetCurrent(context);
+            return oc->implLookupAttribute(context, name->getHash(context), cache);
         }
 
         return PROTO_NONE;
     }
 
-    ProtoObject* ProtoObject::hasAttribute(ProtoContext* context, ProtoString* name)
+    ProtoObject* ProtoObject::hasAttribute(ProtoContext* context, ProtoString* name, ProtoAttributeCache* cache)
     {
         ProtoObjectPointer pa;
 
@@ -219,24 +210,9 @@ namespace proto
 
         if (pa.op.pointer_tag == POINTER_TAG_OBJECT)
         {
-            auto* oc = pa.oc.objectCell;
-            if (oc->mutable_ref)
-            {
-                oc = static_cast<ProtoObjectCellImplementation*>(context->space->mutableRoot.load()->getAt(
-                    context, oc->mutable_ref));
-            }
-
-            unsigned long hash = name->getHash(context);
-            do
-            {
-                if (oc->attributes->has(context, hash))
-                    return oc->attributes->getAt(context, hash);
-                if (oc->parent && oc->parent->object)
-                    oc = oc->parent->object;
-                else
-                    break;
-            }
-            while (oc);
+            auto* oc = pa.oc.objectCell->implGetCurrent(context);
+            if (oc->implLookupAttribute(context, name->getHash(context), cache) != PROTO_NONE)
+                return PROTO_TRUE;
         }
         return PROTO_FALSE;
     }
@@ -250,67 +226,228 @@ namespace proto
         if (pa.op.pointer_tag == POINTER_TAG_OBJECT)
         {
             auto* oc = pa.oc.objectCell;
-            ProtoObjectCellImplementation* inmutableBase = nullptr;
-            ProtoSparseList* currentRoot;
-            if (oc->mutable_ref)
-            {
-                inmutableBase = oc;
-                currentRoot = context->space->mutableRoot.load();
-                oc = static_cast<ProtoObjectCellImplementation*>(currentRoot->getAt(context, oc->mutable_ref));
-            }
+            // Un objeto congelado no admite cambios: la escritura se rechaza.
+            if (oc->frozen)
+                return PROTO_NONE;
 
             unsigned long hash = name->getHash(context);
-            auto* newObject = new(context) ProtoObjectCellImplementation(
-                context,
-                oc->parent,
-                oc->mutable_ref,
-                static_cast<ProtoSparseListImplementation*>(oc->attributes->setAt(context, hash, value))
-            );
 
-            if (inmutableBase)
+            if (oc->mutable_ref)
             {
-                ProtoSparseList* newRoot;
+                // Se reintenta sólo si otro hilo cambió el objeto entre la
+                // lectura y el CAS; cada objeto mutable tiene su propia posición.
+                std::atomic<ProtoObject*>* slot = getMutableSlot(context->space, oc->mutable_ref);
+                ProtoObject* current = slot->load();
+                ProtoObject* newObject;
                 do
                 {
-                    currentRoot = context->space->mutableRoot.load();
-                    newRoot = (ProtoSparseList*)currentRoot->setAt(
-                        context, inmutableBase->mutable_ref, newObject);
+                    ProtoObjectPointer pc;
+                    pc.oid.oid = current;
+                    // Un freeze concurrente ganó el CAS: el objeto ya no cambia.
+                    if (pc.oc.objectCell->frozen)
+                        return PROTO_NONE;
+                    newObject = pc.oc.objectCell->implSetOwnAttribute(context, hash, value)->implAsObject(context);
                 }
-                while (context->space->mutableRoot.compare_exchange_strong(
-                    currentRoot,
-                    newRoot
-                ));
+                while (!slot->compare_exchange_weak(current, newObject));
+
+                // El objeto mutable puede ser prototipo de otros: invalidar los
+                // caches que pasaron por él, y sólo esos.
+                getMutableVersion(context->space, oc->mutable_ref)->fetch_add(1);
                 return this;
             }
-            else
-                return newObject;
+
+            return oc->implSetOwnAttribute(context, hash, value);
         }
         return this;
     }
 
-    ProtoObject* ProtoObject::hasOwnAttribute(ProtoContext* context, ProtoString* name)
+    ProtoObject* ProtoObject::setAttributes(
+        ProtoContext* context,
+        unsigned int count,
+        ProtoString** names,
+        ProtoObject** values
+    )
     {
         ProtoObjectPointer pa;
 
         pa.oid.oid = this;
 
-        if (pa.op.pointer_tag == POINTER_TAG_OBJECT)
+        if (pa.op.pointer_tag != POINTER_TAG_OBJECT)
+            return this;
+        if (pa.oc.objectCell->frozen)
+            return PROTO_NONE;
+
+        // Las claves de los lotes habituales se calculan en la pila.
+        unsigned long keyBuffer[SHAPE_MAX_SLOTS];
+        std::vector<unsigned long> keyVector;
+        unsigned long* keys = keyBuffer;
+        if (count > SHAPE_MAX_SLOTS)
         {
-            const auto* oc = pa.oc.objectCell;
-            ProtoSparseList* currentRoot;
-            if (oc->mutable_ref)
+            keyVector.resize(count);
+            keys = keyVector.data();
+        }
+        for (unsigned int i = 0; i < count; i++)
+            keys[i] = names[i]->getHash(context);
+
+        auto* oc = pa.oc.objectCell;
+        if (oc->mutable_ref)
+        {
+            std::atomic<ProtoObject*>* slot = getMutableSlot(context->space, oc->mutable_ref);
+            ProtoObject* current = slot->load();
+            ProtoObject* newObject;
+            do
             {
-                currentRoot = context->space->mutableRoot.load();
-                oc = static_cast<ProtoObjectCellImplementation*>(currentRoot->getAt(context, oc->mutable_ref));
+                ProtoObjectPointer pc;
+                pc.oid.oid = current;
+                if (pc.oc.objectCell->frozen)
+                    return PROTO_NONE;
+                newObject = pc.oc.objectCell->implSetOwnAttributes(context, count, keys, values)->implAsObject(context);
             }
+            while (!slot->compare_exchange_weak(current, newObject));
 
-            unsigned long hash = name->getHash(context);
-            return oc->attributes->has(context, hash) ? PROTO_TRUE : PROTO_FALSE;
+            getMutableVersion(context->space, oc->mutable_ref)->fetch_add(1);
+            return this;
+        }
+
+        return oc->implSetOwnAttributes(context, count, keys, values);
+    }
+
+    namespace
+    {
+        void collectSlotCells(AttributeSlots* slots, std::vector<Cell*>& cells)
+        {
+            if (!slots)
+                return;
+
+            cells.push_back(slots);
+            if (slots->height)
+                for (auto* child : slots->pointers.children)
+                    collectSlotCells(child, cells);
+        }
+
+        void collectFrozenCells(ProtoObjectCellImplementation* frozenObject, std::vector<Cell*>& cells)
+        {
+            cells.push_back(frozenObject);
+            if (frozenObject->spilled)
+                collectSlotCells(frozenObject->slots, cells);
         }
+
+        void freezeMutable(
+            ProtoContext* context,
+            ProtoObjectCellImplementation* object,
+            std::vector<Cell*>& cells,
+            std::unordered_set<Cell*>& visited
+        );
+
+        // Congela lo que puede cambiar en una cadena de padres: los ancestros
+        // mutables. Los inmutables ya no cambian y sólo se recorren. Las celdas
+        // de la cadena se juntan para pasarlas a la región inmortal; formas y
+        // valores siguen en el heap normal.
+        void freezeAncestors(
+            ProtoContext* context,
+            ParentLinkImplementation* link,
+            std::vector<Cell*>& cells,
+            std::unordered_set<Cell*>& visited
+        )
+        {
+            for (; link && visited.insert(link).second; link = link->parent)
+            {
+                cells.push_back(link);
+
+                ProtoObjectCellImplementation* object = link->object;
+                if (object->mutable_ref)
+                {
+                    freezeMutable(context, object, cells, visited);
+                }
+                else if (visited.insert(object).second)
+                {
+                    cells.push_back(object);
+                    freezeAncestors(context, object->parent, cells, visited);
+                }
+            }
+        }
+
+        // Un objeto mutable se congela en su posición: la tabla plana congelada
+        // se publica con un CAS y conserva la identidad del objeto. Una escritura
+        // que ya estaba en curso hace fallar el CAS y la tabla se vuelve a
+        // calcular; las siguientes encuentran la tabla congelada y no cambian nada.
+        void freezeMutable(
+            ProtoContext* context,
+            ProtoObjectCellImplementation* object,
+            std::vector<Cell*>& cells,
+            std::unordered_set<Cell*>& visited
+        )
+        {
+            if (!visited.insert(object).second)
+                return;
+            cells.push_back(object);
+
+            std::atomic<ProtoObject*>* slot = getMutableSlot(context->space, object->mutable_ref);
+            ProtoObject* current = slot->load();
+            ProtoObjectCellImplementation* flatTable;
+            do
+            {
+                ProtoObjectPointer pc;
+                pc.oid.oid = current;
+                if (pc.oc.objectCell->frozen)
+                    return;
+
+                // Los ancestros primero, así la tabla plana ya no puede quedar vieja.
+                freezeAncestors(context, pc.oc.objectCell->parent, cells, visited);
+                flatTable = pc.oc.objectCell->implFreeze(context);
+            }
+            while (!slot->compare_exchange_weak(current, flatTable->implAsObject(context)));
+
+            collectFrozenCells(flatTable, cells);
+        }
+    } // fin del namespace anónimo
+
+    ProtoObject* ProtoObject::freeze(ProtoContext* context)
+    {
+        ProtoObjectPointer pa;
+
+        pa.oid.oid = this;
+
+        if (pa.op.pointer_tag != POINTER_TAG_OBJECT || pa.oc.objectCell->frozen)
+            return this;
+
+        auto* oc = pa.oc.objectCell;
+        std::vector<Cell*> cells;
+        std::unordered_set<Cell*> visited;
+        ProtoObject* result = this;
+        if (oc->mutable_ref)
+        {
+            freezeMutable(context, oc, cells, visited);
+        }
+        else
+        {
+            // Una celda inmutable ya publicada no se modifica: como cualquier
+            // otro cambio, congelarla devuelve una copia.
+            freezeAncestors(context, oc->parent, cells, visited);
+            ProtoObjectCellImplementation* frozenObject = oc->implFreeze(context);
+            collectFrozenCells(frozenObject, cells);
+            result = frozenObject->implAsObject(context);
+        }
+
+        // El grafo congelado queda fuera del trazado normal del GC.
+        if (context->space)
+            context->space->pinCells(context, cells.size(), cells.data());
+
+        return result;
+    }
+
+    ProtoObject* ProtoObject::isFrozen(ProtoContext* context)
+    {
+        ProtoObjectPointer pa;
+
+        pa.oid.oid = this;
+
+        if (pa.op.pointer_tag == POINTER_TAG_OBJECT && pa.oc.objectCell->implGetCurrent(context)->frozen)
+            return PROTO_TRUE;
         return PROTO_FALSE;
-    };
+    }
 
-    ProtoSparseList* ProtoObject::getAttributes(ProtoContext* context)
+    ProtoObject* ProtoObject::hasOwnAttribute(ProtoContext* context, ProtoString* name)
     {
         ProtoObjectPointer pa;
 
@@ -318,38 +455,119 @@ namespace proto
 
         if (pa.op.pointer_tag == POINTER_TAG_OBJECT)
         {
-            auto* oc = pa.oc.objectCell;
-            ProtoSparseList* currentRoot = nullptr;
-            if (oc->mutable_ref)
-            {
-                currentRoot = context->space->mutableRoot.load();
-                oc = static_cast<ProtoObjectCellImplementation*>(currentRoot->getAt(context, oc->mutable_ref));
-            }
+            auto* oc = pa.oc.objectCell->implGetCurrent(context);
+
+            unsigned long hash = name->getHash(context);
+            return oc->implGetOwnAttribute(context, hash) != PROTO_NONE ? PROTO_TRUE : PROTO_FALSE;
+        }
+        return PROTO_FALSE;
+    };
+
+    namespace
+    {
+        // Recorrido de los atributos visibles: el receptor y luego su orden de
+        // resolución. Un atributo de un nivel se informa sólo si ningún nivel
+        // anterior lo define, lo que se verifica sin reservar memoria.
+        struct AttributeView
+        {
+            ProtoObjectCellImplementation* receiver;
+            ResolutionOrder* order;
+            ResolutionOrder* currentBlock;
+            unsigned long currentIndex;
+            bool atReceiver;
+            void* self;
+            void (*method)(ProtoContext* context, void* self, unsigned long key, ProtoObject* value);
+        };
+
+        bool isShadowed(ProtoContext* context, AttributeView* view, unsigned long key)
+        {
+            if (view->atReceiver)
+                return false;
 
-            ProtoSparseList* attributes = context->newSparseList();
+            if (view->receiver->implGetOwnAttribute(context, key) != PROTO_NONE)
+                return true;
 
-            while (oc)
+            for (ResolutionOrder* order = view->order; order; order = order->next)
             {
-                auto* ai = reinterpret_cast<ProtoListIterator*>(oc->attributes->getIterator(context));
-                while (ai->hasNext(context))
-                {
-                    const unsigned long attributeKey = reinterpret_cast<ProtoSparseListIterator*>(ai)->nextKey(context);
-                    ProtoObject* attributeValue = oc->attributes->getAt(context, attributeKey);
-                    attributes = (ProtoSparseList*)attributes->setAt(
-                        context,
-                        attributeKey,
-                        attributeValue
-                    );
-                    ai = ai->advance(context);
-                }
-                if (oc->parent)
+                for (unsigned long i = 0; i < order->count; i++)
                 {
-                    oc = oc->parent->object;
-                    if (oc->mutable_ref)
-                        oc = static_cast<ProtoObjectCellImplementation*>(currentRoot->getAt(context, oc->mutable_ref));
+                    if (order == view->currentBlock && i == view->currentIndex)
+                        return false;
+                    if (order->objects[i]->implGetCurrent(context)->implGetOwnAttribute(context, key) != PROTO_NONE)
+                        return true;
                 }
             }
+            return false;
+        }
+
+        void visitAttribute(ProtoContext* context, void* self, unsigned long key, ProtoObject* value)
+        {
+            auto* view = static_cast<AttributeView*>(self);
+            if (value != PROTO_NONE && !isShadowed(context, view, key))
+                view->method(context, view->self, key, value);
+        }
 
+        void collectAttribute(ProtoContext* context, void* self, unsigned long key, ProtoObject* value)
+        {
+            auto** attributes = static_cast<ProtoSparseListImplementation**>(self);
+            *attributes = (*attributes)->implSetAt(context, key, value);
+        }
+    }
+
+    void ProtoObject::processAttributes(
+        ProtoContext* context,
+        void* self,
+        void (*method)(ProtoContext* context, void* self, unsigned long key, ProtoObject* value)
+    )
+    {
+        ProtoObjectPointer pa;
+
+        pa.oid.oid = this;
+
+        if (pa.op.pointer_tag != POINTER_TAG_OBJECT)
+            return;
+
+        auto* oc = pa.oc.objectCell->implGetCurrent(context);
+
+        AttributeView view = {
+            oc,
+            oc->parent ? oc->parent->implGetResolutionOrder(context) : nullptr,
+            nullptr,
+            0,
+            true,
+            self,
+            method
+        };
+
+        // Un objeto congelado ya tiene todos sus atributos visibles en su tabla plana.
+        if (oc->flat)
+        {
+            oc->implProcessFlatAttributes(context, &view, visitAttribute);
+            return;
+        }
+
+        oc->implProcessOwnAttributes(context, &view, visitAttribute);
+
+        view.atReceiver = false;
+        for (view.currentBlock = view.order; view.currentBlock; view.currentBlock = view.currentBlock->next)
+        {
+            for (view.currentIndex = 0; view.currentIndex < view.currentBlock->count; view.currentIndex++)
+                view.currentBlock->objects[view.currentIndex]->implGetCurrent(context)->implProcessOwnAttributes(
+                    context, &view, visitAttribute);
+        }
+    }
+
+    ProtoSparseList* ProtoObject::getAttributes(ProtoContext* context)
+    {
+        ProtoObjectPointer pa;
+
+        pa.oid.oid = this;
+
+        if (pa.op.pointer_tag == POINTER_TAG_OBJECT)
+        {
+            // Copia concreta de la vista de atributos.
+            auto* attributes = new(context) ProtoSparseListImplementation(context);
+            this->processAttributes(context, &attributes, collectAttribute);
             return attributes;
         }
         return nullptr;
@@ -362,18 +580,8 @@ namespace proto
         pa.oid.oid = this;
 
         if (pa.op.pointer_tag == POINTER_TAG_OBJECT)
-        {
-            auto* oc = pa.oc.objectCell;
+            return pa.oc.objectCell->implGetCurrent(context)->implGetOwnAttributes(context);
 
-            if (oc->mutable_ref)
-            {
-                auto* mutableCurrentObject = reinterpret_cast<ProtoObjectCell*>(context->space->mutableRoot.load()->
-                    getAt(context, oc->mutable_ref));
-                return mutableCurrentObject->attributes;
-            }
-            else
-                return oc->attributes;
-        }
         return nullptr;
     };
 
@@ -387,12 +595,15 @@ namespace proto
         {
             ProtoList* parents = new(context) ProtoListImplementation(context);
 
-            auto* oc = pa.oc.objectCell;
-            auto* parent = (ParentLinkImplementation*)oc->parent;
-            while (parent)
+            // Los padres se devuelven en su orden de resolución.
+            auto* oc = pa.oc.objectCell->implGetCurrent(context);
+            if (oc->parent)
             {
-                parents = (ProtoList*)parents->appendLast(context, parent->object->asObject(context));
-                parent = parent->parent;
+                for (ResolutionOrder* order = oc->parent->implGetResolutionOrder(context); order; order = order->next)
+                {
+                    for (unsigned long i = 0; i < order->count; i++)
+                        parents = (ProtoList*)parents->appendLast(context, order->objects[i]->implAsObject(context));
+                }
             }
 
             return parents;
@@ -425,41 +636,47 @@ namespace proto
 
     ProtoObject* ProtoObject::addParent(ProtoContext* context, ProtoObject* newParent)
     {
-        ProtoObjectPointer pa;
+        ProtoObjectPointer pa, pp;
 
         pa.oid.oid = this;
+        pp.oid.oid = newParent;
 
-        ProtoSparseList* existingParents = context->newSparseList();
+        if (pa.op.pointer_tag != POINTER_TAG_OBJECT)
+            return this;
+        if (!newParent || pp.op.pointer_tag != POINTER_TAG_OBJECT)
+            return PROTO_NONE;
 
-        if (pa.op.pointer_tag == POINTER_TAG_OBJECT)
-        {
-            auto* oc = pa.oc.objectCell;
+        auto* oc = pa.oc.objectCell;
+        if (oc->frozen)
+            return PROTO_NONE;
 
-            // Collect existing parents
-            ParentLinkImplementation* currentParent = oc->parent;
-            while (currentParent)
+        // La cadena nueva tiene su propio orden de resolución, que se calcula
+        // la primera vez que se pide; el de la cadena anterior no se toca.
+        if (oc->mutable_ref)
+        {
+            std::atomic<ProtoObject*>* slot = getMutableSlot(context->space, oc->mutable_ref);
+            ProtoObject* current = slot->load();
+            ProtoObject* newObject;
+            do
             {
-                existingParents = (ProtoSparseList*)existingParents->setAt(
-                    context,
-                    currentParent->object->getHash(context),
-                    nullptr
-                );
-                currentParent = currentParent->parent;
-            };
-
-            auto* newParentLink = new(context) ParentLinkImplementation(
-                context, oc->parent, reinterpret_cast<ProtoObjectCellImplementation*>(newParent)
-            );
+                ProtoObjectPointer pc;
+                pc.oid.oid = current;
+                auto* currentCell = pc.oc.objectCell;
+                if (currentCell->frozen)
+                    return PROTO_NONE;
+
+                auto* newParentLink = new(context) ParentLinkImplementation(context, currentCell->parent, pp.oc.objectCell);
+                newObject = currentCell->implWithParent(context, newParentLink, oc->mutable_ref)->implAsObject(context);
+            }
+            while (!slot->compare_exchange_weak(current, newObject));
 
-            return (new(context) ProtoObjectCellImplementation(
-                context,
-                newParentLink,
-                oc->mutable_ref,
-                oc->attributes
-            ))->implAsObject(context);
-        }
-        else
+            // Los caches que pasaron por este objeto dependen de sus padres.
+            getMutableVersion(context->space, oc->mutable_ref)->fetch_add(1);
             return this;
+        }
+
+        auto* newParentLink = new(context) ParentLinkImplementation(context, oc->parent, pp.oc.objectCell);
+        return oc->implWithParent(context, newParentLink, 0)->implAsObject(context);
     }
 
 
@@ -640,6 +857,37 @@ namespace proto
         return nullptr;
     }
 
+    ProtoDictionary* ProtoObject::asDictionary(ProtoContext* context)
+    {
+        ProtoObjectPointer p{};
+        p.oid.oid = (ProtoObject*)this;
+        if (p.op.pointer_tag == POINTER_TAG_DICTIONARY)
+        {
+            p.op.pointer_tag = POINTER_TAG_OBJECT;
+            return reinterpret_cast<ProtoDictionary*>(p.oc.objectCell);
+        }
+
+        return nullptr;
+    }
+
+    ProtoSortedMap* ProtoObject::asSortedMap(ProtoContext* context)
+    {
+        auto* collection = CollectionCell::fromObject(this, COLLECTION_SORTED_MAP);
+        return collection ? static_cast<ProtoSortedMapImplementation*>(collection) : nullptr;
+    }
+
+    ProtoDeque* ProtoObject::asDeque(ProtoContext* context)
+    {
+        auto* collection = CollectionCell::fromObject(this, COLLECTION_DEQUE);
+        return collection ? static_cast<ProtoDequeImplementation*>(collection) : nullptr;
+    }
+
+    ProtoPriorityQueue* ProtoObject::asPriorityQueue(ProtoContext* context)
+    {
+        auto* collection = CollectionCell::fromObject(this, COLLECTION_PRIORITY_QUEUE);
+        return collection ? static_cast<ProtoPriorityQueueImplementation*>(collection) : nullptr;
+    }
+
 
     unsigned long ProtoObject::getHash(ProtoContext* context)
     {
@@ -655,21 +903,89 @@ namespace proto
         return p.op.pointer_tag != POINTER_TAG_EMBEDEDVALUE;
     }
 
+    namespace
+    {
+        // Resuelve un método desde el objeto (o desde nextParent para una llamada
+        // a super) y devuelve el eslabón donde debe continuar una llamada a super:
+        // lo que sigue al método en el orden de resolución del receptor.
+        ProtoMethodCellImplementation* resolveMethod(
+            ProtoContext* context,
+            ProtoObject* start,
+            ParentLink* nextParent,
+            ProtoString* method,
+            ProtoAttributeCache* cache,
+            ParentLink** methodParent
+        )
+        {
+            ProtoObjectCellImplementation* holder = nullptr;
+            ParentLinkImplementation* chain;
+            ProtoObjectPointer pm;
+            if (nextParent)
+            {
+                // Llamada a super: se busca en el orden de resolución de esa cadena.
+                chain = toImpl<ParentLinkImplementation>(nextParent);
+                pm.oid.oid = chain->implLookupAttribute(context, method->getHash(context), &holder);
+            }
+            else
+            {
+                ProtoObjectPointer pa;
+                pa.oid.oid = start;
+                if (pa.op.pointer_tag != POINTER_TAG_OBJECT)
+                    return nullptr;
+
+                ProtoObjectCellImplementation* current = pa.oc.objectCell->implGetCurrent(context);
+                pm.oid.oid = current->implLookupAttribute(context, method->getHash(context), cache, &holder);
+                chain = holder == current ? nullptr : current->parent;
+            }
+            if (pm.oid.oid == PROTO_NONE || pm.op.pointer_tag != POINTER_TAG_METHOD)
+                return nullptr;
+
+            *methodParent = chain ? chain->implGetNextAfter(context, holder) : holder->parent;
+
+            pm.op.pointer_tag = POINTER_TAG_OBJECT;
+            return reinterpret_cast<ProtoMethodCellImplementation*>(pm.oid.oid);
+        }
+    }
+
     ProtoObject* ProtoObject::call(ProtoContext* c,
                                    ParentLink* nextParent,
                                    ProtoString* method,
                                    ProtoObject* self,
                                    ProtoList* unnamedParametersList,
-                                   ProtoSparseList* keywordParametersDict)
+                                   ProtoSparseList* keywordParametersDict,
+                                   ProtoAttributeCache* cache)
     {
-        return PROTO_NONE;
+        ParentLink* methodParent = nullptr;
+        ProtoMethodCellImplementation* target = resolveMethod(c, this, nextParent, method, cache, &methodParent);
+        if (!target)
+            return PROTO_NONE;
+
+        return target->implInvoke(c, self, methodParent, unnamedParametersList, keywordParametersDict);
+    }
+
+    ProtoObject* ProtoObject::callFast(ProtoContext* c,
+                                       ParentLink* nextParent,
+                                       ProtoString* method,
+                                       ProtoObject* self,
+                                       unsigned int argc,
+                                       ProtoObject** argv,
+                                       ProtoAttributeCache* cache)
+    {
+        ParentLink* methodParent = nullptr;
+        ProtoMethodCellImplementation* target = resolveMethod(c, this, nextParent, method, cache, &methodParent);
+        if (!target)
+            return PROTO_NONE;
+
+        return target->implInvokeFast(c, self, methodParent, argc, argv);
     }
 
     Cell* ProtoObject::asCell(ProtoContext* context)
     {
+        // Las celdas están alineadas a 64 bytes: basta con limpiar la etiqueta.
         ProtoObjectPointer p{};
         p.oid.oid = this;
-        return p.cell.cell;
+        p.op.pointer_tag = 0;
+        return reinterpret_cast<Cell*>(p.oid.oid);
     }
 
     void ProtoObject::processReferences(ProtoContext* context,
@@ -829,6 +1145,28 @@ namespace proto
         return toImpl<ProtoListImplementation>(this)->implGetIterator(context);
     }
 
+    ProtoListTransient* ProtoList::beginTransient(ProtoContext* context)
+    {
+        return toImpl<ProtoListImplementation>(this)->implBeginTransient(context);
+    }
+
+    // ------------------- ProtoListTransient -------------------
+
+    ProtoListTransient* ProtoListTransient::appendLast(ProtoContext* context, ProtoObject* value)
+    {
+        return toImpl<ProtoListTransientImplementation>(this)->implAppendLast(context, value);
+    }
+
+    unsigned long ProtoListTransient::getSize(ProtoContext* context)
+    {
+        return toImpl<ProtoListTransientImplementation>(this)->implGetSize(context);
+    }
+
+    ProtoList* ProtoListTransient::persistent(ProtoContext* context)
+    {
+        return toImpl<ProtoListTransientImplementation>(this)->implPersistent(context);
+    }
+
     // ------------------- ProtoTupleIterator -------------------
 
     int ProtoTupleIterator::hasNext(ProtoContext* context)
@@ -953,6 +1291,28 @@ namespace proto
         return toImpl<ProtoTupleImplementation>(this)->implGetIterator(context);
     }
 
+    ProtoTupleTransient* ProtoTuple::beginTransient(ProtoContext* context)
+    {
+        return toImpl<ProtoTupleImplementation>(this)->implBeginTransient(context);
+    }
+
+    // ------------------- ProtoTupleTransient -------------------
+
+    ProtoTupleTransient* ProtoTupleTransient::appendLast(ProtoContext* context, ProtoObject* value)
+    {
+        return toImpl<ProtoTupleTransientImplementation>(this)->implAppendLast(context, value);
+    }
+
+    unsigned long ProtoTupleTransient::getSize(ProtoContext* context)
+    {
+        return toImpl<ProtoTupleTransientImplementation>(this)->implGetSize(context);
+    }
+
+    ProtoTuple* ProtoTupleTransient::persistent(ProtoContext* context)
+    {
+        return toImpl<ProtoTupleTransientImplementation>(this)->implPersistent(context);
+    }
+
     // ------------------- ProtoStringIterator -------------------
 
     int ProtoStringIterator::hasNext(ProtoContext* context)
@@ -1113,55 +1473,434 @@ namespace proto
 
     bool ProtoSparseList::has(ProtoContext* context, unsigned long index)
     {
-        return toImpl<ProtoSparseListImplementation>(this)->implHas(context, index);
+        return toImpl<SparseListCell>(this)->implHas(context, index);
+    }
+
+    bool ProtoSparseList::isOrdered(ProtoContext* context)
+    {
+        return toImpl<SparseListCell>(this)->type != SPARSE_LIST_HASH;
     }
 
     ProtoObject* ProtoSparseList::getAt(ProtoContext* context, unsigned long index)
     {
-        return toImpl<ProtoSparseListImplementation>(this)->implGetAt(context, index);
+        return toImpl<SparseListCell>(this)->implGetAt(context, index);
     }
 
     ProtoSparseList* ProtoSparseList::setAt(ProtoContext* context, unsigned long index, ProtoObject* value)
     {
-        return toImpl<ProtoSparseListImplementation>(this)->implSetAt(context, index, value);
+        return ProtoSparseArrayImplementation::implAdapt(
+            context, toImpl<SparseListCell>(this)->implSetAt(context, index, value));
     }
 
     ProtoSparseList* ProtoSparseList::removeAt(ProtoContext* context, unsigned long index)
     {
-        return toImpl<ProtoSparseListImplementation>(this)->implRemoveAt(context, index);
+        // El árbol devuelve nullptr al quitar su último nodo.
+        SparseListCell* result = toImpl<SparseListCell>(this)->implRemoveAt(context, index);
+        return result ? result : new(context) ProtoSparseListImplementation(context);
+    }
+
+    unsigned long ProtoSparseList::countRange(ProtoContext* context, unsigned long from, unsigned long to)
+    {
+        return toImpl<SparseListCell>(this)->implAsTree(context)->implCountRange(context, from, to);
+    }
+
+    ProtoSparseList* ProtoSparseList::sliceRange(ProtoContext* context, unsigned long from, unsigned long to)
+    {
+        return toImpl<SparseListCell>(this)->implAsTree(context)->implSliceRange(context, from, to);
+    }
+
+    ProtoSparseList* ProtoSparseList::removeRange(ProtoContext* context, unsigned long from, unsigned long to)
+    {
+        return toImpl<SparseListCell>(this)->implAsTree(context)->implRemoveRange(context, from, to);
+    }
+
+    bool ProtoSparseList::firstKey(ProtoContext* context, unsigned long* key)
+    {
+        return toImpl<SparseListCell>(this)->implAsTree(context)->implFirstKey(context, key);
+    }
+
+    bool ProtoSparseList::lastKey(ProtoContext* context, unsigned long* key)
+    {
+        return toImpl<SparseListCell>(this)->implAsTree(context)->implLastKey(context, key);
+    }
+
+    bool ProtoSparseList::floor(ProtoContext* context, unsigned long key, unsigned long* found)
+    {
+        return toImpl<SparseListCell>(this)->implAsTree(context)->implFloor(context, key, found);
+    }
+
+    bool ProtoSparseList::ceiling(ProtoContext* context, unsigned long key, unsigned long* found)
+    {
+        return toImpl<SparseListCell>(this)->implAsTree(context)->implCeiling(context, key, found);
+    }
+
+    namespace
+    {
+        // El álgebra de conjuntos trabaja sobre árboles. Si el resultado es uno
+        // de los operandos ya convertidos, se devuelve el operando original.
+        ProtoSparseList* originalOperand(
+            ProtoSparseListImplementation* result,
+            ProtoSparseList* left, ProtoSparseListImplementation* leftTree,
+            ProtoSparseList* right, ProtoSparseListImplementation* rightTree)
+        {
+            if (result == leftTree)
+                return left;
+            if (result == rightTree)
+                return right;
+            return result;
+        }
+    }
+
+    ProtoSparseList* ProtoSparseList::unionWith(
+        ProtoContext* context, ProtoSparseList* other, void* self, ProtoMergeFunction merge)
+    {
+        auto* tree = toImpl<SparseListCell>(this)->implAsTree(context);
+        auto* otherTree = toImpl<SparseListCell>(other)->implAsTree(context);
+        return originalOperand(tree->implUnion(context, otherTree, self, merge), this, tree, other, otherTree);
+    }
+
+    ProtoSparseList* ProtoSparseList::intersectionWith(
+        ProtoContext* context, ProtoSparseList* other, void* self, ProtoMergeFunction merge)
+    {
+        auto* tree = toImpl<SparseListCell>(this)->implAsTree(context);
+        auto* otherTree = toImpl<SparseListCell>(other)->implAsTree(context);
+        return originalOperand(tree->implIntersection(context, otherTree, self, merge), this, tree, other, otherTree);
+    }
+
+    ProtoSparseList* ProtoSparseList::differenceWith(ProtoContext* context, ProtoSparseList* other)
+    {
+        auto* tree = toImpl<SparseListCell>(this)->implAsTree(context);
+        auto* otherTree = toImpl<SparseListCell>(other)->implAsTree(context);
+        return originalOperand(tree->implDifference(context, otherTree), this, tree, other, otherTree);
     }
 
     unsigned long ProtoSparseList::getSize(ProtoContext* context)
     {
-        return toImpl<ProtoSparseListImplementation>(this)->implGetSize(context);
+        return toImpl<SparseListCell>(this)->implGetSize(context);
     }
 
     ProtoObject* ProtoSparseList::asObject(ProtoContext* context)
     {
-        return toImpl<ProtoSparseListImplementation>(this)->implAsObject(context);
+        return toImpl<SparseListCell>(this)->implAsObject(context);
     }
 
     unsigned long ProtoSparseList::getHash(ProtoContext* context)
     {
-        return toImpl<ProtoSparseListImplementation>(this)->getHash(context);
+        return toImpl<SparseListCell>(this)->getHash(context);
     }
 
     ProtoSparseListIterator* ProtoSparseList::getIterator(ProtoContext* context)
     {
-        return toImpl<ProtoSparseListImplementation>(this)->implGetIterator(context);
+        return toImpl<SparseListCell>(this)->implAsTree(context)->implGetIterator(context);
+    }
+
+    ProtoSparseListTransient* ProtoSparseList::beginTransient(ProtoContext* context)
+    {
+        return toImpl<SparseListCell>(this)->implAsTree(context)->implBeginTransient(context);
     }
 
     void ProtoSparseList::processElements(ProtoContext* context, void* self,
                                           void (*method)(ProtoContext* context, void* self, unsigned long index,
                                                          ProtoObject* value))
     {
-        toImpl<ProtoSparseListImplementation>(this)->implProcessElements(context, self, method);
+        toImpl<SparseListCell>(this)->implProcessElements(context, self, method);
     }
 
     void ProtoSparseList::processValues(ProtoContext* context, void* self,
                                         void (*method)(ProtoContext* context, void* self, ProtoObject* value))
     {
-        toImpl<ProtoSparseListImplementation>(this)->implProcessValues(context, self, method);
+        toImpl<SparseListCell>(this)->implProcessValues(context, self, method);
+    }
+
+    // ------------------- ProtoSparseListTransient -------------------
+
+    ProtoSparseListTransient* ProtoSparseListTransient::setAt(ProtoContext* context, unsigned long index, ProtoObject* value)
+    {
+        return toImpl<ProtoSparseListTransientImplementation>(this)->implSetAt(context, index, value);
+    }
+
+    ProtoSparseListTransient* ProtoSparseListTransient::removeAt(ProtoContext* context, unsigned long index)
+    {
+        return toImpl<ProtoSparseListTransientImplementation>(this)->implSetAt(context, index, PROTO_NONE);
+    }
+
+    ProtoSparseList* ProtoSparseListTransient::persistent(ProtoContext* context)
+    {
+        return ProtoSparseArrayImplementation::implFromTree(
+            context, toImpl<ProtoSparseListTransientImplementation>(this)->implPersistent(context));
+    }
+
+    // ------------------- ProtoDictionary -------------------
+
+    bool ProtoDictionary::has(ProtoContext* context, ProtoObject* key)
+    {
+        return toImpl<ProtoDictionaryImplementation>(this)->implHas(context, key);
+    }
+
+    ProtoObject* ProtoDictionary::getAt(ProtoContext* context, ProtoObject* key)
+    {
+        return toImpl<ProtoDictionaryImplementation>(this)->implGetAt(context, key);
+    }
+
+    ProtoDictionary* ProtoDictionary::setAt(ProtoContext* context, ProtoObject* key, ProtoObject* value)
+    {
+        return toImpl<ProtoDictionaryImplementation>(this)->implSetAt(context, key, value);
+    }
+
+    ProtoDictionary* ProtoDictionary::removeAt(ProtoContext* context, ProtoObject* key)
+    {
+        return toImpl<ProtoDictionaryImplementation>(this)->implRemoveAt(context, key);
+    }
+
+    unsigned long ProtoDictionary::getSize(ProtoContext* context)
+    {
+        return toImpl<ProtoDictionaryImplementation>(this)->implGetSize(context);
+    }
+
+    bool ProtoDictionary::keepsInsertionOrder(ProtoContext* context)
+    {
+        return toImpl<ProtoDictionaryImplementation>(this)->implKeepsInsertionOrder(context);
+    }
+
+    ProtoObject* ProtoDictionary::asObject(ProtoContext* context)
+    {
+        return toImpl<ProtoDictionaryImplementation>(this)->implAsObject(context);
+    }
+
+    unsigned long ProtoDictionary::getHash(ProtoContext* context)
+    {
+        return toImpl<ProtoDictionaryImplementation>(this)->getHash(context);
+    }
+
+    void ProtoDictionary::processElements(ProtoContext* context, void* self,
+                                          void (*method)(ProtoContext* context, void* self,
+                                                         ProtoObject* key, ProtoObject* value))
+    {
+        toImpl<ProtoDictionaryImplementation>(this)->implProcessElements(context, self, method);
+    }
+
+    // ------------------- ProtoSortedMap -------------------
+
+    bool ProtoSortedMap::has(ProtoContext* context, ProtoObject* key)
+    {
+        return toImpl<ProtoSortedMapImplementation>(this)->implGetAt(context, key) != PROTO_NONE;
+    }
+
+    ProtoObject* ProtoSortedMap::getAt(ProtoContext* context, ProtoObject* key)
+    {
+        return toImpl<ProtoSortedMapImplementation>(this)->implGetAt(context, key);
+    }
+
+    ProtoSortedMap* ProtoSortedMap::setAt(ProtoContext* context, ProtoObject* key, ProtoObject* value)
+    {
+        return toImpl<ProtoSortedMapImplementation>(this)->implSetAt(context, key, value);
+    }
+
+    ProtoSortedMap* ProtoSortedMap::removeAt(ProtoContext* context, ProtoObject* key)
+    {
+        return toImpl<ProtoSortedMapImplementation>(this)->implRemoveAt(context, key);
+    }
+
+    unsigned long ProtoSortedMap::getSize(ProtoContext* context)
+    {
+        return toImpl<ProtoSortedMapImplementation>(this)->implGetSize(context);
+    }
+
+    ProtoObject* ProtoSortedMap::firstKey(ProtoContext* context)
+    {
+        return toImpl<ProtoSortedMapImplementation>(this)->implKeyAt(context, 0, false);
+    }
+
+    ProtoObject* ProtoSortedMap::lastKey(ProtoContext* context)
+    {
+        auto* map = toImpl<ProtoSortedMapImplementation>(this);
+        unsigned long size = map->implGetSize(context);
+        return size ? map->implKeyAt(context, size - 1, false) : PROTO_NONE;
+    }
+
+    ProtoObject* ProtoSortedMap::floor(ProtoContext* context, ProtoObject* key)
+    {
+        return toImpl<ProtoSortedMapImplementation>(this)->implFloor(context, key);
+    }
+
+    ProtoObject* ProtoSortedMap::ceiling(ProtoContext* context, ProtoObject* key)
+    {
+        return toImpl<ProtoSortedMapImplementation>(this)->implCeiling(context, key);
+    }
+
+    unsigned long ProtoSortedMap::rank(ProtoContext* context, ProtoObject* key)
+    {
+        return toImpl<ProtoSortedMapImplementation>(this)->implRank(context, key, false);
+    }
+
+    ProtoObject* ProtoSortedMap::keyAt(ProtoContext* context, unsigned long index)
+    {
+        return toImpl<ProtoSortedMapImplementation>(this)->implKeyAt(context, index, false);
+    }
+
+    ProtoObject* ProtoSortedMap::valueAt(ProtoContext* context, unsigned long index)
+    {
+        return toImpl<ProtoSortedMapImplementation>(this)->implKeyAt(context, index, true);
+    }
+
+    unsigned long ProtoSortedMap::countRange(ProtoContext* context, ProtoObject* from, ProtoObject* to)
+    {
+        return toImpl<ProtoSortedMapImplementation>(this)->implCountRange(context, from, to);
+    }
+
+    void ProtoSortedMap::processRange(ProtoContext* context, ProtoObject* from, ProtoObject* to, void* self,
+                                      void (*method)(ProtoContext* context, void* self,
+                                                     ProtoObject* key, ProtoObject* value))
+    {
+        toImpl<ProtoSortedMapImplementation>(this)->implProcessRange(context, from, to, self, method);
+    }
+
+    void ProtoSortedMap::processElements(ProtoContext* context, void* self,
+                                         void (*method)(ProtoContext* context, void* self,
+                                                        ProtoObject* key, ProtoObject* value))
+    {
+        toImpl<ProtoSortedMapImplementation>(this)->implProcessRange(context, PROTO_NONE, PROTO_NONE, self, method);
+    }
+
+    ProtoObject* ProtoSortedMap::asObject(ProtoContext* context)
+    {
+        return toImpl<ProtoSortedMapImplementation>(this)->implAsObject(context);
+    }
+
+    unsigned long ProtoSortedMap::getHash(ProtoContext* context)
+    {
+        return toImpl<ProtoSortedMapImplementation>(this)->getHash(context);
+    }
+
+    // ------------------- ProtoDeque -------------------
+
+    ProtoObject* ProtoDeque::getAt(ProtoContext* context, int index)
+    {
+        return toImpl<ProtoDequeImplementation>(this)->implGetAt(context, index);
+    }
+
+    ProtoObject* ProtoDeque::getFirst(ProtoContext* context)
+    {
+        return toImpl<ProtoDequeImplementation>(this)->implGetAt(context, 0);
+    }
+
+    ProtoObject* ProtoDeque::getLast(ProtoContext* context)
+    {
+        return toImpl<ProtoDequeImplementation>(this)->implGetAt(context, -1);
+    }
+
+    ProtoDeque* ProtoDeque::getSlice(ProtoContext* context, int from, int to)
+    {
+        return toImpl<ProtoDequeImplementation>(this)->implGetSlice(context, from, to);
+    }
+
+    unsigned long ProtoDeque::getSize(ProtoContext* context)
+    {
+        return toImpl<ProtoDequeImplementation>(this)->implGetSize(context);
+    }
+
+    bool ProtoDeque::has(ProtoContext* context, ProtoObject* value)
+    {
+        return toImpl<ProtoDequeImplementation>(this)->implHas(context, value);
+    }
+
+    ProtoDeque* ProtoDeque::appendFirst(ProtoContext* context, ProtoObject* value)
+    {
+        return toImpl<ProtoDequeImplementation>(this)->implAppendFirst(context, value);
+    }
+
+    ProtoDeque* ProtoDeque::appendLast(ProtoContext* context, ProtoObject* value)
+    {
+        return toImpl<ProtoDequeImplementation>(this)->implAppendLast(context, value);
+    }
+
+    ProtoDeque* ProtoDeque::removeFirst(ProtoContext* context)
+    {
+        return toImpl<ProtoDequeImplementation>(this)->implRemoveFirst(context);
+    }
+
+    ProtoDeque* ProtoDeque::removeLast(ProtoContext* context)
+    {
+        return toImpl<ProtoDequeImplementation>(this)->implRemoveLast(context);
+    }
+
+    ProtoDeque* ProtoDeque::extend(ProtoContext* context, ProtoDeque* other)
+    {
+        return toImpl<ProtoDequeImplementation>(this)->implExtend(context, toImpl<ProtoDequeImplementation>(other));
+    }
+
+    ProtoDeque* ProtoDeque::splitFirst(ProtoContext* context, int index)
+    {
+        return toImpl<ProtoDequeImplementation>(this)->implSplitFirst(context, index);
+    }
+
+    ProtoDeque* ProtoDeque::splitLast(ProtoContext* context, int index)
+    {
+        return toImpl<ProtoDequeImplementation>(this)->implSplitLast(context, index);
+    }
+
+    void ProtoDeque::processValues(ProtoContext* context, void* self,
+                                   void (*method)(ProtoContext* context, void* self, ProtoObject* value))
+    {
+        toImpl<ProtoDequeImplementation>(this)->implProcessValues(context, self, method);
+    }
+
+    ProtoList* ProtoDeque::asList(ProtoContext* context)
+    {
+        return toImpl<ProtoDequeImplementation>(this)->implAsList(context);
+    }
+
+    ProtoObject* ProtoDeque::asObject(ProtoContext* context)
+    {
+        return toImpl<ProtoDequeImplementation>(this)->implAsObject(context);
+    }
+
+    unsigned long ProtoDeque::getHash(ProtoContext* context)
+    {
+        return toImpl<ProtoDequeImplementation>(this)->getHash(context);
+    }
+
+    // ------------------- ProtoPriorityQueue -------------------
+
+    ProtoPriorityQueue* ProtoPriorityQueue::insert(ProtoContext* context, ProtoObject* key, ProtoObject* value)
+    {
+        return toImpl<ProtoPriorityQueueImplementation>(this)->implInsert(context, key, value);
+    }
+
+    ProtoObject* ProtoPriorityQueue::getMinKey(ProtoContext* context)
+    {
+        return toImpl<ProtoPriorityQueueImplementation>(this)->implGetMinKey(context);
+    }
+
+    ProtoObject* ProtoPriorityQueue::getMin(ProtoContext* context)
+    {
+        return toImpl<ProtoPriorityQueueImplementation>(this)->implGetMin(context);
+    }
+
+    ProtoPriorityQueue* ProtoPriorityQueue::removeMin(ProtoContext* context)
+    {
+        return toImpl<ProtoPriorityQueueImplementation>(this)->implRemoveMin(context);
+    }
+
+    ProtoPriorityQueue* ProtoPriorityQueue::meld(ProtoContext* context, ProtoPriorityQueue* other)
+    {
+        return toImpl<ProtoPriorityQueueImplementation>(this)->implMeld(
+            context, toImpl<ProtoPriorityQueueImplementation>(other));
+    }
+
+    unsigned long ProtoPriorityQueue::getSize(ProtoContext* context)
+    {
+        return toImpl<ProtoPriorityQueueImplementation>(this)->implGetSize(context);
+    }
+
+    ProtoObject* ProtoPriorityQueue::asObject(ProtoContext* context)
+    {
+        return toImpl<ProtoPriorityQueueImplementation>(this)->implAsObject(context);
+    }
+
+    unsigned long ProtoPriorityQueue::getHash(ProtoContext* context)
+    {
+        return toImpl<ProtoPriorityQueueImplementation>(this)->getHash(context);
     }
 
     // ------------------- ProtoByteBuffer -------------------
@@ -8,27 +8,114 @@
 #include "../headers/proto_internal.h"
 
 #include <thread>
+#include <cstdio>
 #include <cstdlib>   // Para std::malloc
 #include <algorithm> // Para std::max
-#include <random>
 
 namespace proto
 {
-    uint64_t generate_mutable_ref()
+    namespace
     {
-        // 'thread_local' asegura que cada hilo tenga su propio generador de números,
-        // lo que es crucial para la seguridad en entornos multihilo.
-        // Se siembra con std::random_device para una aleatoriedad de alta calidad.
-        thread_local std::mt19937_64 generator(std::random_device{}());
+        // Bloque de identificadores que el hilo actual reparte sin
+        // sincronizarse con los demás hilos.
+        struct MutableBlock
+        {
+            ProtoSpace* space = nullptr;
+            unsigned long next = 0;
+            unsigned long end = 0;
+        };
+
+        thread_local MutableBlock currentMutableBlock;
+
+        void lockMutableTable(ProtoSpace* space)
+        {
+            while (space->mutableLock.exchange(true))
+                std::this_thread::yield();
+        }
+
+        // Primero se reutiliza lo que dejó un hilo que terminó; si no hay, se
+        // agrega un bloque nuevo. Las páginas se crean a medida y nunca se
+        // mueven, así que una posición obtenida sigue valiendo para siempre.
+        MutableBlock reserveMutableBlock(ProtoSpace* space)
+        {
+            lockMutableTable(space);
+            if (!space->freeMutableBlocks.empty())
+            {
+                auto range = space->freeMutableBlocks.back();
+                space->freeMutableBlocks.pop_back();
+                space->mutableLock.store(false);
+                return MutableBlock{space, range.first, range.second};
+            }
+            space->mutableLock.store(false);
+
+            unsigned long shard = space->mutableShardCount.fetch_add(1);
+            if (shard >= PROTO_MUTABLE_PAGE_SIZE * PROTO_MUTABLE_MAX_PAGES)
+            {
+                printf(
+                    "\nPANIC ERROR: The mutable object table is full (%lu objects)! Exiting ...\n",
+                    (unsigned long) PROTO_MUTABLE_SHARD_SIZE * PROTO_MUTABLE_PAGE_SIZE * PROTO_MUTABLE_MAX_PAGES
+                );
+                std::exit(1);
+            }
+
+            std::atomic<MutablePage*>& pageSlot = space->mutablePages[shard / PROTO_MUTABLE_PAGE_SIZE];
+            MutablePage* page = pageSlot.load();
+            if (!page)
+            {
+                auto* newPage = new MutablePage();
+                if (pageSlot.compare_exchange_strong(page, newPage))
+                    page = newPage;
+                else
+                    delete newPage;
+            }
+
+            page->shards[shard % PROTO_MUTABLE_PAGE_SIZE].store(new MutableShard());
+            return MutableBlock{space, shard * PROTO_MUTABLE_SHARD_SIZE, (shard + 1) * PROTO_MUTABLE_SHARD_SIZE};
+        }
+    } // fin del namespace anónimo
+
+    unsigned long generate_mutable_ref(ProtoContext* context)
+    {
+        ProtoSpace* space = context->space;
+        if (!space)
+            return 0;
+
+        MutableBlock& block = currentMutableBlock;
+        if (block.space != space || block.next == block.end)
+            block = reserveMutableBlock(space);
 
-        uint64_t id = 0;
-        // Nos aseguramos de que el ID generado nunca sea 0,
-        // ya que 0 está reservado para los objetos inmutables.
-        while (id == 0)
+        // Se suma 1 porque 0 está reservado para los objetos inmutables.
+        return ++block.next;
+    }
+
+    void release_mutable_block(ProtoSpace* space)
+    {
+        // Los identificadores ya entregados no se devuelven: sus objetos
+        // pueden vivir más que el hilo. Sólo vuelve el resto del bloque.
+        MutableBlock& block = currentMutableBlock;
+        if (block.space == space && block.next < block.end)
         {
-            id = generator();
+            lockMutableTable(space);
+            space->freeMutableBlocks.emplace_back(block.next, block.end);
+            space->mutableLock.store(false);
         }
-        return id;
+        block = MutableBlock{};
+    }
+
+    std::atomic<ProtoObject*>* getMutableSlot(ProtoSpace* space, unsigned long mutable_ref)
+    {
+        unsigned long index = mutable_ref - 1;
+        unsigned long shard = index / PROTO_MUTABLE_SHARD_SIZE;
+        MutablePage* page = space->mutablePages[shard / PROTO_MUTABLE_PAGE_SIZE].load();
+        return &page->shards[shard % PROTO_MUTABLE_PAGE_SIZE].load()->values[index % PROTO_MUTABLE_SHARD_SIZE];
+    }
+
+    std::atomic<unsigned long>* getMutableVersion(ProtoSpace* space, unsigned long mutable_ref)
+    {
+        unsigned long index = mutable_ref - 1;
+        unsigned long shard = index / PROTO_MUTABLE_SHARD_SIZE;
+        MutablePage* page = space->mutablePages[shard / PROTO_MUTABLE_PAGE_SIZE].load();
+        return &page->shards[shard % PROTO_MUTABLE_PAGE_SIZE].load()->versions[index % PROTO_MUTABLE_SHARD_SIZE];
     }
 
     // ADVERTENCIA: Estas variables globales pueden causar problemas en un entorno
@@ -119,25 +206,22 @@ namespace proto
         Cell* newCell;
         if (this->thread)
         {
+            // Se entrega la cadena antes de reservar: la celda nueva debe quedar
+            // en la cadena siguiente, no en la que ya analiza el GC.
+            this->checkCellsCount();
             newCell = ((ProtoThreadImplementation*)(this->thread))->implAllocCell();
-            ::new(newCell) Cell(this);
-            newCell = static_cast<Cell*>(newCell);
             this->allocatedCellsCount++;
-            this->checkCellsCount();
         }
         else
         {
             // ADVERTENCIA: Esta rama usa malloc directamente, lo que evita el GC.
             // Esto es probablemente un remanente de código antiguo y podría ser una fuente de fugas de memoria.
             // Todas las asignaciones de celdas deberían pasar por el gestor de memoria del espacio.
-            void* newChunk = std::malloc(sizeof(BigCell));
-            ::new(newChunk) Cell(this);
-            newCell = static_cast<Cell*>(newChunk);
+            newCell = static_cast<Cell*>(std::malloc(sizeof(BigCell)));
         }
 
-        // Las celdas se encadenan en una lista simple para su seguimiento dentro del contexto.
-        newCell->nextCell = this->lastAllocatedCell;
-        this->lastAllocatedCell = newCell;
+        // El constructor de Cell encadena la celda en este contexto; hacerlo
+        // también aquí la dejaba apuntándose a sí misma.
         return newCell;
     }
 
@@ -218,11 +302,11 @@ namespace proto
     ProtoString* ProtoContext::fromUTF8String(const char* zeroTerminatedUtf8String)
     {
         const char* currentChar = zeroTerminatedUtf8String;
-        ProtoList* charList = this->newList();
+        auto* chars = new(this) ProtoTupleTransientImplementation(this, nullptr);
 
         while (*currentChar)
         {
-            charList = (ProtoList*)charList->appendLast(this, this->fromUTF8Char(currentChar));
+            chars->implAppendLast(this, this->fromUTF8Char(currentChar));
 
             // Avanzar el puntero según el número de bytes del carácter UTF-8
             if ((*currentChar & 0x80) == 0) currentChar += 1;
@@ -232,11 +316,8 @@ namespace proto
             else currentChar += 1; // Carácter inválido, avanzar 1 para evitar bucle infinito
         }
 
-        // La creación de una cadena implica convertir la lista de caracteres en una tupla.
-        return new(this) ProtoStringImplementation(
-            this,
-            ProtoTupleImplementation::tupleFromList(this, charList)
-        );
+        // Los caracteres se agregan en su lugar sobre el editor de la tupla.
+        return new(this) ProtoStringImplementation(this, chars->implPersistent(this));
     }
 
     // --- Constructores de Tipos de Colección (new...) ---
@@ -247,6 +328,11 @@ namespace proto
         return new(this) ProtoListImplementation(this);
     }
 
+    ProtoList* ProtoContext::newListFromArray(ProtoObject* const* values, unsigned long count)
+    {
+        return ProtoListImplementation::implFromArray(this, values, count);
+    }
+
     ProtoTuple* ProtoContext::newTuple()
     {
         return new(this) ProtoTupleImplementation(this, 0, 0, static_cast<ProtoObject**>(nullptr));
@@ -262,14 +348,60 @@ namespace proto
         return new(this) ProtoSparseListImplementation(this);
     }
 
+    ProtoSparseList* ProtoContext::newUnorderedSparseList()
+    {
+        return new(this) ProtoSparseHashImplementation(this);
+    }
+
+    ProtoDictionary* ProtoContext::newDictionary(bool insertionOrder)
+    {
+        return new(this) ProtoDictionaryImplementation(this, insertionOrder);
+    }
+
+    ProtoSortedMap* ProtoContext::newSortedMap(ProtoCompareFunction compare)
+    {
+        return new(this) ProtoSortedMapImplementation(this, compare);
+    }
+
+    ProtoSortedMap* ProtoContext::newSortedMapFromArray(ProtoCompareFunction compare,
+                                                        ProtoObject* const* keys,
+                                                        ProtoObject* const* values,
+                                                        unsigned long count)
+    {
+        return ProtoSortedMapImplementation::implFromArray(this, compare, keys, values, count);
+    }
+
+    ProtoDeque* ProtoContext::newDeque()
+    {
+        return new(this) ProtoDequeImplementation(this);
+    }
+
+    ProtoPriorityQueue* ProtoContext::newPriorityQueue()
+    {
+        return new(this) ProtoPriorityQueueImplementation(this);
+    }
+
     ProtoObject* ProtoContext::newObject(bool mutableObject)
     {
-        return new(this) ProtoObjectCellImplementation(
+        unsigned long mutable_ref = 0;
+        if (mutableObject)
+        {
+            mutable_ref = generate_mutable_ref(this);
+            if (!mutable_ref)
+                return PROTO_NONE;
+        }
+
+        auto* newObject = new(this) ProtoObjectCellImplementation(
             this,
             nullptr,
-            mutableObject ? generate_mutable_ref() : 0,
-            nullptr
+            mutable_ref,
+            this->space ? this->space->rootShape : nullptr
         );
+
+        if (mutable_ref)
+            getMutableSlot(this->space, mutable_ref)->store(newObject->implAsObject(this));
+
+        return newObject->implAsObject(this);
     }
 
 
@@ -332,6 +464,11 @@ namespace proto
         return new(this) ProtoMethodCellImplementation(this, method);
     }
 
+    ProtoMethodCell* ProtoContext::fromFastMethod(ProtoObject* self, ProtoFastMethod method, ProtoMethod generic)
+    {
+        return new(this) ProtoMethodCellImplementation(this, method, generic);
+    }
+
     ProtoExternalPointer* ProtoContext::fromExternalPointer(void* pointer)
     {
         return new(this) ProtoExternalPointerImplementation(this, pointer);
@@ -0,0 +1,603 @@
+/*
+ * ProtoDeque.cpp
+ *
+ *  Created on: October, 2026
+ *      Author: gamarino
+ */
+
+#include "../headers/proto_internal.h"
+
+namespace proto
+{
+    namespace
+    {
+        // En los niveles centrales los elementos son DequeNode guardados como
+        // ProtoObject*; nunca salen del árbol.
+        DequeNode* asNode(ProtoObject* item)
+        {
+            return reinterpret_cast<DequeNode*>(item);
+        }
+
+        ProtoObject* asItem(DequeNode* node)
+        {
+            return reinterpret_cast<ProtoObject*>(node);
+        }
+
+        unsigned long itemSize(ProtoObject* item, bool values)
+        {
+            return values ? 1 : asNode(item)->size;
+        }
+
+        unsigned long treeSize(ProtoDequeImplementation* tree)
+        {
+            return tree ? tree->size : 0;
+        }
+
+        bool isEmpty(ProtoDequeImplementation* tree)
+        {
+            return !tree || !tree->prefix;
+        }
+
+        DequeNode* newNode(ProtoContext* context, bool values, unsigned long count, ProtoObject* const* items)
+        {
+            return new(context) DequeNode(context, values, count, items);
+        }
+
+        ProtoDequeImplementation* newTree(
+            ProtoContext* context,
+            DequeNode* prefix,
+            ProtoDequeImplementation* middle,
+            DequeNode* suffix
+        )
+        {
+            return new(context) ProtoDequeImplementation(context, prefix, isEmpty(middle) ? nullptr : middle, suffix);
+        }
+
+        // Elemento de items que contiene la posición index; deja en index la
+        // posición dentro de ese elemento.
+        unsigned long locate(ProtoObject* const* items, unsigned long count, bool values, unsigned long& index)
+        {
+            for (unsigned long i = 0; i + 1 < count; i++)
+            {
+                unsigned long size = itemSize(items[i], values);
+                if (index < size)
+                    return i;
+                index -= size;
+            }
+            return count - 1;
+        }
+
+        ProtoDequeImplementation* fromItems(ProtoContext* context, bool values, ProtoObject* const* items, unsigned long count)
+        {
+            if (!count)
+                return nullptr;
+            if (count == 1)
+                return newTree(context, newNode(context, values, 1, items), nullptr, nullptr);
+            unsigned long half = count / 2;
+            return newTree(context, newNode(context, values, half, items), nullptr,
+                           newNode(context, values, count - half, items + half));
+        }
+
+        ProtoDequeImplementation* fromDigit(ProtoContext* context, bool values, DequeNode* digit)
+        {
+            if (digit->count == 1)
+                return newTree(context, digit, nullptr, nullptr);
+            return fromItems(context, values, digit->items, digit->count);
+        }
+
+        ProtoDequeImplementation* pushFront(ProtoContext* context, ProtoDequeImplementation* tree, ProtoObject* item, bool values)
+        {
+            if (isEmpty(tree))
+                return newTree(context, newNode(context, values, 1, &item), nullptr, nullptr);
+            if (!tree->suffix)
+                return newTree(context, newNode(context, values, 1, &item), nullptr, tree->prefix);
+
+            DequeNode* prefix = tree->prefix;
+            if (prefix->count < DEQUE_DIGIT_SIZE)
+            {
+                ProtoObject* items[DEQUE_DIGIT_SIZE];
+                items[0] = item;
+                for (unsigned long i = 0; i < prefix->count; i++)
+                    items[i + 1] = prefix->items[i];
+                return newTree(context, newNode(context, values, prefix->count + 1, items), tree->middle, tree->suffix);
+            }
+
+            // Dígito lleno: tres elementos bajan como un nodo al nivel central.
+            ProtoObject* items[2] = {item, prefix->items[0]};
+            DequeNode* node = newNode(context, values, 3, prefix->items + 1);
+            return newTree(context, newNode(context, values, 2, items),
+                           pushFront(context, tree->middle, asItem(node), false), tree->suffix);
+        }
+
+        ProtoDequeImplementation* pushBack(ProtoContext* context, ProtoDequeImplementation* tree, ProtoObject* item, bool values)
+        {
+            if (isEmpty(tree))
+                return newTree(context, newNode(context, values, 1, &item), nullptr, nullptr);
+            if (!tree->suffix)
+                return newTree(context, tree->prefix, nullptr, newNode(context, values, 1, &item));
+
+            DequeNode* suffix = tree->suffix;
+            if (suffix->count < DEQUE_DIGIT_SIZE)
+            {
+                ProtoObject* items[DEQUE_DIGIT_SIZE];
+                for (unsigned long i = 0; i < suffix->count; i++)
+                    items[i] = suffix->items[i];
+                items[suffix->count] = item;
+                return newTree(context, tree->prefix, tree->middle, newNode(context, values, suffix->count + 1, items));
+            }
+
+            ProtoObject* items[2] = {suffix->items[3], item};
+            DequeNode* node = newNode(context, values, 3, suffix->items);
+            return newTree(context, tree->prefix, pushBack(context, tree->middle, asItem(node), false),
+                           newNode(context, values, 2, items));
+        }
+
+        ProtoDequeImplementation* popFront(ProtoContext* context, ProtoDequeImplementation* tree, bool values, ProtoObject** item);
+        ProtoDequeImplementation* popBack(ProtoContext* context, ProtoDequeImplementation* tree, bool values, ProtoObject** item);
+
+        // Árbol con prefijo items (posiblemente vacío): si falta, lo toma del
+        // primer nodo del nivel central o, si éste está vacío, del sufijo.
+        ProtoDequeImplementation* deepLeft(
+            ProtoContext* context,
+            bool values,
+            ProtoObject* const* items,
+            unsigned long count,
+            ProtoDequeImplementation* middle,
+            DequeNode* suffix
+        )
+        {
+            if (count)
+                return newTree(context, newNode(context, values, count, items), middle, suffix);
+            if (isEmpty(middle))
+                return fromDigit(context, values, suffix);
+
+            ProtoObject* node;
+            ProtoDequeImplementation* rest = popFront(context, middle, false, &node);
+            return newTree(context, asNode(node), rest, suffix);
+        }
+
+        ProtoDequeImplementation* deepRight(
+            ProtoContext* context,
+            bool values,
+            DequeNode* prefix,
+            ProtoDequeImplementation* middle,
+            ProtoObject* const* items,
+            unsigned long count
+        )
+        {
+            if (count)
+                return newTree(context, prefix, middle, newNode(context, values, count, items));
+            if (isEmpty(middle))
+                return fromDigit(context, values, prefix);
+
+            ProtoObject* node;
+            ProtoDequeImplementation* rest = popBack(context, middle, false, &node);
+            return newTree(context, prefix, rest, asNode(node));
+        }
+
+        ProtoDequeImplementation* popFront(ProtoContext* context, ProtoDequeImplementation* tree, bool values, ProtoObject** item)
+        {
+            DequeNode* prefix = tree->prefix;
+            *item = prefix->items[0];
+            if (!tree->suffix)
+                return nullptr;
+            return deepLeft(context, values, prefix->items + 1, prefix->count - 1, tree->middle, tree->suffix);
+        }
+
+        ProtoDequeImplementation* popBack(ProtoContext* context, ProtoDequeImplementation* tree, bool values, ProtoObject** item)
+        {
+            if (!tree->suffix)
+            {
+                *item = tree->prefix->items[0];
+                return nullptr;
+            }
+            DequeNode* suffix = tree->suffix;
+            *item = suffix->items[suffix->count - 1];
+            return deepRight(context, values, tree->prefix, tree->middle, suffix->items, suffix->count - 1);
+        }
+
+        // Concatena left, items y right; los dígitos que quedan entre ambos
+        // árboles bajan agrupados en nodos 2-3 al nivel central.
+        ProtoDequeImplementation* concat(
+            ProtoContext* context,
+            ProtoDequeImplementation* left,
+            ProtoObject* const* items,
+            unsigned long count,
+            ProtoDequeImplementation* right,
+            bool values
+        )
+        {
+            if (isEmpty(left))
+            {
+                for (unsigned long i = count; i > 0; i--)
+                    right = pushFront(context, right, items[i - 1], values);
+                return right;
+            }
+            if (isEmpty(right))
+            {
+                for (unsigned long i = 0; i < count; i++)
+                    left = pushBack(context, left, items[i], values);
+                return left;
+            }
+            if (!left->suffix)
+            {
+                for (unsigned long i = count; i > 0; i--)
+                    right = pushFront(context, right, items[i - 1], values);
+                return pushFront(context, right, left->prefix->items[0], values);
+            }
+            if (!right->suffix)
+            {
+                for (unsigned long i = 0; i < count; i++)
+                    left = pushBack(context, left, items[i], values);
+                return pushBack(context, left, right->prefix->items[0], values);
+            }
+
+            ProtoObject* all[DEQUE_DIGIT_SIZE * 3];
+            unsigned long total = 0;
+            for (unsigned long i = 0; i < left->suffix->count; i++)
+                all[total++] = left->suffix->items[i];
+            for (unsigned long i = 0; i < count; i++)
+                all[total++] = items[i];
+            for (unsigned long i = 0; i < right->prefix->count; i++)
+                all[total++] = right->prefix->items[i];
+
+            ProtoObject* nodes[DEQUE_DIGIT_SIZE];
+            unsigned long nodeCount = 0, next = 0;
+            while (next < total)
+            {
+                unsigned long remaining = total - next;
+                unsigned long size = remaining == 2 || remaining == 4 ? 2 : 3;
+                nodes[nodeCount++] = asItem(newNode(context, values, size, all + next));
+                next += size;
+            }
+
+            return newTree(context, left->prefix,
+                           concat(context, left->middle, nodes, nodeCount, right->middle, false),
+                           right->suffix);
+        }
+
+        // Divide un árbol no vacío en el elemento que contiene la posición
+        // index: deja en left y right lo anterior y lo posterior, y en index la
+        // posición dentro del elemento devuelto.
+        ProtoObject* split(
+            ProtoContext* context,
+            ProtoDequeImplementation* tree,
+            bool values,
+            unsigned long& index,
+            ProtoDequeImplementation** left,
+            ProtoDequeImplementation** right
+        )
+        {
+            DequeNode* prefix = tree->prefix;
+            if (!tree->suffix)
+            {
+                *left = *right = nullptr;
+                return prefix->items[0];
+            }
+
+            if (index < prefix->size)
+            {
+                unsigned long i = locate(prefix->items, prefix->count, values, index);
+                *left = fromItems(context, values, prefix->items, i);
+                *right = deepLeft(context, values, prefix->items + i + 1, prefix->count - i - 1, tree->middle, tree->suffix);
+                return prefix->items[i];
+            }
+            index -= prefix->size;
+
+            if (index < treeSize(tree->middle))
+            {
+                ProtoDequeImplementation *middleLeft, *middleRight;
+                DequeNode* node = asNode(split(context, tree->middle, false, index, &middleLeft, &middleRight));
+                unsigned long i = locate(node->items, node->count, values, index);
+                *left = deepRight(context, values, prefix, middleLeft, node->items, i);
+                *right = deepLeft(context, values, node->items + i + 1, node->count - i - 1, middleRight, tree->suffix);
+                return node->items[i];
+            }
+            index -= treeSize(tree->middle);
+
+            DequeNode* suffix = tree->suffix;
+            unsigned long i = locate(suffix->items, suffix->count, values, index);
+            *left = deepRight(context, values, prefix, tree->middle, suffix->items, i);
+            *right = fromItems(context, values, suffix->items + i + 1, suffix->count - i - 1);
+            return suffix->items[i];
+        }
+
+        // Elemento de este nivel que contiene la posición index.
+        ProtoObject* lookup(ProtoDequeImplementation* tree, bool values, unsigned long& index)
+        {
+            DequeNode* prefix = tree->prefix;
+            if (index < prefix->size || !tree->suffix)
+                return prefix->items[locate(prefix->items, prefix->count, values, index)];
+            index -= prefix->size;
+
+            if (index < treeSize(tree->middle))
+            {
+                DequeNode* node = asNode(lookup(tree->middle, false, index));
+                return node->items[locate(node->items, node->count, values, index)];
+            }
+            index -= treeSize(tree->middle);
+
+            DequeNode* suffix = tree->suffix;
+            return suffix->items[locate(suffix->items, suffix->count, values, index)];
+        }
+
+        template <typename Visit>
+        bool visitItems(ProtoObject* const* items, unsigned long count, bool values, Visit& visit);
+
+        template <typename Visit>
+        bool visitItem(ProtoObject* item, bool values, Visit& visit)
+        {
+            if (values)
+                return visit(item);
+            DequeNode* node = asNode(item);
+            return visitItems(node->items, node->count, node->values, visit);
+        }
+
+        template <typename Visit>
+        bool visitItems(ProtoObject* const* items, unsigned long count, bool values, Visit& visit)
+        {
+            for (unsigned long i = 0; i < count; i++)
+            {
+                if (!visitItem(items[i], values, visit))
+                    return false;
+            }
+            return true;
+        }
+
+        // Recorre los valores en orden; visit devuelve false para detenerse.
+        template <typename Visit>
+        bool visitTree(ProtoDequeImplementation* tree, bool values, Visit& visit)
+        {
+            if (isEmpty(tree))
+                return true;
+            if (!visitItems(tree->prefix->items, tree->prefix->count, values, visit))
+                return false;
+            if (tree->middle && !visitTree(tree->middle, false, visit))
+                return false;
+            return !tree->suffix || visitItems(tree->suffix->items, tree->suffix->count, values, visit);
+        }
+
+        unsigned long normalizeBound(int index, unsigned long count)
+        {
+            long normalized = index < 0 ? (long) count + index : index;
+            if (normalized < 0)
+                return 0;
+            return std::min((unsigned long) normalized, count);
+        }
+
+        ProtoDequeImplementation* orEmpty(ProtoContext* context, ProtoDequeImplementation* tree)
+        {
+            return tree ? tree : new(context) ProtoDequeImplementation(context);
+        }
+    } // fin del namespace anónimo
+
+
+    // --- DequeNode ---
+
+    DequeNode::DequeNode(
+        ProtoContext* context,
+        bool values,
+        unsigned long count,
+        ProtoObject* const* items
+    ) : Cell(context), size(0), count(count), values(values)
+    {
+        unsigned long size = 0;
+        for (unsigned long i = 0; i < DEQUE_DIGIT_SIZE; i++)
+        {
+            this->items[i] = i < count ? items[i] : PROTO_NONE;
+            if (i < count)
+                size += itemSize(items[i], values);
+        }
+        this->size = size;
+    }
+
+    DequeNode::~DequeNode() = default;
+
+    unsigned long DequeNode::getHash(ProtoContext* context)
+    {
+        return Cell::getHash(context);
+    }
+
+    ProtoObject* DequeNode::asObject(ProtoContext* context)
+    {
+        return Cell::asObject(context);
+    }
+
+    void DequeNode::finalize(ProtoContext* context)
+    {
+    }
+
+    void DequeNode::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        for (unsigned long i = 0; i < this->count; i++)
+        {
+            ProtoObject* item = this->items[i];
+            if (!this->values)
+                method(context, self, asNode(item));
+            else if (item && item->isCell(context))
+                method(context, self, item->asCell(context));
+        }
+    }
+
+
+    // --- ProtoDequeImplementation ---
+
+    ProtoDequeImplementation::ProtoDequeImplementation(
+        ProtoContext* context,
+        DequeNode* prefix,
+        ProtoDequeImplementation* middle,
+        DequeNode* suffix
+    ) : CollectionCell(context, COLLECTION_DEQUE), prefix(prefix), middle(middle), suffix(suffix),
+        size((prefix ? prefix->size : 0) + treeSize(middle) + (suffix ? suffix->size : 0))
+    {
+    }
+
+    ProtoDequeImplementation::~ProtoDequeImplementation() = default;
+
+    ProtoObject* ProtoDequeImplementation::implGetAt(ProtoContext* context, int index)
+    {
+        long position = index < 0 ? (long) this->size + index : index;
+        if (position < 0 || (unsigned long) position >= this->size)
+            return PROTO_NONE;
+
+        unsigned long offset = position;
+        return lookup(this, true, offset);
+    }
+
+    unsigned long ProtoDequeImplementation::implGetSize(ProtoContext* context)
+    {
+        return this->size;
+    }
+
+    bool ProtoDequeImplementation::implHas(ProtoContext* context, ProtoObject* value)
+    {
+        auto differs = [value](ProtoObject* item)
+        {
+            return item != value;
+        };
+        return !visitTree(this, true, differs);
+    }
+
+    ProtoDequeImplementation* ProtoDequeImplementation::implGetSlice(ProtoContext* context, int from, int to)
+    {
+        unsigned long first = normalizeBound(from, this->size);
+        unsigned long last = normalizeBound(to, this->size);
+        if (first == 0 && last == this->size)
+            return this;
+        if (last <= first)
+            return new(context) ProtoDequeImplementation(context);
+
+        return this->implSplitLast(context, (int) first)->implSplitFirst(context, (int) (last - first));
+    }
+
+    ProtoDequeImplementation* ProtoDequeImplementation::implAppendFirst(ProtoContext* context, ProtoObject* value)
+    {
+        return pushFront(context, this, value, true);
+    }
+
+    ProtoDequeImplementation* ProtoDequeImplementation::implAppendLast(ProtoContext* context, ProtoObject* value)
+    {
+        return pushBack(context, this, value, true);
+    }
+
+    ProtoDequeImplementation* ProtoDequeImplementation::implRemoveFirst(ProtoContext* context)
+    {
+        if (isEmpty(this))
+            return this;
+        ProtoObject* value;
+        return orEmpty(context, popFront(context, this, true, &value));
+    }
+
+    ProtoDequeImplementation* ProtoDequeImplementation::implRemoveLast(ProtoContext* context)
+    {
+        if (isEmpty(this))
+            return this;
+        ProtoObject* value;
+        return orEmpty(context, popBack(context, this, true, &value));
+    }
+
+    ProtoDequeImplementation* ProtoDequeImplementation::implExtend(ProtoContext* context, ProtoDequeImplementation* other)
+    {
+        if (isEmpty(other))
+            return this;
+        if (isEmpty(this))
+            return other;
+        return concat(context, this, nullptr, 0, other, true);
+    }
+
+    ProtoDequeImplementation* ProtoDequeImplementation::implSplitFirst(ProtoContext* context, int index)
+    {
+        unsigned long count = normalizeBound(index, this->size);
+        if (count == this->size)
+            return this;
+        if (count == 0)
+            return new(context) ProtoDequeImplementation(context);
+
+        ProtoDequeImplementation *left, *right;
+        split(context, this, true, count, &left, &right);
+        return orEmpty(context, left);
+    }
+
+    ProtoDequeImplementation* ProtoDequeImplementation::implSplitLast(ProtoContext* context, int index)
+    {
+        unsigned long count = normalizeBound(index, this->size);
+        if (count == 0)
+            return this;
+        if (count == this->size)
+            return new(context) ProtoDequeImplementation(context);
+
+        ProtoDequeImplementation *left, *right;
+        ProtoObject* value = split(context, this, true, count, &left, &right);
+        return pushFront(context, right, value, true);
+    }
+
+    ProtoList* ProtoDequeImplementation::implAsList(ProtoContext* context)
+    {
+        ProtoListTransient* transient = context->newList()->beginTransient(context);
+        auto append = [context, transient](ProtoObject* value)
+        {
+            transient->appendLast(context, value);
+            return true;
+        };
+        visitTree(this, true, append);
+        return transient->persistent(context);
+    }
+
+    void ProtoDequeImplementation::implProcessValues(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            ProtoObject* value
+        )
+    )
+    {
+        auto visit = [context, self, method](ProtoObject* value)
+        {
+            method(context, self, value);
+            return true;
+        };
+        visitTree(this, true, visit);
+    }
+
+    unsigned long ProtoDequeImplementation::getHash(ProtoContext* context)
+    {
+        return Cell::getHash(context);
+    }
+
+    ProtoObject* ProtoDequeImplementation::asObject(ProtoContext* context)
+    {
+        return this->implAsObject(context);
+    }
+
+    void ProtoDequeImplementation::finalize(ProtoContext* context)
+    {
+    }
+
+    void ProtoDequeImplementation::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        if (this->prefix)
+            method(context, self, this->prefix);
+        if (this->middle)
+            method(context, self, this->middle);
+        if (this->suffix)
+            method(context, self, this->suffix);
+    }
+} // namespace proto
@@ -0,0 +1,450 @@
+/*
+ * ProtoDictionary.cpp
+ *
+ *  Created on: October, 2026
+ *      Author: gamarino
+ */
+
+#include "../headers/proto_internal.h"
+
+namespace proto
+{
+    namespace
+    {
+        unsigned long combineHash(unsigned long hash, unsigned long value)
+        {
+            return (hash ^ value) * 0x100000001b3UL;
+        }
+
+        unsigned long tagOf(ProtoObject* value)
+        {
+            ProtoObjectPointer p{};
+            p.oid.oid = value;
+            return p.op.pointer_tag;
+        }
+
+        // Los valores se comparan por identidad; sólo las claves, por contenido.
+        unsigned long entryHash(ProtoContext* context, unsigned long keyHash, ProtoObject* value)
+        {
+            return keyHash ^ value->getHash(context);
+        }
+
+        template <typename Cursor>
+        unsigned long sequenceHash(ProtoContext* context, Cursor& cursor, unsigned long tag)
+        {
+            unsigned long hash = combineHash(0xcbf29ce484222325UL, tag);
+            while (cursor.hasNext(context))
+                hash = combineHash(hash, protoStructuralHash(context, cursor.next(context)));
+            return hash;
+        }
+
+        template <typename Cursor>
+        bool sequenceEquals(ProtoContext* context, Cursor& left, Cursor& right)
+        {
+            while (left.hasNext(context))
+            {
+                if (!right.hasNext(context) || !protoEquals(context, left.next(context), right.next(context)))
+                    return false;
+            }
+            return !right.hasNext(context);
+        }
+
+        struct SparseListMatch
+        {
+            ProtoSparseList* other;
+            bool equal;
+        };
+
+        void matchSparseEntry(ProtoContext* context, void* self, unsigned long key, ProtoObject* value)
+        {
+            auto* match = static_cast<SparseListMatch*>(self);
+            if (match->equal && (value == PROTO_NONE || match->other->getAt(context, key) != value))
+                match->equal = false;
+        }
+
+        struct DictionaryMatch
+        {
+            ProtoDictionaryImplementation* other;
+            bool equal;
+        };
+
+        void matchDictionaryEntry(ProtoContext* context, void* self, ProtoObject* key, ProtoObject* value)
+        {
+            auto* match = static_cast<DictionaryMatch*>(self);
+            if (match->equal && match->other->implGetAt(context, key) != value)
+                match->equal = false;
+        }
+
+        DictionaryEntry* asEntry(ProtoObject* value)
+        {
+            return reinterpret_cast<DictionaryEntry*>(value);
+        }
+
+        DictionaryEntry* findInChain(ProtoContext* context, DictionaryEntry* chain, ProtoObject* key)
+        {
+            for (DictionaryEntry* entry = chain; entry; entry = entry->next)
+            {
+                if (protoEquals(context, entry->key, key))
+                    return entry;
+            }
+            return nullptr;
+        }
+
+        // Copia la cadena hasta target y la enlaza con lo que sigue a target.
+        DictionaryEntry* chainWithout(ProtoContext* context, DictionaryEntry* chain, DictionaryEntry* target)
+        {
+            if (chain == target)
+                return target->next;
+            return new(context) DictionaryEntry(
+                context, chain->key, chain->value, chain->keyHash, chain->sequence,
+                chainWithout(context, chain->next, target));
+        }
+
+        struct ElementVisit
+        {
+            void* self;
+            void (*method)(ProtoContext* context, void* self, ProtoObject* key, ProtoObject* value);
+        };
+
+        void visitChain(ProtoContext* context, void* self, ProtoObject* value)
+        {
+            auto* visit = static_cast<ElementVisit*>(self);
+            for (DictionaryEntry* entry = asEntry(value); entry; entry = entry->next)
+                visit->method(context, visit->self, entry->key, entry->value);
+        }
+
+        void visitOrdered(ProtoContext* context, void* self, ProtoObject* value)
+        {
+            auto* visit = static_cast<ElementVisit*>(self);
+            DictionaryEntry* entry = asEntry(value);
+            visit->method(context, visit->self, entry->key, entry->value);
+        }
+    } // fin del namespace anónimo
+
+    unsigned long protoStructuralHash(ProtoContext* context, ProtoObject* value)
+    {
+        switch (tagOf(value))
+        {
+        case POINTER_TAG_STRING:
+            {
+                ProtoStringCursor cursor(context, value->asString(context));
+                return sequenceHash(context, cursor, POINTER_TAG_STRING);
+            }
+        case POINTER_TAG_TUPLE:
+            {
+                ProtoTupleCursor cursor(context, value->asTuple(context));
+                return sequenceHash(context, cursor, POINTER_TAG_TUPLE);
+            }
+        case POINTER_TAG_LIST:
+            {
+                ProtoListCursor cursor(context, value->asList(context));
+                return sequenceHash(context, cursor, POINTER_TAG_LIST);
+            }
+        case POINTER_TAG_SPARSE_LIST:
+            return value->asSparseList(context)->getHash(context);
+        case POINTER_TAG_DICTIONARY:
+            return value->asDictionary(context)->getHash(context);
+        default:
+            return value->getHash(context);
+        }
+    }
+
+    bool protoEquals(ProtoContext* context, ProtoObject* a, ProtoObject* b)
+    {
+        if (a == b)
+            return true;
+        if (a == PROTO_NONE || b == PROTO_NONE || tagOf(a) != tagOf(b))
+            return false;
+
+        switch (tagOf(a))
+        {
+        case POINTER_TAG_STRING:
+            {
+                if (a->asString(context)->getSize(context) != b->asString(context)->getSize(context))
+                    return false;
+                ProtoStringCursor left(context, a->asString(context));
+                ProtoStringCursor right(context, b->asString(context));
+                return sequenceEquals(context, left, right);
+            }
+        case POINTER_TAG_TUPLE:
+            {
+                if (a->asTuple(context)->getSize(context) != b->asTuple(context)->getSize(context))
+                    return false;
+                ProtoTupleCursor left(context, a->asTuple(context));
+                ProtoTupleCursor right(context, b->asTuple(context));
+                return sequenceEquals(context, left, right);
+            }
+        case POINTER_TAG_LIST:
+            {
+                if (a->asList(context)->getSize(context) != b->asList(context)->getSize(context))
+                    return false;
+                ProtoListCursor left(context, a->asList(context));
+                ProtoListCursor right(context, b->asList(context));
+                return sequenceEquals(context, left, right);
+            }
+        case POINTER_TAG_SPARSE_LIST:
+            {
+                ProtoSparseList* left = a->asSparseList(context);
+                ProtoSparseList* right = b->asSparseList(context);
+                if (left->getSize(context) != right->getSize(context) ||
+                    left->getHash(context) != right->getHash(context))
+                    return false;
+                SparseListMatch match{right, true};
+                left->processElements(context, &match, matchSparseEntry);
+                return match.equal;
+            }
+        case POINTER_TAG_DICTIONARY:
+            return toImpl<ProtoDictionaryImplementation>(a->asDictionary(context))->implIsEqual(
+                context, toImpl<ProtoDictionaryImplementation>(b->asDictionary(context)));
+        default:
+            return false;
+        }
+    }
+
+
+    // --- DictionaryEntry ---
+
+    DictionaryEntry::DictionaryEntry(
+        ProtoContext* context,
+        ProtoObject* key,
+        ProtoObject* value,
+        unsigned long keyHash,
+        unsigned long sequence,
+        DictionaryEntry* next
+    ) : Cell(context), key(key), value(value), keyHash(keyHash), sequence(sequence), next(next)
+    {
+    }
+
+    DictionaryEntry::~DictionaryEntry() = default;
+
+    unsigned long DictionaryEntry::getHash(ProtoContext* context)
+    {
+        return Cell::getHash(context);
+    }
+
+    ProtoObject* DictionaryEntry::asObject(ProtoContext* context)
+    {
+        return Cell::asObject(context);
+    }
+
+    void DictionaryEntry::finalize(ProtoContext* context)
+    {
+    }
+
+    void DictionaryEntry::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        if (this->key && this->key->isCell(context))
+            method(context, self, this->key->asCell(context));
+        if (this->value && this->value->isCell(context))
+            method(context, self, this->value->asCell(context));
+        if (this->next)
+            method(context, self, this->next);
+    }
+
+
+    // --- ProtoDictionaryImplementation ---
+
+    ProtoDictionaryImplementation::ProtoDictionaryImplementation(ProtoContext* context, bool insertionOrder)
+        : Cell(context),
+          table(new(context) ProtoSparseHashImplementation(context)),
+          order(insertionOrder ? new(context) ProtoSparseListImplementation(context) : nullptr),
+          nextSequence(0), count(0), hash(0)
+    {
+    }
+
+    ProtoDictionaryImplementation::ProtoDictionaryImplementation(
+        ProtoContext* context,
+        ProtoSparseHashImplementation* table,
+        SparseListCell* order,
+        unsigned long nextSequence,
+        unsigned long count,
+        unsigned long hash
+    ) : Cell(context), table(table), order(order), nextSequence(nextSequence), count(count), hash(hash)
+    {
+    }
+
+    ProtoDictionaryImplementation::~ProtoDictionaryImplementation() = default;
+
+    DictionaryEntry* ProtoDictionaryImplementation::implFind(
+        ProtoContext* context,
+        ProtoObject* key,
+        unsigned long keyHash
+    )
+    {
+        return findInChain(context, asEntry(this->table->implGetAt(context, keyHash)), key);
+    }
+
+    bool ProtoDictionaryImplementation::implHas(ProtoContext* context, ProtoObject* key)
+    {
+        return this->implFind(context, key, protoStructuralHash(context, key)) != nullptr;
+    }
+
+    ProtoObject* ProtoDictionaryImplementation::implGetAt(ProtoContext* context, ProtoObject* key)
+    {
+        DictionaryEntry* entry = this->implFind(context, key, protoStructuralHash(context, key));
+        return entry ? entry->value : PROTO_NONE;
+    }
+
+    ProtoDictionaryImplementation* ProtoDictionaryImplementation::implSetAt(
+        ProtoContext* context,
+        ProtoObject* key,
+        ProtoObject* value
+    )
+    {
+        if (value == PROTO_NONE)
+            return this->implRemoveAt(context, key);
+
+        // La cadena se busca una sola vez en el trie; después sólo se
+        // reemplaza la hoja.
+        unsigned long keyHash = protoStructuralHash(context, key);
+        DictionaryEntry* chain = asEntry(this->table->implGetAt(context, keyHash));
+        DictionaryEntry* existing = findInChain(context, chain, key);
+        if (existing && existing->value == value)
+            return this;
+
+        // La entrada nueva encabeza la cadena de su hash; una clave que ya
+        // estaba conserva su clave original y su lugar en el orden de inserción.
+        if (existing)
+            chain = chainWithout(context, chain, existing);
+        auto* entry = new(context) DictionaryEntry(
+            context,
+            existing ? existing->key : key,
+            value,
+            keyHash,
+            existing ? existing->sequence : this->nextSequence,
+            chain
+        );
+
+        SparseListCell* order = this->order;
+        if (order)
+            order = ProtoSparseArrayImplementation::implAdapt(
+                context, order->implSetAt(context, entry->sequence, reinterpret_cast<ProtoObject*>(entry)));
+
+        unsigned long hash = this->hash ^ entryHash(context, keyHash, value);
+        if (existing)
+            hash ^= entryHash(context, keyHash, existing->value);
+
+        return new(context) ProtoDictionaryImplementation(
+            context,
+            this->table->implSetAt(context, keyHash, reinterpret_cast<ProtoObject*>(entry)),
+            order,
+            existing ? this->nextSequence : this->nextSequence + 1,
+            existing ? this->count : this->count + 1,
+            hash
+        );
+    }
+
+    ProtoDictionaryImplementation* ProtoDictionaryImplementation::implRemoveAt(
+        ProtoContext* context,
+        ProtoObject* key
+    )
+    {
+        unsigned long keyHash = protoStructuralHash(context, key);
+        DictionaryEntry* chain = asEntry(this->table->implGetAt(context, keyHash));
+        DictionaryEntry* existing = findInChain(context, chain, key);
+        if (!existing)
+            return this;
+
+        chain = chainWithout(context, chain, existing);
+
+        SparseListCell* order = this->order;
+        if (order)
+        {
+            // El árbol devuelve nullptr al quitar su último nodo.
+            order = order->implRemoveAt(context, existing->sequence);
+            if (!order)
+                order = new(context) ProtoSparseListImplementation(context);
+        }
+
+        return new(context) ProtoDictionaryImplementation(
+            context,
+            chain
+                ? this->table->implSetAt(context, keyHash, reinterpret_cast<ProtoObject*>(chain))
+                : this->table->implRemoveAt(context, keyHash),
+            order,
+            this->nextSequence,
+            this->count - 1,
+            this->hash ^ entryHash(context, keyHash, existing->value)
+        );
+    }
+
+    unsigned long ProtoDictionaryImplementation::implGetSize(ProtoContext* context)
+    {
+        return this->count;
+    }
+
+    bool ProtoDictionaryImplementation::implKeepsInsertionOrder(ProtoContext* context)
+    {
+        return this->order != nullptr;
+    }
+
+    bool ProtoDictionaryImplementation::implIsEqual(ProtoContext* context, ProtoDictionaryImplementation* other)
+    {
+        if (this == other)
+            return true;
+        if (this->count != other->count || this->hash != other->hash)
+            return false;
+
+        DictionaryMatch match{other, true};
+        this->implProcessElements(context, &match, matchDictionaryEntry);
+        return match.equal;
+    }
+
+    void ProtoDictionaryImplementation::implProcessElements(
+        ProtoContext* context,
+        void* self,
+        void (*method)(ProtoContext* context, void* self, ProtoObject* key, ProtoObject* value)
+    )
+    {
+        ElementVisit visit{self, method};
+        if (this->order)
+            this->order->implProcessValues(context, &visit, visitOrdered);
+        else
+            this->table->implProcessValues(context, &visit, visitChain);
+    }
+
+    ProtoObject* ProtoDictionaryImplementation::implAsObject(ProtoContext* context)
+    {
+        ProtoObjectPointer p{};
+        p.oid.oid = reinterpret_cast<ProtoObject*>(this);
+        p.op.pointer_tag = POINTER_TAG_DICTIONARY;
+        return p.oid.oid;
+    }
+
+    unsigned long ProtoDictionaryImplementation::getHash(ProtoContext* context)
+    {
+        return this->hash;
+    }
+
+    ProtoObject* ProtoDictionaryImplementation::asObject(ProtoContext* context)
+    {
+        return this->implAsObject(context);
+    }
+
+    void ProtoDictionaryImplementation::finalize(ProtoContext* context)
+    {
+    }
+
+    void ProtoDictionaryImplementation::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        method(context, self, this->table);
+        if (this->order)
+            method(context, self, this->order);
+    }
+} // namespace proto
@@ -7,6 +7,7 @@
 
 #include "../headers/proto_internal.h"
 #include <algorithm> // Para std::max
+#include <vector>
 
 namespace proto
 {
@@ -89,23 +90,21 @@ namespace proto
 
     // --- ProtoListImplementation ---
 
-    // Constructor modernizado con lista de inicialización
     ProtoListImplementation::ProtoListImplementation(
         ProtoContext* context,
-        ProtoObject* value,
         ProtoListImplementation* previous,
-        ProtoListImplementation* newNext
+        ProtoListImplementation* next,
+        unsigned long size,
+        ProtoObject* const* values
     ) : Cell(context),
         previous(previous),
-        next(newNext),
-        value(value)
+        next(next),
+        size(size)
     {
-        // Calcular hash y contadores después de inicializar los miembros.
-        this->hash = (value ? value->getHash(context) : 0) ^
-            (previous ? previous->hash : 0) ^
-            (next ? next->hash : 0);
+        for (unsigned long i = 0; i < LIST_CHUNK_SIZE; i++)
+            this->values[i] = i < size ? values[i] : PROTO_NONE;
 
-        this->count = (value ? 1 : 0) +
+        this->count = size +
             (previous ? previous->count : 0) +
             (next ? next->count : 0);
 
@@ -116,11 +115,17 @@ namespace proto
 
     ProtoListImplementation::~ProtoListImplementation() = default;
 
-    // --- Lógica de Árbol AVL (Corregida) ---
+    // --- Lógica de Árbol AVL de bloques ---
 
     namespace
     {
-        // Funciones auxiliares anónimas
+        // Funciones auxiliares anónimas. Trabajan con subárboles donde nullptr
+        // es el árbol vacío; las operaciones públicas lo traducen a la lista vacía.
+
+        unsigned long getCount(const ProtoListImplementation* node)
+        {
+            return node ? node->count : 0;
+        }
 
         int getHeight(const ProtoListImplementation* node)
         {
@@ -136,14 +141,30 @@ namespace proto
             return getHeight(node->next) - getHeight(node->previous);
         }
 
+        // El mismo bloque de elementos con otros subárboles.
+        ProtoListImplementation* withChildren(
+            ProtoContext* context,
+            const ProtoListImplementation* node,
+            ProtoListImplementation* previous,
+            ProtoListImplementation* next
+        )
+        {
+            return new(context) ProtoListImplementation(context, previous, next, node->size, node->values);
+        }
+
+        ProtoListImplementation* orEmpty(ProtoContext* context, ProtoListImplementation* node)
+        {
+            return node ? node : new(context) ProtoListImplementation(context);
+        }
+
         ProtoListImplementation* rightRotate(ProtoContext* context, const ProtoListImplementation* y)
         {
             ProtoListImplementation* x = y->previous;
             ProtoListImplementation* T2 = x->next;
 
             // Realizar rotación
-            ProtoListImplementation* new_y = new(context) ProtoListImplementation(context, y->value, T2, y->next);
-            return new(context) ProtoListImplementation(context, x->value, x->previous, new_y);
+            ProtoListImplementation* new_y = withChildren(context, y, T2, y->next);
+            return withChildren(context, x, x->previous, new_y);
         }
 
         ProtoListImplementation* leftRotate(ProtoContext* context, const ProtoListImplementation* x)
@@ -152,12 +173,10 @@ namespace proto
             ProtoListImplementation* T2 = y->previous;
 
             // Realizar rotación
-            auto* new_x = new(context) ProtoListImplementation(context, x->value, x->previous, T2);
-            return new(context) ProtoListImplementation(context, y->value, new_x, y->next);
+            ProtoListImplementation* new_x = withChildren(context, x, x->previous, T2);
+            return withChildren(context, y, new_x, y->next);
         }
 
-        // CORRECCIÓN CRÍTICA: La lógica de rebalanceo estaba rota.
-        // Esta es una implementación estándar y correcta para un árbol AVL.
         ProtoListImplementation* rebalance(ProtoContext* context, ProtoListImplementation* node)
         {
             if (!node) return nullptr;
@@ -180,59 +199,285 @@ namespace proto
             if (balance < -1 && getBalance(node->previous) > 0)
             {
                 ProtoListImplementation* new_prev = leftRotate(context, node->previous);
-                const auto* new_node = new(context) ProtoListImplementation(
-                    context, node->value, new_prev, node->next);
-                return rightRotate(context, new_node);
+                return rightRotate(context, withChildren(context, node, new_prev, node->next));
             }
 
             // Caso 4: Derecha-Izquierda (RL)
             if (balance > 1 && getBalance(node->next) < 0)
             {
                 ProtoListImplementation* new_next = rightRotate(context, node->next);
-                const auto* new_node = new(context) ProtoListImplementation(
-                    context, node->value, node->previous, new_next);
-                return leftRotate(context, new_node);
+                return leftRotate(context, withChildren(context, node, node->previous, new_next));
             }
 
             return node; // El nodo ya está balanceado
         }
+
+        ProtoListImplementation* insertInto(
+            ProtoContext* context,
+            ProtoListImplementation* node,
+            unsigned long index,
+            ProtoObject* value
+        )
+        {
+            if (!node)
+                return new(context) ProtoListImplementation(context, nullptr, nullptr, 1, &value);
+
+            unsigned long thisIndex = getCount(node->previous);
+            if (index < thisIndex)
+                return rebalance(context, withChildren(
+                    context, node, insertInto(context, node->previous, index, value), node->next));
+
+            if (index > thisIndex + node->size)
+                return rebalance(context, withChildren(
+                    context, node, node->previous,
+                    insertInto(context, node->next, index - thisIndex - node->size, value)));
+
+            // La posición cae dentro del bloque de este nodo.
+            ProtoObject* values[LIST_CHUNK_SIZE + 1];
+            unsigned long position = index - thisIndex;
+            unsigned long n = 0;
+            for (unsigned long i = 0; i < node->size; i++)
+            {
+                if (i == position)
+                    values[n++] = value;
+                values[n++] = node->values[i];
+            }
+            if (position == node->size)
+                values[n++] = value;
+
+            if (n <= LIST_CHUNK_SIZE)
+                return new(context) ProtoListImplementation(context, node->previous, node->next, n, values);
+
+            // Bloque lleno: el último elemento pasa al comienzo del subárbol siguiente.
+            return rebalance(context, new(context) ProtoListImplementation(
+                context,
+                node->previous,
+                insertInto(context, node->next, 0, values[LIST_CHUNK_SIZE]),
+                LIST_CHUNK_SIZE,
+                values
+            ));
+        }
+
+        // Quita el nodo de más a la izquierda y lo devuelve en first.
+        ProtoListImplementation* removeFirstNode(
+            ProtoContext* context,
+            ProtoListImplementation* node,
+            ProtoListImplementation** first
+        )
+        {
+            if (!node->previous)
+            {
+                *first = node;
+                return node->next;
+            }
+
+            return rebalance(context, withChildren(
+                context, node, removeFirstNode(context, node->previous, first), node->next));
+        }
+
+        ProtoListImplementation* removeFrom(
+            ProtoContext* context,
+            ProtoListImplementation* node,
+            unsigned long index
+        )
+        {
+            unsigned long thisIndex = getCount(node->previous);
+            if (index < thisIndex)
+                return rebalance(context, withChildren(
+                    context, node, removeFrom(context, node->previous, index), node->next));
+
+            if (index >= thisIndex + node->size)
+                return rebalance(context, withChildren(
+                    context, node, node->previous,
+                    removeFrom(context, node->next, index - thisIndex - node->size)));
+
+            if (node->size > 1)
+            {
+                ProtoObject* values[LIST_CHUNK_SIZE];
+                unsigned long n = 0;
+                for (unsigned long i = 0; i < node->size; i++)
+                {
+                    if (i != index - thisIndex)
+                        values[n++] = node->values[i];
+                }
+                return new(context) ProtoListImplementation(context, node->previous, node->next, n, values);
+            }
+
+            // El nodo queda vacío: se reemplaza por el primer nodo del subárbol siguiente.
+            if (!node->previous) return node->next;
+            if (!node->next) return node->previous;
+
+            ProtoListImplementation* first = nullptr;
+            ProtoListImplementation* rest = removeFirstNode(context, node->next, &first);
+            return rebalance(context, withChildren(context, first, node->previous, rest));
+        }
+
+        // Une previous, un bloque de elementos y next, en ese orden. Desciende por
+        // el lado del árbol más alto hasta encontrar un subárbol de altura
+        // parecida al otro, así que cuesta O(|altura(previous) - altura(next)|).
+        ProtoListImplementation* join(
+            ProtoContext* context,
+            ProtoListImplementation* previous,
+            unsigned long size,
+            ProtoObject* const* values,
+            ProtoListImplementation* next
+        )
+        {
+            if (getHeight(previous) > getHeight(next) + 1)
+                return rebalance(context, withChildren(
+                    context, previous, previous->previous, join(context, previous->next, size, values, next)));
+
+            if (getHeight(next) > getHeight(previous) + 1)
+                return rebalance(context, withChildren(
+                    context, next, join(context, previous, size, values, next->previous), next->next));
+
+            return new(context) ProtoListImplementation(context, previous, next, size, values);
+        }
+
+        // Concatena dos subárboles usando como bloque intermedio el primero de next.
+        ProtoListImplementation* concat(
+            ProtoContext* context,
+            ProtoListImplementation* previous,
+            ProtoListImplementation* next
+        )
+        {
+            if (!previous) return next;
+            if (!next) return previous;
+
+            ProtoListImplementation* first = nullptr;
+            ProtoListImplementation* rest = removeFirstNode(context, next, &first);
+            return join(context, previous, first->size, first->values, rest);
+        }
+
+        // Divide node en los elementos [0, index) y [index, count). Solo se crean
+        // nodos sobre el camino hasta index; el resto de los subárboles se comparte.
+        void splitAt(
+            ProtoContext* context,
+            ProtoListImplementation* node,
+            unsigned long index,
+            ProtoListImplementation** left,
+            ProtoListImplementation** right
+        )
+        {
+            if (!node)
+            {
+                *left = *right = nullptr;
+                return;
+            }
+
+            unsigned long thisIndex = getCount(node->previous);
+            if (index <= thisIndex)
+            {
+                ProtoListImplementation* middle = nullptr;
+                splitAt(context, node->previous, index, left, &middle);
+                *right = join(context, middle, node->size, node->values, node->next);
+            }
+            else if (index >= thisIndex + node->size)
+            {
+                ProtoListImplementation* middle = nullptr;
+                splitAt(context, node->next, index - thisIndex - node->size, &middle, right);
+                *left = join(context, node->previous, node->size, node->values, middle);
+            }
+            else
+            {
+                // El corte cae dentro del bloque: cada mitad se lleva su parte.
+                unsigned long position = index - thisIndex;
+                *left = join(context, node->previous, position, node->values, nullptr);
+                *right = join(context, nullptr, node->size - position, node->values + position, node->next);
+            }
+        }
+
+        // Construye de abajo hacia arriba un árbol balanceado con bloques llenos.
+        ProtoListImplementation* buildBalanced(
+            ProtoContext* context,
+            ProtoObject* const* values,
+            unsigned long count,
+            unsigned long firstChunk,
+            unsigned long lastChunk
+        )
+        {
+            if (firstChunk >= lastChunk)
+                return nullptr;
+
+            unsigned long middle = firstChunk + (lastChunk - firstChunk) / 2;
+            ProtoListImplementation* previous = buildBalanced(context, values, count, firstChunk, middle);
+            ProtoListImplementation* next = buildBalanced(context, values, count, middle + 1, lastChunk);
+
+            unsigned long start = middle * LIST_CHUNK_SIZE;
+            unsigned long size = std::min((unsigned long) LIST_CHUNK_SIZE, count - start);
+            return new(context) ProtoListImplementation(context, previous, next, size, values + start);
+        }
+
+        // Enlaza en su lugar bloques propios (aún no publicados) como un árbol balanceado.
+        ProtoListImplementation* linkBalanced(
+            std::vector<ProtoListImplementation*>& chunks,
+            unsigned long firstChunk,
+            unsigned long lastChunk
+        )
+        {
+            if (firstChunk >= lastChunk)
+                return nullptr;
+
+            unsigned long middle = firstChunk + (lastChunk - firstChunk) / 2;
+            ProtoListImplementation* node = chunks[middle];
+            node->previous = linkBalanced(chunks, firstChunk, middle);
+            node->next = linkBalanced(chunks, middle + 1, lastChunk);
+            node->count = node->size + getCount(node->previous) + getCount(node->next);
+            node->height = 1 + std::max(getHeight(node->previous), getHeight(node->next));
+            return node;
+        }
+
+        // Normaliza un índice de corte: negativos desde el final, acotado a [0, count].
+        unsigned long normalizeBound(int index, unsigned long count)
+        {
+            long normalized = index < 0 ? (long) count + index : index;
+            if (normalized < 0)
+                return 0;
+            return std::min((unsigned long) normalized, count);
+        }
     } // fin del namespace anónimo
 
     // --- Métodos de la Interfaz Pública ---
 
-    ProtoObject* ProtoListImplementation::implGetAt(ProtoContext* context, int index)
+    ProtoListImplementation* ProtoListImplementation::implFromArray(
+        ProtoContext* context,
+        ProtoObject* const* values,
+        unsigned long count
+    )
     {
-        if (!this->value)
-        {
-            return PROTO_NONE;
-        }
+        unsigned long chunks = (count + LIST_CHUNK_SIZE - 1) / LIST_CHUNK_SIZE;
+        return orEmpty(context, buildBalanced(context, values, count, 0, chunks));
+    }
 
+    ProtoObject* ProtoListImplementation::implGetAt(ProtoContext* context, int index)
+    {
         if (index < 0)
         {
             index += this->count;
         }
 
-        if (index < 0 || (unsigned)index >= this->count)
+        if (index < 0 || (unsigned long)index >= this->count)
         {
             return PROTO_NONE;
         }
 
+        unsigned long position = index;
         const ProtoListImplementation* node = this;
         while (node)
         {
-            const unsigned long thisIndex = node->previous ? node->previous->count : 0;
-            if ((unsigned long)index == thisIndex)
+            const unsigned long thisIndex = getCount(node->previous);
+            if (position < thisIndex)
             {
-                return node->value;
+                node = node->previous;
             }
-            if ((unsigned long)index < thisIndex)
+            else if (position < thisIndex + node->size)
             {
-                node = node->previous;
+                return node->values[position - thisIndex];
             }
             else
             {
+                position -= thisIndex + node->size;
                 node = node->next;
-                index -= (thisIndex + 1);
             }
         }
         return PROTO_NONE; // No debería llegar aquí si la lógica es correcta
@@ -255,136 +500,31 @@ namespace proto
 
     bool ProtoListImplementation::implHas(ProtoContext* context, ProtoObject* value)
     {
-        // CORRECCIÓN CRÍTICA: Bucle corregido para evitar acceso fuera de límites.
-        // El bucle original (i <= this->count) iteraba una vez de más.
-        for (unsigned long i = 0; i < this->count; i++)
+        // Recorrido en orden, un bloque por nodo.
+        const ProtoListImplementation* stack[64];
+        int depth = 0;
+        const ProtoListImplementation* node = this;
+        while (node || depth)
         {
-            if (this->implGetAt(context, i) == value)
+            while (node)
             {
-                return true;
+                stack[depth++] = node;
+                node = node->previous;
             }
-        }
-        return false;
-    }
-
-    ProtoListImplementation* ProtoListImplementation::implAppendLast(ProtoContext* context, ProtoObject* newValue)
-    {
-        if (!this->value)
-        {
-            return new(context) ProtoListImplementation(context, newValue);
-        }
-
-        ProtoListImplementation* newNode;
-        if (this->next)
-        {
-            ProtoListImplementation* new_next = static_cast<ProtoListImplementation*>(this->next->implAppendLast(
-                context, newValue));
-            newNode = new(context) ProtoListImplementation(context, this->value, this->previous, new_next);
-        }
-        else
-        {
-            newNode = new(context) ProtoListImplementation(
-                context,
-                this->value,
-                this->previous,
-                new(context) ProtoListImplementation(context, newValue)
-            );
-        }
-        return rebalance(context, newNode);
-    }
-
-    ProtoListImplementation* ProtoListImplementation::implRemoveLast(ProtoContext* context)
-    {
-        // STUB implementation, la lógica real es más compleja.
-        return this->implRemoveAt(context, -1);
-    }
-
-    // ... Implementación del resto de los métodos (setAt, insertAt, etc.) ...
-    // NOTA: Muchos de estos métodos usan la variable 'value' que no está definida.
-    // Se debe corregir a 'this->value' en todos los casos.
-
-    ProtoListImplementation* ProtoListImplementation::implRemoveAt(ProtoContext* context, int index)
-    {
-        if (!this->value)
-        {
-            return new(context) ProtoListImplementation(context);
-        }
-        // ... Lógica de normalización de índice ...
-        if (index < 0) index += this->count;
-        if (index < 0 || static_cast<unsigned>(index) >= this->count) return this;
-
-        unsigned long thisIndex = this->previous ? this->previous->count : 0;
-        ProtoListImplementation* newNode;
-
-        if (static_cast<unsigned long>(index) == thisIndex)
-        {
-            // Lógica para unir subárboles izquierdo y derecho
-            if (!this->previous) return this->next;
-            if (!this->next) return this->previous;
 
-            // Unir los dos subárboles
-            ProtoObject* rightmost_of_left = this->previous->implGetLast(context);
-            auto* left_without_rightmost = static_cast<ProtoListImplementation*>(this->previous->
-                implRemoveLast(context));
-
-            newNode = new(context) ProtoListImplementation(
-                context,
-                rightmost_of_left,
-                left_without_rightmost,
-                this->next
-            );
-        }
-        else
-        {
-            if (static_cast<unsigned long>(index) < thisIndex)
+            node = stack[--depth];
+            for (unsigned long i = 0; i < node->size; i++)
             {
-                auto* new_prev = static_cast<ProtoListImplementation*>(this->previous->implRemoveAt(
-                    context, index));
-                newNode = new(context) ProtoListImplementation(context, this->value, new_prev, this->next);
-            }
-            else
-            {
-                auto* new_next = static_cast<ProtoListImplementation*>(this->next->implRemoveAt(
-                    context, index - thisIndex - 1));
-                // CORRECCIÓN CRÍTICA: Usar this->value en lugar de 'value'
-                newNode = new(context) ProtoListImplementation(context, this->value, this->previous, new_next);
+                if (node->values[i] == value)
+                    return true;
             }
+            node = node->next;
         }
-        return rebalance(context, newNode);
+        return false;
     }
 
-    ProtoListImplementation* ProtoListImplementation::implGetSlice(ProtoContext* context, int from, int to)
-    {
-        if (from < 0)
-        {
-            from = this->count + from;
-            if (from < 0)
-                from = 0;
-        }
-
-        if (to < 0)
-        {
-            to = this->count + to;
-            if (to < 0)
-                to = 0;
-        }
-
-        if (to >= from)
-        {
-            ProtoListImplementation* upperPart = this->implSplitLast(context, from);
-            return upperPart->implSplitFirst(context, to - from);
-        }
-        else
-            return new(context) ProtoListImplementation(context);
-    };
-
     ProtoListImplementation* ProtoListImplementation::implSetAt(ProtoContext* context, int index, ProtoObject* value)
     {
-        if (!this->value)
-        {
-            return nullptr;
-        }
-
         if (index < 0)
         {
             index = this->count + index;
@@ -397,369 +537,258 @@ namespace proto
             return nullptr;
         }
 
-        int thisIndex = this->previous ? this->previous->count : 0;
-        if (thisIndex == index)
-        {
-            return new(context) ProtoListImplementation(
-                context,
-                value,
-                this->previous,
-                this->next
-            );
-        }
+        unsigned long thisIndex = getCount(this->previous);
+        if ((unsigned long)index < thisIndex)
+            return withChildren(context, this, this->previous->implSetAt(context, index, value), this->next);
 
-        if (index < thisIndex)
-            return new(context) ProtoListImplementation(
-                context,
-                value,
-                this->previous->implSetAt(context, index, value),
-                this->next
-            );
-        else
-            return new(context) ProtoListImplementation(
-                context,
-                value,
-                this->previous,
-                this->next->implSetAt(context, index - thisIndex - 1, value)
-            );
+        if ((unsigned long)index >= thisIndex + this->size)
+            return withChildren(context, this, this->previous,
+                                this->next->implSetAt(context, index - thisIndex - this->size, value));
+
+        ProtoObject* values[LIST_CHUNK_SIZE];
+        for (unsigned long i = 0; i < this->size; i++)
+            values[i] = this->values[i];
+        values[index - thisIndex] = value;
+        return new(context) ProtoListImplementation(context, this->previous, this->next, this->size, values);
     };
 
     ProtoListImplementation* ProtoListImplementation::implInsertAt(ProtoContext* context, int index, ProtoObject* value)
     {
-        if (!this->value)
-            return new(context) ProtoListImplementation(
-                context,
-                value
-            );
-
-        if (index < 0)
-        {
-            index = this->count + index;
-            if (index < 0)
-                index = 0;
-        }
+        unsigned long position = normalizeBound(index, this->count);
+        if (!this->count)
+            return insertInto(context, nullptr, 0, value);
 
-        if (((unsigned long)index) >= this->count)
-            index = this->count - 1;
-
-        unsigned long thisIndex = this->previous ? this->previous->count : 0;
-        ProtoListImplementation* newNode;
-
-        if (thisIndex == ((unsigned long)index))
-            newNode = new(context) ProtoListImplementation(
-                context,
-                value,
-                this->previous,
-                new(context) ProtoListImplementation(
-                    context,
-                    this->value,
-                    nullptr,
-                    this->next
-                )
-            );
-        else
-        {
-            if (((unsigned long)index) < thisIndex)
-                newNode = new(context) ProtoListImplementation(
-                    context,
-                    this->value,
-                    this->previous->implInsertAt(context, index, value),
-                    this->next
-                );
-            else
-                newNode = new(context) ProtoListImplementation(
-                    context,
-                    this->value,
-                    this->previous,
-                    this->next->implInsertAt(context, index - thisIndex - 1, value)
-                );
-        }
-
-        return rebalance(context, newNode);
+        return insertInto(context, this, position, value);
     };
 
     ProtoListImplementation* ProtoListImplementation::implAppendFirst(ProtoContext* context, ProtoObject* value)
     {
-        if (!this->value)
-            return new(context) ProtoListImplementation(
-                context,
-                value
-            );
+        return this->implInsertAt(context, 0, value);
+    };
 
-        ProtoListImplementation* newNode;
+    ProtoListImplementation* ProtoListImplementation::implAppendLast(ProtoContext* context, ProtoObject* newValue)
+    {
+        if (!this->count)
+            return insertInto(context, nullptr, 0, newValue);
 
-        if (this->previous)
-            newNode = new(context) ProtoListImplementation(
-                context,
-                this->value,
-                this->previous->implAppendFirst(context, value),
-                this->next
-            );
-        else
-        {
-            newNode = new(context) ProtoListImplementation(
-                context,
-                this->value,
-                new(context) ProtoListImplementation(
-                    context,
-                    value
-                ),
-                this->next
-            );
-        }
+        return insertInto(context, this, this->count, newValue);
+    }
+
+    ProtoListImplementation* ProtoListImplementation::implRemoveAt(ProtoContext* context, int index)
+    {
+        if (index < 0) index += this->count;
+        if (index < 0 || static_cast<unsigned long>(index) >= this->count) return this;
+
+        return orEmpty(context, removeFrom(context, this, index));
+    }
 
-        return rebalance(context, newNode);
+    ProtoListImplementation* ProtoListImplementation::implRemoveFirst(ProtoContext* context)
+    {
+        return this->implRemoveAt(context, 0);
     };
 
-    ProtoListImplementation* ProtoListImplementation::implExtend(ProtoContext* context, ProtoList* other)
+    ProtoListImplementation* ProtoListImplementation::implRemoveLast(ProtoContext* context)
     {
-        if (this->count == 0)
-            return (ProtoListImplementation*)other;
+        return this->implRemoveAt(context, -1);
+    }
 
-        unsigned long otherCount = other->getSize(context);
+    ProtoListImplementation* ProtoListImplementation::implGetSlice(ProtoContext* context, int from, int to)
+    {
+        unsigned long first = normalizeBound(from, this->count);
+        unsigned long last = normalizeBound(to, this->count);
 
-        if (otherCount == 0)
+        if (first == 0 && last == this->count)
             return this;
 
-        if (this->count < otherCount)
-            return rebalance(
-                context,
-                new(context) ProtoListImplementation(
-                    context,
-                    this->implGetLast(context),
-                    this->implRemoveLast(context),
-                    (ProtoListImplementation*)other
-                ));
-        else
-            return rebalance(
-                context,
-                new(context) ProtoListImplementation(
-                    context,
-                    other->getFirst(context),
-                    this,
-                    (ProtoListImplementation*)other->removeFirst(context)
-                ));
+        if (last <= first)
+            return new(context) ProtoListImplementation(context);
+
+        ProtoListImplementation* head = nullptr;
+        ProtoListImplementation* rest = nullptr;
+        ProtoListImplementation* slice = nullptr;
+        ProtoListImplementation* tail = nullptr;
+        splitAt(context, this, last, &rest, &tail);
+        splitAt(context, rest, first, &head, &slice);
+        return orEmpty(context, slice);
     };
 
     ProtoListImplementation* ProtoListImplementation::implSplitFirst(ProtoContext* context, int index)
     {
-        if (!this->value)
-            return this;
+        return this->implGetSlice(context, 0, normalizeBound(index, this->count));
+    };
 
-        if (index < 0)
-        {
-            index = (int)this->count + index;
-            if (index < 0)
-                index = 0;
-        }
+    ProtoListImplementation* ProtoListImplementation::implSplitLast(ProtoContext* context, int index)
+    {
+        return this->implGetSlice(context, normalizeBound(index, this->count), this->count);
+    };
 
-        if (index >= (int)this->count)
-            index = (int)this->count - 1;
+    ProtoListImplementation* ProtoListImplementation::implRemoveSlice(ProtoContext* context, int from, int to)
+    {
+        unsigned long first = normalizeBound(from, this->count);
+        unsigned long last = normalizeBound(to, this->count);
 
-        if (index == (int)this->count - 1)
+        if (last <= first)
             return this;
 
-        if (index == 0)
-            return new(context) ProtoListImplementation(context);
-
-        ProtoListImplementation* newNode = NULL;
+        ProtoListImplementation* head = nullptr;
+        ProtoListImplementation* rest = nullptr;
+        ProtoListImplementation* removed = nullptr;
+        ProtoListImplementation* tail = nullptr;
+        splitAt(context, this, last, &rest, &tail);
+        splitAt(context, rest, first, &head, &removed);
+        return orEmpty(context, concat(context, head, tail));
+    };
 
-        int thisIndex = (this->previous ? this->previous->count : 0);
+    ProtoListImplementation* ProtoListImplementation::implExtend(ProtoContext* context, ProtoList* other)
+    {
+        auto* otherList = toImpl<ProtoListImplementation>(other);
+        if (this->count == 0)
+            return otherList;
 
-        if (thisIndex == index)
-            return this->previous;
-        else
-        {
-            if (index > thisIndex)
-            {
-                ProtoListImplementation* newNext = this->next->
-                                                         implSplitFirst(context, (unsigned long)index - thisIndex - 1);
-                if (newNext->count == 0)
-                    newNext = NULL;
-                newNode = new(context) ProtoListImplementation(
-                    context,
-                    this->value,
-                    this->previous,
-                    newNext
-                );
-            }
-            else
-            {
-                if (this->previous)
-                    return this->previous->implSplitFirst(context, index);
-                else
-                    newNode = new(context) ProtoListImplementation(
-                        context,
-                        value,
-                        NULL,
-                        this->next->implSplitFirst(context, index - thisIndex - 1)
-                    );
-            }
-        }
+        if (otherList->count == 0)
+            return this;
 
-        return rebalance(context, newNode);
+        return concat(context, this, otherList);
     };
 
-    ProtoListImplementation* ProtoListImplementation::implSplitLast(ProtoContext* context, int index)
+    ProtoObject* ProtoListImplementation::implAsObject(ProtoContext* context)
     {
-        if (!this->value)
-            return this;
-
-        if (index < 0)
-        {
-            index = this->count + index;
-            if (index < 0)
-                index = 0;
-        }
+        ProtoObjectPointer p{};
+        p.oid.oid = (ProtoObject*)this;
+        p.op.pointer_tag = POINTER_TAG_LIST;
+        return p.oid.oid;
+    }
 
-        if (((unsigned long)index) >= this->count)
-            index = this->count - 1;
+    unsigned long ProtoListImplementation::getHash(ProtoContext* context)
+    {
+        // La clase base Cell ya proporciona un hash basado en la dirección,
+        // que es consistente. Se puede usar esa o la que estaba aquí.
+        return Cell::getHash(context);
+    }
 
-        if (index == 0)
-            return this;
+    ProtoListIteratorImplementation* ProtoListImplementation::implGetIterator(ProtoContext* context)
+    {
+        // CORRECCIÓN CRÍTICA: El iterador debe apuntar a 'this', no a 'nullptr'.
+        return new(context) ProtoListIteratorImplementation(context, this, 0);
+    }
 
-        ProtoListImplementation* newNode = NULL;
+    ProtoListTransientImplementation* ProtoListImplementation::implBeginTransient(ProtoContext* context)
+    {
+        return new(context) ProtoListTransientImplementation(context, this);
+    }
 
-        int thisIndex = (this->previous ? this->previous->count : 0);
+    void ProtoListImplementation::finalize(ProtoContext* context)
+    {
+    };
 
-        if (thisIndex == index)
+    void ProtoListImplementation::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        if (this->previous)
         {
-            if (!this->previous)
-                return this;
-            else
-            {
-                newNode = new(context) ProtoListImplementation(
-                    context,
-                    value,
-                    NULL,
-                    this->next
-                );
-            }
+            method(context, self, this->previous);
         }
-        else
+        if (this->next)
         {
-            if (index < thisIndex)
-            {
-                newNode = new(context) ProtoListImplementation(
-                    context,
-                    this->value,
-                    this->previous->implSplitLast(context, index),
-                    this->next
-                );
-            }
-            else
-            {
-                if (!this->next)
-                // It should not happen!
-                    return new(context) ProtoListImplementation(context);
-                else
-                {
-                    return this->next->implSplitLast(
-                        context,
-                        ((unsigned long)index - thisIndex - 1)
-                    );
-                }
-            }
+            method(context, self, this->next);
         }
+        for (unsigned long i = 0; i < this->size; i++)
+        {
+            ProtoObject* value = this->values[i];
+            if (value && value->isCell(context))
+                method(context, self, value->asCell(context));
+        }
+    }
 
-        return rebalance(context, newNode);
-    };
 
-    ProtoListImplementation* ProtoListImplementation::implRemoveFirst(ProtoContext* context)
+    // --- ProtoListTransientImplementation ---
+
+    ProtoListTransientImplementation::ProtoListTransientImplementation(
+        ProtoContext* context,
+        ProtoListImplementation* base
+    ) : Cell(context), base(base), first(nullptr), last(nullptr), pendingCount(0), sealed(0)
     {
-        if (!this->value)
-            return this;
+    }
 
-        ProtoListImplementation* newNode;
+    ProtoListTransientImplementation::~ProtoListTransientImplementation() = default;
 
-        if (this->previous)
+    ProtoListTransientImplementation* ProtoListTransientImplementation::implAppendLast(
+        ProtoContext* context,
+        ProtoObject* value
+    )
+    {
+        if (this->sealed)
+            return nullptr;
+
+        // El último bloque es propio: se completa en su lugar.
+        if (this->last && this->last->size < LIST_CHUNK_SIZE)
         {
-            newNode = this->previous->implRemoveFirst(context);
-            if (newNode->value == NULL)
-                newNode = NULL;
-            newNode = new(context) ProtoListImplementation(
-                context,
-                value,
-                newNode,
-                this->next
-            );
+            this->last->values[this->last->size++] = value;
+            this->last->count++;
         }
         else
         {
-            if (this->next)
-                return this->next;
-
-            newNode = new(context) ProtoListImplementation(
-                context,
-                NULL,
-                NULL,
-                NULL
-            );
+            auto* chunk = new(context) ProtoListImplementation(context, nullptr, nullptr, 1, &value);
+            if (this->last)
+                this->last->next = chunk;
+            else
+                this->first = chunk;
+            this->last = chunk;
         }
 
-        return rebalance(context, newNode);
-    };
+        this->pendingCount++;
+        return this;
+    }
 
+    unsigned long ProtoListTransientImplementation::implGetSize(ProtoContext* context)
+    {
+        return this->base->count + this->pendingCount;
+    }
 
-    ProtoListImplementation* ProtoListImplementation::implRemoveSlice(ProtoContext* context, int from, int to)
+    ProtoListImplementation* ProtoListTransientImplementation::implPersistent(ProtoContext* context)
     {
-        if (from < 0)
-        {
-            from = this->count + from;
-            if (from < 0)
-                from = 0;
-        }
+        if (this->sealed)
+            return this->base;
 
-        if (to < 0)
+        if (this->first)
         {
-            to = this->count + to;
-            if (to < 0)
-                to = 0;
-        }
+            std::vector<ProtoListImplementation*> chunks;
+            chunks.reserve(this->pendingCount / LIST_CHUNK_SIZE + 1);
+            for (ProtoListImplementation* chunk = this->first; chunk; chunk = chunk->next)
+                chunks.push_back(chunk);
 
-        ProtoListImplementation* slice = new(context) ProtoListImplementation(context);
-        if (to >= from)
-        {
-            return this->implSplitFirst(context, from)->implExtend(
-                context,
-                this->implSplitLast(context, from)
-            );
+            ProtoListImplementation* tail = linkBalanced(chunks, 0, chunks.size());
+            this->base = this->base->count ? this->base->implExtend(context, tail) : tail;
         }
-        else
-            return this;
-
-        return slice;
-    };
 
-
-    // ... El resto de las implementaciones deben ser revisadas para corregir el error de 'value' ...
-
-    ProtoObject* ProtoListImplementation::implAsObject(ProtoContext* context)
-    {
-        ProtoObjectPointer p{};
-        p.oid.oid = (ProtoObject*)this;
-        p.op.pointer_tag = POINTER_TAG_LIST;
-        return p.oid.oid;
+        this->first = nullptr;
+        this->last = nullptr;
+        this->sealed = 1;
+        return this->base;
     }
 
-    unsigned long ProtoListImplementation::getHash(ProtoContext* context)
+    unsigned long ProtoListTransientImplementation::getHash(ProtoContext* context)
     {
-        // La clase base Cell ya proporciona un hash basado en la dirección,
-        // que es consistente. Se puede usar esa o la que estaba aquí.
         return Cell::getHash(context);
     }
 
-    ProtoListIteratorImplementation* ProtoListImplementation::implGetIterator(ProtoContext* context)
+    ProtoObject* ProtoListTransientImplementation::asObject(ProtoContext* context)
     {
-        // CORRECCIÓN CRÍTICA: El iterador debe apuntar a 'this', no a 'nullptr'.
-        return new(context) ProtoListIteratorImplementation(context, this, 0);
+        return Cell::asObject(context);
     }
 
-    void ProtoListImplementation::finalize(ProtoContext* context)
+    void ProtoListTransientImplementation::finalize(ProtoContext* context)
     {
-    };
+    }
 
-    void ProtoListImplementation::processReferences(
+    void ProtoListTransientImplementation::processReferences(
         ProtoContext* context,
         void* self,
         void (*method)(
@@ -769,18 +798,75 @@ namespace proto
         )
     )
     {
-        // Recorrer recursivamente todas las referencias para el GC.
-        if (this->previous)
+        if (this->base)
+            method(context, self, this->base);
+
+        // Los bloques pendientes se alcanzan desde el primero por su campo next.
+        if (this->first)
+            method(context, self, this->first);
+    }
+
+    // --- ProtoListCursor ---
+
+    ProtoListCursor::ProtoListCursor(ProtoContext* context, ProtoList* list) : depth(0), offset(0)
+    {
+        auto* root = toImpl<ProtoListImplementation>(list);
+        if (root && root->count)
+            this->pushLeftmost(root);
+    }
+
+    // Apila node y toda su rama izquierda; el tope queda en el primer bloque pendiente.
+    void ProtoListCursor::pushLeftmost(Cell* node)
+    {
+        auto* current = static_cast<ProtoListImplementation*>(node);
+        while (current)
         {
-            this->previous->processReferences(context, self, method);
+            this->stack[this->depth++] = current;
+            current = current->previous;
         }
-        if (this->next)
+    }
+
+    bool ProtoListCursor::hasNext(ProtoContext* context)
+    {
+        return this->depth != 0;
+    }
+
+    ProtoObject* ProtoListCursor::next(ProtoContext* context)
+    {
+        if (!this->depth)
+            return PROTO_NONE;
+
+        auto* node = static_cast<ProtoListImplementation*>(this->stack[this->depth - 1]);
+        ProtoObject* value = node->values[this->offset++];
+        if (this->offset == node->size)
         {
-            this->next->processReferences(context, self, method);
+            // Bloque agotado: sigue el subárbol posterior o, si no hay, el ancestro.
+            this->depth--;
+            this->offset = 0;
+            if (node->next)
+                this->pushLeftmost(node->next);
         }
-        if (this->value && this->value->isCell(context))
+        return value;
+    }
+
+    unsigned long ProtoListCursor::nextChunk(ProtoContext* context, std::span<ProtoObject*> out)
+    {
+        unsigned long copied = 0;
+        while (copied < out.size() && this->depth)
         {
-            this->value->processReferences(context, self, method);
+            auto* node = static_cast<ProtoListImplementation*>(this->stack[this->depth - 1]);
+            unsigned long n = std::min((unsigned long) (node->size - this->offset), (unsigned long) out.size() - copied);
+            for (unsigned long i = 0; i < n; i++)
+                out[copied++] = node->values[this->offset++];
+
+            if (this->offset == node->size)
+            {
+                this->depth--;
+                this->offset = 0;
+                if (node->next)
+                    this->pushLeftmost(node->next);
+            }
         }
+        return copied;
     }
 } // namespace proto
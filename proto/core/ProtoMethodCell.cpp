@@ -17,27 +17,91 @@ namespace proto
         this->method = method;
     };
 
+    /**
+     * @brief Constructor para métodos con la convención de aridad fija.
+     * @param context El contexto de ejecución actual.
+     * @param fastMethod Método que recibe los argumentos en un arreglo.
+     * @param method Entrada genérica para las llamadas que no entran en el
+     *        arreglo (argumentos por palabra clave o más de PROTO_MAX_FAST_ARGS).
+     */
+    ProtoMethodCellImplementation::ProtoMethodCellImplementation(
+        ProtoContext* context,
+        ProtoFastMethod fastMethod,
+        ProtoMethod method
+    ): Cell(context)
+    {
+        this->fastMethod = fastMethod;
+        this->method = method;
+    };
+
     /**
      * @brief Invoca el método C nativo encapsulado por esta celda.
      *
      * Esta función actúa como un puente entre el sistema de objetos de Proto
-     * y el código C nativo. Delega la llamada al puntero de función 'method'
-     * que se almacenó durante la construcción.
+     * y el código C nativo. Si el método usa la convención de aridad fija y
+     * la llamada entra en ella, los argumentos de la lista se copian a un
+     * arreglo en la pila; si no, se usa la entrada genérica.
      *
      * @param context El contexto de ejecución actual.
+     * @param self El receptor del mensaje.
+     * @param parentLink El eslabón donde debe continuar una llamada a super.
      * @param args Una lista de argumentos posicionales para la función.
      * @param kwargs Una lista dispersa de argumentos por palabra clave.
      * @return El ProtoObject resultante de la ejecución del método nativo.
      */
     ProtoObject* ProtoMethodCellImplementation::implInvoke(
         ProtoContext* context,
+        ProtoObject* self,
+        ParentLink* parentLink,
         ProtoList* args,
         ProtoSparseList* kwargs
     )
     {
-        // La lógica principal es simplemente llamar al puntero de función almacenado.
-        // Se asume que this->method no es nulo, lo cual debería garantizarse en el constructor.
-        return this->method(context, this->implAsObject(context), static_cast<ParentLink*>(nullptr), args, kwargs);
+        // La convención de aridad fija no tiene lugar para argumentos por
+        // palabra clave ni para más de PROTO_MAX_FAST_ARGS posicionales.
+        unsigned long argc = args ? args->getSize(context) : 0;
+        bool fits = argc <= PROTO_MAX_FAST_ARGS && (!kwargs || !kwargs->getSize(context));
+
+        if (this->fastMethod && fits)
+        {
+            ProtoObject* argv[PROTO_MAX_FAST_ARGS];
+            for (unsigned long i = 0; i < argc; i++)
+                argv[i] = args->getAt(context, (int) i);
+
+            return this->fastMethod(context, self, parentLink, (unsigned int) argc, argv);
+        }
+
+        // Un método de aridad fija sin entrada genérica no acepta la llamada.
+        if (!this->method)
+            return PROTO_NONE;
+
+        return this->method(context, self, parentLink, args, kwargs);
+    }
+
+    /**
+     * @brief Invoca el método con los argumentos en un arreglo provisto por el llamador.
+     *
+     * Es el camino rápido: un método de aridad fija se llama directamente, sin
+     * reservar celdas. Un método clásico, o una llamada con más de
+     * PROTO_MAX_FAST_ARGS argumentos, sigue por implInvoke con una ProtoList
+     * construida con los argumentos.
+     */
+    ProtoObject* ProtoMethodCellImplementation::implInvokeFast(
+        ProtoContext* context,
+        ProtoObject* self,
+        ParentLink* parentLink,
+        unsigned int argc,
+        ProtoObject** argv
+    )
+    {
+        if (this->fastMethod && argc <= PROTO_MAX_FAST_ARGS)
+            return this->fastMethod(context, self, parentLink, argc, argv);
+
+        ProtoList* args = context->newList();
+        for (unsigned int i = 0; i < argc; i++)
+            args = args->appendLast(context, argv[i]);
+
+        return this->implInvoke(context, self, parentLink, args, nullptr);
     }
 
     /**
@@ -113,6 +177,6 @@ namespace proto
     }
 
     ProtoMethod ProtoMethodCellImplementation::implGetMethod(ProtoContext* context) {
-        return nullptr;
+        return this->method;
     }
 } // namespace proto
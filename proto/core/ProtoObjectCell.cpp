@@ -7,21 +7,59 @@
 
 #include "../headers/proto_internal.h"
 
+#include <vector>
+
 namespace proto
 {
+    namespace
+    {
+        struct AttributeEntries
+        {
+            std::vector<unsigned long> keys;
+            std::vector<ProtoObject*> values;
+        };
+
+        void collectEntry(ProtoContext* context, void* self, unsigned long key, ProtoObject* value)
+        {
+            auto* entries = static_cast<AttributeEntries*>(self);
+            entries->keys.push_back(key);
+            entries->values.push_back(value);
+        }
+    }
+
     // --- Constructor y Destructor ---
 
     // Constructor modernizado con lista de inicialización de miembros.
-    // AJUSTADO: Se eliminó el tipo de plantilla de 'ProtoSparseListImplementation'.
+    // Los objetos con forma no reservan ninguna lista de atributos: hasta
+    // OBJECT_INLINE_SLOTS valores viven en la propia celda, y con más, los
+    // primeros quedan en la celda y el resto en 'slots'. Sólo los objetos en
+    // modo diccionario usan 'attributes'.
+    ProtoObjectCellImplementation::ProtoObjectCellImplementation(
+        ProtoContext* context,
+        ParentLinkImplementation* parent,
+        unsigned long mutable_ref,
+        ObjectShape* shape,
+        AttributeSlots* slots,
+        ProtoObject** inlineValues
+    ) : Cell(context), parent(parent), mutable_ref(mutable_ref), frozen(0), flat(0), ownCount(0),
+        spilled(shape && shape->slotCount > OBJECT_INLINE_SLOTS), shape(shape), slots(slots)
+    {
+        for (int i = 0; i < OBJECT_INLINE_SLOTS - 1; i++)
+            this->inlineValues[i] = inlineValues ? inlineValues[i] : PROTO_NONE;
+        if (shape && !this->spilled)
+            this->lastInlineValue = inlineValues ? inlineValues[OBJECT_INLINE_SLOTS - 1] : PROTO_NONE;
+    }
+
     ProtoObjectCellImplementation::ProtoObjectCellImplementation(
         ProtoContext* context,
         ParentLinkImplementation* parent,
         unsigned long mutable_ref,
         ProtoSparseListImplementation* attributes
-    ) : Cell(context), parent(parent), mutable_ref(mutable_ref),
-        attributes(attributes ? attributes : new(context) ProtoSparseListImplementation(context))
+    ) : Cell(context), parent(parent), mutable_ref(mutable_ref), frozen(0), flat(0), ownCount(0),
+        spilled(0), shape(nullptr), attributes(attributes)
     {
-        // El cuerpo del constructor ahora puede estar vacío.
+        for (int i = 0; i < OBJECT_INLINE_SLOTS - 1; i++)
+            this->inlineValues[i] = PROTO_NONE;
     }
 
     // Para destructores vacíos, usar '= default' es la práctica recomendada.
@@ -44,15 +82,47 @@ namespace proto
         // Devuelve una nueva ProtoObjectCell que es una copia de la actual,
         // pero con la cadena de herencia extendida.
         return reinterpret_cast<ProtoObjectCell*>(
-            new(context) ProtoObjectCellImplementation(
-                context,
-                newParentLink,
-                this->mutable_ref, // Se conservan las demás propiedades.
-                this->attributes
-            )
+            this->implWithParent(context, newParentLink, this->mutable_ref)
         );
     }
 
+    ProtoObjectCellImplementation* ProtoObjectCellImplementation::implWithParent(
+        ProtoContext* context,
+        ParentLinkImplementation* parent,
+        unsigned long mutable_ref
+    )
+    {
+        // La tabla plana de un objeto congelado incluye atributos heredados que
+        // no corresponden a otra cadena: se copian sólo los propios.
+        if (this->flat)
+        {
+            AttributeEntries entries;
+            this->implProcessOwnAttributes(context, &entries, collectEntry);
+
+            auto* empty = new(context) ProtoObjectCellImplementation(
+                context, parent, mutable_ref, context->space ? context->space->rootShape : nullptr);
+            return empty->implSetOwnAttributes(
+                context, (unsigned int) entries.keys.size(), entries.keys.data(), entries.values.data());
+        }
+
+        if (this->shape)
+        {
+            ProtoObject* values[OBJECT_INLINE_SLOTS];
+            this->implGetInlineValues(values);
+            return new(context) ProtoObjectCellImplementation(
+                context, parent, mutable_ref, this->shape, this->slots, values);
+        }
+
+        return new(context) ProtoObjectCellImplementation(context, parent, mutable_ref, this->attributes);
+    }
+
+    void ProtoObjectCellImplementation::implGetInlineValues(ProtoObject** values)
+    {
+        for (int i = 0; i < OBJECT_INLINE_SLOTS - 1; i++)
+            values[i] = this->inlineValues[i];
+        values[OBJECT_INLINE_SLOTS - 1] = this->shape && !this->spilled ? this->lastInlineValue : PROTO_NONE;
+    }
+
     ProtoObject* ProtoObjectCellImplementation::implAsObject(ProtoContext* context)
     {
         ProtoObjectPointer p;
@@ -61,6 +131,388 @@ namespace proto
         return p.oid.oid;
     }
 
+    ProtoObjectCellImplementation* ProtoObjectCellImplementation::implGetCurrent(ProtoContext* context)
+    {
+        if (!this->mutable_ref)
+            return this;
+
+        ProtoObjectPointer current;
+        current.oid.oid = getMutableSlot(context->space, this->mutable_ref)->load();
+        return current.oid.oid ? current.oc.objectCell : this;
+    }
+
+    ProtoObject* ProtoObjectCellImplementation::implGetOwnAttribute(ProtoContext* context, unsigned long key)
+    {
+        if (this->shape)
+        {
+            long slot = this->shape->implGetSlot(context, key);
+            if (this->flat && slot >= (long) this->ownCount)
+                return PROTO_NONE;
+            return slot >= 0 ? this->implGetSlotValue(slot) : PROTO_NONE;
+        }
+
+        return this->attributes ? this->attributes->implGetAt(context, key) : PROTO_NONE;
+    }
+
+    ProtoObject* ProtoObjectCellImplementation::implLookupAttribute(
+        ProtoContext* context,
+        unsigned long key,
+        ProtoAttributeCache* cache,
+        ProtoObjectCellImplementation** holderOut
+    )
+    {
+        // Sólo los receptores con forma se pueden cachear: la forma y la cadena
+        // de padres (su primer objeto y el resto de la cadena) determinan dónde
+        // se resuelve cada nombre. Las cadenas creadas por newChild desde el
+        // mismo prototipo son distintas celdas pero comparten esos dos valores.
+        if (!this->shape || !context->space)
+            cache = nullptr;
+
+        ProtoObject* prototype = this->parent ? reinterpret_cast<ProtoObject*>(this->parent->object) : nullptr;
+        ParentLink* ancestors = this->parent ? this->parent->parent : nullptr;
+
+        if (cache)
+        {
+            if (cache->key != key)
+            {
+                cache->reset();
+                cache->key = key;
+            }
+
+            for (auto& entry : cache->entries)
+            {
+                if (entry.shape != this->shape || entry.prototype != prototype || entry.ancestors != ancestors)
+                    continue;
+
+                // Sólo caduca si cambió alguno de los objetos mutables por los
+                // que pasó la búsqueda; un objeto congelado no depende de ninguno.
+                bool changed = false;
+                for (unsigned int i = 0; i < entry.dependencyCount; i++)
+                    changed = changed || entry.versions[i]->load() != entry.expected[i];
+                if (changed)
+                    continue;
+
+                ProtoObjectPointer holder;
+                holder.oid.oid = entry.holder;
+                if (holderOut)
+                    *holderOut = entry.holder ? holder.oc.objectCell : this;
+
+                // Un valor heredado se guarda en la entrada: la celda que lo
+                // tiene no cambia mientras la entrada sea válida.
+                if (entry.slot < 0)
+                    return entry.value;
+
+                // Un valor propio es una lectura indexada en la posición cacheada.
+                ProtoObject* value = this->implGetSlotValue(entry.slot);
+                // Un valor propio en PROTO_NONE obliga a buscar en los padres.
+                if (value != PROTO_NONE)
+                    return value;
+                cache = nullptr;
+                break;
+            }
+        }
+
+        ProtoObject* value = PROTO_NONE;
+        ProtoObjectCellImplementation* holder = nullptr;
+        long slot = -1;
+        ProtoAttributeCache::Entry dependencies{};
+
+        if (this->shape)
+        {
+            slot = this->shape->implGetSlot(context, key);
+            if (slot >= 0)
+            {
+                value = this->implGetSlotValue(slot);
+                // Otros objetos con la misma forma pueden tener un valor en
+                // esta posición, así que el resultado no se puede cachear.
+                if (value == PROTO_NONE)
+                    cache = nullptr;
+            }
+        }
+        else if (this->attributes)
+        {
+            value = this->attributes->implGetAt(context, key);
+        }
+
+        if (value != PROTO_NONE)
+        {
+            holder = this;
+        }
+        else if (!this->flat)
+        {
+            // Los padres se recorren en su orden de resolución linealizado.
+            slot = -1;
+            if (this->parent)
+                value = this->parent->implLookupAttribute(context, key, &holder, cache ? &dependencies : nullptr);
+
+            // Demasiados prototipos mutables en el camino: validar la entrada
+            // costaría más que recorrer la cadena.
+            if (dependencies.dependencyCount > PROTO_ATTRIBUTE_CACHE_DEPENDENCIES)
+                cache = nullptr;
+        }
+
+        if (cache)
+        {
+            // La primera entrada es la monomórfica; las demás se reemplazan por turnos.
+            unsigned int victim = 0;
+            if (cache->entries[0].shape)
+            {
+                victim = 1 + cache->nextVictim;
+                cache->nextVictim = (cache->nextVictim + 1) % (PROTO_ATTRIBUTE_CACHE_ENTRIES - 1);
+            }
+
+            auto& entry = cache->entries[victim];
+            entry.shape = this->shape;
+            entry.prototype = prototype;
+            entry.ancestors = ancestors;
+            entry.holder = holder && holder != this ? holder->implAsObject(context) : nullptr;
+            entry.slot = slot;
+            entry.value = slot < 0 ? value : PROTO_NONE;
+            entry.dependencyCount = dependencies.dependencyCount;
+            for (unsigned int i = 0; i < dependencies.dependencyCount; i++)
+            {
+                entry.versions[i] = dependencies.versions[i];
+                entry.expected[i] = dependencies.expected[i];
+            }
+        }
+
+        if (holderOut)
+            *holderOut = holder ? holder : this;
+
+        return value;
+    }
+
+    ProtoObjectCellImplementation* ProtoObjectCellImplementation::implSetOwnAttribute(
+        ProtoContext* context,
+        unsigned long key,
+        ProtoObject* value
+    )
+    {
+        if (this->shape)
+        {
+            ObjectShape* newShape = this->shape;
+            long slot = this->shape->implGetSlot(context, key);
+            if (slot < 0)
+            {
+                newShape = this->shape->implAddKey(context, key);
+                if (newShape)
+                    slot = (long) this->shape->slotCount;
+            }
+
+            if (newShape)
+            {
+                ProtoObject* newInlineValues[OBJECT_INLINE_SLOTS];
+                this->implGetInlineValues(newInlineValues);
+
+                // Al pasar de OBJECT_INLINE_SLOTS posiciones, la última de la
+                // celda se muda al vector junto con las que siguen.
+                bool spills = newShape->slotCount > OBJECT_INLINE_SLOTS;
+                AttributeSlots* newSlots = this->spilled ? this->slots : nullptr;
+                if (spills && !this->spilled)
+                    newSlots = AttributeSlots::implSetAt(context, nullptr, 0, newInlineValues[OBJECT_INLINE_SLOTS - 1]);
+
+                if (slot < OBJECT_INLINE_SLOTS - 1 || !spills)
+                    newInlineValues[slot] = value;
+                else
+                    newSlots = AttributeSlots::implSetAt(context, newSlots, slot - (OBJECT_INLINE_SLOTS - 1), value);
+
+                return new(context) ProtoObjectCellImplementation(
+                    context,
+                    this->parent,
+                    this->mutable_ref,
+                    newShape,
+                    newSlots,
+                    newInlineValues
+                );
+            }
+
+            // Demasiadas claves para compartir formas: pasar a modo diccionario.
+            return new(context) ProtoObjectCellImplementation(
+                context,
+                this->parent,
+                this->mutable_ref,
+                this->implGetOwnAttributes(context)->implSetAt(context, key, value)
+            );
+        }
+
+        return new(context) ProtoObjectCellImplementation(
+            context,
+            this->parent,
+            this->mutable_ref,
+            this->attributes
+                ? this->attributes->implSetAt(context, key, value)
+                : new(context) ProtoSparseListImplementation(context, key, value)
+        );
+    }
+
+    ProtoObjectCellImplementation* ProtoObjectCellImplementation::implSetOwnAttributes(
+        ProtoContext* context,
+        unsigned int count,
+        unsigned long* keys,
+        ProtoObject** values
+    )
+    {
+        if (this->shape)
+        {
+            // Extender la forma con las claves nuevas, sin tocar todavía los valores.
+            ObjectShape* newShape = this->shape;
+            for (unsigned int i = 0; i < count && newShape; i++)
+            {
+                if (newShape->implGetSlot(context, keys[i]) < 0)
+                    newShape = newShape->implAddKey(context, keys[i]);
+            }
+
+            if (newShape)
+            {
+                ProtoObject* buffer[SHAPE_MAX_SLOTS + OBJECT_INLINE_SLOTS];
+                for (unsigned long i = 0; i < newShape->slotCount; i++)
+                    buffer[i] = this->implGetSlotValue(i);
+                for (unsigned long i = newShape->slotCount; i < OBJECT_INLINE_SLOTS; i++)
+                    buffer[i] = PROTO_NONE;
+
+                for (unsigned int i = 0; i < count; i++)
+                    buffer[newShape->implGetSlot(context, keys[i])] = values[i];
+
+                return new(context) ProtoObjectCellImplementation(
+                    context,
+                    this->parent,
+                    this->mutable_ref,
+                    newShape,
+                    newShape->slotCount > OBJECT_INLINE_SLOTS
+                        ? AttributeSlots::implFromArray(
+                            context,
+                            newShape->slotCount - (OBJECT_INLINE_SLOTS - 1),
+                            buffer + (OBJECT_INLINE_SLOTS - 1))
+                        : nullptr,
+                    buffer
+                );
+            }
+        }
+
+        // Modo diccionario, o demasiadas claves para compartir formas.
+        ProtoSparseListImplementation* attributes = this->shape
+            ? this->implGetOwnAttributes(context)
+            : this->attributes;
+        if (!attributes)
+            attributes = new(context) ProtoSparseListImplementation(context);
+
+        for (unsigned int i = 0; i < count; i++)
+            attributes = attributes->implSetAt(context, keys[i], values[i]);
+
+        return new(context) ProtoObjectCellImplementation(
+            context,
+            this->parent,
+            this->mutable_ref,
+            attributes
+        );
+    }
+
+    namespace
+    {
+        struct ShapeVisit
+        {
+            ProtoObjectCellImplementation* object;
+            unsigned long limit;
+            void* self;
+            void (*method)(ProtoContext* context, void* self, unsigned long key, ProtoObject* value);
+        };
+
+        void visitShapeSlot(ProtoContext* context, void* self, unsigned long key, ProtoObject* slot)
+        {
+            auto* visit = static_cast<ShapeVisit*>(self);
+            unsigned long index = slot->asInteger(context);
+            if (index >= visit->limit)
+                return;
+
+            ProtoObject* value = visit->object->implGetSlotValue(index);
+            if (value != PROTO_NONE)
+                visit->method(context, visit->self, key, value);
+        }
+
+        void collectAttribute(ProtoContext* context, void* self, unsigned long key, ProtoObject* value)
+        {
+            auto** attributes = static_cast<ProtoSparseListImplementation**>(self);
+            *attributes = (*attributes)->implSetAt(context, key, value);
+        }
+    }
+
+    void ProtoObjectCellImplementation::implProcessOwnAttributes(
+        ProtoContext* context,
+        void* self,
+        void (*method)(ProtoContext* context, void* self, unsigned long key, ProtoObject* value)
+    )
+    {
+        if (this->shape)
+        {
+            if (this->shape->slotIndex)
+            {
+                ShapeVisit visit = {this, this->flat ? this->ownCount : SHAPE_MAX_SLOTS, self, method};
+                this->shape->slotIndex->implProcessElements(context, &visit, visitShapeSlot);
+            }
+        }
+        else if (this->attributes)
+        {
+            this->attributes->implProcessElements(context, self, method);
+        }
+    }
+
+    void ProtoObjectCellImplementation::implProcessFlatAttributes(
+        ProtoContext* context,
+        void* self,
+        void (*method)(ProtoContext* context, void* self, unsigned long key, ProtoObject* value)
+    )
+    {
+        if (this->shape->slotIndex)
+        {
+            ShapeVisit visit = {this, SHAPE_MAX_SLOTS, self, method};
+            this->shape->slotIndex->implProcessElements(context, &visit, visitShapeSlot);
+        }
+    }
+
+    ProtoSparseListImplementation* ProtoObjectCellImplementation::implGetOwnAttributes(ProtoContext* context)
+    {
+        if (!this->shape && this->attributes)
+            return this->attributes;
+
+        auto* attributes = new(context) ProtoSparseListImplementation(context);
+        this->implProcessOwnAttributes(context, &attributes, collectAttribute);
+        return attributes;
+    }
+
+
+    ProtoObjectCellImplementation* ProtoObjectCellImplementation::implFreeze(ProtoContext* context)
+    {
+        // Primero los atributos propios y luego los heredados visibles, en el
+        // mismo orden en que los recorre processAttributes.
+        AttributeEntries own;
+        this->implProcessOwnAttributes(context, &own, collectEntry);
+
+        AttributeEntries visible;
+        this->implAsObject(context)->processAttributes(context, &visible, collectEntry);
+
+        ProtoObjectCellImplementation* frozenObject = nullptr;
+        if (visible.keys.size() <= SHAPE_MAX_SLOTS)
+        {
+            // Una forma exclusiva: ningún otro objeto comparte sus entradas de cache.
+            ObjectShape* shape = new(context) ObjectShape(context, nullptr, 0, nullptr);
+            for (auto key : visible.keys)
+                shape = shape->implAddKey(context, key);
+
+            auto* empty = new(context) ProtoObjectCellImplementation(context, this->parent, 0, shape);
+            frozenObject = empty->implSetOwnAttributes(
+                context, (unsigned int) visible.keys.size(), visible.keys.data(), visible.values.data());
+            frozenObject->flat = 1;
+            frozenObject->ownCount = own.keys.size();
+        }
+        else
+        {
+            frozenObject = this->implWithParent(context, this->parent, 0);
+        }
+
+        frozenObject->frozen = 1;
+        return frozenObject;
+    }
+
 
     // --- Métodos del Recolector de Basura (GC) ---
 
@@ -86,8 +538,30 @@ namespace proto
             method(context, self, this->parent);
         }
 
-        // 2. Procesar la referencia a la lista de atributos.
-        if (this->attributes)
+        // 2. Procesar la forma y los valores de los atributos.
+        if (this->shape)
+        {
+            method(context, self, this->shape);
+
+            for (auto* value : this->inlineValues)
+            {
+                if (value && value->isCell(context))
+                    method(context, self, value->asCell(context));
+            }
+
+            if (!this->spilled)
+            {
+                ProtoObject* value = this->lastInlineValue;
+                if (value && value->isCell(context))
+                    method(context, self, value->asCell(context));
+            }
+            else if (this->slots)
+            {
+                method(context, self, this->slots);
+            }
+        }
+        // 3. Procesar la referencia a la lista de atributos (modo diccionario).
+        else if (this->attributes)
         {
             method(context, self, this->attributes);
         }
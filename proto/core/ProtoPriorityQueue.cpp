@@ -0,0 +1,353 @@
+/*
+ * ProtoPriorityQueue.cpp
+ *
+ *  Created on: October, 2026
+ *      Author: gamarino
+ */
+
+#include "../headers/proto_internal.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace proto
+{
+    namespace
+    {
+        bool precedes(ProtoContext* context, ProtoPriorityQueueImplementation* a, ProtoPriorityQueueImplementation* b)
+        {
+            return protoCompareNumbers(context, a->key, b->key) <= 0;
+        }
+
+        HeapNode* newNode(
+            ProtoContext* context,
+            ProtoPriorityQueueImplementation* element,
+            unsigned long rank,
+            HeapNode* extras,
+            HeapNode* child,
+            HeapNode* sibling
+        )
+        {
+            return new(context) HeapNode(context, element, rank, extras, child, sibling);
+        }
+
+        // El mismo árbol en otra posición de una lista: se copia sólo la raíz,
+        // y sólo si cambia su hermano.
+        HeapNode* withSibling(ProtoContext* context, HeapNode* tree, HeapNode* sibling)
+        {
+            if (tree->sibling == sibling)
+                return tree;
+            return newNode(context, tree->element, tree->rank, tree->extras, tree->child, sibling);
+        }
+
+        // Enlace de dos árboles del mismo rango: la raíz mayor pasa a ser el
+        // primer hijo de la otra.
+        HeapNode* link(ProtoContext* context, HeapNode* a, HeapNode* b)
+        {
+            if (!precedes(context, a->element, b->element))
+                std::swap(a, b);
+            return newNode(context, a->element, a->rank + 1, a->extras, withSibling(context, b, a->child), nullptr);
+        }
+
+        // Enlace sesgado: dos árboles y un elemento suelto forman un árbol de
+        // rango mayor; el elemento que no queda en la raíz va a 'extras'.
+        HeapNode* skewLink(
+            ProtoContext* context,
+            ProtoPriorityQueueImplementation* element,
+            HeapNode* a,
+            HeapNode* b,
+            HeapNode* sibling
+        )
+        {
+            HeapNode* tree = link(context, a, b);
+            ProtoPriorityQueueImplementation* root = tree->element;
+            if (precedes(context, element, root))
+                std::swap(element, root);
+            return newNode(context, root, tree->rank,
+                           newNode(context, element, 0, nullptr, nullptr, tree->extras), tree->child, sibling);
+        }
+
+        // Inserción en O(1) peor caso: si los dos primeros árboles tienen el
+        // mismo rango se enlazan con el elemento; si no, el elemento es un árbol
+        // de rango 0 al frente de la lista.
+        HeapNode* insertElement(ProtoContext* context, ProtoPriorityQueueImplementation* element, HeapNode* trees)
+        {
+            if (trees && trees->sibling && trees->rank == trees->sibling->rank)
+                return skewLink(context, element, trees, trees->sibling, trees->sibling->sibling);
+            return newNode(context, element, 0, nullptr, nullptr, trees);
+        }
+
+        void toSequence(HeapNode* list, std::vector<HeapNode*>& trees)
+        {
+            for (; list; list = list->sibling)
+                trees.push_back(list);
+        }
+
+        HeapNode* fromSequence(ProtoContext* context, const std::vector<HeapNode*>& trees)
+        {
+            HeapNode* list = nullptr;
+            for (unsigned long i = trees.size(); i-- > 0;)
+                list = withSibling(context, trees[i], list);
+            return list;
+        }
+
+        // En una lista sesgada sólo los dos primeros árboles pueden compartir
+        // rango; se enlazan hasta que los rangos quedan estrictamente crecientes.
+        std::vector<HeapNode*> normalize(ProtoContext* context, const std::vector<HeapNode*>& trees)
+        {
+            std::vector<HeapNode*> result;
+            if (trees.empty())
+                return result;
+
+            HeapNode* first = trees[0];
+            unsigned long i = 1;
+            while (i < trees.size() && trees[i]->rank == first->rank)
+                first = link(context, first, trees[i++]);
+
+            result.push_back(first);
+            result.insert(result.end(), trees.begin() + i, trees.end());
+            return result;
+        }
+
+        // Suma con acarreo de dos listas de rangos estrictamente crecientes.
+        std::vector<HeapNode*> mergeSequences(
+            ProtoContext* context,
+            const std::vector<HeapNode*>& a,
+            const std::vector<HeapNode*>& b
+        )
+        {
+            std::vector<HeapNode*> result;
+            HeapNode* carry = nullptr;
+            unsigned long i = 0, j = 0;
+            while (i < a.size() || j < b.size() || carry)
+            {
+                unsigned long rank = carry ? carry->rank : ~0UL;
+                if (i < a.size())
+                    rank = std::min(rank, a[i]->rank);
+                if (j < b.size())
+                    rank = std::min(rank, b[j]->rank);
+
+                HeapNode* same[3];
+                int count = 0;
+                if (carry && carry->rank == rank)
+                {
+                    same[count++] = carry;
+                    carry = nullptr;
+                }
+                if (i < a.size() && a[i]->rank == rank)
+                    same[count++] = a[i++];
+                if (j < b.size() && b[j]->rank == rank)
+                    same[count++] = b[j++];
+
+                if (count != 2)
+                    result.push_back(same[0]);
+                if (count >= 2)
+                    carry = link(context, same[count - 2], same[count - 1]);
+            }
+            return result;
+        }
+
+        HeapNode* meldTrees(ProtoContext* context, HeapNode* a, HeapNode* b)
+        {
+            if (!a)
+                return b;
+            if (!b)
+                return a;
+
+            std::vector<HeapNode*> first, second;
+            toSequence(a, first);
+            toSequence(b, second);
+            return fromSequence(context, mergeSequences(context, normalize(context, first), normalize(context, second)));
+        }
+
+        // Quita el árbol de raíz mínima: sus hijos (en rango decreciente) se
+        // funden con el resto y sus elementos sueltos se vuelven a insertar.
+        // Todo es O(log n) peor caso, sin trabajo diferido.
+        HeapNode* removeMinElement(
+            ProtoContext* context,
+            HeapNode* trees,
+            ProtoPriorityQueueImplementation** minimum
+        )
+        {
+            std::vector<HeapNode*> roots;
+            toSequence(trees, roots);
+
+            unsigned long best = 0;
+            for (unsigned long i = 1; i < roots.size(); i++)
+                if (!precedes(context, roots[best]->element, roots[i]->element))
+                    best = i;
+
+            HeapNode* tree = roots[best];
+            roots.erase(roots.begin() + best);
+            *minimum = tree->element;
+
+            std::vector<HeapNode*> children;
+            toSequence(tree->child, children);
+            std::reverse(children.begin(), children.end());
+
+            HeapNode* result = fromSequence(
+                context, mergeSequences(context, normalize(context, roots), normalize(context, children)));
+            for (HeapNode* extra = tree->extras; extra; extra = extra->sibling)
+                result = insertElement(context, extra->element, result);
+            return result;
+        }
+    } // fin del namespace anónimo
+
+
+    // --- HeapNode ---
+
+    HeapNode::HeapNode(
+        ProtoContext* context,
+        ProtoPriorityQueueImplementation* element,
+        unsigned long rank,
+        HeapNode* extras,
+        HeapNode* child,
+        HeapNode* sibling
+    ) : Cell(context), element(element), rank(rank), extras(extras), child(child), sibling(sibling)
+    {
+    }
+
+    HeapNode::~HeapNode() = default;
+
+    unsigned long HeapNode::getHash(ProtoContext* context)
+    {
+        return Cell::getHash(context);
+    }
+
+    ProtoObject* HeapNode::asObject(ProtoContext* context)
+    {
+        return Cell::asObject(context);
+    }
+
+    void HeapNode::finalize(ProtoContext* context)
+    {
+    }
+
+    void HeapNode::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        method(context, self, this->element);
+        if (this->extras)
+            method(context, self, this->extras);
+        if (this->child)
+            method(context, self, this->child);
+        if (this->sibling)
+            method(context, self, this->sibling);
+    }
+
+
+    // --- ProtoPriorityQueueImplementation ---
+
+    ProtoPriorityQueueImplementation::ProtoPriorityQueueImplementation(
+        ProtoContext* context,
+        ProtoObject* key,
+        ProtoObject* value,
+        HeapNode* trees,
+        unsigned long size
+    ) : CollectionCell(context, COLLECTION_PRIORITY_QUEUE), key(key), value(value), trees(trees), size(size)
+    {
+    }
+
+    ProtoPriorityQueueImplementation::~ProtoPriorityQueueImplementation() = default;
+
+    ProtoPriorityQueueImplementation* ProtoPriorityQueueImplementation::implInsert(
+        ProtoContext* context,
+        ProtoObject* key,
+        ProtoObject* value
+    )
+    {
+        ProtoObjectPointer p{};
+        p.oid.oid = key;
+        if (p.op.pointer_tag != POINTER_TAG_EMBEDEDVALUE)
+            return nullptr;
+
+        return this->implMeld(context, new(context) ProtoPriorityQueueImplementation(context, key, value, nullptr, 1));
+    }
+
+    ProtoObject* ProtoPriorityQueueImplementation::implGetMinKey(ProtoContext* context)
+    {
+        return this->size ? this->key : PROTO_NONE;
+    }
+
+    ProtoObject* ProtoPriorityQueueImplementation::implGetMin(ProtoContext* context)
+    {
+        return this->size ? this->value : PROTO_NONE;
+    }
+
+    ProtoPriorityQueueImplementation* ProtoPriorityQueueImplementation::implRemoveMin(ProtoContext* context)
+    {
+        if (!this->size)
+            return this;
+        if (!this->trees)
+            return new(context) ProtoPriorityQueueImplementation(context);
+
+        // El nuevo mínimo es la raíz de la subcola menor; sus propias subcolas
+        // se funden con las que quedan.
+        ProtoPriorityQueueImplementation* minimum;
+        HeapNode* rest = removeMinElement(context, this->trees, &minimum);
+        return new(context) ProtoPriorityQueueImplementation(
+            context, minimum->key, minimum->value, meldTrees(context, minimum->trees, rest), this->size - 1);
+    }
+
+    ProtoPriorityQueueImplementation* ProtoPriorityQueueImplementation::implMeld(
+        ProtoContext* context,
+        ProtoPriorityQueueImplementation* other
+    )
+    {
+        if (!other->size)
+            return this;
+        if (!this->size)
+            return other;
+
+        // La cola de mínimo mayor entra entera, como un elemento, en el
+        // montículo de la otra: O(1) peor caso.
+        ProtoPriorityQueueImplementation* first = this;
+        ProtoPriorityQueueImplementation* second = other;
+        if (!precedes(context, first, second))
+            std::swap(first, second);
+        return new(context) ProtoPriorityQueueImplementation(
+            context, first->key, first->value, insertElement(context, second, first->trees), this->size + other->size);
+    }
+
+    unsigned long ProtoPriorityQueueImplementation::implGetSize(ProtoContext* context)
+    {
+        return this->size;
+    }
+
+    unsigned long ProtoPriorityQueueImplementation::getHash(ProtoContext* context)
+    {
+        return Cell::getHash(context);
+    }
+
+    ProtoObject* ProtoPriorityQueueImplementation::asObject(ProtoContext* context)
+    {
+        return this->implAsObject(context);
+    }
+
+    void ProtoPriorityQueueImplementation::finalize(ProtoContext* context)
+    {
+    }
+
+    void ProtoPriorityQueueImplementation::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        if (this->value && this->value->isCell(context))
+            method(context, self, this->value->asCell(context));
+        if (this->trees)
+            method(context, self, this->trees);
+    }
+} // namespace proto
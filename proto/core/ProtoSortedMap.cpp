@@ -0,0 +1,697 @@
+/*
+ * ProtoSortedMap.cpp
+ *
+ *  Created on: October, 2026
+ *      Author: gamarino
+ */
+
+#include "../headers/proto_internal.h"
+
+namespace proto
+{
+    namespace
+    {
+        // Orden entre valores de distinto tipo: primero la etiqueta y el tipo
+        // embebido, después los bits. Mantiene el orden total del mapa.
+        int compareRaw(ProtoObject* a, ProtoObject* b)
+        {
+            auto x = reinterpret_cast<unsigned long>(a);
+            auto y = reinterpret_cast<unsigned long>(b);
+            unsigned long xKind = x & 0xff, yKind = y & 0xff;
+            if (xKind != yKind)
+                return xKind < yKind ? -1 : 1;
+            return x < y ? -1 : (x > y ? 1 : 0);
+        }
+
+        template <typename T>
+        int compareValues(T x, T y)
+        {
+            return x < y ? -1 : (x > y ? 1 : 0);
+        }
+
+        bool isNumber(const ProtoObjectPointer& p)
+        {
+            return p.op.pointer_tag == POINTER_TAG_EMBEDEDVALUE &&
+                (p.op.embedded_type == EMBEDED_TYPE_SMALLINT || p.op.embedded_type == EMBEDED_TYPE_FLOAT);
+        }
+
+        double numberOf(ProtoContext* context, const ProtoObjectPointer& p)
+        {
+            if (p.op.embedded_type == EMBEDED_TYPE_SMALLINT)
+                return (double) p.si.smallInteger;
+            return (double) p.oid.oid->asFloat(context);
+        }
+    } // fin del namespace anónimo
+
+    int protoCompareNumbers(ProtoContext* context, ProtoObject* a, ProtoObject* b)
+    {
+        ProtoObjectPointer pa{}, pb{};
+        pa.oid.oid = a;
+        pb.oid.oid = b;
+        if (pa.op.pointer_tag == POINTER_TAG_EMBEDEDVALUE && pb.op.pointer_tag == POINTER_TAG_EMBEDEDVALUE &&
+            pa.op.embedded_type == pb.op.embedded_type)
+        {
+            switch (pa.op.embedded_type)
+            {
+            case EMBEDED_TYPE_SMALLINT:
+                return compareValues(pa.si.smallInteger, pb.si.smallInteger);
+            case EMBEDED_TYPE_TIMESTAMP:
+                return compareValues(pa.timestampValue.timestamp, pb.timestampValue.timestamp);
+            case EMBEDED_TYPE_TIMEDELTA:
+                return compareValues(pa.timedeltaValue.timedelta, pb.timedeltaValue.timedelta);
+            case EMBEDED_TYPE_DATE:
+                {
+                    int byDate = compareValues(
+                        (pa.date.year << 16) | (pa.date.month << 8) | pa.date.day,
+                        (pb.date.year << 16) | (pb.date.month << 8) | pb.date.day);
+                    return byDate;
+                }
+            case EMBEDED_TYPE_FLOAT:
+                break;
+            default:
+                return compareValues(pa.op.value, pb.op.value);
+            }
+        }
+
+        if (isNumber(pa) && isNumber(pb))
+        {
+            int byValue = compareValues(numberOf(context, pa), numberOf(context, pb));
+            // Los NaN no se ordenan por valor; quedan ordenados por sus bits.
+            if (byValue || numberOf(context, pa) == numberOf(context, pb))
+                return byValue;
+        }
+        return compareRaw(a, b);
+    }
+
+    namespace
+    {
+        inline int compareStringsInline(ProtoContext* context, ProtoObject* a, ProtoObject* b)
+        {
+            ProtoString* x = a->asString(context);
+            ProtoString* y = b->asString(context);
+            if (x && y)
+                return a == b ? 0 : toImpl<ProtoStringImplementation>(x)->implCmpToString(context, y);
+            return compareRaw(a, b);
+        }
+
+        // Los comparadores propios se reconocen por su dirección y se resuelven
+        // sin llamada indirecta.
+        inline int compareKeys(ProtoContext* context, ProtoCompareFunction compare, ProtoObject* a, ProtoObject* b)
+        {
+            if (compare == ProtoSortedMap::compareNumbers)
+                return protoCompareNumbers(context, a, b);
+            if (compare == ProtoSortedMap::compareStrings)
+                return compareStringsInline(context, a, b);
+            return compare(context, a, b);
+        }
+
+        // Subárbol de un nodo interior donde puede estar key.
+        unsigned long childIndex(ProtoContext* context, ProtoCompareFunction compare, SortedMapNode* node, ProtoObject* key)
+        {
+            unsigned long index = 0;
+            while (index + 1 < node->size && compareKeys(context, compare, key, node->slots.inner.keys[index]) >= 0)
+                index++;
+            return index;
+        }
+
+        SortedMapNode* newLeaf(ProtoContext* context, unsigned long size, ProtoObject* const* keys, ProtoObject* const* values)
+        {
+            return new(context) SortedMapNode(context, size, keys, values);
+        }
+
+        SortedMapNode* newInner(ProtoContext* context, unsigned long size, SortedMapNode* const* children, ProtoObject* const* keys)
+        {
+            return new(context) SortedMapNode(context, size, children, keys);
+        }
+
+        // Resultado de una inserción: el nodo nuevo o, si se dividió, dos nodos
+        // y la menor clave del segundo.
+        struct Insertion
+        {
+            SortedMapNode* left;
+            SortedMapNode* right;
+            ProtoObject* separator;
+        };
+
+        Insertion insertIn(
+            ProtoContext* context,
+            ProtoCompareFunction compare,
+            SortedMapNode* node,
+            ProtoObject* key,
+            ProtoObject* value
+        )
+        {
+            if (node->height == 0)
+            {
+                ProtoObject* keys[SORTED_MAP_LEAF_SIZE + 1];
+                ProtoObject* values[SORTED_MAP_LEAF_SIZE + 1];
+                unsigned long size = 0, i = 0;
+                for (; i < node->size; i++)
+                {
+                    int order = compareKeys(context, compare, node->slots.leaf.keys[i], key);
+                    if (order == 0)
+                    {
+                        // La clave ya estaba: se conserva la original y cambia el valor.
+                        if (node->slots.leaf.values[i] == value)
+                            return {node, nullptr, nullptr};
+                        ProtoObject* newValues[SORTED_MAP_LEAF_SIZE];
+                        for (unsigned long j = 0; j < node->size; j++)
+                            newValues[j] = j == i ? value : node->slots.leaf.values[j];
+                        return {newLeaf(context, node->size, node->slots.leaf.keys, newValues), nullptr, nullptr};
+                    }
+                    if (order > 0)
+                        break;
+                    keys[size] = node->slots.leaf.keys[i];
+                    values[size++] = node->slots.leaf.values[i];
+                }
+                keys[size] = key;
+                values[size++] = value;
+                for (; i < node->size; i++)
+                {
+                    keys[size] = node->slots.leaf.keys[i];
+                    values[size++] = node->slots.leaf.values[i];
+                }
+
+                if (size <= SORTED_MAP_LEAF_SIZE)
+                    return {newLeaf(context, size, keys, values), nullptr, nullptr};
+
+                // Al dividir, la hoja izquierda queda llena: las inserciones en
+                // orden creciente dejan todas las hojas completas.
+                return {
+                    newLeaf(context, SORTED_MAP_LEAF_SIZE, keys, values),
+                    newLeaf(context, size - SORTED_MAP_LEAF_SIZE, keys + SORTED_MAP_LEAF_SIZE, values + SORTED_MAP_LEAF_SIZE),
+                    keys[SORTED_MAP_LEAF_SIZE]
+                };
+            }
+
+            unsigned long index = childIndex(context, compare, node, key);
+            SortedMapNode* child = node->slots.inner.children[index];
+            Insertion inserted = insertIn(context, compare, child, key, value);
+            if (inserted.left == child)
+                return {node, nullptr, nullptr};
+
+            SortedMapNode* children[SORTED_MAP_FANOUT + 1];
+            ProtoObject* keys[SORTED_MAP_FANOUT];
+            unsigned long size = 0;
+            for (unsigned long i = 0; i < node->size; i++)
+            {
+                if (i > 0)
+                    keys[size - 1] = node->slots.inner.keys[i - 1];
+                if (i != index)
+                {
+                    children[size++] = node->slots.inner.children[i];
+                    continue;
+                }
+                children[size++] = inserted.left;
+                if (inserted.right)
+                {
+                    keys[size - 1] = inserted.separator;
+                    children[size++] = inserted.right;
+                }
+            }
+
+            if (size <= SORTED_MAP_FANOUT)
+                return {newInner(context, size, children, keys), nullptr, nullptr};
+
+            unsigned long half = size / 2;
+            return {
+                newInner(context, half, children, keys),
+                newInner(context, size - half, children + half, keys + half),
+                keys[half - 1]
+            };
+        }
+
+        bool underfull(SortedMapNode* node)
+        {
+            return node->height == 0 ? node->size == 0 : node->size < 2;
+        }
+
+        // Une un hijo que quedó por debajo del mínimo con su hermano. Devuelve
+        // uno o dos nodos en first/second, y en separator la clave entre ambos.
+        void mergeSiblings(
+            ProtoContext* context,
+            SortedMapNode* left,
+            ProtoObject* middle,
+            SortedMapNode* right,
+            SortedMapNode** first,
+            SortedMapNode** second,
+            ProtoObject** separator
+        )
+        {
+            if (left->height == 0)
+            {
+                ProtoObject* keys[SORTED_MAP_LEAF_SIZE * 2];
+                ProtoObject* values[SORTED_MAP_LEAF_SIZE * 2];
+                unsigned long size = 0;
+                for (SortedMapNode* leaf : {left, right})
+                {
+                    for (unsigned long i = 0; i < leaf->size; i++)
+                    {
+                        keys[size] = leaf->slots.leaf.keys[i];
+                        values[size++] = leaf->slots.leaf.values[i];
+                    }
+                }
+                *first = newLeaf(context, size, keys, values);
+                *second = nullptr;
+                return;
+            }
+
+            SortedMapNode* children[SORTED_MAP_FANOUT * 2];
+            ProtoObject* keys[SORTED_MAP_FANOUT * 2];
+            unsigned long size = 0;
+            for (SortedMapNode* inner : {left, right})
+            {
+                if (size)
+                    keys[size - 1] = middle;
+                for (unsigned long i = 0; i < inner->size; i++)
+                {
+                    if (i > 0)
+                        keys[size - 1] = inner->slots.inner.keys[i - 1];
+                    children[size++] = inner->slots.inner.children[i];
+                }
+            }
+
+            if (size <= SORTED_MAP_FANOUT)
+            {
+                *first = newInner(context, size, children, keys);
+                *second = nullptr;
+                return;
+            }
+
+            unsigned long half = size / 2;
+            *first = newInner(context, half, children, keys);
+            *second = newInner(context, size - half, children + half, keys + half);
+            *separator = keys[half - 1];
+        }
+
+        // Devuelve el subárbol sin key; puede quedar por debajo del mínimo, y
+        // entonces lo arregla el padre. Si key no está, devuelve node.
+        SortedMapNode* removeFrom(ProtoContext* context, ProtoCompareFunction compare, SortedMapNode* node, ProtoObject* key)
+        {
+            if (node->height == 0)
+            {
+                ProtoObject* keys[SORTED_MAP_LEAF_SIZE];
+                ProtoObject* values[SORTED_MAP_LEAF_SIZE];
+                unsigned long size = 0;
+                for (unsigned long i = 0; i < node->size; i++)
+                {
+                    if (compareKeys(context, compare, node->slots.leaf.keys[i], key) == 0)
+                        continue;
+                    keys[size] = node->slots.leaf.keys[i];
+                    values[size++] = node->slots.leaf.values[i];
+                }
+                return size == node->size ? node : newLeaf(context, size, keys, values);
+            }
+
+            unsigned long index = childIndex(context, compare, node, key);
+            SortedMapNode* child = node->slots.inner.children[index];
+            SortedMapNode* updated = removeFrom(context, compare, child, key);
+            if (updated == child)
+                return node;
+
+            SortedMapNode* children[SORTED_MAP_FANOUT];
+            ProtoObject* keys[SORTED_MAP_FANOUT - 1];
+            for (unsigned long i = 0; i < node->size; i++)
+            {
+                children[i] = i == index ? updated : node->slots.inner.children[i];
+                if (i + 1 < node->size)
+                    keys[i] = node->slots.inner.keys[i];
+            }
+
+            if (!underfull(updated))
+                return newInner(context, node->size, children, keys);
+
+            // Se une con el hermano izquierdo o, si es el primero, con el derecho.
+            unsigned long leftIndex = index > 0 ? index - 1 : index;
+            SortedMapNode *first, *second;
+            ProtoObject* separator = nullptr;
+            mergeSiblings(context, children[leftIndex], keys[leftIndex], children[leftIndex + 1],
+                          &first, &second, &separator);
+
+            SortedMapNode* merged[SORTED_MAP_FANOUT];
+            ProtoObject* mergedKeys[SORTED_MAP_FANOUT - 1];
+            unsigned long size = 0;
+            for (unsigned long i = 0; i < node->size; i++)
+            {
+                if (i == leftIndex + 1)
+                    continue;
+                if (size)
+                    mergedKeys[size - 1] = keys[i - 1];
+                if (i != leftIndex)
+                {
+                    merged[size++] = node->slots.inner.children[i];
+                    continue;
+                }
+                merged[size++] = first;
+                if (second)
+                {
+                    mergedKeys[size - 1] = separator;
+                    merged[size++] = second;
+                }
+            }
+            return newInner(context, size, merged, mergedKeys);
+        }
+
+        SortedMapNode* leafFor(ProtoContext* context, ProtoCompareFunction compare, SortedMapNode* node, ProtoObject* key)
+        {
+            while (node->height)
+                node = node->slots.inner.children[childIndex(context, compare, node, key)];
+            return node;
+        }
+
+        void processNode(
+            ProtoContext* context,
+            ProtoCompareFunction compare,
+            SortedMapNode* node,
+            ProtoObject* from,
+            ProtoObject* to,
+            void* self,
+            void (*method)(ProtoContext* context, void* self, ProtoObject* key, ProtoObject* value)
+        )
+        {
+            if (node->height == 0)
+            {
+                for (unsigned long i = 0; i < node->size; i++)
+                {
+                    ProtoObject* key = node->slots.leaf.keys[i];
+                    if ((from == PROTO_NONE || compareKeys(context, compare, key, from) >= 0) &&
+                        (to == PROTO_NONE || compareKeys(context, compare, key, to) < 0))
+                        method(context, self, key, node->slots.leaf.values[i]);
+                }
+                return;
+            }
+
+            unsigned long first = from == PROTO_NONE ? 0 : childIndex(context, compare, node, from);
+            unsigned long last = to == PROTO_NONE ? node->size - 1 : childIndex(context, compare, node, to);
+            for (unsigned long i = first; i <= last; i++)
+                processNode(context, compare, node->slots.inner.children[i], from, to, self, method);
+        }
+    } // fin del namespace anónimo
+
+
+    // --- ProtoSortedMap (comparadores) ---
+
+    int ProtoSortedMap::compareNumbers(ProtoContext* context, ProtoObject* a, ProtoObject* b)
+    {
+        return protoCompareNumbers(context, a, b);
+    }
+
+    int ProtoSortedMap::compareStrings(ProtoContext* context, ProtoObject* a, ProtoObject* b)
+    {
+        return compareStringsInline(context, a, b);
+    }
+
+
+    // --- SortedMapNode ---
+
+    SortedMapNode::SortedMapNode(
+        ProtoContext* context,
+        unsigned long size,
+        ProtoObject* const* keys,
+        ProtoObject* const* values
+    ) : Cell(context), count(size), size(size), height(0)
+    {
+        for (unsigned long i = 0; i < SORTED_MAP_LEAF_SIZE; i++)
+        {
+            this->slots.leaf.keys[i] = i < size ? keys[i] : PROTO_NONE;
+            this->slots.leaf.values[i] = i < size ? values[i] : PROTO_NONE;
+        }
+    }
+
+    SortedMapNode::SortedMapNode(
+        ProtoContext* context,
+        unsigned long size,
+        SortedMapNode* const* children,
+        ProtoObject* const* keys
+    ) : Cell(context), count(0), size(size), height(children[0]->height + 1)
+    {
+        unsigned long count = 0;
+        for (unsigned long i = 0; i < SORTED_MAP_FANOUT; i++)
+        {
+            this->slots.inner.children[i] = i < size ? children[i] : nullptr;
+            if (i < size)
+                count += children[i]->count;
+            if (i + 1 < SORTED_MAP_FANOUT)
+                this->slots.inner.keys[i] = i + 1 < size ? keys[i] : PROTO_NONE;
+        }
+        this->count = count;
+    }
+
+    SortedMapNode::~SortedMapNode() = default;
+
+    unsigned long SortedMapNode::getHash(ProtoContext* context)
+    {
+        return Cell::getHash(context);
+    }
+
+    ProtoObject* SortedMapNode::asObject(ProtoContext* context)
+    {
+        return Cell::asObject(context);
+    }
+
+    void SortedMapNode::finalize(ProtoContext* context)
+    {
+    }
+
+    void SortedMapNode::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        if (this->height)
+        {
+            for (unsigned long i = 0; i < this->size; i++)
+                method(context, self, this->slots.inner.children[i]);
+            for (unsigned long i = 0; i + 1 < this->size; i++)
+            {
+                ProtoObject* key = this->slots.inner.keys[i];
+                if (key && key->isCell(context))
+                    method(context, self, key->asCell(context));
+            }
+            return;
+        }
+
+        for (unsigned long i = 0; i < this->size; i++)
+        {
+            for (ProtoObject* value : {this->slots.leaf.keys[i], this->slots.leaf.values[i]})
+            {
+                if (value && value->isCell(context))
+                    method(context, self, value->asCell(context));
+            }
+        }
+    }
+
+
+    // --- ProtoSortedMapImplementation ---
+
+    ProtoSortedMapImplementation::ProtoSortedMapImplementation(
+        ProtoContext* context,
+        ProtoCompareFunction compare,
+        SortedMapNode* root
+    ) : CollectionCell(context, COLLECTION_SORTED_MAP),
+        root(root ? root : newLeaf(context, 0, nullptr, nullptr)),
+        compare(compare ? compare : ProtoSortedMap::compareNumbers)
+    {
+    }
+
+    ProtoSortedMapImplementation::~ProtoSortedMapImplementation() = default;
+
+    ProtoSortedMapImplementation* ProtoSortedMapImplementation::implFromArray(
+        ProtoContext* context,
+        ProtoCompareFunction compare,
+        ProtoObject* const* keys,
+        ProtoObject* const* values,
+        unsigned long count
+    )
+    {
+        if (!compare)
+            compare = ProtoSortedMap::compareNumbers;
+        for (unsigned long i = 1; i < count; i++)
+        {
+            if (compareKeys(context, compare, keys[i - 1], keys[i]) >= 0)
+                return nullptr;
+        }
+        if (!count)
+            return new(context) ProtoSortedMapImplementation(context, compare);
+
+        // Hojas llenas de izquierda a derecha; cada nivel agrupa de a tres
+        // nodos, salvo el final, que se reparte en dos grupos de dos si
+        // quedaría uno solo. Junto a cada nodo se guarda su menor clave.
+        std::vector<SortedMapNode*> level;
+        std::vector<ProtoObject*> lowest;
+        for (unsigned long i = 0; i < count; i += SORTED_MAP_LEAF_SIZE)
+        {
+            unsigned long size = std::min((unsigned long) SORTED_MAP_LEAF_SIZE, count - i);
+            level.push_back(newLeaf(context, size, keys + i, values + i));
+            lowest.push_back(keys[i]);
+        }
+
+        while (level.size() > 1)
+        {
+            std::vector<SortedMapNode*> parents;
+            std::vector<ProtoObject*> parentLowest;
+            unsigned long i = 0;
+            while (i < level.size())
+            {
+                unsigned long remaining = level.size() - i;
+                unsigned long size = remaining == 4 ? 2 : std::min(remaining, (unsigned long) SORTED_MAP_FANOUT);
+                parents.push_back(newInner(context, size, &level[i], &lowest[i + 1]));
+                parentLowest.push_back(lowest[i]);
+                i += size;
+            }
+            level.swap(parents);
+            lowest.swap(parentLowest);
+        }
+
+        return new(context) ProtoSortedMapImplementation(context, compare, level[0]);
+    }
+
+    ProtoObject* ProtoSortedMapImplementation::implGetAt(ProtoContext* context, ProtoObject* key)
+    {
+        SortedMapNode* leaf = leafFor(context, this->compare, this->root, key);
+        for (unsigned long i = 0; i < leaf->size; i++)
+        {
+            if (compareKeys(context, this->compare, leaf->slots.leaf.keys[i], key) == 0)
+                return leaf->slots.leaf.values[i];
+        }
+        return PROTO_NONE;
+    }
+
+    ProtoSortedMapImplementation* ProtoSortedMapImplementation::implSetAt(
+        ProtoContext* context,
+        ProtoObject* key,
+        ProtoObject* value
+    )
+    {
+        if (value == PROTO_NONE)
+            return this->implRemoveAt(context, key);
+
+        Insertion inserted = insertIn(context, this->compare, this->root, key, value);
+        if (inserted.left == this->root)
+            return this;
+
+        SortedMapNode* root = inserted.left;
+        if (inserted.right)
+        {
+            SortedMapNode* children[2] = {inserted.left, inserted.right};
+            root = newInner(context, 2, children, &inserted.separator);
+        }
+        return new(context) ProtoSortedMapImplementation(context, this->compare, root);
+    }
+
+    ProtoSortedMapImplementation* ProtoSortedMapImplementation::implRemoveAt(ProtoContext* context, ProtoObject* key)
+    {
+        SortedMapNode* root = removeFrom(context, this->compare, this->root, key);
+        if (root == this->root)
+            return this;
+
+        // Una raíz interior con un solo hijo se reemplaza por ese hijo.
+        while (root->height && root->size == 1)
+            root = root->slots.inner.children[0];
+        return new(context) ProtoSortedMapImplementation(context, this->compare, root);
+    }
+
+    unsigned long ProtoSortedMapImplementation::implGetSize(ProtoContext* context)
+    {
+        return this->root->count;
+    }
+
+    unsigned long ProtoSortedMapImplementation::implRank(ProtoContext* context, ProtoObject* key, bool inclusive)
+    {
+        unsigned long rank = 0;
+        SortedMapNode* node = this->root;
+        while (node->height)
+        {
+            unsigned long index = childIndex(context, this->compare, node, key);
+            for (unsigned long i = 0; i < index; i++)
+                rank += node->slots.inner.children[i]->count;
+            node = node->slots.inner.children[index];
+        }
+        for (unsigned long i = 0; i < node->size; i++)
+        {
+            int order = compareKeys(context, this->compare, node->slots.leaf.keys[i], key);
+            if (order < 0 || (inclusive && order == 0))
+                rank++;
+        }
+        return rank;
+    }
+
+    ProtoObject* ProtoSortedMapImplementation::implKeyAt(ProtoContext* context, unsigned long index, bool value)
+    {
+        if (index >= this->root->count)
+            return PROTO_NONE;
+
+        SortedMapNode* node = this->root;
+        while (node->height)
+        {
+            unsigned long i = 0;
+            while (index >= node->slots.inner.children[i]->count)
+                index -= node->slots.inner.children[i++]->count;
+            node = node->slots.inner.children[i];
+        }
+        return value ? node->slots.leaf.values[index] : node->slots.leaf.keys[index];
+    }
+
+    ProtoObject* ProtoSortedMapImplementation::implFloor(ProtoContext* context, ProtoObject* key)
+    {
+        unsigned long rank = this->implRank(context, key, true);
+        return rank ? this->implKeyAt(context, rank - 1, false) : PROTO_NONE;
+    }
+
+    ProtoObject* ProtoSortedMapImplementation::implCeiling(ProtoContext* context, ProtoObject* key)
+    {
+        return this->implKeyAt(context, this->implRank(context, key, false), false);
+    }
+
+    unsigned long ProtoSortedMapImplementation::implCountRange(ProtoContext* context, ProtoObject* from, ProtoObject* to)
+    {
+        unsigned long low = from == PROTO_NONE ? 0 : this->implRank(context, from, false);
+        unsigned long high = to == PROTO_NONE ? this->root->count : this->implRank(context, to, false);
+        return high > low ? high - low : 0;
+    }
+
+    void ProtoSortedMapImplementation::implProcessRange(
+        ProtoContext* context,
+        ProtoObject* from,
+        ProtoObject* to,
+        void* self,
+        void (*method)(ProtoContext* context, void* self, ProtoObject* key, ProtoObject* value)
+    )
+    {
+        if (from != PROTO_NONE && to != PROTO_NONE && compareKeys(context, this->compare, from, to) >= 0)
+            return;
+        processNode(context, this->compare, this->root, from, to, self, method);
+    }
+
+    unsigned long ProtoSortedMapImplementation::getHash(ProtoContext* context)
+    {
+        return Cell::getHash(context);
+    }
+
+    ProtoObject* ProtoSortedMapImplementation::asObject(ProtoContext* context)
+    {
+        return this->implAsObject(context);
+    }
+
+    void ProtoSortedMapImplementation::finalize(ProtoContext* context)
+    {
+    }
+
+    void ProtoSortedMapImplementation::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        method(context, self, this->root);
+    }
+} // namespace proto
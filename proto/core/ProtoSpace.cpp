@@ -12,6 +12,8 @@
 #include <thread>
 #include <chrono>
 #include <functional>
+#include <algorithm>
+#include <vector>
 #include <condition_variable>
 
 using namespace std;
@@ -31,11 +33,16 @@ namespace proto
 
     std::mutex ProtoSpace::globalMutex;
 
+    // Las celdas de la región inmortal (arranque, makeImmortal y objetos
+    // congelados) no se recorren ni se liberan.
     void gcCollectCells(ProtoContext* context, void* self, Cell* value)
     {
         ProtoObjectPointer p;
         p.oid.oid = (ProtoObject*)value;
 
+        if (value->isImmortal())
+            return;
+
         ProtoSparseListImplementation* cellSet = new(context) ProtoSparseListImplementation(context);
 
         // Go further in the scanning only if it is a cell and the cell belongs to current context!
@@ -55,6 +62,9 @@ namespace proto
         ProtoObjectPointer p;
         p.oid.oid = (ProtoObject*)value;
 
+        if (p.op.pointer_tag != POINTER_TAG_EMBEDEDVALUE && value->asCell(context)->isImmortal())
+            return;
+
         ProtoSparseListImplementation* cellSet = new(context) ProtoSparseListImplementation(context);
 
         // Go further in the scanning only if it is a cell and the cell belongs to current context!
@@ -69,6 +79,18 @@ namespace proto
         }
     }
 
+    void gcCollectRemembered(ProtoContext* context, void* self, unsigned long key, ProtoObject* value)
+    {
+        gcCollectCells(context, self, reinterpret_cast<Cell*>(key));
+    }
+
+    // De una celda inmortal que cambió se recorren sus campos actuales, no
+    // todo lo que alguna vez guardó.
+    void gcCollectOwnerFields(ProtoContext* context, void* self, unsigned long key, ProtoObject* value)
+    {
+        reinterpret_cast<Cell*>(key)->processReferences(context, self, gcCollectCells);
+    }
+
     void gcScan(ProtoContext* context, ProtoSpace* space)
     {
         DirtySegment* toAnalize;
@@ -146,11 +168,31 @@ namespace proto
         ProtoSparseListImplementation* cellSet = new(context) ProtoSparseListImplementation(context);
 
         // Add all mutables to cellSet
-        ((ProtoSparseList*)space->mutableRoot.load())->processValues(
-            &gcContext,
-            &cellSet,
-            gcCollectObjects
-        );
+        unsigned long shardCount = std::min(
+            space->mutableShardCount.load(), (unsigned long) PROTO_MUTABLE_PAGE_SIZE * PROTO_MUTABLE_MAX_PAGES);
+        for (unsigned long shard = 0; shard < shardCount; shard++)
+        {
+            // Un bloque recién reservado puede no estar publicado todavía.
+            MutablePage* page = space->mutablePages[shard / PROTO_MUTABLE_PAGE_SIZE].load();
+            MutableShard* mutables = page ? page->shards[shard % PROTO_MUTABLE_PAGE_SIZE].load() : nullptr;
+            if (!mutables)
+                continue;
+
+            for (auto& value : mutables->values)
+            {
+                ProtoObject* current = value.load();
+                if (current)
+                    gcCollectObjects(&gcContext, &cellSet, current);
+            }
+        }
+
+        // The immortal region is not traced: only the cells it references
+        // (its remembered set) are roots, along with the set itself, plus the
+        // current fields of the immortal cells written after it was built.
+        gcCollectObjects(&gcContext, &cellSet, space->rememberedCells.load()->asObject(&gcContext));
+        space->rememberedCells.load()->processElements(&gcContext, &cellSet, gcCollectRemembered);
+        gcCollectObjects(&gcContext, &cellSet, space->rememberedOwners.load()->asObject(&gcContext));
+        space->rememberedOwners.load()->processElements(&gcContext, &cellSet, gcCollectOwnerFields);
 
         // Collect all roots from thread stacks
 
@@ -176,7 +218,7 @@ namespace proto
                         );
                     }
 
-                    currentCell = currentCell->nextCell;
+                    currentCell = currentCell->getNextCell();
                 }
 
                 if (currentContext->localsBase)
@@ -220,9 +262,9 @@ namespace proto
 
             while (block)
             {
-                Cell* nextCell = block->nextCell;
+                Cell* nextCell = block->getNextCell();
 
-                if (!cellSet->implHas(&gcContext, block->getHash(context)))
+                if (!cellSet->implHas(&gcContext, block->getHash(context)) && !block->isImmortal())
                 {
                     block->~Cell();
 
@@ -299,6 +341,7 @@ namespace proto
         );
         this->threads = creationContext->newSparseList();
         this->tupleRoot = new(creationContext) TupleDictionary(creationContext, nullptr, nullptr, nullptr);
+        this->rootShape = new(creationContext) ObjectShape(creationContext, nullptr, 0, nullptr);
 
         ProtoList* mainParameters = creationContext->newList();
         mainParameters = (ProtoList*)mainParameters->appendLast(
@@ -323,7 +366,15 @@ namespace proto
         this->mutableLock.store(false);
         this->threadsLock.store(false);
         this->gcLock.store(false);
-        this->mutableRoot.store(new(creationContext) ProtoSparseListImplementation(creationContext));
+        for (auto& page : this->mutablePages)
+            page.store(nullptr);
+        this->mutableShardCount.store(0);
+        this->immortalCells.store(0);
+        this->rememberedCells.store(creationContext->newUnorderedSparseList());
+        this->rememberedOwners.store(creationContext->newUnorderedSparseList());
+
+        // Todo lo creado hasta aquí vive lo mismo que el espacio.
+        this->makeImmortal(creationContext);
 
         this->maxAllocatedCellsPerContext = MAX_ALLOCATED_CELLS_PER_CONTEXT;
         this->blocksPerAllocation = BLOCKS_PER_ALLOCATION;
@@ -360,6 +411,16 @@ namespace proto
 
         mainThread->join(creationContext);
         this->gcThread->join();
+
+        for (auto& page : this->mutablePages)
+        {
+            MutablePage* mutables = page.load();
+            if (!mutables)
+                continue;
+            for (auto& shard : mutables->shards)
+                delete shard.load();
+            delete mutables;
+        }
     };
 
     void scanThreads(ProtoContext* context, void* self, ProtoObject* value)
@@ -392,6 +453,98 @@ namespace proto
         this->gcThread->join();
     };
 
+    namespace
+    {
+        void pinReference(ProtoContext* context, void* self, Cell* cell)
+        {
+            static_cast<std::vector<Cell*>*>(self)->push_back(cell);
+        }
+
+        // Agrega las celdas a uno de los conjuntos del espacio (indexado por dirección).
+        void addCellsToSet(ProtoContext* context, std::atomic<ProtoSparseList*>& set, const std::vector<Cell*>& cells)
+        {
+            ProtoSparseList* current = set.load();
+            ProtoSparseList* updated;
+            do
+            {
+                updated = current;
+                for (auto* cell : cells)
+                    updated = updated->setAt(context, reinterpret_cast<unsigned long>(cell), PROTO_TRUE);
+            }
+            while (!set.compare_exchange_weak(current, updated));
+        }
+    }
+
+    void ProtoSpace::pinCells(ProtoContext* context, unsigned long count, Cell** cells)
+    {
+        // Primero se marcan todas, así las referencias entre ellas no se
+        // recuerdan. La marca es un bit de la propia celda: el GC la consulta
+        // con una carga por celda trazada o barrida.
+        unsigned long marked = 0;
+        for (unsigned long i = 0; i < count; i++)
+        {
+            if (!cells[i]->isImmortal())
+            {
+                cells[i]->markImmortal();
+                marked++;
+            }
+        }
+
+        if (!marked)
+            return;
+        this->immortalCells.fetch_add(marked);
+
+        // Sólo las referencias que salen de la región se recuerdan: son las
+        // raíces que el GC necesita, y la región no se vuelve a trazar.
+        std::vector<Cell*> references;
+        for (unsigned long i = 0; i < count; i++)
+            cells[i]->processReferences(context, &references, pinReference);
+
+        std::vector<Cell*> remembered;
+        for (auto* cell : references)
+        {
+            if (!cell->isImmortal())
+                remembered.push_back(cell);
+        }
+
+        if (!remembered.empty())
+            addCellsToSet(context, this->rememberedCells, remembered);
+    }
+
+    void ProtoSpace::makeImmortal(ProtoContext* context)
+    {
+        // Las celdas salen de la cadena del contexto, así que nunca llegan a un
+        // segmento sucio ni al barrido.
+        std::vector<Cell*> cells;
+        for (Cell* cell = context->lastAllocatedCell; cell; cell = cell->getNextCell())
+            cells.push_back(cell);
+
+        context->lastAllocatedCell = nullptr;
+        context->allocatedCellsCount = 0;
+
+        // Una celda ya inmortal (congelada en este contexto) conserva su marca.
+        for (auto* cell : cells)
+        {
+            bool immortal = cell->isImmortal();
+            cell->nextCell = nullptr;
+            if (immortal)
+                cell->markImmortal();
+        }
+
+        this->pinCells(context, cells.size(), cells.data());
+    }
+
+    void ProtoSpace::rememberReference(ProtoContext* context, Cell* owner, Cell* target)
+    {
+        // Los campos atómicos de una celda inmortal (transiciones de formas,
+        // caches de los eslabones) cambian después de recorrida la región. Se
+        // recuerda el dueño una sola vez: el conjunto no crece con cada
+        // escritura y un valor reemplazado deja de ser raíz.
+        if (target && !target->isImmortal() && owner->isImmortal() &&
+            !this->rememberedOwners.load()->has(context, reinterpret_cast<unsigned long>(owner)))
+            addCellsToSet(context, this->rememberedOwners, {owner});
+    }
+
     void ProtoSpace::triggerGC()
     {
         this->gcCV.notify_all();
@@ -418,6 +571,10 @@ namespace proto
 
     void ProtoSpace::deallocThread(ProtoContext* context, ProtoThread* thread)
     {
+        // Se llama desde el hilo que termina: lo que no usó de su bloque de
+        // objetos mutables queda para otro hilo.
+        release_mutable_block(this);
+
         bool oldValue = false;
         while (this->threadsLock.compare_exchange_strong(
             oldValue,
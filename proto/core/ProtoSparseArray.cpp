@@ -0,0 +1,258 @@
+/*
+ * ProtoSparseArray.cpp
+ *
+ *  Created on: October, 2026
+ *      Author: gamarino
+ */
+
+#include "../headers/proto_internal.h"
+
+namespace proto
+{
+    namespace
+    {
+        unsigned long entryHash(ProtoContext* context, unsigned long key, ProtoObject* value)
+        {
+            return key ^ value->getHash(context);
+        }
+
+        // Cantidad de posiciones que direcciona un vector de la altura dada.
+        unsigned long slotsCapacity(unsigned long height)
+        {
+            unsigned long capacity = SLOTS_SIZE;
+            while (height--)
+                capacity *= SLOTS_SIZE;
+            return capacity;
+        }
+
+        // Recorre en orden las posiciones ocupadas de [start, span) bajo node.
+        template <typename Visit>
+        void visitSlots(AttributeSlots* node, unsigned long start, unsigned long capacity,
+                        unsigned long span, Visit& visit)
+        {
+            if (!node || start >= span)
+                return;
+
+            if (node->height == 0)
+            {
+                for (unsigned long i = 0; i < SLOTS_SIZE && start + i < span; i++)
+                {
+                    if (node->pointers.values[i] != PROTO_NONE)
+                        visit(start + i, node->pointers.values[i]);
+                }
+                return;
+            }
+
+            unsigned long childCapacity = capacity / SLOTS_SIZE;
+            for (unsigned long i = 0; i < SLOTS_SIZE; i++)
+                visitSlots(node->pointers.children[i], start + i * childCapacity, childCapacity, span, visit);
+        }
+
+        struct DenseBuild
+        {
+            unsigned long base;
+            ProtoObject** values;
+        };
+
+        void addToDense(ProtoContext* context, void* self, unsigned long index, ProtoObject* value)
+        {
+            auto* build = static_cast<DenseBuild*>(self);
+            build->values[index - build->base] = value;
+        }
+    } // fin del namespace anónimo
+
+    ProtoSparseArrayImplementation::ProtoSparseArrayImplementation(
+        ProtoContext* context,
+        unsigned long base,
+        unsigned long start,
+        unsigned long span,
+        AttributeSlots* slots,
+        unsigned long count,
+        unsigned long hash
+    ) : SparseListCell(context, SPARSE_LIST_ARRAY), base(base), start(start), span(span), slots(slots)
+    {
+        this->count = count;
+        this->hash = hash;
+    }
+
+    ProtoSparseArrayImplementation::~ProtoSparseArrayImplementation() = default;
+
+    SparseListCell* ProtoSparseArrayImplementation::implFromTree(
+        ProtoContext* context,
+        ProtoSparseListImplementation* tree
+    )
+    {
+        unsigned long first, last;
+        if (tree->count < SPARSE_ARRAY_MIN_SIZE ||
+            !tree->implFirstKey(context, &first) || !tree->implLastKey(context, &last) ||
+            last - first >= SPARSE_ARRAY_DENSITY * tree->count)
+            return tree;
+
+        unsigned long span = last - first + 1;
+        std::vector<ProtoObject*> values(span, PROTO_NONE);
+        DenseBuild build{first, values.data()};
+        tree->implProcessElements(context, &build, addToDense);
+
+        // El árbol puede guardar claves con valor NONE; el vector no las cuenta.
+        unsigned long count = 0, hash = 0;
+        for (unsigned long i = 0; i < span; i++)
+        {
+            if (values[i] != PROTO_NONE)
+            {
+                count++;
+                hash ^= entryHash(context, first + i, values[i]);
+            }
+        }
+        if (count < SPARSE_ARRAY_MIN_SIZE || span > SPARSE_ARRAY_DENSITY * count)
+            return tree;
+
+        return new(context) ProtoSparseArrayImplementation(
+            context, first, 0, span, AttributeSlots::implFromArray(context, span, values.data()), count, hash);
+    }
+
+    SparseListCell* ProtoSparseArrayImplementation::implAdapt(ProtoContext* context, SparseListCell* list)
+    {
+        if (list->type != SPARSE_LIST_TREE || (list->count & (list->count - 1)))
+            return list;
+        return implFromTree(context, static_cast<ProtoSparseListImplementation*>(list));
+    }
+
+    bool ProtoSparseArrayImplementation::implHas(ProtoContext* context, unsigned long index)
+    {
+        return this->implGetAt(context, index) != PROTO_NONE;
+    }
+
+    ProtoObject* ProtoSparseArrayImplementation::implGetAt(ProtoContext* context, unsigned long index)
+    {
+        if (index < this->base || index - this->base >= this->span)
+            return PROTO_NONE;
+        return AttributeSlots::implGetAt(this->slots, index - this->base);
+    }
+
+    SparseListCell* ProtoSparseArrayImplementation::implSetAt(
+        ProtoContext* context,
+        unsigned long index,
+        ProtoObject* value
+    )
+    {
+        if (value == PROTO_NONE)
+            return this->implRemoveAt(context, index);
+
+        if (index >= this->base)
+        {
+            unsigned long offset = index - this->base;
+            ProtoObject* current = offset < this->span
+                                       ? AttributeSlots::implGetAt(this->slots, offset)
+                                       : PROTO_NONE;
+            if (current == value)
+                return this;
+
+            unsigned long count = this->count + (current == PROTO_NONE ? 1 : 0);
+            unsigned long start = std::min(this->start, offset);
+            unsigned long span = std::max(this->span, offset + 1);
+            if (span - start <= SPARSE_ARRAY_DENSITY * count)
+            {
+                unsigned long hash = this->hash ^ entryHash(context, index, value);
+                if (current != PROTO_NONE)
+                    hash ^= entryHash(context, index, current);
+
+                return new(context) ProtoSparseArrayImplementation(
+                    context,
+                    this->base,
+                    start,
+                    span,
+                    AttributeSlots::implSetAt(context, this->slots, offset, value),
+                    count,
+                    hash
+                );
+            }
+        }
+
+        // La clave rompe la densidad: la lista vuelve al árbol.
+        return this->implAsTree(context)->implSetAt(context, index, value);
+    }
+
+    SparseListCell* ProtoSparseArrayImplementation::implRemoveAt(ProtoContext* context, unsigned long index)
+    {
+        ProtoObject* current = this->implGetAt(context, index);
+        if (current == PROTO_NONE)
+            return this;
+
+        if (this->count == 1)
+            return new(context) ProtoSparseListImplementation(context);
+
+        AttributeSlots* slots = AttributeSlots::implSetAt(context, this->slots, index - this->base, PROTO_NONE);
+
+        // Quitar la primera o la última clave acorta el rango; queda al menos un elemento.
+        unsigned long start = this->start, span = this->span;
+        while (AttributeSlots::implGetAt(slots, span - 1) == PROTO_NONE)
+            span--;
+        while (AttributeSlots::implGetAt(slots, start) == PROTO_NONE)
+            start++;
+
+        unsigned long count = this->count - 1;
+        if (span - start > SPARSE_ARRAY_DENSITY * count)
+            return this->implAsTree(context)->implRemoveAt(context, index);
+
+        unsigned long hash = this->hash ^ entryHash(context, index, current);
+        if (start <= span - start)
+            return new(context) ProtoSparseArrayImplementation(context, this->base, start, span, slots, count, hash);
+
+        // El prefijo vacío ya supera al rango ocupado: el vector se reconstruye
+        // desde la primera clave. Cada reconstrucción cuesta lo que las bajas
+        // que la hicieron necesaria.
+        std::vector<ProtoObject*> values(span - start, PROTO_NONE);
+        auto collect = [&](unsigned long offset, ProtoObject* value)
+        {
+            values[offset - start] = value;
+        };
+        visitSlots(slots, 0, slotsCapacity(slots->height), span, collect);
+        return new(context) ProtoSparseArrayImplementation(
+            context, this->base + start, 0, span - start,
+            AttributeSlots::implFromArray(context, span - start, values.data()), count, hash);
+    }
+
+    void ProtoSparseArrayImplementation::implProcessElements(
+        ProtoContext* context,
+        void* self,
+        void (*method)(ProtoContext* context, void* self, unsigned long index, ProtoObject* value)
+    )
+    {
+        auto visit = [&](unsigned long offset, ProtoObject* value)
+        {
+            method(context, self, this->base + offset, value);
+        };
+        visitSlots(this->slots, 0, slotsCapacity(this->slots->height), this->span, visit);
+    }
+
+    void ProtoSparseArrayImplementation::implProcessValues(
+        ProtoContext* context,
+        void* self,
+        void (*method)(ProtoContext* context, void* self, ProtoObject* value)
+    )
+    {
+        auto visit = [&](unsigned long, ProtoObject* value)
+        {
+            method(context, self, value);
+        };
+        visitSlots(this->slots, 0, slotsCapacity(this->slots->height), this->span, visit);
+    }
+
+    void ProtoSparseArrayImplementation::finalize(ProtoContext* context)
+    {
+    }
+
+    void ProtoSparseArrayImplementation::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        if (this->slots)
+            method(context, self, this->slots);
+    }
+} // namespace proto
@@ -0,0 +1,482 @@
+/*
+ * ProtoSparseHash.cpp
+ *
+ *  Created on: October, 2026
+ *      Author: gamarino
+ */
+
+#include "../headers/proto_internal.h"
+
+#include <bit>
+
+namespace proto
+{
+    namespace
+    {
+        // Mezcla biyectiva de la clave (finalizador de splitmix64). Las claves
+        // suelen ser direcciones o hashes con los bits bajos repetidos; mezclarlas
+        // reparte los nodos sin perder la garantía de que dos claves distintas se
+        // separan antes de agotar los 64 bits.
+        unsigned long mixKey(unsigned long key)
+        {
+            key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9UL;
+            key = (key ^ (key >> 27)) * 0x94d049bb133111ebUL;
+            return key ^ (key >> 31);
+        }
+
+        unsigned long digitAt(unsigned long mixed, unsigned long level)
+        {
+            return (mixed >> (level * SPARSE_HASH_BITS)) & (SPARSE_HASH_FANOUT - 1);
+        }
+
+        unsigned long tagOf(unsigned long node)
+        {
+            return node & SPARSE_HASH_TAG_MASK;
+        }
+
+        template <typename T>
+        T* untag(unsigned long node)
+        {
+            return reinterpret_cast<T*>(node & ~static_cast<unsigned long>(SPARSE_HASH_TAG_MASK));
+        }
+
+        unsigned long tagged(Cell* cell, unsigned long tag)
+        {
+            return reinterpret_cast<unsigned long>(cell) | tag;
+        }
+
+        unsigned long newLeaf(ProtoContext* context, unsigned long key, ProtoObject* value)
+        {
+            return tagged(new(context) SparseHashLeaf(context, key, value), SPARSE_HASH_TAG_LEAF);
+        }
+
+        // Hijo de un nodo interior en la posición digit, o 0 si no existe.
+        unsigned long childAt(unsigned long node, unsigned long digit)
+        {
+            if (tagOf(node) == SPARSE_HASH_TAG_WIDE)
+            {
+                auto* chunk = reinterpret_cast<SparseHashBlock*>(
+                    untag<SparseHashBlock>(node)->children[digit / SPARSE_HASH_CHUNK_SIZE]);
+                return chunk ? chunk->children[digit % SPARSE_HASH_CHUNK_SIZE] : 0;
+            }
+
+            SparseHashNode* sparse = untag<SparseHashNode>(node);
+            unsigned long bit = 1UL << digit;
+            if (!(sparse->bitmap & bit))
+                return 0;
+            return sparse->children[std::popcount(sparse->bitmap & (bit - 1))];
+        }
+
+        // Nodo interior con los hijos indicados (en el orden de sus posiciones).
+        // Sin hijos no hay nodo, una hoja sola lo reemplaza y, si no caben en
+        // una celda, se arma un nodo ancho.
+        unsigned long makeInterior(ProtoContext* context, unsigned long bitmap, const unsigned long* children)
+        {
+            unsigned long count = std::popcount(bitmap);
+            if (!count)
+                return 0;
+            if (count == 1 && tagOf(children[0]) == SPARSE_HASH_TAG_LEAF)
+                return children[0];
+            if (count <= SPARSE_HASH_NODE_SLOTS)
+                return tagged(new(context) SparseHashNode(context, bitmap, children), SPARSE_HASH_TAG_NODE);
+
+            unsigned long slots[SPARSE_HASH_CHUNK_SIZE * SPARSE_HASH_CHUNK_SIZE] = {};
+            for (unsigned long digit = 0, i = 0; digit < SPARSE_HASH_FANOUT; digit++)
+                if (bitmap & (1UL << digit))
+                    slots[digit] = children[i++];
+
+            unsigned long chunks[SPARSE_HASH_CHUNK_SIZE] = {};
+            for (unsigned long c = 0; c < SPARSE_HASH_CHUNK_SIZE; c++)
+            {
+                const unsigned long* chunk = slots + c * SPARSE_HASH_CHUNK_SIZE;
+                for (unsigned long i = 0; i < SPARSE_HASH_CHUNK_SIZE && !chunks[c]; i++)
+                    if (chunk[i])
+                        chunks[c] = reinterpret_cast<unsigned long>(new(context) SparseHashBlock(context, chunk));
+            }
+            return tagged(new(context) SparseHashBlock(context, chunks), SPARSE_HASH_TAG_WIDE);
+        }
+
+        // Reemplaza el hijo de la posición digit de un nodo con mapa de bits.
+        unsigned long replaceInNode(ProtoContext* context, unsigned long node, unsigned long digit, unsigned long child)
+        {
+            SparseHashNode* sparse = untag<SparseHashNode>(node);
+            unsigned long bit = 1UL << digit;
+            unsigned long rank = std::popcount(sparse->bitmap & (bit - 1));
+            unsigned long count = std::popcount(sparse->bitmap);
+
+            unsigned long bitmap = sparse->bitmap;
+            unsigned long children[SPARSE_HASH_NODE_SLOTS + 1];
+            unsigned long used = 0;
+            for (unsigned long i = 0; i <= count; i++)
+            {
+                if (i == rank)
+                {
+                    if (child)
+                        children[used++] = child;
+                    // Un hijo reemplazado (o quitado) no se copia.
+                    if (sparse->bitmap & bit)
+                        continue;
+                }
+                if (i < count)
+                    children[used++] = sparse->children[i];
+            }
+            bitmap = child ? bitmap | bit : bitmap & ~bit;
+
+            return makeInterior(context, bitmap, children);
+        }
+
+        // Reemplaza el hijo de la posición digit de un nodo ancho: se copian la
+        // raíz y el bloque afectado; los demás bloques se comparten.
+        unsigned long replaceInWide(ProtoContext* context, unsigned long node, unsigned long digit, unsigned long child)
+        {
+            SparseHashBlock* wide = untag<SparseHashBlock>(node);
+            unsigned long c = digit / SPARSE_HASH_CHUNK_SIZE;
+            auto* chunk = reinterpret_cast<SparseHashBlock*>(wide->children[c]);
+
+            unsigned long slots[SPARSE_HASH_CHUNK_SIZE] = {};
+            bool empty = true;
+            for (unsigned long i = 0; i < SPARSE_HASH_CHUNK_SIZE; i++)
+            {
+                slots[i] = i == digit % SPARSE_HASH_CHUNK_SIZE ? child : chunk ? chunk->children[i] : 0;
+                empty = empty && !slots[i];
+            }
+
+            unsigned long chunks[SPARSE_HASH_CHUNK_SIZE];
+            for (unsigned long i = 0; i < SPARSE_HASH_CHUNK_SIZE; i++)
+                chunks[i] = wide->children[i];
+            chunks[c] = empty ? 0 : reinterpret_cast<unsigned long>(new(context) SparseHashBlock(context, slots));
+
+            if (!child)
+            {
+                // Al quitar, un nodo que ya cabe holgado en una celda vuelve a
+                // tener mapa de bits; el margen evita alternar entre formas.
+                unsigned long bitmap = 0;
+                unsigned long children[SPARSE_HASH_NODE_SLOTS];
+                unsigned long count = 0;
+                for (unsigned long d = 0; d < SPARSE_HASH_FANOUT && count < SPARSE_HASH_NODE_SLOTS; d++)
+                {
+                    auto* block = reinterpret_cast<SparseHashBlock*>(chunks[d / SPARSE_HASH_CHUNK_SIZE]);
+                    unsigned long present = block ? block->children[d % SPARSE_HASH_CHUNK_SIZE] : 0;
+                    if (present)
+                    {
+                        bitmap |= 1UL << d;
+                        children[count++] = present;
+                    }
+                }
+                if (count < SPARSE_HASH_NODE_SLOTS)
+                    return makeInterior(context, bitmap, children);
+            }
+
+            return tagged(new(context) SparseHashBlock(context, chunks), SPARSE_HASH_TAG_WIDE);
+        }
+
+        // Devuelve el subárbol con key asociada a value (o sin key, si value es
+        // NONE), y deja en previous el valor anterior. Si nada cambia devuelve node.
+        unsigned long updateIn(
+            ProtoContext* context,
+            unsigned long node,
+            unsigned long level,
+            unsigned long key,
+            unsigned long mixed,
+            ProtoObject* value,
+            ProtoObject** previous
+        )
+        {
+            if (!node)
+                return value == PROTO_NONE ? 0 : newLeaf(context, key, value);
+
+            if (tagOf(node) == SPARSE_HASH_TAG_LEAF)
+            {
+                SparseHashLeaf* leaf = untag<SparseHashLeaf>(node);
+                if (leaf->key == key)
+                {
+                    *previous = leaf->value;
+                    if (value == PROTO_NONE)
+                        return 0;
+                    if (leaf->value == value)
+                        return node;
+                    return newLeaf(context, key, value);
+                }
+
+                if (value == PROTO_NONE)
+                    return node;
+
+                // Dos claves en la misma posición: se separan un nivel más abajo.
+                node = tagged(
+                    new(context) SparseHashNode(context, 1UL << digitAt(mixKey(leaf->key), level), &node),
+                    SPARSE_HASH_TAG_NODE
+                );
+            }
+
+            unsigned long digit = digitAt(mixed, level);
+            unsigned long child = childAt(node, digit);
+            unsigned long updated = updateIn(context, child, level + 1, key, mixed, value, previous);
+            if (updated == child)
+                return node;
+
+            return tagOf(node) == SPARSE_HASH_TAG_WIDE
+                ? replaceInWide(context, node, digit, updated)
+                : replaceInNode(context, node, digit, updated);
+        }
+
+        template <typename Visit>
+        void visitLeaves(unsigned long node, Visit&& visit)
+        {
+            switch (tagOf(node))
+            {
+            case SPARSE_HASH_TAG_LEAF:
+                visit(untag<SparseHashLeaf>(node));
+                break;
+            case SPARSE_HASH_TAG_WIDE:
+                for (unsigned long chunk : untag<SparseHashBlock>(node)->children)
+                    if (chunk)
+                        for (unsigned long child : reinterpret_cast<SparseHashBlock*>(chunk)->children)
+                            if (child)
+                                visitLeaves(child, visit);
+                break;
+            default:
+            {
+                SparseHashNode* sparse = untag<SparseHashNode>(node);
+                unsigned long count = std::popcount(sparse->bitmap);
+                for (unsigned long i = 0; i < count; i++)
+                    visitLeaves(sparse->children[i], visit);
+                break;
+            }
+            }
+        }
+    } // fin del namespace anónimo
+
+
+    // --- SparseHashNode ---
+
+    SparseHashNode::SparseHashNode(
+        ProtoContext* context,
+        unsigned long bitmap,
+        const unsigned long* children
+    ) : Cell(context), bitmap(bitmap)
+    {
+        unsigned long count = std::popcount(bitmap);
+        for (unsigned long i = 0; i < SPARSE_HASH_NODE_SLOTS; i++)
+            this->children[i] = i < count ? children[i] : 0;
+    }
+
+    SparseHashNode::~SparseHashNode() = default;
+
+    unsigned long SparseHashNode::getHash(ProtoContext* context)
+    {
+        return Cell::getHash(context);
+    }
+
+    ProtoObject* SparseHashNode::asObject(ProtoContext* context)
+    {
+        return Cell::asObject(context);
+    }
+
+    void SparseHashNode::finalize(ProtoContext* context)
+    {
+    }
+
+    void SparseHashNode::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        unsigned long count = std::popcount(this->bitmap);
+        for (unsigned long i = 0; i < count; i++)
+            method(context, self, untag<Cell>(this->children[i]));
+    }
+
+
+    // --- SparseHashBlock ---
+
+    SparseHashBlock::SparseHashBlock(ProtoContext* context, const unsigned long* children) : Cell(context)
+    {
+        for (unsigned long i = 0; i < SPARSE_HASH_CHUNK_SIZE; i++)
+            this->children[i] = children[i];
+    }
+
+    SparseHashBlock::~SparseHashBlock() = default;
+
+    unsigned long SparseHashBlock::getHash(ProtoContext* context)
+    {
+        return Cell::getHash(context);
+    }
+
+    ProtoObject* SparseHashBlock::asObject(ProtoContext* context)
+    {
+        return Cell::asObject(context);
+    }
+
+    void SparseHashBlock::finalize(ProtoContext* context)
+    {
+    }
+
+    void SparseHashBlock::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        // Los bloques de un nodo ancho apuntan a bloques sin marca; los de
+        // hijos, a nodos marcados.
+        for (unsigned long child : this->children)
+            if (child)
+                method(context, self, untag<Cell>(child));
+    }
+
+
+    // --- SparseHashLeaf ---
+
+    SparseHashLeaf::SparseHashLeaf(
+        ProtoContext* context,
+        unsigned long key,
+        ProtoObject* value
+    ) : Cell(context), key(key), value(value)
+    {
+    }
+
+    SparseHashLeaf::~SparseHashLeaf() = default;
+
+    unsigned long SparseHashLeaf::getHash(ProtoContext* context)
+    {
+        return Cell::getHash(context);
+    }
+
+    ProtoObject* SparseHashLeaf::asObject(ProtoContext* context)
+    {
+        return Cell::asObject(context);
+    }
+
+    void SparseHashLeaf::finalize(ProtoContext* context)
+    {
+    }
+
+    void SparseHashLeaf::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        if (this->value && this->value->isCell(context))
+            method(context, self, this->value->asCell(context));
+    }
+
+
+    // --- ProtoSparseHashImplementation ---
+
+    ProtoSparseHashImplementation::ProtoSparseHashImplementation(
+        ProtoContext* context,
+        unsigned long root,
+        unsigned long count,
+        unsigned long hash
+    ) : SparseListCell(context, SPARSE_LIST_HASH), root(root)
+    {
+        this->count = count;
+        this->hash = hash;
+    }
+
+    ProtoSparseHashImplementation::~ProtoSparseHashImplementation() = default;
+
+    bool ProtoSparseHashImplementation::implHas(ProtoContext* context, unsigned long index)
+    {
+        return this->implGetAt(context, index) != PROTO_NONE;
+    }
+
+    ProtoObject* ProtoSparseHashImplementation::implGetAt(ProtoContext* context, unsigned long index)
+    {
+        unsigned long mixed = mixKey(index);
+        unsigned long node = this->root;
+        for (unsigned long level = 0; node && tagOf(node) != SPARSE_HASH_TAG_LEAF; level++)
+            node = childAt(node, digitAt(mixed, level));
+
+        if (node && untag<SparseHashLeaf>(node)->key == index)
+            return untag<SparseHashLeaf>(node)->value;
+        return PROTO_NONE;
+    }
+
+    ProtoSparseHashImplementation* ProtoSparseHashImplementation::implSetAt(
+        ProtoContext* context,
+        unsigned long index,
+        ProtoObject* value
+    )
+    {
+        ProtoObject* previous = PROTO_NONE;
+        unsigned long newRoot = updateIn(context, this->root, 0, index, mixKey(index), value, &previous);
+        if (newRoot == this->root)
+            return this;
+
+        unsigned long newHash = this->hash;
+        unsigned long newCount = this->count;
+        if (previous != PROTO_NONE)
+        {
+            newHash ^= index ^ previous->getHash(context);
+            newCount--;
+        }
+        if (value != PROTO_NONE)
+        {
+            newHash ^= index ^ value->getHash(context);
+            newCount++;
+        }
+
+        return new(context) ProtoSparseHashImplementation(context, newRoot, newCount, newHash);
+    }
+
+    ProtoSparseHashImplementation* ProtoSparseHashImplementation::implRemoveAt(
+        ProtoContext* context,
+        unsigned long index
+    )
+    {
+        return this->implSetAt(context, index, PROTO_NONE);
+    }
+
+    void ProtoSparseHashImplementation::implProcessElements(
+        ProtoContext* context,
+        void* self,
+        void (*method)(ProtoContext* context, void* self, unsigned long index, ProtoObject* value)
+    )
+    {
+        if (this->root)
+            visitLeaves(this->root, [&](SparseHashLeaf* leaf) { method(context, self, leaf->key, leaf->value); });
+    }
+
+    void ProtoSparseHashImplementation::implProcessValues(
+        ProtoContext* context,
+        void* self,
+        void (*method)(ProtoContext* context, void* self, ProtoObject* value)
+    )
+    {
+        if (this->root)
+            visitLeaves(this->root, [&](SparseHashLeaf* leaf) { method(context, self, leaf->value); });
+    }
+
+    void ProtoSparseHashImplementation::finalize(ProtoContext* context)
+    {
+    }
+
+    void ProtoSparseHashImplementation::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        if (this->root)
+            method(context, self, untag<Cell>(this->root));
+    }
+} // namespace proto
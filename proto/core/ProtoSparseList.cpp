@@ -7,6 +7,7 @@
 
 #include "../headers/proto_internal.h"
 #include <algorithm> // Para std::max
+#include <vector>
 
 namespace proto
 {
@@ -78,8 +79,7 @@ namespace proto
             if (this->current && this->current->next)
             {
                 // Si hay un subárbol derecho, el siguiente es el primer elemento de ese subárbol.
-                return dynamic_cast<ProtoSparseListIteratorImplementation*>(this->current->next->
-                    implGetIterator(context));
+                return this->current->next->implGetIterator(context);
             }
             if (this->queue)
             {
@@ -132,6 +132,146 @@ namespace proto
     }
 
 
+    // --- SparseListCell ---
+
+    SparseListCell::SparseListCell(ProtoContext* context, unsigned long type)
+        : Cell(context), hash(0), count(0), height(0), type(type)
+    {
+    }
+
+    unsigned long SparseListCell::implGetSize(ProtoContext* context)
+    {
+        return this->count;
+    }
+
+    ProtoObject* SparseListCell::implAsObject(ProtoContext* context)
+    {
+        ProtoObjectPointer p{};
+        p.oid.oid = reinterpret_cast<ProtoObject*>(this);
+        p.op.pointer_tag = POINTER_TAG_SPARSE_LIST;
+        return p.oid.oid;
+    }
+
+    unsigned long SparseListCell::getHash(ProtoContext* context)
+    {
+        return this->hash;
+    }
+
+    // Las operaciones por clave se resuelven por `type` con llamadas directas
+    // a la clase concreta (todas son final), que el compilador puede expandir.
+
+    bool SparseListCell::implHas(ProtoContext* context, unsigned long index)
+    {
+        switch (this->type)
+        {
+        case SPARSE_LIST_HASH:
+            return static_cast<ProtoSparseHashImplementation*>(this)->implHas(context, index);
+        case SPARSE_LIST_ARRAY:
+            return static_cast<ProtoSparseArrayImplementation*>(this)->implHas(context, index);
+        default:
+            return static_cast<ProtoSparseListImplementation*>(this)->implHas(context, index);
+        }
+    }
+
+    ProtoObject* SparseListCell::implGetAt(ProtoContext* context, unsigned long index)
+    {
+        switch (this->type)
+        {
+        case SPARSE_LIST_HASH:
+            return static_cast<ProtoSparseHashImplementation*>(this)->implGetAt(context, index);
+        case SPARSE_LIST_ARRAY:
+            return static_cast<ProtoSparseArrayImplementation*>(this)->implGetAt(context, index);
+        default:
+            return static_cast<ProtoSparseListImplementation*>(this)->implGetAt(context, index);
+        }
+    }
+
+    SparseListCell* SparseListCell::implSetAt(ProtoContext* context, unsigned long index, ProtoObject* value)
+    {
+        switch (this->type)
+        {
+        case SPARSE_LIST_HASH:
+            return static_cast<ProtoSparseHashImplementation*>(this)->implSetAt(context, index, value);
+        case SPARSE_LIST_ARRAY:
+            return static_cast<ProtoSparseArrayImplementation*>(this)->implSetAt(context, index, value);
+        default:
+            return static_cast<ProtoSparseListImplementation*>(this)->implSetAt(context, index, value);
+        }
+    }
+
+    SparseListCell* SparseListCell::implRemoveAt(ProtoContext* context, unsigned long index)
+    {
+        switch (this->type)
+        {
+        case SPARSE_LIST_HASH:
+            return static_cast<ProtoSparseHashImplementation*>(this)->implRemoveAt(context, index);
+        case SPARSE_LIST_ARRAY:
+            return static_cast<ProtoSparseArrayImplementation*>(this)->implRemoveAt(context, index);
+        default:
+            return static_cast<ProtoSparseListImplementation*>(this)->implRemoveAt(context, index);
+        }
+    }
+
+    void SparseListCell::implProcessElements(
+        ProtoContext* context,
+        void* self,
+        void (*method)(ProtoContext* context, void* self, unsigned long index, ProtoObject* value)
+    )
+    {
+        switch (this->type)
+        {
+        case SPARSE_LIST_HASH:
+            static_cast<ProtoSparseHashImplementation*>(this)->implProcessElements(context, self, method);
+            break;
+        case SPARSE_LIST_ARRAY:
+            static_cast<ProtoSparseArrayImplementation*>(this)->implProcessElements(context, self, method);
+            break;
+        default:
+            static_cast<ProtoSparseListImplementation*>(this)->implProcessElements(context, self, method);
+            break;
+        }
+    }
+
+    void SparseListCell::implProcessValues(
+        ProtoContext* context,
+        void* self,
+        void (*method)(ProtoContext* context, void* self, ProtoObject* value)
+    )
+    {
+        switch (this->type)
+        {
+        case SPARSE_LIST_HASH:
+            static_cast<ProtoSparseHashImplementation*>(this)->implProcessValues(context, self, method);
+            break;
+        case SPARSE_LIST_ARRAY:
+            static_cast<ProtoSparseArrayImplementation*>(this)->implProcessValues(context, self, method);
+            break;
+        default:
+            static_cast<ProtoSparseListImplementation*>(this)->implProcessValues(context, self, method);
+            break;
+        }
+    }
+
+    namespace
+    {
+        void addToTransient(ProtoContext* context, void* self, unsigned long index, ProtoObject* value)
+        {
+            static_cast<ProtoSparseListTransientImplementation*>(self)->implSetAt(context, index, value);
+        }
+    }
+
+    ProtoSparseListImplementation* SparseListCell::implAsTree(ProtoContext* context)
+    {
+        if (this->type == SPARSE_LIST_TREE)
+            return static_cast<ProtoSparseListImplementation*>(this);
+
+        // Un lote grande sobre la lista vacía se ordena y se arma balanceado de una vez.
+        auto* editor = (new(context) ProtoSparseListImplementation(context))->implBeginTransient(context);
+        this->implProcessElements(context, editor, addToTransient);
+        return editor->implPersistent(context);
+    }
+
+
     // --- ProtoSparseListImplementation ---
 
     // Constructor modernizado.
@@ -141,7 +281,7 @@ namespace proto
         ProtoObject* value,
         ProtoSparseListImplementation* previous,
         ProtoSparseListImplementation* next
-    ) : Cell(context), previous(previous), next(next), index(index), value(value)
+    ) : SparseListCell(context, SPARSE_LIST_TREE), previous(previous), next(next), index(index), value(value)
     {
         // Calcular hash, contador y altura después de inicializar los miembros.
         this->hash = index ^
@@ -236,6 +376,305 @@ namespace proto
 
             return node; // El nodo ya está balanceado.
         }
+
+        unsigned long getCount(const ProtoSparseListImplementation* node)
+        {
+            return node ? node->count : 0;
+        }
+
+        // Un nodo con valor NONE (la raíz de la lista vacía o un setAt con NONE)
+        // no cuenta como elemento.
+        unsigned long ownCount(const ProtoSparseListImplementation* node)
+        {
+            return node->value != PROTO_NONE ? 1 : 0;
+        }
+
+        ProtoSparseListImplementation* orEmpty(ProtoContext* context, ProtoSparseListImplementation* node)
+        {
+            return node ? node : new(context) ProtoSparseListImplementation(context);
+        }
+
+        // Une previous, el par (index, value) y next; todas las claves de previous
+        // son menores que index y las de next mayores. Cuesta O(diferencia de alturas).
+        ProtoSparseListImplementation* join(
+            ProtoContext* context,
+            ProtoSparseListImplementation* previous,
+            unsigned long index,
+            ProtoObject* value,
+            ProtoSparseListImplementation* next
+        )
+        {
+            if (getHeight(previous) > getHeight(next) + 1)
+                return rebalance(context, new(context) ProtoSparseListImplementation(
+                    context, previous->index, previous->value, previous->previous,
+                    join(context, previous->next, index, value, next)));
+
+            if (getHeight(next) > getHeight(previous) + 1)
+                return rebalance(context, new(context) ProtoSparseListImplementation(
+                    context, next->index, next->value,
+                    join(context, previous, index, value, next->previous), next->next));
+
+            return new(context) ProtoSparseListImplementation(context, index, value, previous, next);
+        }
+
+        // Quita el nodo de menor clave y lo devuelve en first.
+        ProtoSparseListImplementation* removeFirstNode(
+            ProtoContext* context,
+            ProtoSparseListImplementation* node,
+            ProtoSparseListImplementation** first
+        )
+        {
+            if (!node->previous)
+            {
+                *first = node;
+                return node->next;
+            }
+
+            return rebalance(context, new(context) ProtoSparseListImplementation(
+                context, node->index, node->value,
+                removeFirstNode(context, node->previous, first), node->next));
+        }
+
+        ProtoSparseListImplementation* concat(
+            ProtoContext* context,
+            ProtoSparseListImplementation* previous,
+            ProtoSparseListImplementation* next
+        )
+        {
+            if (!previous) return next;
+            if (!next) return previous;
+
+            ProtoSparseListImplementation* first = nullptr;
+            ProtoSparseListImplementation* rest = removeFirstNode(context, next, &first);
+            return join(context, previous, first->index, first->value, rest);
+        }
+
+        // Divide node en las claves menores que key y las mayores o iguales.
+        // Los nodos con valor NONE del camino se descartan.
+        void splitAt(
+            ProtoContext* context,
+            ProtoSparseListImplementation* node,
+            unsigned long key,
+            ProtoSparseListImplementation** left,
+            ProtoSparseListImplementation** right
+        )
+        {
+            if (!node)
+            {
+                *left = *right = nullptr;
+                return;
+            }
+
+            ProtoSparseListImplementation* middle = nullptr;
+            if (node->index >= key)
+            {
+                splitAt(context, node->previous, key, left, &middle);
+                *right = node->value != PROTO_NONE
+                    ? join(context, middle, node->index, node->value, node->next)
+                    : concat(context, middle, node->next);
+            }
+            else
+            {
+                splitAt(context, node->next, key, &middle, right);
+                *left = node->value != PROTO_NONE
+                    ? join(context, node->previous, node->index, node->value, middle)
+                    : concat(context, node->previous, middle);
+            }
+        }
+
+        // Como splitAt, pero deja fuera la clave buscada y devuelve su valor
+        // (NONE si no está).
+        ProtoObject* splitExact(
+            ProtoContext* context,
+            ProtoSparseListImplementation* node,
+            unsigned long key,
+            ProtoSparseListImplementation** left,
+            ProtoSparseListImplementation** right
+        )
+        {
+            if (!node)
+            {
+                *left = *right = nullptr;
+                return PROTO_NONE;
+            }
+
+            if (node->index == key)
+            {
+                *left = node->previous;
+                *right = node->next;
+                return node->value;
+            }
+
+            ProtoSparseListImplementation* middle = nullptr;
+            ProtoObject* found;
+            if (key < node->index)
+            {
+                found = splitExact(context, node->previous, key, left, &middle);
+                *right = node->value != PROTO_NONE
+                    ? join(context, middle, node->index, node->value, node->next)
+                    : concat(context, middle, node->next);
+            }
+            else
+            {
+                found = splitExact(context, node->next, key, &middle, right);
+                *left = node->value != PROTO_NONE
+                    ? join(context, node->previous, node->index, node->value, middle)
+                    : concat(context, node->previous, middle);
+            }
+            return found;
+        }
+
+        // Arma el resultado alrededor de node. Si nada cambió devuelve node tal
+        // cual, de modo que los subárboles intactos se comparten.
+        ProtoSparseListImplementation* rebuildAround(
+            ProtoContext* context,
+            ProtoSparseListImplementation* node,
+            ProtoSparseListImplementation* previous,
+            ProtoObject* value,
+            ProtoSparseListImplementation* next
+        )
+        {
+            if (previous == node->previous && next == node->next && value == node->value)
+                return node;
+
+            if (value == PROTO_NONE)
+                return concat(context, previous, next);
+
+            return join(context, previous, node->index, value, next);
+        }
+
+        ProtoSparseListImplementation* unionOf(
+            ProtoContext* context,
+            ProtoSparseListImplementation* a,
+            ProtoSparseListImplementation* b,
+            void* self,
+            ProtoMergeFunction merge
+        )
+        {
+            if (!a) return b;
+            if (!b) return a;
+
+            ProtoSparseListImplementation* left = nullptr;
+            ProtoSparseListImplementation* right = nullptr;
+            ProtoObject* other = splitExact(context, b, a->index, &left, &right);
+
+            ProtoObject* value = a->value;
+            if (other != PROTO_NONE)
+            {
+                if (value == PROTO_NONE)
+                    value = other;
+                else
+                    value = merge ? merge(context, self, a->index, value, other) : other;
+            }
+
+            return rebuildAround(
+                context, a,
+                unionOf(context, a->previous, left, self, merge),
+                value,
+                unionOf(context, a->next, right, self, merge)
+            );
+        }
+
+        ProtoSparseListImplementation* intersectionOf(
+            ProtoContext* context,
+            ProtoSparseListImplementation* a,
+            ProtoSparseListImplementation* b,
+            void* self,
+            ProtoMergeFunction merge
+        )
+        {
+            if (!a || !b) return nullptr;
+
+            ProtoSparseListImplementation* left = nullptr;
+            ProtoSparseListImplementation* right = nullptr;
+            ProtoObject* other = splitExact(context, b, a->index, &left, &right);
+
+            ProtoObject* value = PROTO_NONE;
+            if (a->value != PROTO_NONE && other != PROTO_NONE)
+                value = merge ? merge(context, self, a->index, a->value, other) : a->value;
+
+            return rebuildAround(
+                context, a,
+                intersectionOf(context, a->previous, left, self, merge),
+                value,
+                intersectionOf(context, a->next, right, self, merge)
+            );
+        }
+
+        // Elementos de a cuya clave no está en b. Se divide a por las claves de b,
+        // así que el costo depende del tamaño de b y no del de a.
+        ProtoSparseListImplementation* differenceOf(
+            ProtoContext* context,
+            ProtoSparseListImplementation* a,
+            ProtoSparseListImplementation* b
+        )
+        {
+            if (!a) return nullptr;
+            if (!b) return a;
+
+            ProtoSparseListImplementation* left = nullptr;
+            ProtoSparseListImplementation* right = nullptr;
+            ProtoObject* kept = splitExact(context, a, b->index, &left, &right);
+
+            ProtoSparseListImplementation* previous = differenceOf(context, left, b->previous);
+            ProtoSparseListImplementation* next = differenceOf(context, right, b->next);
+            if (b->value == PROTO_NONE && kept != PROTO_NONE)
+                return join(context, previous, b->index, kept, next);
+            return concat(context, previous, next);
+        }
+
+        // La raíz de una lista vacía se trata como el árbol vacío.
+        ProtoSparseListImplementation* asTree(ProtoSparseListImplementation* list)
+        {
+            return list && list->count ? list : nullptr;
+        }
+
+        // Cantidad de elementos con clave menor que key (o menor o igual, si inclusive).
+        unsigned long rankOf(const ProtoSparseListImplementation* node, unsigned long key, bool inclusive)
+        {
+            unsigned long rank = 0;
+            while (node)
+            {
+                if (node->index < key || (inclusive && node->index == key))
+                {
+                    rank += getCount(node->previous) + ownCount(node);
+                    node = node->next;
+                }
+                else
+                    node = node->previous;
+            }
+            return rank;
+        }
+
+        // El nodo del elemento en la posición rank del orden por clave.
+        const ProtoSparseListImplementation* selectAt(const ProtoSparseListImplementation* node, unsigned long rank)
+        {
+            while (node)
+            {
+                unsigned long before = getCount(node->previous);
+                if (rank < before)
+                    node = node->previous;
+                else if (rank == before && ownCount(node))
+                    return node;
+                else
+                {
+                    rank -= before + ownCount(node);
+                    node = node->next;
+                }
+            }
+            return nullptr;
+        }
+
+        bool keyAt(const ProtoSparseListImplementation* root, unsigned long rank, unsigned long* key)
+        {
+            if (rank >= root->count)
+                return false;
+
+            const ProtoSparseListImplementation* node = selectAt(root, rank);
+            if (node && key)
+                *key = node->index;
+            return node != nullptr;
+        }
     } // fin del namespace anónimo
 
     // --- Métodos de la Interfaz Pública ---
@@ -381,9 +820,81 @@ namespace proto
         return rebalance(context, newNode);
     }
 
-    unsigned long ProtoSparseListImplementation::implGetSize(ProtoContext* context)
+    unsigned long ProtoSparseListImplementation::implCountRange(
+        ProtoContext* context, unsigned long from, unsigned long to)
     {
-        return this->count;
+        if (from >= to)
+            return 0;
+        return rankOf(this, to, false) - rankOf(this, from, false);
+    }
+
+    ProtoSparseListImplementation* ProtoSparseListImplementation::implSliceRange(
+        ProtoContext* context, unsigned long from, unsigned long to)
+    {
+        if (from >= to || !this->count)
+            return new(context) ProtoSparseListImplementation(context);
+
+        ProtoSparseListImplementation* before = nullptr;
+        ProtoSparseListImplementation* rest = nullptr;
+        ProtoSparseListImplementation* slice = nullptr;
+        ProtoSparseListImplementation* after = nullptr;
+        splitAt(context, this, from, &before, &rest);
+        splitAt(context, rest, to, &slice, &after);
+        return orEmpty(context, slice);
+    }
+
+    ProtoSparseListImplementation* ProtoSparseListImplementation::implRemoveRange(
+        ProtoContext* context, unsigned long from, unsigned long to)
+    {
+        if (from >= to || !this->implCountRange(context, from, to))
+            return this;
+
+        ProtoSparseListImplementation* before = nullptr;
+        ProtoSparseListImplementation* rest = nullptr;
+        ProtoSparseListImplementation* removed = nullptr;
+        ProtoSparseListImplementation* after = nullptr;
+        splitAt(context, this, from, &before, &rest);
+        splitAt(context, rest, to, &removed, &after);
+        return orEmpty(context, concat(context, before, after));
+    }
+
+    bool ProtoSparseListImplementation::implFirstKey(ProtoContext* context, unsigned long* key)
+    {
+        return keyAt(this, 0, key);
+    }
+
+    bool ProtoSparseListImplementation::implLastKey(ProtoContext* context, unsigned long* key)
+    {
+        return this->count && keyAt(this, this->count - 1, key);
+    }
+
+    bool ProtoSparseListImplementation::implFloor(ProtoContext* context, unsigned long key, unsigned long* found)
+    {
+        unsigned long rank = rankOf(this, key, true);
+        return rank && keyAt(this, rank - 1, found);
+    }
+
+    bool ProtoSparseListImplementation::implCeiling(ProtoContext* context, unsigned long key, unsigned long* found)
+    {
+        return keyAt(this, rankOf(this, key, false), found);
+    }
+
+    ProtoSparseListImplementation* ProtoSparseListImplementation::implUnion(
+        ProtoContext* context, ProtoSparseListImplementation* other, void* self, ProtoMergeFunction merge)
+    {
+        return orEmpty(context, unionOf(context, asTree(this), asTree(other), self, merge));
+    }
+
+    ProtoSparseListImplementation* ProtoSparseListImplementation::implIntersection(
+        ProtoContext* context, ProtoSparseListImplementation* other, void* self, ProtoMergeFunction merge)
+    {
+        return orEmpty(context, intersectionOf(context, asTree(this), asTree(other), self, merge));
+    }
+
+    ProtoSparseListImplementation* ProtoSparseListImplementation::implDifference(
+        ProtoContext* context, ProtoSparseListImplementation* other)
+    {
+        return orEmpty(context, differenceOf(context, asTree(this), asTree(other)));
     }
 
     void ProtoSparseListImplementation::implProcessElements(
@@ -450,14 +961,6 @@ namespace proto
         }
     }
 
-    ProtoObject* ProtoSparseListImplementation::implAsObject(ProtoContext* context)
-    {
-        ProtoObjectPointer p{};
-        p.oid.oid = reinterpret_cast<ProtoObject*>(this);
-        p.op.pointer_tag = POINTER_TAG_SPARSE_LIST;
-        return p.oid.oid;
-    }
-
     ProtoSparseListIteratorImplementation* ProtoSparseListImplementation::implGetIterator(ProtoContext* context)
     {
         // La lógica del iterador es compleja, pero se mantiene la estructura original.
@@ -472,9 +975,9 @@ namespace proto
         return new(context) ProtoSparseListIteratorImplementation(context, ITERATOR_NEXT_THIS, node, queue);
     }
 
-    unsigned long ProtoSparseListImplementation::getHash(ProtoContext* context)
+    ProtoSparseListTransientImplementation* ProtoSparseListImplementation::implBeginTransient(ProtoContext* context)
     {
-        return this->hash;
+        return new(context) ProtoSparseListTransientImplementation(context, this);
     }
 
     void ProtoSparseListImplementation::finalize(ProtoContext* context)
@@ -483,4 +986,256 @@ namespace proto
 
     // El método getHash se hereda de la clase base Cell, que proporciona un hash
     // basado en la dirección, lo cual es suficiente y consistente.
+
+    // --- ProtoSparseListTransientImplementation ---
+
+    namespace
+    {
+        struct SparseEntry
+        {
+            unsigned long index;
+            ProtoObject* value;
+            ProtoSparseListImplementation* owned;  // nodo propio del editor, si lo hay
+        };
+
+        void collectSparseEntry(ProtoContext* context, void* self, unsigned long index, ProtoObject* value)
+        {
+            static_cast<std::vector<SparseEntry>*>(self)->push_back({index, value, nullptr});
+        }
+
+        ProtoSparseListImplementation* buildSparseBalanced(
+            ProtoContext* context,
+            std::vector<SparseEntry>& entries,
+            unsigned long first,
+            unsigned long last
+        )
+        {
+            if (first >= last)
+                return nullptr;
+
+            unsigned long middle = first + (last - first) / 2;
+            ProtoSparseListImplementation* previous = buildSparseBalanced(context, entries, first, middle);
+            ProtoSparseListImplementation* next = buildSparseBalanced(context, entries, middle + 1, last);
+
+            SparseEntry& entry = entries[middle];
+            ProtoSparseListImplementation* node = entry.owned;
+            if (!node)
+                return new(context) ProtoSparseListImplementation(context, entry.index, entry.value, previous, next);
+
+            // Nodo propio todavía no publicado: se enlaza en su lugar.
+            node->previous = previous;
+            node->next = next;
+            node->hash = node->index ^
+                node->value->getHash(context) ^
+                (previous ? previous->hash : 0) ^
+                (next ? next->hash : 0);
+            node->count = 1 + (previous ? previous->count : 0) + (next ? next->count : 0);
+            node->height = 1 + std::max(getHeight(previous), getHeight(next));
+            return node;
+        }
+    }
+
+    ProtoSparseListTransientImplementation::ProtoSparseListTransientImplementation(
+        ProtoContext* context,
+        ProtoSparseListImplementation* base
+    ) : Cell(context), base(base), pending(nullptr), pendingCount(0), sealed(0)
+    {
+    }
+
+    ProtoSparseListTransientImplementation::~ProtoSparseListTransientImplementation() = default;
+
+    ProtoSparseListTransientImplementation* ProtoSparseListTransientImplementation::implSetAt(
+        ProtoContext* context,
+        unsigned long index,
+        ProtoObject* value
+    )
+    {
+        if (this->sealed)
+            return nullptr;
+
+        // Un solo nodo por cambio, sin copiar caminos; el orden se resuelve al sellar.
+        this->pending = new(context) ProtoSparseListImplementation(context, index, value, nullptr, this->pending);
+        this->pendingCount++;
+        return this;
+    }
+
+    ProtoSparseListImplementation* ProtoSparseListTransientImplementation::implPersistent(ProtoContext* context)
+    {
+        if (this->sealed)
+            return this->base;
+
+        // Del más nuevo al más viejo: tras un ordenamiento estable, el primero
+        // de cada índice es el último valor asignado.
+        std::vector<SparseEntry> changes;
+        changes.reserve(this->pendingCount);
+        for (ProtoSparseListImplementation* node = this->pending; node; node = node->next)
+            changes.push_back({node->index, node->value, node});
+
+        std::stable_sort(changes.begin(), changes.end(), [](const SparseEntry& a, const SparseEntry& b)
+        {
+            return a.index < b.index;
+        });
+        changes.erase(std::unique(changes.begin(), changes.end(), [](const SparseEntry& a, const SparseEntry& b)
+        {
+            return a.index == b.index;
+        }), changes.end());
+
+        ProtoSparseListImplementation* result = this->base;
+        if (changes.size() * (this->base->height + 1) < this->base->count)
+        {
+            // Pocos cambios sobre una base grande: caminos copiados, uno por cambio.
+            for (auto& change : changes)
+            {
+                result = change.value == PROTO_NONE
+                    ? result->implRemoveAt(context, change.index)
+                    : result->implSetAt(context, change.index, change.value);
+                if (!result)
+                    result = new(context) ProtoSparseListImplementation(context);
+            }
+        }
+        else
+        {
+            std::vector<SparseEntry> current;
+            current.reserve(this->base->count);
+            this->base->implProcessElements(context, &current, collectSparseEntry);
+
+            // Mezcla ordenada; ante el mismo índice gana el cambio, y NONE borra.
+            std::vector<SparseEntry> merged;
+            merged.reserve(current.size() + changes.size());
+            unsigned long i = 0, j = 0;
+            while (i < current.size() || j < changes.size())
+            {
+                if (j == changes.size() || (i < current.size() && current[i].index < changes[j].index))
+                {
+                    merged.push_back(current[i++]);
+                    continue;
+                }
+
+                if (i < current.size() && current[i].index == changes[j].index)
+                    i++;
+                if (changes[j].value != PROTO_NONE)
+                    merged.push_back(changes[j]);
+                j++;
+            }
+
+            result = buildSparseBalanced(context, merged, 0, merged.size());
+            if (!result)
+                result = new(context) ProtoSparseListImplementation(context);
+        }
+
+        this->base = result;
+        this->pending = nullptr;
+        this->sealed = 1;
+        return result;
+    }
+
+    unsigned long ProtoSparseListTransientImplementation::getHash(ProtoContext* context)
+    {
+        return Cell::getHash(context);
+    }
+
+    ProtoObject* ProtoSparseListTransientImplementation::asObject(ProtoContext* context)
+    {
+        return Cell::asObject(context);
+    }
+
+    void ProtoSparseListTransientImplementation::finalize(ProtoContext* context)
+    {
+    }
+
+    void ProtoSparseListTransientImplementation::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        if (this->base)
+            method(context, self, this->base);
+        if (this->pending)
+            method(context, self, this->pending);
+    }
+
+    // --- ProtoSparseListCursor ---
+
+    ProtoSparseListCursor::ProtoSparseListCursor(ProtoContext* context, ProtoSparseList* list)
+        : root(list ? toImpl<SparseListCell>(list)->implAsTree(context) : nullptr), depth(0)
+    {
+        this->pushLeftmost(this->root);
+        this->skipEmpty();
+    }
+
+    void ProtoSparseListCursor::pushLeftmost(Cell* node)
+    {
+        auto* current = static_cast<ProtoSparseListImplementation*>(node);
+        while (current)
+        {
+            this->stack[this->depth++] = current;
+            current = current->previous;
+        }
+    }
+
+    // Saltea los nodos sin valor, como la raíz de una lista vacía.
+    void ProtoSparseListCursor::skipEmpty()
+    {
+        while (this->depth)
+        {
+            auto* node = static_cast<ProtoSparseListImplementation*>(this->stack[this->depth - 1]);
+            if (node->value != PROTO_NONE)
+                return;
+            this->depth--;
+            this->pushLeftmost(node->next);
+        }
+    }
+
+    bool ProtoSparseListCursor::hasNext(ProtoContext* context)
+    {
+        return this->depth != 0;
+    }
+
+    unsigned long ProtoSparseListCursor::nextKey(ProtoContext* context)
+    {
+        if (!this->depth)
+            return 0;
+        return static_cast<ProtoSparseListImplementation*>(this->stack[this->depth - 1])->index;
+    }
+
+    ProtoObject* ProtoSparseListCursor::nextValue(ProtoContext* context)
+    {
+        if (!this->depth)
+            return PROTO_NONE;
+        return static_cast<ProtoSparseListImplementation*>(this->stack[this->depth - 1])->value;
+    }
+
+    void ProtoSparseListCursor::advance(ProtoContext* context)
+    {
+        if (!this->depth)
+            return;
+
+        auto* node = static_cast<ProtoSparseListImplementation*>(this->stack[--this->depth]);
+        this->pushLeftmost(node->next);
+        this->skipEmpty();
+    }
+
+    void ProtoSparseListCursor::seek(ProtoContext* context, unsigned long key)
+    {
+        // Solo quedan en la pila los nodos con clave >= key por los que se bajó
+        // a la izquierda: son exactamente los pendientes del recorrido en orden.
+        this->depth = 0;
+        auto* node = static_cast<ProtoSparseListImplementation*>(this->root);
+        while (node)
+        {
+            if (node->index >= key)
+            {
+                this->stack[this->depth++] = node;
+                node = node->previous;
+            }
+            else
+                node = node->next;
+        }
+        this->skipEmpty();
+    }
 } // namespace proto
@@ -350,7 +350,31 @@ namespace proto
         return Cell::getHash(context);
     }
 
-    int ProtoStringImplementation::implCmpToString(ProtoContext* context, ProtoString* otherString) { return 0; }
+    int ProtoStringImplementation::implCmpToString(ProtoContext* context, ProtoString* otherString)
+    {
+        // Orden lexicográfico por punto de código, leyendo ambas cadenas por bloques.
+        ProtoStringCursor left(context, this);
+        ProtoStringCursor right(context, otherString);
+        ProtoObject* leftChars[32];
+        ProtoObject* rightChars[32];
+        while (true)
+        {
+            unsigned long leftCount = left.nextChunk(context, leftChars);
+            unsigned long rightCount = right.nextChunk(context, std::span<ProtoObject*>(rightChars, leftCount ? leftCount : 1));
+            for (unsigned long i = 0; i < leftCount && i < rightCount; i++)
+            {
+                ProtoObjectPointer a{}, b{};
+                a.oid.oid = leftChars[i];
+                b.oid.oid = rightChars[i];
+                if (a.unicodeChar.unicodeValue != b.unicodeChar.unicodeValue)
+                    return a.unicodeChar.unicodeValue < b.unicodeChar.unicodeValue ? -1 : 1;
+            }
+            if (leftCount != rightCount)
+                return leftCount < rightCount ? -1 : 1;
+            if (!leftCount)
+                return 0;
+        }
+    }
 
     ProtoStringImplementation* ProtoStringImplementation::implSetAtString(
         ProtoContext* context, int index, ProtoString* otherString) { return nullptr; }
@@ -382,4 +406,11 @@ namespace proto
     {
         return nullptr;
     }
+
+    // --- ProtoStringCursor ---
+
+    ProtoStringCursor::ProtoStringCursor(ProtoContext* context, ProtoString* string)
+        : ProtoTupleCursor(context, string ? toImpl<ProtoStringImplementation>(string)->baseTuple : nullptr)
+    {
+    }
 } // namespace proto
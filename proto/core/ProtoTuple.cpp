@@ -25,8 +25,8 @@ namespace proto
     TupleDictionary::TupleDictionary(
         ProtoContext* context,
         ProtoTupleImplementation* key,
-        TupleDictionary* next,
-        TupleDictionary* previous
+        TupleDictionary* previous,
+        TupleDictionary* next
     ): Cell(context)
     {
         this->key = key;
@@ -51,10 +51,11 @@ namespace proto
     )
     {
         if (this->next)
-            this->next->processReferences(context, self, method);
+            (*method)(context, self, this->next);
         if (this->previous)
-            this->previous->processReferences(context, self, method);
-        (*method)(context, this, this);
+            (*method)(context, self, this->previous);
+        if (this->key)
+            (*method)(context, self, this->key);
     };
 
     int TupleDictionary::compareList(ProtoContext* context, ProtoList* list)
@@ -229,9 +230,10 @@ namespace proto
             else if (thisElementHash < tupleElementHash)
                 return -1;
         }
-        if (i > thisSize)
+        // Con el prefijo común igual, la tupla más corta es la menor.
+        if (thisSize < tupleSize)
             return -1;
-        else if (i > tupleSize)
+        else if (thisSize > tupleSize)
             return 1;
         return 0;
     }
@@ -431,7 +433,7 @@ namespace proto
         this->elementCount = elementCount;
         this->height = height;
         for (int i = 0; i < TUPLE_SIZE; i++)
-            this->pointers.data[i] = data[i];
+            this->pointers.data[i] = data ? data[i] : PROTO_NONE;
     };
 
     ProtoTupleImplementation::ProtoTupleImplementation(
@@ -444,7 +446,7 @@ namespace proto
         this->elementCount = elementCount;
         this->height = height;
         for (int i = 0; i < TUPLE_SIZE; i++)
-            this->pointers.indirect[i] = indirect[i];
+            this->pointers.indirect[i] = indirect ? indirect[i] : nullptr;
     };
 
     ProtoTupleImplementation::~ProtoTupleImplementation()
@@ -453,73 +455,37 @@ namespace proto
 
     ProtoTupleImplementation* ProtoTupleImplementation::tupleFromList(ProtoContext* context, ProtoList* list)
     {
+        auto* transient = new(context) ProtoTupleTransientImplementation(context, nullptr);
         unsigned long size = list->getSize(context);
-        ProtoTupleImplementation* newTuple = nullptr;
-        ProtoListImplementation *nextLevel, *lastLevel = nullptr;
-        ProtoTupleImplementation* indirectData[TUPLE_SIZE];
-        ProtoObject* data[TUPLE_SIZE];
-
-        ProtoListImplementation* indirectPointers = new(context) ProtoListImplementation(context);
-        unsigned long i, j;
-        for (i = 0, j = 0; i < size; i++)
-        {
-            data[j++] = list->getAt(context, i);
+        for (unsigned long i = 0; i < size; i++)
+            transient->implAppendLast(context, list->getAt(context, i));
 
-            if (j == TUPLE_SIZE)
-            {
-                newTuple = new(context) ProtoTupleImplementation(
-                    context,
-                    TUPLE_SIZE,
-                    0,
-                    data
-                );
-                indirectPointers = indirectPointers->implAppendLast(context, (ProtoObject*)newTuple);
-                j = 0;
-            }
-        }
+        return transient->implPersistent(context);
+    }
 
-        if (j != 0)
-        {
-            unsigned long lastSize = j;
-            for (; j < TUPLE_SIZE; j++)
-                data[j] = nullptr;
-            newTuple = new(context) ProtoTupleImplementation(
-                context,
-                lastSize,
-                0,
-                data
-            );
-            indirectPointers = indirectPointers->implAppendLast(context, (ProtoObject*)newTuple);
-        }
+    ProtoTupleImplementation* ProtoTupleImplementation::tupleFromLeaves(ProtoContext* context, ProtoList* leaves)
+    {
+        ProtoTupleImplementation* newTuple = nullptr;
+        if (leaves->getSize(context) == 1)
+            newTuple = (ProtoTupleImplementation*)leaves->getAt(context, 0);
 
-        if (size > TUPLE_SIZE)
+        // Cada nivel agrupa hasta TUPLE_SIZE nodos del nivel anterior.
+        ProtoList* level = leaves;
+        int levelCount = 0;
+        while (level->getSize(context) > 1)
         {
-            int indirectSize = 0;
-            int levelCount = 0;
-            do
+            levelCount++;
+            auto* nextLevel = toImpl<ProtoListImplementation>(context->newList())->implBeginTransient(context);
+            ProtoTupleImplementation* indirectData[TUPLE_SIZE];
+            unsigned long levelSize = level->getSize(context);
+            unsigned long indirectSize = 0;
+            unsigned long j = 0;
+            for (unsigned long i = 0; i < levelSize; i++)
             {
-                nextLevel = new(context) ProtoListImplementation(context);
-                levelCount++;
-                indirectSize = 0;
-                for (i = 0, j = 0; i < indirectPointers->getSize(context); i++)
-                {
-                    indirectData[j] = (ProtoTupleImplementation*)indirectPointers->getAt(context, i);
-                    indirectSize += indirectData[j]->elementCount;
-                    j++;
-                    if (j == TUPLE_SIZE)
-                    {
-                        newTuple = new(context) ProtoTupleImplementation(
-                            context,
-                            indirectSize,
-                            levelCount,
-                            indirectData
-                        );
-                        indirectSize = 0;
-                        j = 0;
-                        nextLevel = nextLevel->implAppendLast(context, (ProtoObject*)newTuple);
-                    }
-                }
-                if (j != 0)
+                indirectData[j] = (ProtoTupleImplementation*)level->getAt(context, i);
+                indirectSize += indirectData[j]->elementCount;
+                j++;
+                if (j == TUPLE_SIZE || i == levelSize - 1)
                 {
                     for (; j < TUPLE_SIZE; j++)
                         indirectData[j] = nullptr;
@@ -529,13 +495,12 @@ namespace proto
                         levelCount,
                         indirectData
                     );
-                    nextLevel = nextLevel->implAppendLast(context, (ProtoObject*)newTuple);
+                    nextLevel->implAppendLast(context, (ProtoObject*)newTuple);
+                    indirectSize = 0;
+                    j = 0;
                 }
-
-                lastLevel = indirectPointers;
-                indirectPointers = nextLevel;
             }
-            while (nextLevel->getSize(context) > 1);
+            level = nextLevel->implPersistent(context);
         }
 
         TupleDictionary *currentRoot, *newRoot;
@@ -567,15 +532,24 @@ namespace proto
         if (index < 0)
             index = 0;
 
-        int rest = index % TUPLE_SIZE;
+        if ((unsigned long)index >= this->elementCount)
+            return PROTO_NONE;
+
+        // Cada hijo de un nodo de altura h cubre TUPLE_SIZE^h elementos.
+        unsigned long childCapacity = 1;
+        for (unsigned long i = 0; i < this->height; i++)
+            childCapacity *= TUPLE_SIZE;
+
+        unsigned long position = index;
         ProtoTupleImplementation* node = this;
-        for (int i = this->height; i > 0; i--)
+        while (node->height)
         {
-            index = index / TUPLE_SIZE;
-            node = node->pointers.indirect[index];
+            node = node->pointers.indirect[position / childCapacity];
+            position %= childCapacity;
+            childCapacity /= TUPLE_SIZE;
         }
 
-        return node->pointers.data[rest];
+        return node->pointers.data[position];
     };
 
     ProtoObject* ProtoTupleImplementation::implGetFirst(ProtoContext* context)
@@ -876,10 +850,14 @@ namespace proto
         int size = (this->elementCount > TUPLE_SIZE) ? TUPLE_SIZE : this->elementCount;
         for (int i = 0; i < size; i++)
             if (this->height > 0)
-                method(context, self, this->pointers.indirect[i]);
+            {
+                // El último nodo de cada nivel puede estar incompleto.
+                if (this->pointers.indirect[i])
+                    method(context, self, this->pointers.indirect[i]);
+            }
             else
             {
-                if (this->pointers.data[i]->isCell(context))
+                if (this->pointers.data[i] && this->pointers.data[i]->isCell(context))
                     method(context, self, this->pointers.data[i]->asCell(context));
             }
     };
@@ -905,4 +883,174 @@ namespace proto
     {
         return new(context) ProtoTupleIteratorImplementation(context, this, 0);
     };
+
+    ProtoTupleTransientImplementation* ProtoTupleImplementation::implBeginTransient(ProtoContext* context)
+    {
+        return new(context) ProtoTupleTransientImplementation(context, this);
+    };
+
+
+    // --- ProtoTupleTransientImplementation ---
+
+    ProtoTupleTransientImplementation::ProtoTupleTransientImplementation(
+        ProtoContext* context,
+        ProtoTupleImplementation* base
+    ) : Cell(context), current(nullptr), result(nullptr), count(0), sealed(0)
+    {
+        this->leaves = toImpl<ProtoListImplementation>(context->newList())->implBeginTransient(context);
+
+        if (base)
+        {
+            ProtoTupleCursor cursor(context, base);
+            while (cursor.hasNext(context))
+                this->implAppendLast(context, cursor.next(context));
+        }
+    }
+
+    ProtoTupleTransientImplementation::~ProtoTupleTransientImplementation() = default;
+
+    ProtoTupleTransientImplementation* ProtoTupleTransientImplementation::implAppendLast(
+        ProtoContext* context,
+        ProtoObject* value
+    )
+    {
+        if (this->sealed)
+            return nullptr;
+
+        if (!this->current || this->current->elementCount == TUPLE_SIZE)
+        {
+            ProtoObject* empty[TUPLE_SIZE] = {};
+            this->current = new(context) ProtoTupleImplementation(context, 0, 0, empty);
+            this->leaves->implAppendLast(context, (ProtoObject*)this->current);
+        }
+
+        // La hoja actual es propia del editor: se completa en su lugar.
+        this->current->pointers.data[this->current->elementCount] = value;
+        this->current->elementCount++;
+        this->count++;
+        return this;
+    }
+
+    unsigned long ProtoTupleTransientImplementation::implGetSize(ProtoContext* context)
+    {
+        return this->count;
+    }
+
+    ProtoTupleImplementation* ProtoTupleTransientImplementation::implPersistent(ProtoContext* context)
+    {
+        if (this->sealed)
+            return this->result;
+
+        this->result = ProtoTupleImplementation::tupleFromLeaves(context, this->leaves->implPersistent(context));
+        this->current = nullptr;
+        this->sealed = 1;
+        return this->result;
+    }
+
+    unsigned long ProtoTupleTransientImplementation::getHash(ProtoContext* context)
+    {
+        return Cell::getHash(context);
+    }
+
+    ProtoObject* ProtoTupleTransientImplementation::asObject(ProtoContext* context)
+    {
+        return Cell::asObject(context);
+    }
+
+    void ProtoTupleTransientImplementation::finalize(ProtoContext* context)
+    {
+    }
+
+    void ProtoTupleTransientImplementation::processReferences(
+        ProtoContext* context,
+        void* self,
+        void (*method)(
+            ProtoContext* context,
+            void* self,
+            Cell* cell
+        )
+    )
+    {
+        if (this->leaves)
+            method(context, self, this->leaves);
+        if (this->current)
+            method(context, self, this->current);
+        if (this->result)
+            method(context, self, this->result);
+    }
+
+    // --- ProtoTupleCursor ---
+
+    ProtoTupleCursor::ProtoTupleCursor(ProtoContext* context, ProtoTuple* tuple) : leafLevel(0), remaining(0)
+    {
+        auto* node = toImpl<ProtoTupleImplementation>(tuple);
+        if (!node || !node->elementCount)
+            return;
+
+        this->remaining = node->elementCount;
+        this->path[0] = node;
+        this->index[0] = 0;
+        while (node->height)
+        {
+            node = node->pointers.indirect[0];
+            this->leafLevel++;
+            this->path[this->leafLevel] = node;
+            this->index[this->leafLevel] = 0;
+        }
+    }
+
+    // La hoja actual se agotó: sube hasta el primer nivel con un hijo
+    // siguiente y baja por su rama izquierda hasta la próxima hoja.
+    void ProtoTupleCursor::advanceLeaf()
+    {
+        unsigned int level = this->leafLevel - 1;
+        while (this->index[level] + 1 == TUPLE_SIZE)
+            level--;
+
+        this->index[level]++;
+        for (unsigned int l = level + 1; l <= this->leafLevel; l++)
+        {
+            auto* parent = static_cast<ProtoTupleImplementation*>(this->path[l - 1]);
+            this->path[l] = parent->pointers.indirect[this->index[l - 1]];
+            this->index[l] = 0;
+        }
+    }
+
+    bool ProtoTupleCursor::hasNext(ProtoContext* context)
+    {
+        return this->remaining != 0;
+    }
+
+    ProtoObject* ProtoTupleCursor::next(ProtoContext* context)
+    {
+        if (!this->remaining)
+            return PROTO_NONE;
+
+        auto* leaf = static_cast<ProtoTupleImplementation*>(this->path[this->leafLevel]);
+        ProtoObject* value = leaf->pointers.data[this->index[this->leafLevel]++];
+        if (--this->remaining && this->index[this->leafLevel] == TUPLE_SIZE)
+            this->advanceLeaf();
+        return value;
+    }
+
+    unsigned long ProtoTupleCursor::nextChunk(ProtoContext* context, std::span<ProtoObject*> out)
+    {
+        unsigned long copied = 0;
+        while (copied < out.size() && this->remaining)
+        {
+            auto* leaf = static_cast<ProtoTupleImplementation*>(this->path[this->leafLevel]);
+            unsigned char& position = this->index[this->leafLevel];
+            unsigned long n = std::min(
+                std::min((unsigned long) (TUPLE_SIZE - position), this->remaining),
+                (unsigned long) out.size() - copied
+            );
+            for (unsigned long i = 0; i < n; i++)
+                out[copied++] = leaf->pointers.data[position++];
+
+            this->remaining -= n;
+            if (this->remaining && position == TUPLE_SIZE)
+                this->advanceLeaf();
+        }
+        return copied;
+    }
 } // namespace proto
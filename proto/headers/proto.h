@@ -10,6 +10,11 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
 
 
 namespace proto
@@ -57,10 +62,74 @@ namespace proto
 	class ParentLink;
 	class ProtoList;
 	class ProtoListIterator;
+	class ProtoListTransient;
 	class ProtoSparseList;
 	class ProtoSparseListIterator;
+	class ProtoSparseListTransient;
+	class ProtoDictionary;
+	class ProtoSortedMap;
+	class ProtoDeque;
+	class ProtoPriorityQueue;
+	class ProtoTupleTransient;
+	class ProtoListCursor;
+	class ProtoTupleCursor;
+	class ProtoStringCursor;
+	class ProtoSparseListCursor;
 	class ProtoObjectCell;
-
+	class ObjectShape;
+	class MutableShard;
+	class MutablePage;
+
+
+#define PROTO_ATTRIBUTE_CACHE_ENTRIES 4
+#define PROTO_ATTRIBUTE_CACHE_DEPENDENCIES 2
+
+	// Longest root-to-leaf path a cursor can follow. Balanced trees that fit
+	// in memory are far shallower than this.
+#define PROTO_CURSOR_DEPTH 96
+
+	// Mutable objects live in a table of shards, grouped in pages that are
+	// allocated on demand: the table grows without moving. Each thread
+	// reserves a block of ids at a time and hands out dense ids from it; the
+	// unused part of its block is handed to the next thread when it ends.
+#define PROTO_MUTABLE_SHARD_SIZE 1024
+#define PROTO_MUTABLE_PAGE_SIZE 256
+#define PROTO_MUTABLE_MAX_PAGES 16384
+
+	// Call-site cache for attribute lookups.
+	// Keep one per lookup site and pass it to getAttribute / hasAttribute.
+	// It remembers where a name was resolved for a given receiver shape and
+	// parent chain, so a hit is a shape compare plus either one indexed load
+	// (own attributes) or the cached value itself (inherited ones). The first
+	// entry is the monomorphic fast path and the rest are a small polymorphic
+	// fallback. Each entry also remembers the version of the mutable objects
+	// the lookup went through (up to PROTO_ATTRIBUTE_CACHE_DEPENDENCIES of
+	// them); a write to one of those invalidates it, while writes to
+	// unrelated mutable objects do not.
+	// A cache must not be shared between threads.
+	class ProtoAttributeCache
+	{
+	public:
+		ProtoAttributeCache();
+		void reset();
+
+		struct Entry
+		{
+			ObjectShape* shape;       // receiver shape
+			ProtoObject* prototype;   // receiver first parent
+			ParentLink* ancestors;    // rest of the receiver parent chain
+			ProtoObject* holder;      // object holding the value, nullptr for the receiver
+			long slot;                // slot in the receiver shape, -1 if value is cached
+			ProtoObject* value;       // cached value (when slot is -1)
+			unsigned int dependencyCount;
+			std::atomic<unsigned long>* versions[PROTO_ATTRIBUTE_CACHE_DEPENDENCIES];
+			unsigned long expected[PROTO_ATTRIBUTE_CACHE_DEPENDENCIES];
+		};
+
+		unsigned long key;
+		unsigned int nextVictim;
+		Entry entries[PROTO_ATTRIBUTE_CACHE_ENTRIES];
+	};
 
 	typedef ProtoObject*(*ProtoMethod)(
 		ProtoContext*, // context
@@ -70,6 +139,36 @@ namespace proto
 		ProtoSparseList* // keywordParameters
 	);
 
+	// Fixed-arity calling convention: positional arguments are passed in a
+	// caller owned array (usually on the C++ stack), so no list is allocated.
+	// Calls with keyword arguments or more than PROTO_MAX_FAST_ARGS arguments
+	// go to the method's generic entry (see ProtoContext::fromFastMethod).
+#define PROTO_MAX_FAST_ARGS 8
+
+	typedef ProtoObject*(*ProtoFastMethod)(
+		ProtoContext*, // context
+		ProtoObject*, // self
+		ParentLink*, // parentLink
+		unsigned int, // argc
+		ProtoObject** // argv
+	);
+
+	// Resolves a key present in both operands of a sparse-list set operation.
+	typedef ProtoObject*(*ProtoMergeFunction)(
+		ProtoContext*, // context
+		void*, // self
+		unsigned long, // key
+		ProtoObject*, // value in the receiver
+		ProtoObject* // value in the other list
+	);
+
+	// Total order between two keys: negative, zero or positive.
+	typedef int(*ProtoCompareFunction)(
+		ProtoContext*, // context
+		ProtoObject*, // a
+		ProtoObject* // b
+	);
+
 	class ProtoObject
 	{
 	public:
@@ -77,24 +176,61 @@ namespace proto
 		ProtoObject* clone(ProtoContext* c, bool isMutable = false);
 		ProtoObject* newChild(ProtoContext* c, bool isMutable = false);
 
-		ProtoObject* getAttribute(ProtoContext* c, ProtoString* name);
-		ProtoObject* hasAttribute(ProtoContext* c, ProtoString* name);
+		ProtoObject* getAttribute(ProtoContext* c, ProtoString* name, ProtoAttributeCache* cache = nullptr);
+		ProtoObject* hasAttribute(ProtoContext* c, ProtoString* name, ProtoAttributeCache* cache = nullptr);
 		ProtoObject* hasOwnAttribute(ProtoContext* c, ProtoString* name);
 		ProtoObject* setAttribute(ProtoContext* c, ProtoString* name, ProtoObject* value);
+		// Sets count attributes at once, producing a single new version of the object.
+		// If a name appears more than once, the last value wins.
+		ProtoObject* setAttributes(ProtoContext* c, unsigned int count, ProtoString** names, ProtoObject** values);
 
 		ProtoSparseList* getAttributes(ProtoContext* c);
 		ProtoSparseList* getOwnAttributes(ProtoContext* c);
+		// Visits every visible attribute (own and inherited) without building a list.
+		// Inherited attributes shadowed by a closer object are skipped.
+		void processAttributes(
+			ProtoContext* c,
+			void* self,
+			void (*method)(
+				ProtoContext* context,
+				void* self,
+				unsigned long key,
+				ProtoObject* value
+			)
+		);
 		ProtoList* getParents(ProtoContext* c);
 
 		ProtoObject* addParent(ProtoContext* c, ProtoObject* newParent);
+
+		// Returns the frozen version of the object and freezes the mutable objects
+		// in its parent chain. An immutable object is frozen into a copy; a
+		// mutable one keeps its identity and is frozen in place. A frozen object
+		// never changes: setAttribute / setAttributes / addParent reject the
+		// write and return NONE. Its visible attributes (own and inherited) are copied to a
+		// flat table, so reads do not walk the parent chain and call-site caches
+		// never need to revalidate them.
+		ProtoObject* freeze(ProtoContext* c);
+		ProtoObject* isFrozen(ProtoContext* c);
 		ProtoObject* isInstanceOf(ProtoContext* c, const ProtoObject* prototype);
 
+		// Resolves 'method' starting at this object (or at nextParent for a
+		// super-call) and invokes it on 'self'. The method receives the parent
+		// link where a super-call must continue: the objects that follow its
+		// holder in the receiver's resolution order.
 		ProtoObject* call(ProtoContext* c,
 		                  ParentLink* nextParent,
 		                  ProtoString* method,
 		                  ProtoObject* self,
 		                  ProtoList* unnamedParametersList = nullptr,
-		                  ProtoSparseList* keywordParametersDict = nullptr);
+		                  ProtoSparseList* keywordParametersDict = nullptr,
+		                  ProtoAttributeCache* cache = nullptr);
+		ProtoObject* callFast(ProtoContext* c,
+		                      ParentLink* nextParent,
+		                      ProtoString* method,
+		                      ProtoObject* self,
+		                      unsigned int argc = 0,
+		                      ProtoObject** argv = nullptr,
+		                      ProtoAttributeCache* cache = nullptr);
 
 		unsigned long getHash(ProtoContext* context);
 		int isCell(ProtoContext* context);
@@ -137,6 +273,10 @@ namespace proto
 		ProtoStringIterator * asStringIterator(ProtoContext *context);
 		ProtoSparseList * asSparseList(ProtoContext *context);
 		ProtoSparseListIterator * asSparseListIterator(ProtoContext *context);
+		ProtoDictionary * asDictionary(ProtoContext *context);
+		ProtoSortedMap * asSortedMap(ProtoContext *context);
+		ProtoDeque * asDeque(ProtoContext *context);
+		ProtoPriorityQueue * asPriorityQueue(ProtoContext *context);
 
 	};
 
@@ -190,6 +330,40 @@ namespace proto
 		ProtoObject* asObject(ProtoContext* context) ;
 		unsigned long getHash(ProtoContext* context) ;
 		ProtoListIterator* getIterator(ProtoContext* context) ;
+		ProtoListTransient* beginTransient(ProtoContext* context) ;
+	};
+
+	// Transient editors build a collection in place: the nodes they allocate
+	// are owned by the editor and filled without copying. persistent() seals
+	// the result into an ordinary immutable value; after that the editor
+	// rejects further changes (they return nullptr).
+	class ProtoListTransient
+	{
+	public:
+		ProtoListTransient* appendLast(ProtoContext* context, ProtoObject* value) ;
+		unsigned long getSize(ProtoContext* context) ;
+		ProtoList* persistent(ProtoContext* context) ;
+	};
+
+	// Cursors walk a collection in order without allocating. They live on the
+	// C++ stack and keep the path from the root to the current element, so
+	// each step is amortized O(1). nextChunk copies up to out.size() elements
+	// and returns how many it copied. The collection must stay reachable while
+	// the cursor is in use.
+	class ProtoListCursor
+	{
+	public:
+		ProtoListCursor(ProtoContext* context, ProtoList* list);
+		bool hasNext(ProtoContext* context);
+		ProtoObject* next(ProtoContext* context);
+		unsigned long nextChunk(ProtoContext* context, std::span<ProtoObject*> out);
+
+	private:
+		void pushLeftmost(Cell* node);
+
+		Cell* stack[PROTO_CURSOR_DEPTH];   // nodes whose elements are still pending
+		unsigned int depth;
+		unsigned int offset;               // next element in the top node
 	};
 
 	class ProtoTupleIterator
@@ -231,6 +405,15 @@ namespace proto
 		ProtoObject* asObject(ProtoContext* context) ;
 		unsigned long getHash(ProtoContext* context) ;
 		ProtoTupleIterator* getIterator(ProtoContext* context) ;
+		ProtoTupleTransient* beginTransient(ProtoContext* context) ;
+	};
+
+	class ProtoTupleTransient
+	{
+	public:
+		ProtoTupleTransient* appendLast(ProtoContext* context, ProtoObject* value) ;
+		unsigned long getSize(ProtoContext* context) ;
+		ProtoTuple* persistent(ProtoContext* context) ;
 	};
 
 	class ProtoStringIterator
@@ -244,6 +427,30 @@ namespace proto
 		ProtoObject* asObject(ProtoContext* context) ;
 	};
 
+	class ProtoTupleCursor
+	{
+	public:
+		ProtoTupleCursor(ProtoContext* context, ProtoTuple* tuple);
+		bool hasNext(ProtoContext* context);
+		ProtoObject* next(ProtoContext* context);
+		unsigned long nextChunk(ProtoContext* context, std::span<ProtoObject*> out);
+
+	private:
+		void advanceLeaf();
+
+		Cell* path[PROTO_CURSOR_DEPTH];            // one node per level, root first
+		unsigned char index[PROTO_CURSOR_DEPTH];   // position inside each node
+		unsigned int leafLevel;
+		unsigned long remaining;
+	};
+
+	// Walks the characters of a string, as a tuple cursor over its storage.
+	class ProtoStringCursor : public ProtoTupleCursor
+	{
+	public:
+		ProtoStringCursor(ProtoContext* context, ProtoString* string);
+	};
+
 	class ProtoString
 	{
 	public:
@@ -289,6 +496,28 @@ namespace proto
 		void finalize(ProtoContext* context) ;
 	};
 
+	// Ordered cursor over a sparse list: visits keys in increasing order
+	// without allocating. seek() moves to the first key >= the given one, so
+	// a range scan costs O(log n + k).
+	class ProtoSparseListCursor
+	{
+	public:
+		ProtoSparseListCursor(ProtoContext* context, ProtoSparseList* list);
+		bool hasNext(ProtoContext* context);
+		unsigned long nextKey(ProtoContext* context);
+		ProtoObject* nextValue(ProtoContext* context);
+		void advance(ProtoContext* context);
+		void seek(ProtoContext* context, unsigned long key);
+
+	private:
+		void pushLeftmost(Cell* node);
+		void skipEmpty();
+
+		Cell* root;
+		Cell* stack[PROTO_CURSOR_DEPTH];   // top is the current node
+		unsigned int depth;
+	};
+
 	class ProtoSparseList
 	{
 	public:
@@ -298,11 +527,34 @@ namespace proto
 		ProtoSparseList* setAt(ProtoContext* context, unsigned long index, ProtoObject* value) ;
 		ProtoSparseList* removeAt(ProtoContext* context, unsigned long index) ;
 		int isEqual(ProtoContext* context, ProtoSparseList* otherDict) ;
+		bool isOrdered(ProtoContext* context) ;
+
+		// Ordered queries. Ranges are half open, [from, to), and cost O(log n).
+		// sliceRange and removeRange share every subtree outside the cut path.
+		// The key lookups return false when there is no such key.
+		unsigned long countRange(ProtoContext* context, unsigned long from, unsigned long to) ;
+		ProtoSparseList* sliceRange(ProtoContext* context, unsigned long from, unsigned long to) ;
+		ProtoSparseList* removeRange(ProtoContext* context, unsigned long from, unsigned long to) ;
+		bool firstKey(ProtoContext* context, unsigned long* key) ;
+		bool lastKey(ProtoContext* context, unsigned long* key) ;
+		bool floor(ProtoContext* context, unsigned long key, unsigned long* found) ;
+		bool ceiling(ProtoContext* context, unsigned long key, unsigned long* found) ;
+
+		// Set algebra by key. Untouched subtrees of both operands are shared.
+		// Without a merge function, unionWith keeps the value of other and
+		// intersectionWith keeps the value of the receiver. A merge function
+		// that returns NONE drops the key.
+		ProtoSparseList* unionWith(ProtoContext* context, ProtoSparseList* other,
+		                           void* self = nullptr, ProtoMergeFunction merge = nullptr) ;
+		ProtoSparseList* intersectionWith(ProtoContext* context, ProtoSparseList* other,
+		                                  void* self = nullptr, ProtoMergeFunction merge = nullptr) ;
+		ProtoSparseList* differenceWith(ProtoContext* context, ProtoSparseList* other) ;
 
 		unsigned long getSize(ProtoContext* context) ;
 		ProtoObject* asObject(ProtoContext* context) ;
 		unsigned long getHash(ProtoContext* context) ;
 		ProtoSparseListIterator* getIterator(ProtoContext* context) ;
+		ProtoSparseListTransient* beginTransient(ProtoContext* context) ;
 
 		void processElements(
 			ProtoContext* context,
@@ -326,6 +578,160 @@ namespace proto
 		) ;
 	};
 
+	class ProtoSparseListTransient
+	{
+	public:
+		ProtoSparseListTransient* setAt(ProtoContext* context, unsigned long index, ProtoObject* value) ;
+		ProtoSparseListTransient* removeAt(ProtoContext* context, unsigned long index) ;
+		ProtoSparseList* persistent(ProtoContext* context) ;
+	};
+
+	// Persistent hash map over arbitrary keys. Keys match by content: strings,
+	// tuples and lists element by element, sparse lists and dictionaries entry
+	// by entry, and any other value by identity. Setting NONE removes the key.
+	// A dictionary created with insertionOrder visits its entries in the order
+	// their keys were first added; otherwise the order is unspecified.
+	class ProtoDictionary
+	{
+	public:
+		bool has(ProtoContext* context, ProtoObject* key) ;
+		ProtoObject* getAt(ProtoContext* context, ProtoObject* key) ;
+		ProtoDictionary* setAt(ProtoContext* context, ProtoObject* key, ProtoObject* value) ;
+		ProtoDictionary* removeAt(ProtoContext* context, ProtoObject* key) ;
+		unsigned long getSize(ProtoContext* context) ;
+		bool keepsInsertionOrder(ProtoContext* context) ;
+
+		ProtoObject* asObject(ProtoContext* context) ;
+		unsigned long getHash(ProtoContext* context) ;
+
+		void processElements(
+			ProtoContext* context,
+			void* self,
+			void (*method)(
+				ProtoContext* context,
+				void* self,
+				ProtoObject* key,
+				ProtoObject* value
+			)
+		) ;
+	};
+
+	// Persistent ordered map over arbitrary keys, kept as a B+tree. The
+	// comparator fixes the order; two keys it finds equal are the same key.
+	// The built-in comparators are recognized by the map and run inline:
+	// compareNumbers orders embedded values (integers and floats by value,
+	// timestamps, dates and time deltas chronologically) and compareStrings
+	// orders strings by code point. Setting NONE removes the key.
+	class ProtoSortedMap
+	{
+	public:
+		static int compareNumbers(ProtoContext* context, ProtoObject* a, ProtoObject* b);
+		static int compareStrings(ProtoContext* context, ProtoObject* a, ProtoObject* b);
+
+		bool has(ProtoContext* context, ProtoObject* key) ;
+		ProtoObject* getAt(ProtoContext* context, ProtoObject* key) ;
+		ProtoSortedMap* setAt(ProtoContext* context, ProtoObject* key, ProtoObject* value) ;
+		ProtoSortedMap* removeAt(ProtoContext* context, ProtoObject* key) ;
+		unsigned long getSize(ProtoContext* context) ;
+
+		// Ordered queries, O(log n). They return NONE when there is no such key.
+		ProtoObject* firstKey(ProtoContext* context) ;
+		ProtoObject* lastKey(ProtoContext* context) ;
+		ProtoObject* floor(ProtoContext* context, ProtoObject* key) ;
+		ProtoObject* ceiling(ProtoContext* context, ProtoObject* key) ;
+
+		// Rank and select: rank counts the keys below key; keyAt and valueAt
+		// take a rank, from 0 to getSize() - 1.
+		unsigned long rank(ProtoContext* context, ProtoObject* key) ;
+		ProtoObject* keyAt(ProtoContext* context, unsigned long index) ;
+		ProtoObject* valueAt(ProtoContext* context, unsigned long index) ;
+
+		// Range scans over [from, to), in key order. NONE leaves that end open.
+		unsigned long countRange(ProtoContext* context, ProtoObject* from, ProtoObject* to) ;
+		void processRange(
+			ProtoContext* context,
+			ProtoObject* from,
+			ProtoObject* to,
+			void* self,
+			void (*method)(
+				ProtoContext* context,
+				void* self,
+				ProtoObject* key,
+				ProtoObject* value
+			)
+		) ;
+		void processElements(
+			ProtoContext* context,
+			void* self,
+			void (*method)(
+				ProtoContext* context,
+				void* self,
+				ProtoObject* key,
+				ProtoObject* value
+			)
+		) ;
+
+		ProtoObject* asObject(ProtoContext* context) ;
+		unsigned long getHash(ProtoContext* context) ;
+	};
+
+	// Persistent double-ended queue (a 2-3 finger tree). Adding or removing
+	// at either end is amortized O(1); getAt, getSlice, the splits and
+	// extend are O(log n). The read methods follow ProtoList, including
+	// negative indexes counted from the end.
+	class ProtoDeque
+	{
+	public:
+		ProtoObject* getAt(ProtoContext* context, int index) ;
+		ProtoObject* getFirst(ProtoContext* context) ;
+		ProtoObject* getLast(ProtoContext* context) ;
+		ProtoDeque* getSlice(ProtoContext* context, int from, int to) ;
+		unsigned long getSize(ProtoContext* context) ;
+		bool has(ProtoContext* context, ProtoObject* value) ;
+
+		ProtoDeque* appendFirst(ProtoContext* context, ProtoObject* value) ;
+		ProtoDeque* appendLast(ProtoContext* context, ProtoObject* value) ;
+		ProtoDeque* removeFirst(ProtoContext* context) ;
+		ProtoDeque* removeLast(ProtoContext* context) ;
+
+		ProtoDeque* extend(ProtoContext* context, ProtoDeque* other) ;
+		ProtoDeque* splitFirst(ProtoContext* context, int index) ;
+		ProtoDeque* splitLast(ProtoContext* context, int index) ;
+
+		void processValues(
+			ProtoContext* context,
+			void* self,
+			void (*method)(
+				ProtoContext* context,
+				void* self,
+				ProtoObject* value
+			)
+		) ;
+		ProtoList* asList(ProtoContext* context) ;
+		ProtoObject* asObject(ProtoContext* context) ;
+		unsigned long getHash(ProtoContext* context) ;
+	};
+
+	// Persistent min-priority queue (a bootstrapped skew-binomial heap).
+	// insert, getMinKey, getMin and meld are O(1) and removeMin is O(log n),
+	// all worst case, so the bounds hold for every version. Keys are
+	// embedded values (integers, floats, timestamps, dates, time deltas),
+	// ordered as ProtoSortedMap::compareNumbers; insert returns nullptr for
+	// any other key. Values with equal keys come out in no particular order.
+	class ProtoPriorityQueue
+	{
+	public:
+		ProtoPriorityQueue* insert(ProtoContext* context, ProtoObject* key, ProtoObject* value) ;
+		ProtoObject* getMinKey(ProtoContext* context) ;
+		ProtoObject* getMin(ProtoContext* context) ;
+		ProtoPriorityQueue* removeMin(ProtoContext* context) ;
+		ProtoPriorityQueue* meld(ProtoContext* context, ProtoPriorityQueue* other) ;
+		unsigned long getSize(ProtoContext* context) ;
+
+		ProtoObject* asObject(ProtoContext* context) ;
+		unsigned long getHash(ProtoContext* context) ;
+	};
+
 	class ProtoByteBuffer
 	{
 	public:
@@ -429,9 +835,6 @@ namespace proto
 
 		ProtoObject* asObject(ProtoContext* context) ;
 		unsigned long getHash(ProtoContext* context) ;
-
-		ProtoMethod method{};
-		ProtoObject* self{};
 	};
 
 	class ProtoObjectCell
@@ -498,6 +901,9 @@ namespace proto
 		ProtoObject* fromUTF8Char(const char* utf8OneCharString);
 		ProtoString* fromUTF8String(const char* zeroTerminatedUtf8String);
 		ProtoMethodCell* fromMethod(ProtoObject* self, ProtoMethod method);
+		// 'generic', if given, receives the calls that do not fit the fixed-arity
+		// convention; without it those calls return NONE.
+		ProtoMethodCell* fromFastMethod(ProtoObject* self, ProtoFastMethod method, ProtoMethod generic = nullptr);
 		ProtoExternalPointer* fromExternalPointer(void* pointer);
 		ProtoByteBuffer* fromBuffer(unsigned long length, char* buffer);
 		ProtoByteBuffer* newBuffer(unsigned long length);
@@ -508,9 +914,36 @@ namespace proto
 		ProtoObject* fromTimeDelta(long timedelta);
 
 		ProtoList* newList();
+		// Builds a balanced list in one pass, without rebalancing per element.
+		ProtoList* newListFromArray(ProtoObject* const* values, unsigned long count);
+		template<typename Iterator>
+		ProtoList* newListFromRange(Iterator first, Iterator last)
+		{
+			if constexpr (std::contiguous_iterator<Iterator> &&
+			              std::is_same_v<std::iter_value_t<Iterator>, ProtoObject*>)
+				return this->newListFromArray(std::to_address(first), (unsigned long) (last - first));
+			else
+			{
+				std::vector<ProtoObject*> values(first, last);
+				return this->newListFromArray(values.data(), values.size());
+			}
+		}
 		ProtoTuple* newTuple();
 		ProtoTuple* newTupleFromList(ProtoList* sourceList);
 		ProtoSparseList* newSparseList();
+		// Hash-ordered sparse list: cheaper updates, no key order. Ordered
+		// queries still work, converting to the ordered form first.
+		ProtoSparseList* newUnorderedSparseList();
+		ProtoDictionary* newDictionary(bool insertionOrder = false);
+		ProtoSortedMap* newSortedMap(ProtoCompareFunction compare = ProtoSortedMap::compareNumbers);
+		// Bulk load in O(n) from keys already in strictly increasing order.
+		// Returns nullptr if they are not.
+		ProtoSortedMap* newSortedMapFromArray(ProtoCompareFunction compare,
+		                                      ProtoObject* const* keys,
+		                                      ProtoObject* const* values,
+		                                      unsigned long count);
+		ProtoDeque* newDeque();
+		ProtoPriorityQueue* newPriorityQueue();
 		ProtoObject* newObject(bool mutableObject = false);
 
 		Cell* allocCell();
@@ -561,12 +994,29 @@ namespace proto
 		ProtoObject* sparseListPrototype;
 		ProtoObject* sparseListIteratorPrototype;
 
+		ProtoObject* dictionaryPrototype;
+		ProtoObject* sortedMapPrototype;
+		ProtoObject* dequePrototype;
+		ProtoObject* priorityQueuePrototype;
+
 		ProtoString* literalGetAttribute;
 		ProtoString* literalSetAttribute;
 		ProtoString* literalCallMethod;
 
 		Cell* getFreeCells(ProtoThread* currentThread);
 		void analyzeUsedCells(Cell* cellsChain);
+		// Moves the given cells to the immortal region. Their references to
+		// cells outside the region are remembered as collector roots.
+		void pinCells(ProtoContext* context, unsigned long count, Cell** cells);
+		// Moves every cell allocated so far in the context to the immortal
+		// region: it is never swept nor traced again, and only the cells it
+		// references outside the region are kept as collector roots.
+		void makeImmortal(ProtoContext* context);
+		// Write barrier for the immortal region: call it after storing 'target'
+		// into a field of 'owner' once the region was built. The region is not
+		// traced, so the owner is remembered and the collector scans its current
+		// fields on every cycle; a replaced value stops being a root.
+		void rememberReference(ProtoContext* context, Cell* owner, Cell* target);
 		void triggerGC();
 		void allocThread(ProtoContext* context, ProtoThread* thread);
 		void deallocThread(ProtoContext* context, ProtoThread* thread);
@@ -586,7 +1036,14 @@ namespace proto
 		int blockOnNoMemory;
 
 		std::atomic<TupleDictionary*> tupleRoot;
-		std::atomic<ProtoSparseList*> mutableRoot;
+		ObjectShape* rootShape;
+		std::atomic<unsigned long> immortalCells;
+		std::atomic<ProtoSparseList*> rememberedCells;     // References out of the region when it was pinned.
+		std::atomic<ProtoSparseList*> rememberedOwners;    // Immortal cells whose fields changed afterwards.
+		std::atomic<MutablePage*> mutablePages[PROTO_MUTABLE_MAX_PAGES];
+		std::atomic<unsigned long> mutableShardCount;
+		// Unused id ranges left by threads that ended; guarded by mutableLock.
+		std::vector<std::pair<unsigned long, unsigned long>> freeMutableBlocks;
 		std::atomic<bool> mutableLock;
 		std::atomic<bool> threadsLock;
 		std::atomic<bool> gcLock;
@@ -20,13 +20,31 @@ namespace proto
     class ProtoObjectCellImplementation;
     class ParentLinkImplementation;
     class ProtoListImplementation;
+    class ProtoListTransientImplementation;
+    class SparseListCell;
     class ProtoSparseListImplementation;
+    class ProtoSparseHashImplementation;
+    class ProtoSparseArrayImplementation;
+    class ProtoSparseListTransientImplementation;
+    class DictionaryEntry;
+    class ProtoDictionaryImplementation;
+    class CollectionCell;
+    class SortedMapNode;
+    class ProtoSortedMapImplementation;
+    class DequeNode;
+    class ProtoDequeImplementation;
+    class HeapNode;
+    class ProtoPriorityQueueImplementation;
+    class ProtoTupleTransientImplementation;
     class ProtoTupleImplementation;
     class ProtoStringImplementation;
     class ProtoMethodCellImplementation;
     class ProtoExternalPointerImplementation;
     class ProtoByteBufferImplementation;
     class ProtoThreadImplementation;
+    class ObjectShape;
+    class AttributeSlots;
+    class ResolutionOrder;
 
     // Union for pointer tagging
     union ProtoObjectPointer
@@ -151,6 +169,13 @@ namespace proto
 #define POINTER_TAG_EXTERNAL_POINTER        11
 #define POINTER_TAG_METHOD                  12
 #define POINTER_TAG_THREAD                  13
+#define POINTER_TAG_DICTIONARY              14
+#define POINTER_TAG_COLLECTION              15
+
+    // Colecciones que comparten POINTER_TAG_COLLECTION (campo kind de CollectionCell)
+#define COLLECTION_SORTED_MAP               0
+#define COLLECTION_DEQUE                    1
+#define COLLECTION_PRIORITY_QUEUE           2
 
     // Embedded types
 #define EMBEDED_TYPE_SMALLINT               0
@@ -183,6 +208,50 @@ namespace proto
 
 #define TYPE_SHIFT                          4
 
+    // Formas (hidden classes) de los objetos
+#define SHAPE_MAX_SLOTS                     64
+#define SLOTS_SIZE                          5
+#define OBJECT_INLINE_SLOTS                 3
+
+    // Orden de resolución de prototipos
+#define RESOLUTION_ORDER_SIZE               4
+#define PARENT_LINK_INLINE_DEPTH            3   // 'object' y los dos ancestros que caben en la celda.
+
+    // Representaciones de una lista dispersa (campo type de SparseListCell)
+#define SPARSE_LIST_TREE                    0
+#define SPARSE_LIST_HASH                    1
+#define SPARSE_LIST_ARRAY                   3
+
+    // Bits de la clave que consume cada nivel del trie de hash
+#define SPARSE_HASH_BITS                    5
+#define SPARSE_HASH_FANOUT                  (1 << SPARSE_HASH_BITS)
+
+    // Hijos que un nodo del trie de hash guarda en su propia celda, y punteros
+    // de cada bloque de un nodo ancho
+#define SPARSE_HASH_NODE_SLOTS              5
+#define SPARSE_HASH_CHUNK_SIZE              6
+
+    // Marcas en los bits bajos de los punteros a hijos del trie de hash
+#define SPARSE_HASH_TAG_NODE                0
+#define SPARSE_HASH_TAG_LEAF                1
+#define SPARSE_HASH_TAG_WIDE                2
+#define SPARSE_HASH_TAG_MASK                3
+
+    // Una lista dispersa pasa a vector denso desde este tamaño, mientras el
+    // rango de claves no supere SPARSE_ARRAY_DENSITY veces la cantidad de elementos
+#define SPARSE_ARRAY_MIN_SIZE               8
+#define SPARSE_ARRAY_DENSITY                2
+
+    // Pares que guarda una hoja y subárboles que guarda un nodo interior de un mapa ordenado
+#define SORTED_MAP_LEAF_SIZE                2
+#define SORTED_MAP_FANOUT                   3
+
+    // Elementos de un dígito del árbol de dedos de una cola doble
+#define DEQUE_DIGIT_SIZE                    4
+
+    // Cantidad de elementos que guarda cada nodo de una lista
+#define LIST_CHUNK_SIZE                     3
+
     // Plantilla para convertir de puntero a la API pública a puntero a la implementación
     template <typename Impl, typename Api>
     inline Impl* toImpl(Api* ptr)
@@ -197,7 +266,57 @@ namespace proto
         return reinterpret_cast<const Impl*>(ptr);
     }
 
-    unsigned long generate_mutable_ref();
+    /**
+     * @brief Bloque de la tabla de objetos mutables.
+     *
+     * Cada posición guarda la versión actual de un objeto mutable y se
+     * actualiza con CAS, así que los objetos mutables no compiten entre sí.
+     * El contador de cada posición avanza con cada escritura; los caches de
+     * búsqueda lo usan para saber si el objeto cambió.
+     */
+    class MutableShard
+    {
+    public:
+        std::atomic<ProtoObject*> values[PROTO_MUTABLE_SHARD_SIZE];
+        std::atomic<unsigned long> versions[PROTO_MUTABLE_SHARD_SIZE];
+    };
+
+    /**
+     * @brief Página del directorio de bloques de la tabla de objetos mutables.
+     */
+    class MutablePage
+    {
+    public:
+        std::atomic<MutableShard*> shards[PROTO_MUTABLE_PAGE_SIZE];
+    };
+
+    /**
+     * @brief Reserva un identificador denso para un objeto mutable.
+     *
+     * Los identificadores se toman del bloque reservado por el hilo actual;
+     * 0 queda reservado para los objetos inmutables y se devuelve sólo si el
+     * contexto no tiene espacio. Si la tabla se agota el proceso termina con
+     * un error, como cuando se agota el heap.
+     */
+    unsigned long generate_mutable_ref(ProtoContext* context);
+
+    /**
+     * @brief Devuelve al espacio lo que el hilo actual no usó de su bloque.
+     *
+     * Se llama cuando el hilo termina; el siguiente hilo que necesite
+     * identificadores continúa ese bloque antes de reservar uno nuevo.
+     */
+    void release_mutable_block(ProtoSpace* space);
+
+    /**
+     * @brief Devuelve la posición de la tabla que corresponde a un identificador.
+     */
+    std::atomic<ProtoObject*>* getMutableSlot(ProtoSpace* space, unsigned long mutable_ref);
+
+    /**
+     * @brief Devuelve el contador de escrituras del objeto mutable con ese identificador.
+     */
+    std::atomic<unsigned long>* getMutableVersion(ProtoSpace* space, unsigned long mutable_ref);
 
     class Cell
     {
@@ -221,6 +340,30 @@ namespace proto
         virtual unsigned long getHash(ProtoContext* context);
         virtual ProtoObject* asObject(ProtoContext* context);
 
+        /**
+         * @brief Indica si la celda pertenece a la región inmortal.
+         *
+         * Las celdas están alineadas, así que el bit bajo de nextCell queda
+         * libre y es la marca: la consulta es una sola carga.
+         */
+        bool isImmortal() const
+        {
+            return reinterpret_cast<unsigned long>(this->nextCell) & CELL_IMMORTAL_MARK;
+        }
+
+        void markImmortal()
+        {
+            this->nextCell = reinterpret_cast<Cell*>(reinterpret_cast<unsigned long>(this->nextCell) | CELL_IMMORTAL_MARK);
+        }
+
+        // La siguiente celda de la cadena, sin la marca.
+        Cell* getNextCell() const
+        {
+            return reinterpret_cast<Cell*>(reinterpret_cast<unsigned long>(this->nextCell) & ~CELL_IMMORTAL_MARK);
+        }
+
+        static constexpr unsigned long CELL_IMMORTAL_MARK = 1;
+
         Cell* nextCell;
     };
 
@@ -255,6 +398,23 @@ namespace proto
 
     static_assert(sizeof(BigCell) == 64, "El tamaño de la clase BigCell debe ser exactamente 64 bytes.");
 
+    /**
+     * @brief Raíz de una colección etiquetada con POINTER_TAG_COLLECTION.
+     *
+     * Las etiquetas de puntero tienen 4 bits y ya no quedan libres; las
+     * colecciones que se agreguen comparten la última y se distinguen por `kind`.
+     */
+    class CollectionCell : public Cell
+    {
+    public:
+        CollectionCell(ProtoContext* context, unsigned long kind);
+
+        ProtoObject* implAsObject(ProtoContext* context);
+        static CollectionCell* fromObject(ProtoObject* object, unsigned long kind);
+
+        unsigned long kind;
+    };
+
 
     class ParentLinkImplementation : public Cell, public ParentLink
     {
@@ -270,7 +430,1279 @@ namespace proto
         unsigned long getHash(ProtoContext* context);
 
         void finalize(ProtoContext* context);
-
+
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+        /**
+         * @brief Devuelve el orden de resolución (C3) de la cadena que empieza en este eslabón.
+         *
+         * Se calcula la primera vez que se pide y queda guardado en el eslabón.
+         * Los eslabones son inmutables, así que un cambio de padres crea una
+         * cadena nueva con su propio orden.
+         */
+        ResolutionOrder* implGetResolutionOrder(ProtoContext* context);
+
+        /**
+         * @brief Busca un atributo en los objetos del orden de resolución.
+         * @param holder Si no es nulo, recibe el objeto donde se encontró el atributo.
+         * @param dependencies Si no es nulo, recibe las versiones de los objetos
+         *        mutables recorridos hasta resolver el nombre.
+         */
+        ProtoObject* implLookupAttribute(
+            ProtoContext* context,
+            unsigned long key,
+            ProtoObjectCellImplementation** holder = nullptr,
+            ProtoAttributeCache::Entry* dependencies = nullptr
+        );
+
+        /**
+         * @brief Cadena donde continúa una llamada a super hecha desde 'holder':
+         *        el resto del orden de resolución de esta cadena después de él.
+         *
+         * En una cadena lineal es el padre de 'holder'. Con herencia múltiple
+         * se arma una cadena nueva con los objetos que siguen, que recibe ya
+         * calculado su orden (comparte los bloques del original).
+         */
+        ParentLinkImplementation* implGetNextAfter(
+            ProtoContext* context,
+            ProtoObjectCellImplementation* holder
+        );
+
+        /**
+         * @brief Indica si la cadena tiene al prototipo entre sus ancestros.
+         *
+         * Con herencia simple basta con una lectura del vector de ancestros
+         * (display) en la profundidad del prototipo; en una cadena lineal de
+         * hasta PARENT_LINK_INLINE_DEPTH objetos esa lectura es del propio
+         * eslabón. Con herencia múltiple, la máscara de ancestros descarta
+         * casi todos los casos negativos y sólo el resto recorre el orden de
+         * resolución.
+         */
+        bool implHasAncestor(ProtoContext* context, ProtoObjectCellImplementation* prototype);
+
+        /**
+         * @brief Vector indexado por profundidad con los ancestros del linaje principal.
+         */
+        AttributeSlots* implGetDisplay(ProtoContext* context);
+
+        /**
+         * @brief Indica si el display está en el propio eslabón (ver 'rootAncestor').
+         */
+        bool implHasInlineDisplay() const
+        {
+            return this->linear && this->depth <= PARENT_LINK_INLINE_DEPTH;
+        }
+
+        /**
+         * @brief Ancestro del linaje principal en la profundidad dada (< depth),
+         *        para un eslabón con el display en la celda.
+         */
+        ProtoObjectCellImplementation* implGetInlineAncestor(unsigned long index) const
+        {
+            if (index + 1 == this->depth)
+                return this->object;
+            return index ? this->middleAncestor : this->rootAncestor;
+        }
+
+        /**
+         * @brief Unión de los bits de todos los ancestros de la cadena.
+         */
+        unsigned long implGetAncestorMask() const;
+
+        /**
+         * @brief Profundidad en el linaje principal de un objeto (0 si no tiene padres).
+         */
+        static unsigned long implDepthOf(ProtoObjectCellImplementation* object);
+
+        /**
+         * @brief Bit de la máscara de ancestros que corresponde a un objeto.
+         */
+        static unsigned long implAncestorBit(ProtoObjectCellImplementation* object);
+
+        ParentLinkImplementation* parent;
+        ProtoObjectCellImplementation* object;
+        std::atomic<ResolutionOrder*> order;
+        // En una cadena lineal corta todos los ancestros están en el linaje
+        // principal: la máscara se deduce de ellos y su lugar, junto con el
+        // del display, guarda los dos ancestros anteriores a 'object'.
+        union
+        {
+            std::atomic<AttributeSlots*> display;
+            ProtoObjectCellImplementation* rootAncestor;    // Profundidad 0.
+        };
+        union
+        {
+            unsigned long ancestorMask;     // Unión de los bits de todos los ancestros.
+            ProtoObjectCellImplementation* middleAncestor;  // Profundidad 1.
+        };
+        unsigned long depth : 63;       // Largo del linaje principal (object, object->parent, ...).
+        unsigned long linear : 1;       // Toda la cadena fue creada con newChild.
+    };
+
+    /**
+     * @class ResolutionOrder
+     * @brief Arreglo compacto con el orden de resolución de una cadena de padres.
+     *
+     * El orden se guarda en bloques de hasta RESOLUTION_ORDER_SIZE objetos
+     * encadenados. Los hijos creados con newChild comparten los bloques de su
+     * prototipo: sólo agregan uno nuevo al frente.
+     */
+    class ResolutionOrder : public Cell
+    {
+    public:
+        ResolutionOrder(
+            ProtoContext* context,
+            ResolutionOrder* next,
+            unsigned long count,
+            ProtoObjectCellImplementation** objects
+        );
+        ~ResolutionOrder();
+
+        static ResolutionOrder* implFromArray(
+            ProtoContext* context,
+            unsigned long count,
+            ProtoObjectCellImplementation** objects,
+            ResolutionOrder* tail = nullptr
+        );
+        static ResolutionOrder* implPrepend(
+            ProtoContext* context,
+            ProtoObjectCellImplementation* object,
+            ResolutionOrder* order
+        );
+
+        unsigned long getHash(ProtoContext* context);
+        ProtoObject* asObject(ProtoContext* context);
+        void finalize(ProtoContext* context);
+
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+        ResolutionOrder* next;
+        unsigned long count;
+        ProtoObjectCellImplementation* objects[RESOLUTION_ORDER_SIZE];
+    };
+
+    static_assert(sizeof(ParentLinkImplementation) <= 64, "ParentLinkImplementation debe caber en una celda de 64 bytes.");
+    static_assert(sizeof(ResolutionOrder) <= 64, "ResolutionOrder debe caber en una celda de 64 bytes.");
+
+    /**
+     * @class ObjectShape
+     * @brief Descriptor de forma (hidden class) compartido por los objetos.
+     *
+     * Cada forma asigna a cada clave de atributo una posición fija dentro del
+     * vector de valores del objeto (AttributeSlots). Las formas se organizan como
+     * un árbol de transiciones: agregar una clave a un objeto con forma S lleva
+     * siempre a la misma forma hija de S, por lo que los objetos construidos de
+     * la misma manera comparten la misma forma.
+     */
+    class ObjectShape : public Cell
+    {
+    public:
+        ObjectShape(
+            ProtoContext* context,
+            ObjectShape* previous,
+            unsigned long key,
+            ProtoSparseListImplementation* slotIndex
+        );
+        ~ObjectShape();
+
+        /**
+         * @brief Devuelve la posición asignada a la clave, o -1 si la forma no la contiene.
+         */
+        long implGetSlot(ProtoContext* context, unsigned long key);
+
+        /**
+         * @brief Devuelve la forma que resulta de agregar la clave a esta forma.
+         *
+         * La transición se guarda en la forma para que todos los objetos que
+         * agregan la misma clave compartan la forma resultante. Devuelve nullptr
+         * si se alcanzó SHAPE_MAX_SLOTS; el objeto debe pasar a modo diccionario.
+         */
+        ObjectShape* implAddKey(ProtoContext* context, unsigned long key);
+
+        unsigned long getHash(ProtoContext* context);
+        ProtoObject* asObject(ProtoContext* context);
+        void finalize(ProtoContext* context);
+
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+        ObjectShape* previous;
+        unsigned long key;
+        unsigned long slotCount;
+        ProtoSparseListImplementation* slotIndex; // clave -> posición (fromInteger)
+        std::atomic<ProtoSparseListImplementation*> transitions; // clave -> ObjectShape
+    };
+
+    /**
+     * @class AttributeSlots
+     * @brief Vector compacto y persistente con los valores de atributos de un objeto.
+     *
+     * Las hojas (height == 0) guardan hasta SLOTS_SIZE valores; los nodos internos
+     * guardan hasta SLOTS_SIZE subvectores. Las actualizaciones copian sólo el
+     * camino hasta la posición modificada.
+     */
+    class AttributeSlots : public Cell
+    {
+    public:
+        AttributeSlots(
+            ProtoContext* context,
+            unsigned long height,
+            Cell** pointers = nullptr
+        );
+        ~AttributeSlots();
+
+        static ProtoObject* implGetAt(AttributeSlots* slots, unsigned long index);
+        static AttributeSlots* implSetAt(
+            ProtoContext* context,
+            AttributeSlots* slots,
+            unsigned long index,
+            ProtoObject* value
+        );
+        /**
+         * @brief Construye un vector completo en una sola pasada, de las hojas a la raíz.
+         */
+        static AttributeSlots* implFromArray(
+            ProtoContext* context,
+            unsigned long count,
+            ProtoObject** values
+        );
+
+        unsigned long getHash(ProtoContext* context);
+        ProtoObject* asObject(ProtoContext* context);
+        void finalize(ProtoContext* context);
+
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+        unsigned long height;
+        union {
+            ProtoObject* values[SLOTS_SIZE];
+            AttributeSlots* children[SLOTS_SIZE];
+        } pointers;
+    };
+
+    static_assert(sizeof(ObjectShape) <= 64, "ObjectShape debe caber en una celda de 64 bytes.");
+    static_assert(sizeof(AttributeSlots) <= 64, "AttributeSlots debe caber en una celda de 64 bytes.");
+
+    /**
+     * @class ProtoObjectCellImplementation
+     * @brief Implementación de una celda que representa un objeto Proto.
+     *
+     * Hereda de 'Cell' para la gestión de memoria y de 'ProtoObjectCell'
+     * para la interfaz pública de objetos. Contiene una referencia a su cadena
+     * de herencia (padres) y sus atributos propios.
+     *
+     * Los atributos se guardan normalmente según una forma compartida (shape):
+     * la forma asigna posiciones y 'slots' guarda los valores. Si shape es nulo
+     * el objeto está en modo diccionario y usa la lista dispersa 'attributes'.
+     */
+    class ProtoObjectCellImplementation : public Cell, public ProtoObject
+    {
+    public:
+        /**
+         * @brief Constructor de un objeto con forma.
+         * @param context El contexto de ejecución actual.
+         * @param parent Puntero al primer eslabón de la cadena de herencia.
+         * @param mutable_ref Un indicador de si el objeto es mutable.
+         * @param shape La forma del objeto.
+         * @param slots Si la forma tiene más de OBJECT_INLINE_SLOTS posiciones, los
+         *        valores desde la posición OBJECT_INLINE_SLOTS - 1; si no, se ignora.
+         * @param inlineValues Los primeros OBJECT_INLINE_SLOTS valores (nullptr si no hay);
+         *        el último sólo se usa si la forma no tiene más posiciones.
+         */
+        ProtoObjectCellImplementation(
+            ProtoContext* context,
+            ParentLinkImplementation* parent,
+            unsigned long mutable_ref,
+            ObjectShape* shape,
+            AttributeSlots* slots = nullptr,
+            ProtoObject** inlineValues = nullptr
+        );
+
+        /**
+         * @brief Constructor de un objeto en modo diccionario.
+         * @param attributes La lista dispersa de atributos.
+         */
+        ProtoObjectCellImplementation(
+            ProtoContext* context,
+            ParentLinkImplementation* parent,
+            unsigned long mutable_ref,
+            ProtoSparseListImplementation* attributes
+        );
+
+        /**
+         * @brief Destructor virtual.
+         */
+        ~ProtoObjectCellImplementation();
+
+        /**
+         * @brief Crea una nueva celda de objeto con un padre adicional en su cadena de herencia.
+         * @param context El contexto de ejecución actual.
+         * @param newParentToAdd El objeto padre que se va a añadir.
+         * @return Una *nueva* ProtoObjectCellImplementation con la cadena de herencia actualizada.
+         */
+        ProtoObjectCell* implAddParent(
+            ProtoContext* context,
+            ProtoObjectCell* newParentToAdd
+        );
+
+        /**
+         * @brief Devuelve la representación de esta celda como un ProtoObject.
+         * @param context El contexto de ejecución actual.
+         * @return Un ProtoObject que representa este objeto.
+         */
+        ProtoObject* implAsObject(ProtoContext* context);
+
+        /**
+         * @brief Crea una copia del objeto, con los mismos atributos, en otra cadena de padres.
+         */
+        ProtoObjectCellImplementation* implWithParent(
+            ProtoContext* context,
+            ParentLinkImplementation* parent,
+            unsigned long mutable_ref
+        );
+
+        /**
+         * @brief Crea la tabla plana de un objeto que se congela.
+         *
+         * Si los atributos visibles (propios y heredados) caben en una forma, se
+         * copian a una celda con una forma propia, de modo que las lecturas no
+         * recorren la cadena de padres. ProtoObject::freeze la instala como
+         * valor actual del objeto congelado.
+         */
+        ProtoObjectCellImplementation* implFreeze(ProtoContext* context);
+
+        /**
+         * @brief Devuelve el valor guardado en una posición de la forma.
+         */
+        ProtoObject* implGetSlotValue(unsigned long slot)
+        {
+            if (slot < OBJECT_INLINE_SLOTS - 1)
+                return this->inlineValues[slot];
+            return this->spilled
+                ? AttributeSlots::implGetAt(this->slots, slot - (OBJECT_INLINE_SLOTS - 1))
+                : this->lastInlineValue;
+        }
+
+        /**
+         * @brief Copia los valores guardados en la celda (NONE en los que no se usan).
+         */
+        void implGetInlineValues(ProtoObject** values);
+
+        /**
+         * @brief Devuelve la versión vigente del objeto (resuelve los objetos mutables).
+         */
+        ProtoObjectCellImplementation* implGetCurrent(ProtoContext* context);
+
+        /**
+         * @brief Devuelve el valor de un atributo propio, o PROTO_NONE si no existe.
+         */
+        ProtoObject* implGetOwnAttribute(ProtoContext* context, unsigned long key);
+
+        /**
+         * @brief Busca un atributo en el objeto y en su cadena de prototipos.
+         *
+         * Si se indica un cache, se consulta antes de recorrer la cadena y se
+         * actualiza con el objeto y la posición donde se resolvió el nombre.
+         */
+        ProtoObject* implLookupAttribute(
+            ProtoContext* context,
+            unsigned long key,
+            ProtoAttributeCache* cache = nullptr,
+            ProtoObjectCellImplementation** holder = nullptr
+        );
+
+        /**
+         * @brief Crea una nueva versión del objeto con el atributo propio modificado.
+         */
+        ProtoObjectCellImplementation* implSetOwnAttribute(
+            ProtoContext* context,
+            unsigned long key,
+            ProtoObject* value
+        );
+
+        /**
+         * @brief Crea una única versión nueva del objeto con varios atributos propios modificados.
+         *
+         * La forma se extiende clave por clave, pero los valores se copian una
+         * sola vez y se reserva una sola celda de objeto.
+         */
+        ProtoObjectCellImplementation* implSetOwnAttributes(
+            ProtoContext* context,
+            unsigned int count,
+            unsigned long* keys,
+            ProtoObject** values
+        );
+
+        /**
+         * @brief Recorre los atributos propios con valor distinto de PROTO_NONE.
+         */
+        void implProcessOwnAttributes(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                unsigned long key,
+                ProtoObject* value
+            )
+        );
+
+        /**
+         * @brief Recorre toda la tabla plana de un objeto congelado (propios y heredados).
+         */
+        void implProcessFlatAttributes(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                unsigned long key,
+                ProtoObject* value
+            )
+        );
+
+        /**
+         * @brief Construye una lista dispersa con los atributos propios.
+         */
+        ProtoSparseListImplementation* implGetOwnAttributes(ProtoContext* context);
+
+        /**
+         * @brief Finalizador para el recolector de basura.
+         *
+         * Este método es llamado por el GC antes de liberar la memoria de la celda.
+         * @param context El contexto de ejecución actual.
+         */
+        void finalize(ProtoContext* context);
+
+        /**
+         * @brief Procesa las referencias internas para el recolector de basura.
+         *
+         * Recorre las referencias al padre y a los atributos para que el GC
+         * pueda marcar los objetos alcanzables.
+         */
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(ProtoContext* context, void* self, Cell* cell)
+        );
+        long unsigned getHash(ProtoContext* context);
+
+        ParentLinkImplementation* parent;
+        unsigned long mutable_ref : 48;
+        unsigned long frozen : 1;       // El objeto no admite más cambios.
+        unsigned long flat : 1;         // La forma incluye también los atributos heredados.
+        unsigned long ownCount : 13;    // Con 'flat', las primeras ownCount posiciones son propias.
+        unsigned long spilled : 1;      // Los valores desde OBJECT_INLINE_SLOTS - 1 están en 'slots'.
+        ObjectShape* shape;
+        // Con forma, los valores viven en inlineValues; una forma de hasta
+        // OBJECT_INLINE_SLOTS posiciones usa además lastInlineValue y no
+        // necesita otra celda. Con más posiciones, las que siguen a
+        // inlineValues van en slots. Sin forma (modo diccionario), en attributes.
+        union
+        {
+            ProtoObject* lastInlineValue;
+            AttributeSlots* slots;
+            ProtoSparseListImplementation* attributes;
+        };
+        ProtoObject* inlineValues[OBJECT_INLINE_SLOTS - 1];
+    };
+
+    static_assert(sizeof(ProtoObjectCellImplementation) <= 64,
+                  "ProtoObjectCellImplementation debe caber en una celda de 64 bytes.");
+
+    // --- ProtoListIterator ---
+    // Concrete implementation for ProtoObject*
+    class ProtoListIteratorImplementation : public Cell, public ProtoListIterator
+    {
+    public:
+        ProtoListIteratorImplementation(
+            ProtoContext* context,
+            ProtoListImplementation* base,
+            unsigned long currentIndex
+        );
+        ~ProtoListIteratorImplementation();
+
+        int implHasNext(ProtoContext* context);
+        ProtoObject* implNext(ProtoContext* context);
+        ProtoListIteratorImplementation* implAdvance(ProtoContext* context);
+
+        ProtoObject* implAsObject(ProtoContext* context);
+        unsigned long getHash(ProtoContext* context);
+
+        void finalize(ProtoContext* context);
+
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+    private:
+        ProtoListImplementation* base;
+        unsigned long currentIndex;
+    };
+
+    // --- ProtoList ---
+    // Concrete implementation for ProtoObject*
+    /**
+     * @brief Nodo de un árbol AVL de bloques.
+     *
+     * Cada nodo guarda hasta LIST_CHUNK_SIZE elementos consecutivos de la
+     * lista dentro de su propia celda; los subárboles `previous` y `next`
+     * contienen los elementos anteriores y posteriores. Ningún nodo de un
+     * árbol queda vacío: la lista vacía es un único nodo con `size` 0.
+     */
+    class ProtoListImplementation : public Cell, public ProtoList
+    {
+    public:
+        explicit ProtoListImplementation(
+            ProtoContext* context,
+            ProtoListImplementation* previous = nullptr,
+            ProtoListImplementation* next = nullptr,
+            unsigned long size = 0,
+            ProtoObject* const* values = nullptr
+        );
+        ~ProtoListImplementation();
+
+        static ProtoListImplementation* implFromArray(
+            ProtoContext* context,
+            ProtoObject* const* values,
+            unsigned long count
+        );
+
+        ProtoObject* implGetAt(ProtoContext* context, int index);
+        ProtoObject* implGetFirst(ProtoContext* context);
+        ProtoObject* implGetLast(ProtoContext* context);
+        ProtoListImplementation* implGetSlice(ProtoContext* context, int from, int to);
+        unsigned long implGetSize(ProtoContext* context);
+
+        bool implHas(ProtoContext* context, ProtoObject* value);
+        ProtoListImplementation* implSetAt(ProtoContext* context, int index, ProtoObject* value = PROTO_NONE);
+        ProtoListImplementation* implInsertAt(ProtoContext* context, int index, ProtoObject* value);
+
+        ProtoListImplementation* implAppendFirst(ProtoContext* context, ProtoObject* value);
+        ProtoListImplementation* implAppendLast(ProtoContext* context, ProtoObject* value);
+
+        ProtoListImplementation* implExtend(ProtoContext* context, ProtoList* other);
+
+        ProtoListImplementation* implSplitFirst(ProtoContext* context, int index);
+        ProtoListImplementation* implSplitLast(ProtoContext* context, int index);
+
+        ProtoListImplementation* implRemoveFirst(ProtoContext* context);
+        ProtoListImplementation* implRemoveLast(ProtoContext* context);
+        ProtoListImplementation* implRemoveAt(ProtoContext* context, int index);
+        ProtoListImplementation* implRemoveSlice(ProtoContext* context, int from, int to);
+
+        ProtoObject* implAsObject(ProtoContext* context);
+        unsigned long getHash(ProtoContext* context);
+        ProtoListIteratorImplementation* implGetIterator(ProtoContext* context);
+        ProtoListTransientImplementation* implBeginTransient(ProtoContext* context);
+
+        void finalize(ProtoContext* context);
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+        ProtoListImplementation* previous;
+        ProtoListImplementation* next;
+
+        unsigned long count : 52;
+        unsigned long height : 8;
+        unsigned long size : 4;
+        ProtoObject* values[LIST_CHUNK_SIZE];
+    };
+
+    static_assert(sizeof(ProtoListImplementation) <= 64,
+                  "ProtoListImplementation debe caber en una celda de 64 bytes.");
+
+    /**
+     * @brief Editor transitorio de una lista.
+     *
+     * Los elementos agregados se escriben en bloques propios del editor,
+     * encadenados por `next`; nadie más los ve hasta implPersistent, que los
+     * enlaza en su lugar como un árbol balanceado y lo une a la lista base.
+     */
+    class ProtoListTransientImplementation : public Cell, public ProtoListTransient
+    {
+    public:
+        ProtoListTransientImplementation(ProtoContext* context, ProtoListImplementation* base);
+        ~ProtoListTransientImplementation();
+
+        ProtoListTransientImplementation* implAppendLast(ProtoContext* context, ProtoObject* value);
+        unsigned long implGetSize(ProtoContext* context);
+        ProtoListImplementation* implPersistent(ProtoContext* context);
+
+        unsigned long getHash(ProtoContext* context);
+        ProtoObject* asObject(ProtoContext* context);
+        void finalize(ProtoContext* context);
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+    private:
+        ProtoListImplementation* base;
+        ProtoListImplementation* first;
+        ProtoListImplementation* last;
+        unsigned long pendingCount : 63;
+        unsigned long sealed : 1;
+    };
+
+    static_assert(sizeof(ProtoListTransientImplementation) <= 64,
+                  "ProtoListTransientImplementation debe caber en una celda de 64 bytes.");
+
+    // --- ProtoSparseList ---
+    // Concrete implementation for ProtoObject*
+    class ProtoSparseListIteratorImplementation : public Cell, public ProtoSparseListIterator
+    {
+    public:
+        ProtoSparseListIteratorImplementation(
+            ProtoContext* context,
+            int state,
+            ProtoSparseListImplementation* current,
+            ProtoSparseListIteratorImplementation* queue = NULL
+        );
+        ~ProtoSparseListIteratorImplementation();
+
+        int implHasNext(ProtoContext* context);
+        unsigned long implNextKey(ProtoContext* context);
+        ProtoObject* implNextValue(ProtoContext* context);
+
+        ProtoSparseListIteratorImplementation* implAdvance(ProtoContext* context);
+        ProtoObject* implAsObject(ProtoContext* context);
+        unsigned long getHash(ProtoContext* context);
+
+        void finalize(ProtoContext* context);
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+    private:
+        int state;
+        ProtoSparseListImplementation* current;
+        ProtoSparseListIteratorImplementation* queue;
+    };
+
+    /**
+     * @brief Parte común de las representaciones de una lista dispersa.
+     *
+     * Una lista dispersa es un árbol AVL ordenado por clave
+     * (ProtoSparseListImplementation), un trie de hash sin orden
+     * (ProtoSparseHashImplementation) o un vector denso
+     * (ProtoSparseArrayImplementation). Las operaciones por clave eligen la
+     * representación por `type` y llaman directamente a la clase concreta,
+     * sin despacho virtual; las consultas ordenadas se resuelven sobre
+     * implAsTree, que en las otras representaciones construye primero el
+     * árbol equivalente.
+     */
+    class SparseListCell : public Cell, public ProtoSparseList
+    {
+    public:
+        SparseListCell(ProtoContext* context, unsigned long type);
+
+        bool implHas(ProtoContext* context, unsigned long index);
+        ProtoObject* implGetAt(ProtoContext* context, unsigned long index);
+        SparseListCell* implSetAt(ProtoContext* context, unsigned long index, ProtoObject* value);
+        SparseListCell* implRemoveAt(ProtoContext* context, unsigned long index);
+        void implProcessElements(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                unsigned long index,
+                ProtoObject* value
+            )
+        );
+        void implProcessValues(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                ProtoObject* value
+            )
+        );
+
+        unsigned long implGetSize(ProtoContext* context);
+        ProtoObject* implAsObject(ProtoContext* context);
+        ProtoSparseListImplementation* implAsTree(ProtoContext* context);
+        unsigned long getHash(ProtoContext* context);
+
+        // XOR de clave ^ hash del valor de cada elemento: no depende de la forma
+        // del árbol, así que coincide entre representaciones.
+        unsigned long hash;
+
+        unsigned long count : 52;
+        unsigned long height : 8;
+        unsigned long type : 4;
+    };
+
+    class ProtoSparseListImplementation final : public SparseListCell
+    {
+    public:
+        explicit ProtoSparseListImplementation(
+            ProtoContext* context,
+            unsigned long index = 0,
+            ProtoObject* value = PROTO_NONE,
+            ProtoSparseListImplementation* previous = NULL,
+            ProtoSparseListImplementation* next = NULL
+        );
+        ~ProtoSparseListImplementation();
+
+        bool implHas(ProtoContext* context, unsigned long index);
+        ProtoObject* implGetAt(ProtoContext* context, unsigned long index);
+        ProtoSparseListImplementation* implSetAt(ProtoContext* context, unsigned long index, ProtoObject* value);
+        ProtoSparseListImplementation* implRemoveAt(ProtoContext* context, unsigned long index);
+        int implIsEqual(ProtoContext* context, ProtoSparseList* otherDict);
+        ProtoObject* implGetAtOffset(ProtoContext* context, int offset);
+
+        unsigned long implCountRange(ProtoContext* context, unsigned long from, unsigned long to);
+        ProtoSparseListImplementation* implSliceRange(ProtoContext* context, unsigned long from, unsigned long to);
+        ProtoSparseListImplementation* implRemoveRange(ProtoContext* context, unsigned long from, unsigned long to);
+        bool implFirstKey(ProtoContext* context, unsigned long* key);
+        bool implLastKey(ProtoContext* context, unsigned long* key);
+        bool implFloor(ProtoContext* context, unsigned long key, unsigned long* found);
+        bool implCeiling(ProtoContext* context, unsigned long key, unsigned long* found);
+        ProtoSparseListImplementation* implUnion(
+            ProtoContext* context, ProtoSparseListImplementation* other, void* self, ProtoMergeFunction merge);
+        ProtoSparseListImplementation* implIntersection(
+            ProtoContext* context, ProtoSparseListImplementation* other, void* self, ProtoMergeFunction merge);
+        ProtoSparseListImplementation* implDifference(ProtoContext* context, ProtoSparseListImplementation* other);
+
+        ProtoSparseListIteratorImplementation* implGetIterator(ProtoContext* context);
+        ProtoSparseListTransientImplementation* implBeginTransient(ProtoContext* context);
+
+        void implProcessElements(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                unsigned long index,
+                ProtoObject* value
+            )
+        );
+
+        void implProcessValues(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                ProtoObject* value
+            )
+        );
+
+        void finalize(ProtoContext* context);
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+        ProtoSparseListImplementation* previous;
+        ProtoSparseListImplementation* next;
+
+        unsigned long index;
+        ProtoObject* value;
+    };
+
+    static_assert(sizeof(ProtoSparseListImplementation) <= 64,
+                  "ProtoSparseListImplementation debe caber en una celda de 64 bytes.");
+
+    /**
+     * @brief Nodo interior de un trie de hash (ver ProtoSparseHashImplementation).
+     *
+     * Un mapa de bits de SPARSE_HASH_FANOUT posiciones indica qué hijos existen;
+     * los presentes se guardan juntos, en el orden de sus posiciones, así que
+     * el hijo de la posición d está en popcount(bitmap & ((1 << d) - 1)). Los
+     * hijos son punteros marcados con SPARSE_HASH_TAG_*.
+     */
+    class SparseHashNode final : public Cell
+    {
+    public:
+        SparseHashNode(ProtoContext* context, unsigned long bitmap, const unsigned long* children);
+        ~SparseHashNode();
+
+        unsigned long getHash(ProtoContext* context);
+        ProtoObject* asObject(ProtoContext* context);
+        void finalize(ProtoContext* context);
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+        unsigned long bitmap;
+        unsigned long children[SPARSE_HASH_NODE_SLOTS];
+    };
+
+    static_assert(sizeof(SparseHashNode) <= 64, "SparseHashNode debe caber en una celda de 64 bytes.");
+
+    /**
+     * @brief Bloque de SPARSE_HASH_CHUNK_SIZE punteros de un nodo ancho del trie de hash.
+     *
+     * Un nodo con más de SPARSE_HASH_NODE_SLOTS hijos se guarda como un bloque
+     * raíz que apunta a bloques de hijos, indexados por posición: el hijo d
+     * está en el bloque d / SPARSE_HASH_CHUNK_SIZE. Un cambio copia sólo la raíz
+     * y el bloque afectado.
+     */
+    class SparseHashBlock final : public Cell
+    {
+    public:
+        SparseHashBlock(ProtoContext* context, const unsigned long* children);
+        ~SparseHashBlock();
+
+        unsigned long getHash(ProtoContext* context);
+        ProtoObject* asObject(ProtoContext* context);
+        void finalize(ProtoContext* context);
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+        unsigned long children[SPARSE_HASH_CHUNK_SIZE];
+    };
+
+    static_assert(sizeof(SparseHashBlock) <= 64, "SparseHashBlock debe caber en una celda de 64 bytes.");
+    static_assert(SPARSE_HASH_CHUNK_SIZE * SPARSE_HASH_CHUNK_SIZE >= SPARSE_HASH_FANOUT,
+                  "Los bloques de un nodo ancho deben cubrir todas las posiciones.");
+
+    /**
+     * @brief Hoja de un trie de hash: un par clave/valor.
+     */
+    class SparseHashLeaf final : public Cell
+    {
+    public:
+        SparseHashLeaf(ProtoContext* context, unsigned long key, ProtoObject* value);
+        ~SparseHashLeaf();
+
+        unsigned long getHash(ProtoContext* context);
+        ProtoObject* asObject(ProtoContext* context);
+        void finalize(ProtoContext* context);
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+        unsigned long key;
+        ProtoObject* value;
+    };
+
+    static_assert(sizeof(SparseHashLeaf) <= 64, "SparseHashLeaf debe caber en una celda de 64 bytes.");
+
+    /**
+     * @brief Lista dispersa sin orden, guardada como trie de hash persistente.
+     *
+     * Cada nivel consume SPARSE_HASH_BITS bits de la clave mezclada, así que la
+     * profundidad es de log32(n) y una actualización copia sólo el camino, sin
+     * rotaciones. Los nodos usan un mapa de bits y guardan sólo los hijos
+     * presentes (SparseHashNode); uno con más hijos de los que caben en una
+     * celda pasa a nodo ancho (SparseHashBlock). Un nodo que queda con una sola
+     * hoja se reemplaza por ella. Esta celda guarda la raíz, la cantidad y el
+     * hash; un valor NONE no se guarda: asignarlo equivale a quitar la clave.
+     */
+    class ProtoSparseHashImplementation final : public SparseListCell
+    {
+    public:
+        explicit ProtoSparseHashImplementation(
+            ProtoContext* context,
+            unsigned long root = 0,
+            unsigned long count = 0,
+            unsigned long hash = 0
+        );
+        ~ProtoSparseHashImplementation();
+
+        bool implHas(ProtoContext* context, unsigned long index);
+        ProtoObject* implGetAt(ProtoContext* context, unsigned long index);
+        ProtoSparseHashImplementation* implSetAt(ProtoContext* context, unsigned long index, ProtoObject* value);
+        ProtoSparseHashImplementation* implRemoveAt(ProtoContext* context, unsigned long index);
+
+        void implProcessElements(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                unsigned long index,
+                ProtoObject* value
+            )
+        );
+
+        void implProcessValues(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                ProtoObject* value
+            )
+        );
+
+        void finalize(ProtoContext* context);
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+        // Raíz del trie, marcada con SPARSE_HASH_TAG_*; 0 si la lista está vacía.
+        unsigned long root;
+    };
+
+    static_assert(sizeof(ProtoSparseHashImplementation) <= 64,
+                  "ProtoSparseHashImplementation debe caber en una celda de 64 bytes.");
+
+    /**
+     * @brief Lista dispersa densa, guardada como vector persistente por desplazamiento.
+     *
+     * La clave base + i se guarda en la posición i de un AttributeSlots, con
+     * NONE en los huecos: getAt es un acceso por índice, sin comparar claves,
+     * y un cambio copia solo el camino en el vector. Las claves ocupan
+     * [base + start, base + span); quitar la primera avanza start, y cuando el
+     * prefijo vacío supera al rango ocupado el vector se reconstruye desde la
+     * nueva primera clave, de modo que un uso como cola no lo degrada. La
+     * lista se mantiene así mientras span - start no supere
+     * SPARSE_ARRAY_DENSITY * count; una clave que rompe esa densidad, o que
+     * cae por debajo de base, la devuelve al árbol AVL.
+     */
+    class ProtoSparseArrayImplementation final : public SparseListCell
+    {
+    public:
+        ProtoSparseArrayImplementation(
+            ProtoContext* context,
+            unsigned long base,
+            unsigned long start,
+            unsigned long span,
+            AttributeSlots* slots,
+            unsigned long count,
+            unsigned long hash
+        );
+        ~ProtoSparseArrayImplementation();
+
+        /**
+         * @brief Devuelve el vector denso equivalente al árbol, o el mismo árbol
+         * si es chico o sus claves no son lo bastante densas.
+         */
+        static SparseListCell* implFromTree(ProtoContext* context, ProtoSparseListImplementation* tree);
+        /**
+         * @brief Como implFromTree, pero sólo revisa los árboles cuyo tamaño es
+         * potencia de dos, para amortizar la conversión entre actualizaciones.
+         */
+        static SparseListCell* implAdapt(ProtoContext* context, SparseListCell* list);
+
+        bool implHas(ProtoContext* context, unsigned long index);
+        ProtoObject* implGetAt(ProtoContext* context, unsigned long index);
+        SparseListCell* implSetAt(ProtoContext* context, unsigned long index, ProtoObject* value);
+        SparseListCell* implRemoveAt(ProtoContext* context, unsigned long index);
+
+        void implProcessElements(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                unsigned long index,
+                ProtoObject* value
+            )
+        );
+
+        void implProcessValues(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                ProtoObject* value
+            )
+        );
+
+        void finalize(ProtoContext* context);
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+        unsigned long base;
+        unsigned long start;
+        unsigned long span;
+        AttributeSlots* slots;
+    };
+
+    static_assert(sizeof(ProtoSparseArrayImplementation) <= 64,
+                  "ProtoSparseArrayImplementation debe caber en una celda de 64 bytes.");
+
+    /**
+     * @brief Editor transitorio de una lista dispersa.
+     *
+     * Cada cambio se guarda en un nodo propio, encadenado por `next` del más
+     * nuevo al más viejo. implPersistent aplica los cambios sobre la base: un
+     * lote chico se inserta uno a uno y uno grande se mezcla con la base y se
+     * reconstruye balanceado, reutilizando en su lugar los nodos propios.
+     */
+    class ProtoSparseListTransientImplementation : public Cell, public ProtoSparseListTransient
+    {
+    public:
+        ProtoSparseListTransientImplementation(ProtoContext* context, ProtoSparseListImplementation* base);
+        ~ProtoSparseListTransientImplementation();
+
+        ProtoSparseListTransientImplementation* implSetAt(
+            ProtoContext* context, unsigned long index, ProtoObject* value);
+        ProtoSparseListImplementation* implPersistent(ProtoContext* context);
+
+        unsigned long getHash(ProtoContext* context);
+        ProtoObject* asObject(ProtoContext* context);
+        void finalize(ProtoContext* context);
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+    private:
+        ProtoSparseListImplementation* base;
+        ProtoSparseListImplementation* pending;
+        unsigned long pendingCount : 63;
+        unsigned long sealed : 1;
+    };
+
+    // --- Diccionarios ---
+
+    /**
+     * @brief Hash por contenido, coherente con protoEquals.
+     *
+     * Cadenas, tuplas y listas se recorren elemento a elemento; las listas
+     * dispersas y los diccionarios ya guardan un hash de su contenido; el resto
+     * de los valores se identifica por su puntero.
+     */
+    unsigned long protoStructuralHash(ProtoContext* context, ProtoObject* value);
+    /**
+     * @brief Igualdad por contenido entre dos valores del mismo tipo.
+     */
+    bool protoEquals(ProtoContext* context, ProtoObject* a, ProtoObject* b);
+
+    /**
+     * @brief Par clave/valor de un diccionario.
+     *
+     * Guarda el hash de la clave para no recalcularlo y el número de secuencia
+     * con el que entró, que ordena el recorrido por inserción. Las claves
+     * distintas con el mismo hash se encadenan por `next`.
+     */
+    class DictionaryEntry : public Cell
+    {
+    public:
+        DictionaryEntry(
+            ProtoContext* context,
+            ProtoObject* key,
+            ProtoObject* value,
+            unsigned long keyHash,
+            unsigned long sequence,
+            DictionaryEntry* next = nullptr
+        );
+        ~DictionaryEntry();
+
+        unsigned long getHash(ProtoContext* context);
+        ProtoObject* asObject(ProtoContext* context);
+        void finalize(ProtoContext* context);
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+        ProtoObject* key;
+        ProtoObject* value;
+        unsigned long keyHash;
+        unsigned long sequence;
+        DictionaryEntry* next;
+    };
+
+    static_assert(sizeof(DictionaryEntry) <= 64, "DictionaryEntry debe caber en una celda de 64 bytes.");
+
+    /**
+     * @brief Diccionario persistente sobre claves arbitrarias.
+     *
+     * `table` es un trie de hash (ProtoSparseHashImplementation) indexado por el
+     * hash de la clave, cuyo valor es la cadena de entradas de ese hash. Si el
+     * diccionario conserva el orden de inserción, `order` asocia cada número
+     * de secuencia a su entrada; mientras no haya muchas bajas esas claves son
+     * densas y la lista usa el vector por desplazamiento.
+     */
+    class ProtoDictionaryImplementation : public Cell, public ProtoDictionary
+    {
+    public:
+        ProtoDictionaryImplementation(ProtoContext* context, bool insertionOrder);
+        ProtoDictionaryImplementation(
+            ProtoContext* context,
+            ProtoSparseHashImplementation* table,
+            SparseListCell* order,
+            unsigned long nextSequence,
+            unsigned long count,
+            unsigned long hash
+        );
+        ~ProtoDictionaryImplementation();
+
+        DictionaryEntry* implFind(ProtoContext* context, ProtoObject* key, unsigned long keyHash);
+        bool implHas(ProtoContext* context, ProtoObject* key);
+        ProtoObject* implGetAt(ProtoContext* context, ProtoObject* key);
+        ProtoDictionaryImplementation* implSetAt(ProtoContext* context, ProtoObject* key, ProtoObject* value);
+        ProtoDictionaryImplementation* implRemoveAt(ProtoContext* context, ProtoObject* key);
+        unsigned long implGetSize(ProtoContext* context);
+        bool implKeepsInsertionOrder(ProtoContext* context);
+        bool implIsEqual(ProtoContext* context, ProtoDictionaryImplementation* other);
+        void implProcessElements(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                ProtoObject* key,
+                ProtoObject* value
+            )
+        );
+
+        ProtoObject* implAsObject(ProtoContext* context);
+        unsigned long getHash(ProtoContext* context);
+        ProtoObject* asObject(ProtoContext* context);
+        void finalize(ProtoContext* context);
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+        ProtoSparseHashImplementation* table;
+        SparseListCell* order;
+        unsigned long nextSequence;
+        unsigned long count;
+        // XOR de hash de clave ^ hash del valor de cada entrada.
+        unsigned long hash;
+    };
+
+    static_assert(sizeof(ProtoDictionaryImplementation) <= 64,
+                  "ProtoDictionaryImplementation debe caber en una celda de 64 bytes.");
+
+    // --- Mapas ordenados ---
+
+    /**
+     * @brief Orden de ProtoSortedMap::compareNumbers, sin llamada indirecta.
+     *
+     * Enteros y flotantes por valor; marcas de tiempo, fechas e intervalos
+     * cronológicamente; el resto por etiqueta y bits, así que el orden es total.
+     */
+    int protoCompareNumbers(ProtoContext* context, ProtoObject* a, ProtoObject* b);
+
+    /**
+     * @brief Nodo del árbol B+ de un mapa ordenado.
+     *
+     * Las hojas (height == 0) guardan hasta SORTED_MAP_LEAF_SIZE pares y los
+     * nodos interiores hasta SORTED_MAP_FANOUT subárboles; `keys[i]` es la
+     * menor clave de `children[i + 1]`. Todas las hojas están a la misma
+     * profundidad y cada nodo guarda la cantidad de pares de su subárbol, que
+     * resuelve rank y select. Con celdas de 64 bytes el orden máximo es 3.
+     */
+    class SortedMapNode : public Cell
+    {
+    public:
+        SortedMapNode(ProtoContext* context, unsigned long size, ProtoObject* const* keys, ProtoObject* const* values);
+        SortedMapNode(ProtoContext* context, unsigned long size, SortedMapNode* const* children, ProtoObject* const* keys);
+        ~SortedMapNode();
+
+        unsigned long getHash(ProtoContext* context);
+        ProtoObject* asObject(ProtoContext* context);
+        void finalize(ProtoContext* context);
         void processReferences(
             ProtoContext* context,
             void* self,
@@ -281,105 +1713,101 @@ namespace proto
             )
         );
 
-        ParentLinkImplementation* parent;
-        ProtoObjectCellImplementation* object;
+        unsigned long count : 54;
+        unsigned long size : 2;
+        unsigned long height : 8;
+        union
+        {
+            struct
+            {
+                ProtoObject* keys[SORTED_MAP_LEAF_SIZE];
+                ProtoObject* values[SORTED_MAP_LEAF_SIZE];
+            } leaf;
+            struct
+            {
+                SortedMapNode* children[SORTED_MAP_FANOUT];
+                ProtoObject* keys[SORTED_MAP_FANOUT - 1];
+            } inner;
+        } slots;
     };
 
-    /**
-     * @class ProtoObjectCellImplementation
-     * @brief Implementación de una celda que representa un objeto Proto.
-     *
-     * Hereda de 'Cell' para la gestión de memoria y de 'ProtoObjectCell'
-     * para la interfaz pública de objetos. Contiene una referencia a su cadena
-     * de herencia (padres) y una lista de atributos.
-     */
-    class ProtoObjectCellImplementation : public Cell, public ProtoObject
+    static_assert(sizeof(SortedMapNode) <= 64, "SortedMapNode debe caber en una celda de 64 bytes.");
+
+    class ProtoSortedMapImplementation : public CollectionCell, public ProtoSortedMap
     {
     public:
-        /**
-         * @brief Constructor.
-         * @param context El contexto de ejecución actual.
-         * @param parent Puntero al primer eslabón de la cadena de herencia.
-         * @param mutable_ref Un indicador de si el objeto es mutable.
-         * @param attributes La lista dispersa de atributos del objeto.
-         */
-        ProtoObjectCellImplementation(
+        ProtoSortedMapImplementation(ProtoContext* context, ProtoCompareFunction compare, SortedMapNode* root = nullptr);
+        ~ProtoSortedMapImplementation();
+
+        static ProtoSortedMapImplementation* implFromArray(
             ProtoContext* context,
-            ParentLinkImplementation* parent,
-            unsigned long mutable_ref,
-            ProtoSparseListImplementation* attributes
+            ProtoCompareFunction compare,
+            ProtoObject* const* keys,
+            ProtoObject* const* values,
+            unsigned long count
         );
 
-        /**
-         * @brief Destructor virtual.
-         */
-        ~ProtoObjectCellImplementation();
-
-        /**
-         * @brief Crea una nueva celda de objeto con un padre adicional en su cadena de herencia.
-         * @param context El contexto de ejecución actual.
-         * @param newParentToAdd El objeto padre que se va a añadir.
-         * @return Una *nueva* ProtoObjectCellImplementation con la cadena de herencia actualizada.
-         */
-        ProtoObjectCell* implAddParent(
+        ProtoObject* implGetAt(ProtoContext* context, ProtoObject* key);
+        ProtoSortedMapImplementation* implSetAt(ProtoContext* context, ProtoObject* key, ProtoObject* value);
+        ProtoSortedMapImplementation* implRemoveAt(ProtoContext* context, ProtoObject* key);
+        unsigned long implGetSize(ProtoContext* context);
+        unsigned long implRank(ProtoContext* context, ProtoObject* key, bool inclusive);
+        ProtoObject* implKeyAt(ProtoContext* context, unsigned long index, bool value);
+        ProtoObject* implFloor(ProtoContext* context, ProtoObject* key);
+        ProtoObject* implCeiling(ProtoContext* context, ProtoObject* key);
+        unsigned long implCountRange(ProtoContext* context, ProtoObject* from, ProtoObject* to);
+        void implProcessRange(
             ProtoContext* context,
-            ProtoObjectCell* newParentToAdd
+            ProtoObject* from,
+            ProtoObject* to,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                ProtoObject* key,
+                ProtoObject* value
+            )
         );
 
-        /**
-         * @brief Devuelve la representación de esta celda como un ProtoObject.
-         * @param context El contexto de ejecución actual.
-         * @return Un ProtoObject que representa este objeto.
-         */
-        ProtoObject* implAsObject(ProtoContext* context);
-
-        /**
-         * @brief Finalizador para el recolector de basura.
-         *
-         * Este método es llamado por el GC antes de liberar la memoria de la celda.
-         * @param context El contexto de ejecución actual.
-         */
+        unsigned long getHash(ProtoContext* context);
+        ProtoObject* asObject(ProtoContext* context);
         void finalize(ProtoContext* context);
-
-        /**
-         * @brief Procesa las referencias internas para el recolector de basura.
-         *
-         * Recorre las referencias al padre y a los atributos para que el GC
-         * pueda marcar los objetos alcanzables.
-         */
         void processReferences(
             ProtoContext* context,
             void* self,
-            void (*method)(ProtoContext* context, void* self, Cell* cell)
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
         );
-        long unsigned getHash(ProtoContext* context);
 
-        ParentLinkImplementation* parent;
-        unsigned long mutable_ref;
-        ProtoSparseListImplementation* attributes;
+        SortedMapNode* root;
+        ProtoCompareFunction compare;
     };
 
-    // --- ProtoListIterator ---
-    // Concrete implementation for ProtoObject*
-    class ProtoListIteratorImplementation : public Cell, public ProtoListIterator
+    static_assert(sizeof(ProtoSortedMapImplementation) <= 64,
+                  "ProtoSortedMapImplementation debe caber en una celda de 64 bytes.");
+
+    // --- Colas dobles ---
+
+    /**
+     * @brief Dígito o nodo 2-3 del árbol de dedos de una cola doble.
+     *
+     * Con `values` los elementos son los valores de la cola; si no, son otros
+     * DequeNode del nivel anterior. `size` es la cantidad de valores que
+     * cubre. Un nodo 2-3 de un nivel se usa directamente como dígito del
+     * nivel siguiente, sin copiarlo.
+     */
+    class DequeNode : public Cell
     {
     public:
-        ProtoListIteratorImplementation(
-            ProtoContext* context,
-            ProtoListImplementation* base,
-            unsigned long currentIndex
-        );
-        ~ProtoListIteratorImplementation();
-
-        int implHasNext(ProtoContext* context);
-        ProtoObject* implNext(ProtoContext* context);
-        ProtoListIteratorImplementation* implAdvance(ProtoContext* context);
+        DequeNode(ProtoContext* context, bool values, unsigned long count, ProtoObject* const* items);
+        ~DequeNode();
 
-        ProtoObject* implAsObject(ProtoContext* context);
         unsigned long getHash(ProtoContext* context);
-
+        ProtoObject* asObject(ProtoContext* context);
         void finalize(ProtoContext* context);
-
         void processReferences(
             ProtoContext* context,
             void* self,
@@ -390,51 +1818,57 @@ namespace proto
             )
         );
 
-    private:
-        ProtoListImplementation* base;
-        unsigned long currentIndex;
+        unsigned long size : 56;
+        unsigned long count : 7;
+        unsigned long values : 1;
+        ProtoObject* items[DEQUE_DIGIT_SIZE];
     };
 
-    // --- ProtoList ---
-    // Concrete implementation for ProtoObject*
-    class ProtoListImplementation : public Cell, public ProtoList
+    static_assert(sizeof(DequeNode) <= 64, "DequeNode debe caber en una celda de 64 bytes.");
+
+    /**
+     * @brief Árbol de dedos 2-3 (Hinze y Paterson) anotado con tamaños.
+     *
+     * Vacío si no tiene prefijo; un solo elemento si no tiene sufijo; en otro
+     * caso prefijo, árbol central de nodos 2-3 (nullptr si está vacío) y
+     * sufijo. Los niveles centrales son celdas del mismo tipo que nunca se
+     * exponen como objetos.
+     */
+    class ProtoDequeImplementation : public CollectionCell, public ProtoDeque
     {
     public:
-        explicit ProtoListImplementation(
+        ProtoDequeImplementation(
             ProtoContext* context,
-            ProtoObject* value = PROTO_NONE,
-            ProtoListImplementation* previous = nullptr,
-            ProtoListImplementation* next = nullptr
+            DequeNode* prefix = nullptr,
+            ProtoDequeImplementation* middle = nullptr,
+            DequeNode* suffix = nullptr
         );
-        ~ProtoListImplementation();
+        ~ProtoDequeImplementation();
 
         ProtoObject* implGetAt(ProtoContext* context, int index);
-        ProtoObject* implGetFirst(ProtoContext* context);
-        ProtoObject* implGetLast(ProtoContext* context);
-        ProtoListImplementation* implGetSlice(ProtoContext* context, int from, int to);
         unsigned long implGetSize(ProtoContext* context);
-
         bool implHas(ProtoContext* context, ProtoObject* value);
-        ProtoListImplementation* implSetAt(ProtoContext* context, int index, ProtoObject* value = PROTO_NONE);
-        ProtoListImplementation* implInsertAt(ProtoContext* context, int index, ProtoObject* value);
-
-        ProtoListImplementation* implAppendFirst(ProtoContext* context, ProtoObject* value);
-        ProtoListImplementation* implAppendLast(ProtoContext* context, ProtoObject* value);
-
-        ProtoListImplementation* implExtend(ProtoContext* context, ProtoList* other);
-
-        ProtoListImplementation* implSplitFirst(ProtoContext* context, int index);
-        ProtoListImplementation* implSplitLast(ProtoContext* context, int index);
-
-        ProtoListImplementation* implRemoveFirst(ProtoContext* context);
-        ProtoListImplementation* implRemoveLast(ProtoContext* context);
-        ProtoListImplementation* implRemoveAt(ProtoContext* context, int index);
-        ProtoListImplementation* implRemoveSlice(ProtoContext* context, int from, int to);
+        ProtoDequeImplementation* implGetSlice(ProtoContext* context, int from, int to);
+        ProtoDequeImplementation* implAppendFirst(ProtoContext* context, ProtoObject* value);
+        ProtoDequeImplementation* implAppendLast(ProtoContext* context, ProtoObject* value);
+        ProtoDequeImplementation* implRemoveFirst(ProtoContext* context);
+        ProtoDequeImplementation* implRemoveLast(ProtoContext* context);
+        ProtoDequeImplementation* implExtend(ProtoContext* context, ProtoDequeImplementation* other);
+        ProtoDequeImplementation* implSplitFirst(ProtoContext* context, int index);
+        ProtoDequeImplementation* implSplitLast(ProtoContext* context, int index);
+        ProtoList* implAsList(ProtoContext* context);
+        void implProcessValues(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                ProtoObject* value
+            )
+        );
 
-        ProtoObject* implAsObject(ProtoContext* context);
         unsigned long getHash(ProtoContext* context);
-        ProtoListIteratorImplementation* implGetIterator(ProtoContext* context);
-
+        ProtoObject* asObject(ProtoContext* context);
         void finalize(ProtoContext* context);
         void processReferences(
             ProtoContext* context,
@@ -446,38 +1880,42 @@ namespace proto
             )
         );
 
-        ProtoListImplementation* previous;
-        ProtoListImplementation* next;
+        DequeNode* prefix;
+        ProtoDequeImplementation* middle;
+        DequeNode* suffix;
+        unsigned long size;
+    };
 
-        ProtoObject* value;
-        unsigned long hash{};
+    static_assert(sizeof(ProtoDequeImplementation) <= 64,
+                  "ProtoDequeImplementation debe caber en una celda de 64 bytes.");
 
-        unsigned long count : 52{};
-        unsigned long height : 8;
-        unsigned long type : 4{};
-    };
+    // --- Colas de prioridad ---
 
-    // --- ProtoSparseList ---
-    // Concrete implementation for ProtoObject*
-    class ProtoSparseListIteratorImplementation : public Cell, public ProtoSparseListIterator
+    /**
+     * @brief Raíz de un árbol de un montículo binomial sesgado (skew binomial heap).
+     *
+     * Los elementos son colas no vacías, ordenadas por su clave mínima. Los
+     * hijos forman una lista enlazada por `sibling` en rango decreciente; los
+     * árboles de un montículo también, en rango creciente. `extras` es la lista
+     * de elementos sueltos que dejan los enlaces sesgados, como nodos de rango 0.
+     * Un nodo se copia sólo para cambiar su hermano, así que cada versión
+     * comparte todo lo demás.
+     */
+    class HeapNode : public Cell
     {
     public:
-        ProtoSparseListIteratorImplementation(
+        HeapNode(
             ProtoContext* context,
-            int state,
-            ProtoSparseListImplementation* current,
-            ProtoSparseListIteratorImplementation* queue = NULL
+            ProtoPriorityQueueImplementation* element,
+            unsigned long rank,
+            HeapNode* extras,
+            HeapNode* child,
+            HeapNode* sibling
         );
-        ~ProtoSparseListIteratorImplementation();
-
-        int implHasNext(ProtoContext* context);
-        unsigned long implNextKey(ProtoContext* context);
-        ProtoObject* implNextValue(ProtoContext* context);
+        ~HeapNode();
 
-        ProtoSparseListIteratorImplementation* implAdvance(ProtoContext* context);
-        ProtoObject* implAsObject(ProtoContext* context);
         unsigned long getHash(ProtoContext* context);
-
+        ProtoObject* asObject(ProtoContext* context);
         void finalize(ProtoContext* context);
         void processReferences(
             ProtoContext* context,
@@ -489,57 +1927,44 @@ namespace proto
             )
         );
 
-    private:
-        int state;
-        ProtoSparseListImplementation* current;
-        ProtoSparseListIteratorImplementation* queue;
+        ProtoPriorityQueueImplementation* element;
+        unsigned long rank;
+        HeapNode* extras;
+        HeapNode* child;
+        HeapNode* sibling;
     };
 
-    class ProtoSparseListImplementation : public Cell, public ProtoSparseList
+    static_assert(sizeof(HeapNode) <= 64, "HeapNode debe caber en una celda de 64 bytes.");
+
+    /**
+     * @brief Cola de prioridad persistente (Brodal-Okasaki).
+     *
+     * Una cola no vacía guarda su mínimo y un montículo binomial sesgado cuyos
+     * elementos son otras colas. insert, meld y getMin son O(1) peor caso y
+     * removeMin es O(log n) peor caso; ninguna cota es amortizada, así que se
+     * mantienen aunque se opere muchas veces sobre la misma versión.
+     */
+    class ProtoPriorityQueueImplementation : public CollectionCell, public ProtoPriorityQueue
     {
     public:
-        explicit ProtoSparseListImplementation(
+        ProtoPriorityQueueImplementation(
             ProtoContext* context,
-            unsigned long index = 0,
+            ProtoObject* key = PROTO_NONE,
             ProtoObject* value = PROTO_NONE,
-            ProtoSparseListImplementation* previous = NULL,
-            ProtoSparseListImplementation* next = NULL
+            HeapNode* trees = nullptr,
+            unsigned long size = 0
         );
-        ~ProtoSparseListImplementation();
-
-        bool implHas(ProtoContext* context, unsigned long index);
-        ProtoObject* implGetAt(ProtoContext* context, unsigned long index);
-        ProtoSparseListImplementation* implSetAt(ProtoContext* context, unsigned long index, ProtoObject* value);
-        ProtoSparseListImplementation* implRemoveAt(ProtoContext* context, unsigned long index);
-        int implIsEqual(ProtoContext* context, ProtoSparseList* otherDict);
-        ProtoObject* implGetAtOffset(ProtoContext* context, int offset);
+        ~ProtoPriorityQueueImplementation();
 
+        ProtoPriorityQueueImplementation* implInsert(ProtoContext* context, ProtoObject* key, ProtoObject* value);
+        ProtoObject* implGetMinKey(ProtoContext* context);
+        ProtoObject* implGetMin(ProtoContext* context);
+        ProtoPriorityQueueImplementation* implRemoveMin(ProtoContext* context);
+        ProtoPriorityQueueImplementation* implMeld(ProtoContext* context, ProtoPriorityQueueImplementation* other);
         unsigned long implGetSize(ProtoContext* context);
-        ProtoObject* implAsObject(ProtoContext* context);
-        unsigned long getHash(ProtoContext* context);
-        virtual ProtoSparseListIteratorImplementation* implGetIterator(ProtoContext* context);
-
-        void implProcessElements(
-            ProtoContext* context,
-            void* self,
-            void (*method)(
-                ProtoContext* context,
-                void* self,
-                unsigned long index,
-                ProtoObject* value
-            )
-        );
-
-        void implProcessValues(
-            ProtoContext* context,
-            void* self,
-            void (*method)(
-                ProtoContext* context,
-                void* self,
-                ProtoObject* value
-            )
-        );
 
+        unsigned long getHash(ProtoContext* context);
+        ProtoObject* asObject(ProtoContext* context);
         void finalize(ProtoContext* context);
         void processReferences(
             ProtoContext* context,
@@ -551,18 +1976,15 @@ namespace proto
             )
         );
 
-        ProtoSparseListImplementation* previous;
-        ProtoSparseListImplementation* next;
-
-        unsigned long index;
+        ProtoObject* key;
         ProtoObject* value;
-        unsigned long hash;
-
-        unsigned long count : 52;
-        unsigned long height : 8;
-        unsigned long type : 4{};
+        HeapNode* trees;
+        unsigned long size;
     };
 
+    static_assert(sizeof(ProtoPriorityQueueImplementation) <= 64,
+                  "ProtoPriorityQueueImplementation debe caber en una celda de 64 bytes.");
+
     // --- Iterador de Tuplas ---
 #define TUPLE_SIZE 5
 
@@ -583,8 +2005,8 @@ namespace proto
         TupleDictionary(
             ProtoContext* context,
             ProtoTupleImplementation* key = nullptr,
-            TupleDictionary* next = nullptr,
-            TupleDictionary* previous = nullptr
+            TupleDictionary* previous = nullptr,
+            TupleDictionary* next = nullptr
         );
 
         long unsigned int getHash(proto::ProtoContext*);
@@ -673,7 +2095,9 @@ namespace proto
         unsigned long implGetSize(ProtoContext* context);
         ProtoList* implAsList(ProtoContext* context);
         static ProtoTupleImplementation* tupleFromList(ProtoContext* context, ProtoList* list);
+        static ProtoTupleImplementation* tupleFromLeaves(ProtoContext* context, ProtoList* leaves);
         ProtoTupleIteratorImplementation* implGetIterator(ProtoContext* context);
+        ProtoTupleTransientImplementation* implBeginTransient(ProtoContext* context);
         ProtoTupleImplementation* implSetAt(ProtoContext* context, int index, ProtoObject* value);
         bool implHas(ProtoContext* context, ProtoObject* value);
         ProtoTupleImplementation* implInsertAt(ProtoContext* context, int index, ProtoObject* value);
@@ -697,6 +2121,10 @@ namespace proto
         );
 
     private:
+        friend class ProtoTupleTransientImplementation;
+        friend class ProtoTupleCursor;
+        friend class ProtoStringCursor;
+
         unsigned long elementCount:56;
         unsigned long height:8;
         union {
@@ -705,6 +2133,44 @@ namespace proto
         } pointers;
     };
 
+    /**
+     * @brief Editor transitorio de una tupla.
+     *
+     * Llena en su lugar la hoja actual y guarda las hojas completas en un
+     * editor de lista; implPersistent arma los niveles superiores una sola vez
+     * e interna la tupla resultante.
+     */
+    class ProtoTupleTransientImplementation : public Cell, public ProtoTupleTransient
+    {
+    public:
+        ProtoTupleTransientImplementation(ProtoContext* context, ProtoTupleImplementation* base);
+        ~ProtoTupleTransientImplementation();
+
+        ProtoTupleTransientImplementation* implAppendLast(ProtoContext* context, ProtoObject* value);
+        unsigned long implGetSize(ProtoContext* context);
+        ProtoTupleImplementation* implPersistent(ProtoContext* context);
+
+        unsigned long getHash(ProtoContext* context);
+        ProtoObject* asObject(ProtoContext* context);
+        void finalize(ProtoContext* context);
+        void processReferences(
+            ProtoContext* context,
+            void* self,
+            void (*method)(
+                ProtoContext* context,
+                void* self,
+                Cell* cell
+            )
+        );
+
+    private:
+        ProtoListTransientImplementation* leaves;
+        ProtoTupleImplementation* current;
+        ProtoTupleImplementation* result;
+        unsigned long count : 63;
+        unsigned long sealed : 1;
+    };
+
     // --- ProtoStringIterator ---
     // Implementación concreta para el iterador de ProtoString.
     class ProtoStringIteratorImplementation : public Cell, public ProtoStringIterator
@@ -785,6 +2251,8 @@ namespace proto
         );
 
     private:
+        friend class ProtoStringCursor;
+
         ProtoTupleImplementation* baseTuple; // La tupla subyacente que almacena los caracteres.
     };
 
@@ -837,8 +2305,22 @@ namespace proto
     {
     public:
         ProtoMethodCellImplementation(ProtoContext* context, ProtoMethod method);
+        ProtoMethodCellImplementation(ProtoContext* context, ProtoFastMethod fastMethod, ProtoMethod method = nullptr);
 
-        ProtoObject* implInvoke(ProtoContext* context, ProtoList* args, ProtoSparseList* kwargs);
+        ProtoObject* implInvoke(
+            ProtoContext* context,
+            ProtoObject* self,
+            ParentLink* parentLink,
+            ProtoList* args,
+            ProtoSparseList* kwargs
+        );
+        ProtoObject* implInvokeFast(
+            ProtoContext* context,
+            ProtoObject* self,
+            ParentLink* parentLink,
+            unsigned int argc,
+            ProtoObject** argv
+        );
         ProtoObject* implAsObject(ProtoContext* context);
         unsigned long getHash(ProtoContext* context);
         void finalize(ProtoContext* context);
@@ -849,6 +2331,7 @@ namespace proto
 
     private:
         ProtoMethod method{};
+        ProtoFastMethod fastMethod{};
     };
 
     /**
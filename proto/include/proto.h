@@ -0,0 +1,1062 @@
+/*
+ * proto
+ *
+ *  Created on: November, 2017 - Redesign January, 2024
+ *      Author: Gustavo Adrian Marino <gamarino@numaes.com>
+ */
+
+#ifndef PROTO_H_
+#define PROTO_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+
+namespace proto
+{
+	class ProtoStringIterator;
+	class ProtoTupleIterator;
+
+	typedef int BOOLEAN;
+
+	// Usefull constants.
+	// ATENTION: They should be kept on synch with proto_internal.h!
+
+#define PROTO_TRUE ((proto::ProtoObject *)  0x010FL)
+#define PROTO_FALSE ((proto::ProtoObject *) 0x000FL)
+#define PROTO_NONE ((proto::ProtoObject *) NULL)
+
+	// Root base of any internal structure.
+	// All Cell objects should be non mutable once initialized
+	// They could only change their context and nextCell, assuming that the
+	// new nextCell includes the previous chain.
+	// Changing the context or the nextCell are the ONLY changes allowed
+	// (taking into account the previous restriction).
+	// Changes should be atomic
+	//
+	// Cells should be always smaller or equal to 64 bytes.
+	// Been a power of two size has huge advantages and it opens
+	// the posibility to extend the model to massive parallel computers
+	//
+	// Allocations of Cells will be performed in OS page size chunks
+	// Page size is allways a power of two and bigger than 64 bytes
+	// There is no other form of allocation for proto objects or scalars
+	//
+
+	// Forward declarations
+
+	class Cell;
+	class BigCell;
+	class ProtoContext;
+	class ProtoSpace;
+	class DirtySegment;
+	class ProtoObject;
+	class TupleDictionary;
+	class ProtoTuple;
+	class ProtoString;
+	class ParentLink;
+	class ProtoList;
+	class ProtoListIterator;
+	class ProtoListTransient;
+	class ProtoSparseList;
+	class ProtoSparseListIterator;
+	class ProtoSparseListTransient;
+	class ProtoDictionary;
+	class ProtoSortedMap;
+	class ProtoDeque;
+	class ProtoPriorityQueue;
+	class ProtoTupleTransient;
+	class ProtoListCursor;
+	class ProtoTupleCursor;
+	class ProtoStringCursor;
+	class ProtoSparseListCursor;
+	class ProtoObjectCell;
+	class ObjectShape;
+	class MutableShard;
+	class MutablePage;
+
+
+#define PROTO_ATTRIBUTE_CACHE_ENTRIES 4
+#define PROTO_ATTRIBUTE_CACHE_DEPENDENCIES 2
+
+	// Longest root-to-leaf path a cursor can follow. Balanced trees that fit
+	// in memory are far shallower than this.
+#define PROTO_CURSOR_DEPTH 96
+
+	// Mutable objects live in a table of shards, grouped in pages that are
+	// allocated on demand: the table grows without moving. Each thread
+	// reserves a block of ids at a time and hands out dense ids from it; the
+	// unused part of its block is handed to the next thread when it ends.
+#define PROTO_MUTABLE_SHARD_SIZE 1024
+#define PROTO_MUTABLE_PAGE_SIZE 256
+#define PROTO_MUTABLE_MAX_PAGES 16384
+
+	// Call-site cache for attribute lookups.
+	// Keep one per lookup site and pass it to getAttribute / hasAttribute.
+	// It remembers where a name was resolved for a given receiver shape and
+	// parent chain, so a hit is a shape compare plus either one indexed load
+	// (own attributes) or the cached value itself (inherited ones). The first
+	// entry is the monomorphic fast path and the rest are a small polymorphic
+	// fallback. Each entry also remembers the version of the mutable objects
+	// the lookup went through (up to PROTO_ATTRIBUTE_CACHE_DEPENDENCIES of
+	// them); a write to one of those invalidates it, while writes to
+	// unrelated mutable objects do not.
+	// A cache must not be shared between threads.
+	class ProtoAttributeCache
+	{
+	public:
+		ProtoAttributeCache();
+		void reset();
+
+		struct Entry
+		{
+			ObjectShape* shape;       // receiver shape
+			ProtoObject* prototype;   // receiver first parent
+			ParentLink* ancestors;    // rest of the receiver parent chain
+			ProtoObject* holder;      // object holding the value, nullptr for the receiver
+			long slot;                // slot in the receiver shape, -1 if value is cached
+			ProtoObject* value;       // cached value (when slot is -1)
+			unsigned int dependencyCount;
+			std::atomic<unsigned long>* versions[PROTO_ATTRIBUTE_CACHE_DEPENDENCIES];
+			unsigned long expected[PROTO_ATTRIBUTE_CACHE_DEPENDENCIES];
+		};
+
+		unsigned long key;
+		unsigned int nextVictim;
+		Entry entries[PROTO_ATTRIBUTE_CACHE_ENTRIES];
+	};
+
+	typedef ProtoObject*(*ProtoMethod)(
+		ProtoContext*, // context
+		ProtoObject*, // self
+		ParentLink*, // parentLink
+		ProtoList*, // positionalParameters
+		ProtoSparseList* // keywordParameters
+	);
+
+	// Fixed-arity calling convention: positional arguments are passed in a
+	// caller owned array (usually on the C++ stack), so no list is allocated.
+	// Calls with keyword arguments or more than PROTO_MAX_FAST_ARGS arguments
+	// go to the method's generic entry (see ProtoContext::fromFastMethod).
+#define PROTO_MAX_FAST_ARGS 8
+
+	typedef ProtoObject*(*ProtoFastMethod)(
+		ProtoContext*, // context
+		ProtoObject*, // self
+		ParentLink*, // parentLink
+		unsigned int, // argc
+		ProtoObject** // argv
+	);
+
+	// Resolves a key present in both operands of a sparse-list set operation.
+	typedef ProtoObject*(*ProtoMergeFunction)(
+		ProtoContext*, // context
+		void*, // self
+		unsigned long, // key
+		ProtoObject*, // value in the receiver
+		ProtoObject* // value in the other list
+	);
+
+	// Total order between two keys: negative, zero or positive.
+	typedef int(*ProtoCompareFunction)(
+		ProtoContext*, // context
+		ProtoObject*, // a
+		ProtoObject* // b
+	);
+
+	class ProtoObject
+	{
+	public:
+		ProtoObject* getPrototype(const ProtoContext* c);
+		ProtoObject* clone(ProtoContext* c, bool isMutable = false);
+		ProtoObject* newChild(ProtoContext* c, bool isMutable = false);
+
+		ProtoObject* getAttribute(ProtoContext* c, ProtoString* name, ProtoAttributeCache* cache = nullptr);
+		ProtoObject* hasAttribute(ProtoContext* c, ProtoString* name, ProtoAttributeCache* cache = nullptr);
+		ProtoObject* hasOwnAttribute(ProtoContext* c, ProtoString* name);
+		ProtoObject* setAttribute(ProtoContext* c, ProtoString* name, ProtoObject* value);
+		// Sets count attributes at once, producing a single new version of the object.
+		// If a name appears more than once, the last value wins.
+		ProtoObject* setAttributes(ProtoContext* c, unsigned int count, ProtoString** names, ProtoObject** values);
+
+		ProtoSparseList* getAttributes(ProtoContext* c);
+		ProtoSparseList* getOwnAttributes(ProtoContext* c);
+		// Visits every visible attribute (own and inherited) without building a list.
+		// Inherited attributes shadowed by a closer object are skipped.
+		void processAttributes(
+			ProtoContext* c,
+			void* self,
+			void (*method)(
+				ProtoContext* context,
+				void* self,
+				unsigned long key,
+				ProtoObject* value
+			)
+		);
+		ProtoList* getParents(ProtoContext* c);
+
+		ProtoObject* addParent(ProtoContext* c, ProtoObject* newParent);
+
+		// Returns the frozen version of the object and freezes the mutable objects
+		// in its parent chain. An immutable object is frozen into a copy; a
+		// mutable one keeps its identity and is frozen in place. A frozen object
+		// never changes: setAttribute / setAttributes / addParent reject the
+		// write and return NONE. Its visible attributes (own and inherited) are copied to a
+		// flat table, so reads do not walk the parent chain and call-site caches
+		// never need to revalidate them.
+		ProtoObject* freeze(ProtoContext* c);
+		ProtoObject* isFrozen(ProtoContext* c);
+		ProtoObject* isInstanceOf(ProtoContext* c, const ProtoObject* prototype);
+
+		// Resolves 'method' starting at this object (or at nextParent for a
+		// super-call) and invokes it on 'self'. The method receives the parent
+		// link where a super-call must continue: the objects that follow its
+		// holder in the receiver's resolution order.
+		ProtoObject* call(ProtoContext* c,
+		                  ParentLink* nextParent,
+		                  ProtoString* method,
+		                  ProtoObject* self,
+		                  ProtoList* unnamedParametersList = nullptr,
+		                  ProtoSparseList* keywordParametersDict = nullptr,
+		                  ProtoAttributeCache* cache = nullptr);
+		ProtoObject* callFast(ProtoContext* c,
+		                      ParentLink* nextParent,
+		                      ProtoString* method,
+		                      ProtoObject* self,
+		                      unsigned int argc = 0,
+		                      ProtoObject** argv = nullptr,
+		                      ProtoAttributeCache* cache = nullptr);
+
+		unsigned long getHash(ProtoContext* context);
+		int isCell(ProtoContext* context);
+		Cell* asCell(ProtoContext* context);
+
+		void finalize(ProtoContext* context);
+
+		void processReferences(
+			ProtoContext* context,
+			void* self,
+			void (*method)(
+				ProtoContext* context,
+				void* self,
+				Cell* cell
+			)
+		);
+
+
+		bool asBoolean(ProtoContext *context);
+		int asInteger(ProtoContext *context);
+		float asFloat(ProtoContext *context);
+		char asByte(ProtoContext *context);
+		void asDate(ProtoContext *context, unsigned int& year, unsigned& month, unsigned& day);
+		unsigned long asTimestamp(ProtoContext *context);
+		long asTimeDelta(ProtoContext *context);
+
+		bool isBoolean(ProtoContext *context);
+		bool isInteger(ProtoContext *context);
+		bool isFloat(ProtoContext *context);
+		bool isByte(ProtoContext *context);
+		bool isDate(ProtoContext *context);
+		bool isTimestamp(ProtoContext *context);
+		bool isTimeDelta(ProtoContext *context);
+
+		ProtoList * asList(ProtoContext *context);
+		ProtoListIterator * asListIterator(ProtoContext *context);
+		ProtoTuple * asTuple(ProtoContext *context);
+		ProtoTupleIterator * asTupleIterator(ProtoContext *context);
+		ProtoString * asString(ProtoContext *context);
+		ProtoStringIterator * asStringIterator(ProtoContext *context);
+		ProtoSparseList * asSparseList(ProtoContext *context);
+		ProtoSparseListIterator * asSparseListIterator(ProtoContext *context);
+		ProtoDictionary * asDictionary(ProtoContext *context);
+		ProtoSortedMap * asSortedMap(ProtoContext *context);
+		ProtoDeque * asDeque(ProtoContext *context);
+		ProtoPriorityQueue * asPriorityQueue(ProtoContext *context);
+
+	};
+
+
+	// ParentPointers are chains of parent classes used to solve attribute access
+	class ParentLink
+	{
+	public:
+		ProtoObject* getObject(ProtoContext* context);
+		ParentLink* getParent(ProtoContext* context);
+	};
+
+	class ProtoListIterator
+	{
+	public:
+		~ProtoListIterator() = default;
+		int hasNext(ProtoContext* context) ;
+		ProtoObject* next(ProtoContext* context) ;
+		ProtoListIterator* advance(ProtoContext* context) ;
+
+		ProtoObject* asObject(ProtoContext* context) ;
+	};
+
+	class ProtoList
+	{
+	public:
+		~ProtoList() = default;
+		ProtoObject* getAt(ProtoContext* context, int index) ;
+		ProtoObject* getFirst(ProtoContext* context) ;
+		ProtoObject* getLast(ProtoContext* context) ;
+		ProtoList* getSlice(ProtoContext* context, int from, int to) ;
+		unsigned long getSize(ProtoContext* context) ;
+
+		bool has(ProtoContext* context, ProtoObject* value) ;
+		ProtoList* setAt(ProtoContext* context, int index, ProtoObject* value) ;
+		ProtoList* insertAt(ProtoContext* context, int index, ProtoObject* value) ;
+
+		ProtoList* appendFirst(ProtoContext* context, ProtoObject* value) ;
+		ProtoList* appendLast(ProtoContext* context, ProtoObject* value) ;
+
+		ProtoList* extend(ProtoContext* context, ProtoList* other) ;
+
+		ProtoList* splitFirst(ProtoContext* context, int index) ;
+		ProtoList* splitLast(ProtoContext* context, int index) ;
+
+		ProtoList* removeFirst(ProtoContext* context) ;
+		ProtoList* removeLast(ProtoContext* context) ;
+		ProtoList* removeAt(ProtoContext* context, int index) ;
+		ProtoList* removeSlice(ProtoContext* context, int from, int to) ;
+
+		ProtoObject* asObject(ProtoContext* context) ;
+		unsigned long getHash(ProtoContext* context) ;
+		ProtoListIterator* getIterator(ProtoContext* context) ;
+		ProtoListTransient* beginTransient(ProtoContext* context) ;
+	};
+
+	// Transient editors build a collection in place: the nodes they allocate
+	// are owned by the editor and filled without copying. persistent() seals
+	// the result into an ordinary immutable value; after that the editor
+	// rejects further changes (they return nullptr).
+	class ProtoListTransient
+	{
+	public:
+		ProtoListTransient* appendLast(ProtoContext* context, ProtoObject* value) ;
+		unsigned long getSize(ProtoContext* context) ;
+		ProtoList* persistent(ProtoContext* context) ;
+	};
+
+	// Cursors walk a collection in order without allocating. They live on the
+	// C++ stack and keep the path from the root to the current element, so
+	// each step is amortized O(1). nextChunk copies up to out.size() elements
+	// and returns how many it copied. The collection must stay reachable while
+	// the cursor is in use.
+	class ProtoListCursor
+	{
+	public:
+		ProtoListCursor(ProtoContext* context, ProtoList* list);
+		bool hasNext(ProtoContext* context);
+		ProtoObject* next(ProtoContext* context);
+		unsigned long nextChunk(ProtoContext* context, std::span<ProtoObject*> out);
+
+	private:
+		void pushLeftmost(Cell* node);
+
+		Cell* stack[PROTO_CURSOR_DEPTH];   // nodes whose elements are still pending
+		unsigned int depth;
+		unsigned int offset;               // next element in the top node
+	};
+
+	class ProtoTupleIterator
+	{
+	public:
+		~ProtoTupleIterator() = default;
+		int hasNext(ProtoContext* context) ;
+		ProtoObject* next(ProtoContext* context) ;
+		ProtoTupleIterator* advance(ProtoContext* context) ;
+
+		ProtoObject* asObject(ProtoContext* context) ;
+	};
+
+	class ProtoTuple
+	{
+	public:
+		ProtoObject* getAt(ProtoContext* context, int index) ;
+		ProtoObject* getFirst(ProtoContext* context) ;
+		ProtoObject* getLast(ProtoContext* context) ;
+		ProtoObject* getSlice(ProtoContext* context, int from, int to) ;
+		unsigned long getSize(ProtoContext* context) ;
+
+		bool has(ProtoContext* context, ProtoObject* value) ;
+		ProtoObject* setAt(ProtoContext* context, int index, ProtoObject* value) ;
+		ProtoObject* insertAt(ProtoContext* context, int index, ProtoObject* value) ;
+
+		ProtoObject* appendFirst(ProtoContext* context, ProtoTuple* otherTuple) ;
+		ProtoObject* appendLast(ProtoContext* context, ProtoTuple* otherTuple) ;
+
+		ProtoObject* splitFirst(ProtoContext* context, int count) ;
+		ProtoObject* splitLast(ProtoContext* context, int count) ;
+
+		ProtoObject* removeFirst(ProtoContext* context, int count) ;
+		ProtoObject* removeLast(ProtoContext* context, int count) ;
+		ProtoObject* removeAt(ProtoContext* context, int index) ;
+		ProtoObject* removeSlice(ProtoContext* context, int from, int to) ;
+
+		ProtoList* asList(ProtoContext* context) ;
+		ProtoObject* asObject(ProtoContext* context) ;
+		unsigned long getHash(ProtoContext* context) ;
+		ProtoTupleIterator* getIterator(ProtoContext* context) ;
+		ProtoTupleTransient* beginTransient(ProtoContext* context) ;
+	};
+
+	class ProtoTupleTransient
+	{
+	public:
+		ProtoTupleTransient* appendLast(ProtoContext* context, ProtoObject* value) ;
+		unsigned long getSize(ProtoContext* context) ;
+		ProtoTuple* persistent(ProtoContext* context) ;
+	};
+
+	class ProtoStringIterator
+	{
+	public:
+		~ProtoStringIterator() = default;
+		int hasNext(ProtoContext* context) ;
+		ProtoObject* next(ProtoContext* context) ;
+		ProtoStringIterator* advance(ProtoContext* context) ;
+
+		ProtoObject* asObject(ProtoContext* context) ;
+	};
+
+	class ProtoTupleCursor
+	{
+	public:
+		ProtoTupleCursor(ProtoContext* context, ProtoTuple* tuple);
+		bool hasNext(ProtoContext* context);
+		ProtoObject* next(ProtoContext* context);
+		unsigned long nextChunk(ProtoContext* context, std::span<ProtoObject*> out);
+
+	private:
+		void advanceLeaf();
+
+		Cell* path[PROTO_CURSOR_DEPTH];            // one node per level, root first
+		unsigned char index[PROTO_CURSOR_DEPTH];   // position inside each node
+		unsigned int leafLevel;
+		unsigned long remaining;
+	};
+
+	// Walks the characters of a string, as a tuple cursor over its storage.
+	class ProtoStringCursor : public ProtoTupleCursor
+	{
+	public:
+		ProtoStringCursor(ProtoContext* context, ProtoString* string);
+	};
+
+	class ProtoString
+	{
+	public:
+		~ProtoString() = default;
+		int cmp_to_string(ProtoContext* context, ProtoString* otherString);
+
+		ProtoObject* getAt(ProtoContext* context, int index) ;
+		ProtoString* setAt(ProtoContext* context, int index, ProtoObject* character) ;
+		ProtoString* insertAt(ProtoContext* context, int index, ProtoObject* character) ;
+		unsigned long getSize(ProtoContext* context) ;
+		ProtoString* getSlice(ProtoContext* context, int from, int to) ;
+
+		ProtoString* setAtString(ProtoContext* context, int index, ProtoString* otherString) ;
+		ProtoString* insertAtString(ProtoContext* context, int index, ProtoString* otherString) ;
+
+		ProtoString* appendFirst(ProtoContext* context, ProtoString* otherString) ;
+		ProtoString* appendLast(ProtoContext* context, ProtoString* otherString) ;
+
+		ProtoString* splitFirst(ProtoContext* context, int count) ;
+		ProtoString* splitLast(ProtoContext* context, int count) ;
+
+		ProtoString* removeFirst(ProtoContext* context, int count) ;
+		ProtoString* removeLast(ProtoContext* context, int count) ;
+		ProtoString* removeAt(ProtoContext* context, int index) ;
+		ProtoString* removeSlice(ProtoContext* context, int from, int to) ;
+
+		ProtoObject* asObject(ProtoContext* context) ;
+		ProtoList* asList(ProtoContext* context) ;
+		unsigned long getHash(ProtoContext* context) ;
+		ProtoStringIterator* getIterator(ProtoContext* context) ;
+	};
+
+	class ProtoSparseListIterator
+	{
+	public:
+		~ProtoSparseListIterator() = default;
+		int hasNext(ProtoContext* context) ;
+		unsigned long nextKey(ProtoContext* context) ;
+		ProtoObject* nextValue(ProtoContext* context) ;
+		ProtoSparseListIterator* advance(ProtoContext* context) ;
+
+		ProtoObject* asObject(ProtoContext* context) ;
+		void finalize(ProtoContext* context) ;
+	};
+
+	// Ordered cursor over a sparse list: visits keys in increasing order
+	// without allocating. seek() moves to the first key >= the given one, so
+	// a range scan costs O(log n + k).
+	class ProtoSparseListCursor
+	{
+	public:
+		ProtoSparseListCursor(ProtoContext* context, ProtoSparseList* list);
+		bool hasNext(ProtoContext* context);
+		unsigned long nextKey(ProtoContext* context);
+		ProtoObject* nextValue(ProtoContext* context);
+		void advance(ProtoContext* context);
+		void seek(ProtoContext* context, unsigned long key);
+
+	private:
+		void pushLeftmost(Cell* node);
+		void skipEmpty();
+
+		Cell* root;
+		Cell* stack[PROTO_CURSOR_DEPTH];   // top is the current node
+		unsigned int depth;
+	};
+
+	class ProtoSparseList
+	{
+	public:
+		~ProtoSparseList() = default;
+		bool has(ProtoContext* context, unsigned long index) ;
+		ProtoObject* getAt(ProtoContext* context, unsigned long index) ;
+		ProtoSparseList* setAt(ProtoContext* context, unsigned long index, ProtoObject* value) ;
+		ProtoSparseList* removeAt(ProtoContext* context, unsigned long index) ;
+		int isEqual(ProtoContext* context, ProtoSparseList* otherDict) ;
+		bool isOrdered(ProtoContext* context) ;
+
+		// Ordered queries. Ranges are half open, [from, to), and cost O(log n).
+		// sliceRange and removeRange share every subtree outside the cut path.
+		// The key lookups return false when there is no such key.
+		unsigned long countRange(ProtoContext* context, unsigned long from, unsigned long to) ;
+		ProtoSparseList* sliceRange(ProtoContext* context, unsigned long from, unsigned long to) ;
+		ProtoSparseList* removeRange(ProtoContext* context, unsigned long from, unsigned long to) ;
+		bool firstKey(ProtoContext* context, unsigned long* key) ;
+		bool lastKey(ProtoContext* context, unsigned long* key) ;
+		bool floor(ProtoContext* context, unsigned long key, unsigned long* found) ;
+		bool ceiling(ProtoContext* context, unsigned long key, unsigned long* found) ;
+
+		// Set algebra by key. Untouched subtrees of both operands are shared.
+		// Without a merge function, unionWith keeps the value of other and
+		// intersectionWith keeps the value of the receiver. A merge function
+		// that returns NONE drops the key.
+		ProtoSparseList* unionWith(ProtoContext* context, ProtoSparseList* other,
+		                           void* self = nullptr, ProtoMergeFunction merge = nullptr) ;
+		ProtoSparseList* intersectionWith(ProtoContext* context, ProtoSparseList* other,
+		                                  void* self = nullptr, ProtoMergeFunction merge = nullptr) ;
+		ProtoSparseList* differenceWith(ProtoContext* context, ProtoSparseList* other) ;
+
+		unsigned long getSize(ProtoContext* context) ;
+		ProtoObject* asObject(ProtoContext* context) ;
+		unsigned long getHash(ProtoContext* context) ;
+		ProtoSparseListIterator* getIterator(ProtoContext* context) ;
+		ProtoSparseListTransient* beginTransient(ProtoContext* context) ;
+
+		void processElements(
+			ProtoContext* context,
+			void* self,
+			void (*method)(
+				ProtoContext* context,
+				void* self,
+				unsigned long index,
+				ProtoObject* value
+			)
+		) ;
+
+		void processValues(
+			ProtoContext* context,
+			void* self,
+			void (*method)(
+				ProtoContext* context,
+				void* self,
+				ProtoObject* value
+			)
+		) ;
+	};
+
+	class ProtoSparseListTransient
+	{
+	public:
+		ProtoSparseListTransient* setAt(ProtoContext* context, unsigned long index, ProtoObject* value) ;
+		ProtoSparseListTransient* removeAt(ProtoContext* context, unsigned long index) ;
+		ProtoSparseList* persistent(ProtoContext* context) ;
+	};
+
+	// Persistent hash map over arbitrary keys. Keys match by content: strings,
+	// tuples and lists element by element, sparse lists and dictionaries entry
+	// by entry, and any other value by identity. Setting NONE removes the key.
+	// A dictionary created with insertionOrder visits its entries in the order
+	// their keys were first added; otherwise the order is unspecified.
+	class ProtoDictionary
+	{
+	public:
+		bool has(ProtoContext* context, ProtoObject* key) ;
+		ProtoObject* getAt(ProtoContext* context, ProtoObject* key) ;
+		ProtoDictionary* setAt(ProtoContext* context, ProtoObject* key, ProtoObject* value) ;
+		ProtoDictionary* removeAt(ProtoContext* context, ProtoObject* key) ;
+		unsigned long getSize(ProtoContext* context) ;
+		bool keepsInsertionOrder(ProtoContext* context) ;
+
+		ProtoObject* asObject(ProtoContext* context) ;
+		unsigned long getHash(ProtoContext* context) ;
+
+		void processElements(
+			ProtoContext* context,
+			void* self,
+			void (*method)(
+				ProtoContext* context,
+				void* self,
+				ProtoObject* key,
+				ProtoObject* value
+			)
+		) ;
+	};
+
+	// Persistent ordered map over arbitrary keys, kept as a B+tree. The
+	// comparator fixes the order; two keys it finds equal are the same key.
+	// The built-in comparators are recognized by the map and run inline:
+	// compareNumbers orders embedded values (integers and floats by value,
+	// timestamps, dates and time deltas chronologically) and compareStrings
+	// orders strings by code point. Setting NONE removes the key.
+	class ProtoSortedMap
+	{
+	public:
+		static int compareNumbers(ProtoContext* context, ProtoObject* a, ProtoObject* b);
+		static int compareStrings(ProtoContext* context, ProtoObject* a, ProtoObject* b);
+
+		bool has(ProtoContext* context, ProtoObject* key) ;
+		ProtoObject* getAt(ProtoContext* context, ProtoObject* key) ;
+		ProtoSortedMap* setAt(ProtoContext* context, ProtoObject* key, ProtoObject* value) ;
+		ProtoSortedMap* removeAt(ProtoContext* context, ProtoObject* key) ;
+		unsigned long getSize(ProtoContext* context) ;
+
+		// Ordered queries, O(log n). They return NONE when there is no such key.
+		ProtoObject* firstKey(ProtoContext* context) ;
+		ProtoObject* lastKey(ProtoContext* context) ;
+		ProtoObject* floor(ProtoContext* context, ProtoObject* key) ;
+		ProtoObject* ceiling(ProtoContext* context, ProtoObject* key) ;
+
+		// Rank and select: rank counts the keys below key; keyAt and valueAt
+		// take a rank, from 0 to getSize() - 1.
+		unsigned long rank(ProtoContext* context, ProtoObject* key) ;
+		ProtoObject* keyAt(ProtoContext* context, unsigned long index) ;
+		ProtoObject* valueAt(ProtoContext* context, unsigned long index) ;
+
+		// Range scans over [from, to), in key order. NONE leaves that end open.
+		unsigned long countRange(ProtoContext* context, ProtoObject* from, ProtoObject* to) ;
+		void processRange(
+			ProtoContext* context,
+			ProtoObject* from,
+			ProtoObject* to,
+			void* self,
+			void (*method)(
+				ProtoContext* context,
+				void* self,
+				ProtoObject* key,
+				ProtoObject* value
+			)
+		) ;
+		void processElements(
+			ProtoContext* context,
+			void* self,
+			void (*method)(
+				ProtoContext* context,
+				void* self,
+				ProtoObject* key,
+				ProtoObject* value
+			)
+		) ;
+
+		ProtoObject* asObject(ProtoContext* context) ;
+		unsigned long getHash(ProtoContext* context) ;
+	};
+
+	// Persistent double-ended queue (a 2-3 finger tree). Adding or removing
+	// at either end is amortized O(1); getAt, getSlice, the splits and
+	// extend are O(log n). The read methods follow ProtoList, including
+	// negative indexes counted from the end.
+	class ProtoDeque
+	{
+	public:
+		ProtoObject* getAt(ProtoContext* context, int index) ;
+		ProtoObject* getFirst(ProtoContext* context) ;
+		ProtoObject* getLast(ProtoContext* context) ;
+		ProtoDeque* getSlice(ProtoContext* context, int from, int to) ;
+		unsigned long getSize(ProtoContext* context) ;
+		bool has(ProtoContext* context, ProtoObject* value) ;
+
+		ProtoDeque* appendFirst(ProtoContext* context, ProtoObject* value) ;
+		ProtoDeque* appendLast(ProtoContext* context, ProtoObject* value) ;
+		ProtoDeque* removeFirst(ProtoContext* context) ;
+		ProtoDeque* removeLast(ProtoContext* context) ;
+
+		ProtoDeque* extend(ProtoContext* context, ProtoDeque* other) ;
+		ProtoDeque* splitFirst(ProtoContext* context, int index) ;
+		ProtoDeque* splitLast(ProtoContext* context, int index) ;
+
+		void processValues(
+			ProtoContext* context,
+			void* self,
+			void (*method)(
+				ProtoContext* context,
+				void* self,
+				ProtoObject* value
+			)
+		) ;
+		ProtoList* asList(ProtoContext* context) ;
+		ProtoObject* asObject(ProtoContext* context) ;
+		unsigned long getHash(ProtoContext* context) ;
+	};
+
+	// Persistent min-priority queue (a bootstrapped skew-binomial heap).
+	// insert, getMinKey, getMin and meld are O(1) and removeMin is O(log n),
+	// all worst case, so the bounds hold for every version. Keys are
+	// embedded values (integers, floats, timestamps, dates, time deltas),
+	// ordered as ProtoSortedMap::compareNumbers; insert returns nullptr for
+	// any other key. Values with equal keys come out in no particular order.
+	class ProtoPriorityQueue
+	{
+	public:
+		ProtoPriorityQueue* insert(ProtoContext* context, ProtoObject* key, ProtoObject* value) ;
+		ProtoObject* getMinKey(ProtoContext* context) ;
+		ProtoObject* getMin(ProtoContext* context) ;
+		ProtoPriorityQueue* removeMin(ProtoContext* context) ;
+		ProtoPriorityQueue* meld(ProtoContext* context, ProtoPriorityQueue* other) ;
+		unsigned long getSize(ProtoContext* context) ;
+
+		ProtoObject* asObject(ProtoContext* context) ;
+		unsigned long getHash(ProtoContext* context) ;
+	};
+
+	class ProtoByteBuffer
+	{
+	public:
+		~ProtoByteBuffer() = default;
+		unsigned long getSize(ProtoContext* context) ;
+		char* getBuffer(ProtoContext* context) ;
+		char getAt(ProtoContext* context, int index) ;
+		void setAt(ProtoContext* context, int index, char value) ;
+
+		ProtoObject* asObject(ProtoContext* context) ;
+		unsigned long getHash(ProtoContext* context) ;
+	};
+
+	class ProtoExternalPointer
+	{
+	public:
+		~ProtoExternalPointer() = default;
+		void* getPointer(ProtoContext* context) ;
+		ProtoObject* asObject(ProtoContext* context) ;
+		unsigned long getHash(ProtoContext* context) ;
+	};
+
+	// In order to compile a method the folling structure is recommended:
+	// method (self, parent, p1, p2, p3, p4=init4, p5=init5) {
+	//	   super().method()
+	// }
+	//
+	// ProtoObject *literalForP4, *literalForP5;
+	// ProtoObject *constantForInit4, *constantForInit5;
+	//
+	// ProtoObject *method(ProtoContext *previousContext, ProtoParent *parent, ProtoList *positionalParameters, ProtoSparseList *keywordParameters)
+	//      // Parameters + locals
+	//		struct {
+	//   		ProtoObject *p1, *p2, *p3, *p4, *p5, *l1, *l2, *l3;
+	//		} locals;
+	//		ProtoContext context(previousContext, &locals, sizeof(locals) / sizeof(ProtoObject *));
+	//
+	//		locals.p4 = alreadyInitializedConstantForInit4;
+	//		locals.p5 = alreadyInitializedConstantForInit5;
+	//
+	//      if (positionalParameters) {
+	//     		int unnamedSize = positionalParameters->getSize(&context);
+	//
+	//          if (unnamedSize < 3)
+	//    			raise "Too few parameters. At least 3 positional parameters are expected"
+	//
+	//	    	locals.p1 = positionalParameters->getAt(&context, 0);
+	//	    	locals.p2 = positionalParameters->getAt(&context, 1);
+	//	    	locals.p3 = positionalParameters->getAt(&context, 2);
+	//
+	//          if (unnamedSize > 3)
+	//			    locals.p4 = positionalParameters->getAt(&context, 3);
+	//
+	//          if (unnamedSize > 4)
+	//	    		locals.p5 = positionalParameters->getAt(&context, 4);
+	//
+	//		    if (unnamedSize > 5)
+	//			    raise "Too many parameters"
+	//      }
+	//      else
+	//          raise "At least 3 positional parameters expected"
+	//
+	//      if (keywordParameters) {
+	//          if (keywordParameters->has(&context, literalForP4)) {
+	//	    	    if (unnamedSize > 4)
+	//		    	    raise "Double assignment on p4"
+	//
+	//			    locals.p4 = keywordParameters->getAt(&context, literalForP4);
+	//          }
+	//
+	//          if (keywordParameters->has(&context, literalForP5)) {
+	//	    	    if (unnamedSize > 5)
+	//		    	    raise "Double assignment on p5"
+	//
+	//			    locals.p5 = keywordParameters->getAt(&context, literalForP5);
+	//          }
+	//      }
+	//
+	//		ProtoParent *nextParent;
+	//      if (parent)
+	//		    nextParent = parent;
+	//
+	//      if (nextParent)
+	//          nextParent->object->call(this, nextParent->parent, positionalParameters, keywordParameters);
+	//      else
+	//          raise "There is no super!!"
+	//
+	//
+	//
+	// Not used keywordParameters are not detected
+	// This provides a similar behaviour to Python, and it can be automatically generated based on compilation time info
+	//
+	// You can use try ... catch to handle exceptions or not, it's up to you
+
+	class ProtoMethodCell
+	{
+	public:
+		~ProtoMethodCell() = default;
+		ProtoObject* getSelf(ProtoContext* context) ;
+		ProtoMethod getMethod(ProtoContext* context) ;
+
+		ProtoObject* asObject(ProtoContext* context) ;
+		unsigned long getHash(ProtoContext* context) ;
+	};
+
+	class ProtoObjectCell
+	{
+	public:
+		~ProtoObjectCell() = default;
+		ProtoObjectCell* addParent(ProtoContext* context, ProtoObjectCell* object) ;
+
+		ProtoObject* asObject(ProtoContext* context) ;
+		unsigned long getHash(ProtoContext* context) ;
+
+		unsigned long mutable_ref{};
+		ParentLink* parent{};
+		ProtoSparseList* attributes{};
+	};
+
+	class ProtoThread
+	{
+	public:
+		~ProtoThread() = default;
+		static ProtoThread* getCurrentThread(ProtoContext* context);
+
+		
+
+		void detach(ProtoContext* context) ;
+		void join(ProtoContext* context) ;
+		void exit(ProtoContext* context) ; // ONLY for current thread!!!
+
+		ProtoObject* getName(ProtoContext* context) ;
+		ProtoObject* asObject(ProtoContext* context) ;
+		unsigned long getHash(ProtoContext* context) ;
+		void setCurrentContext(ProtoContext* context) ;
+		void setManaged() ;
+		void setUnmanaged() ;
+		void synchToGC() ;
+	};
+
+	class ProtoContext
+	{
+	public:
+		explicit ProtoContext(
+			ProtoContext* previous = nullptr,
+			ProtoObject** localsBase = nullptr,
+			unsigned int localsCount = 0,
+			ProtoThread* thread = nullptr,
+			ProtoSpace* space = nullptr
+		);
+
+		~ProtoContext();
+
+		ProtoContext* previous;
+		ProtoSpace* space;
+		ProtoThread* thread;
+		ProtoObject** localsBase;
+		unsigned int localsCount;
+
+		void checkCellsCount();
+		void setReturnValue(ProtoContext* context, ProtoObject* returnValue);
+		void addCell2Context(Cell* newCell);
+
+		// Constructors for base types, here to get the right context on invoke
+		ProtoObject* fromInteger(int value);
+		ProtoObject* fromDouble(double value);
+		ProtoObject* fromUTF8Char(const char* utf8OneCharString);
+		ProtoString* fromUTF8String(const char* zeroTerminatedUtf8String);
+		ProtoMethodCell* fromMethod(ProtoObject* self, ProtoMethod method);
+		// 'generic', if given, receives the calls that do not fit the fixed-arity
+		// convention; without it those calls return NONE.
+		ProtoMethodCell* fromFastMethod(ProtoObject* self, ProtoFastMethod method, ProtoMethod generic = nullptr);
+		ProtoExternalPointer* fromExternalPointer(void* pointer);
+		ProtoByteBuffer* fromBuffer(unsigned long length, char* buffer);
+		ProtoByteBuffer* newBuffer(unsigned long length);
+		ProtoObject* fromBoolean(bool value);
+		ProtoObject* fromByte(char c);
+		ProtoObject* fromDate(unsigned year, unsigned month, unsigned day);
+		ProtoObject* fromTimestamp(unsigned long timestamp);
+		ProtoObject* fromTimeDelta(long timedelta);
+
+		ProtoList* newList();
+		// Builds a balanced list in one pass, without rebalancing per element.
+		ProtoList* newListFromArray(ProtoObject* const* values, unsigned long count);
+		template<typename Iterator>
+		ProtoList* newListFromRange(Iterator first, Iterator last)
+		{
+			if constexpr (std::contiguous_iterator<Iterator> &&
+			              std::is_same_v<std::iter_value_t<Iterator>, ProtoObject*>)
+				return this->newListFromArray(std::to_address(first), (unsigned long) (last - first));
+			else
+			{
+				std::vector<ProtoObject*> values(first, last);
+				return this->newListFromArray(values.data(), values.size());
+			}
+		}
+		ProtoTuple* newTuple();
+		ProtoTuple* newTupleFromList(ProtoList* sourceList);
+		ProtoSparseList* newSparseList();
+		// Hash-ordered sparse list: cheaper updates, no key order. Ordered
+		// queries still work, converting to the ordered form first.
+		ProtoSparseList* newUnorderedSparseList();
+		ProtoDictionary* newDictionary(bool insertionOrder = false);
+		ProtoSortedMap* newSortedMap(ProtoCompareFunction compare = ProtoSortedMap::compareNumbers);
+		// Bulk load in O(n) from keys already in strictly increasing order.
+		// Returns nullptr if they are not.
+		ProtoSortedMap* newSortedMapFromArray(ProtoCompareFunction compare,
+		                                      ProtoObject* const* keys,
+		                                      ProtoObject* const* values,
+		                                      unsigned long count);
+		ProtoDeque* newDeque();
+		ProtoPriorityQueue* newPriorityQueue();
+		ProtoObject* newObject(bool mutableObject = false);
+
+		Cell* allocCell();
+
+		Cell* lastAllocatedCell;
+		unsigned int allocatedCellsCount;
+		ProtoObject* lastReturnValue;
+	};
+
+	class ProtoSpace
+	{
+	public:
+		explicit ProtoSpace(
+			ProtoMethod mainFunction,
+			int argc ,
+			char** argv = nullptr
+		);
+		~ProtoSpace();
+
+		ProtoObject* getThreads();
+
+		ProtoObject* objectPrototype;
+		ProtoObject* smallIntegerPrototype;
+		ProtoObject* floatPrototype;
+		ProtoObject* unicodeCharPrototype;
+		ProtoObject* bytePrototype;
+		ProtoObject* nonePrototype;
+		ProtoObject* methodPrototype;
+		ProtoObject* bufferPrototype;
+		ProtoObject* pointerPrototype;
+		ProtoObject* booleanPrototype;
+		ProtoObject* doublePrototype;
+		ProtoObject* datePrototype;
+		ProtoObject* timestampPrototype;
+		ProtoObject* timedeltaPrototype;
+		ProtoObject* threadPrototype;
+		ProtoObject* rootObject;
+
+		ProtoObject* listPrototype;
+		ProtoObject* listIteratorPrototype;
+
+		ProtoObject* tuplePrototype;
+		ProtoObject* tupleIteratorPrototype;
+
+		ProtoObject* stringPrototype;
+		ProtoObject* stringIteratorPrototype;
+
+		ProtoObject* sparseListPrototype;
+		ProtoObject* sparseListIteratorPrototype;
+
+		ProtoObject* dictionaryPrototype;
+		ProtoObject* sortedMapPrototype;
+		ProtoObject* dequePrototype;
+		ProtoObject* priorityQueuePrototype;
+
+		ProtoString* literalGetAttribute;
+		ProtoString* literalSetAttribute;
+		ProtoString* literalCallMethod;
+
+		Cell* getFreeCells(ProtoThread* currentThread);
+		void analyzeUsedCells(Cell* cellsChain);
+		// Moves the given cells to the immortal region. Their references to
+		// cells outside the region are remembered as collector roots.
+		void pinCells(ProtoContext* context, unsigned long count, Cell** cells);
+		// Moves every cell allocated so far in the context to the immortal
+		// region: it is never swept nor traced again, and only the cells it
+		// references outside the region are kept as collector roots.
+		void makeImmortal(ProtoContext* context);
+		// Write barrier for the immortal region: call it after storing 'target'
+		// into a field of 'owner' once the region was built. The region is not
+		// traced, so the owner is remembered and the collector scans its current
+		// fields on every cycle; a replaced value stops being a root.
+		void rememberReference(ProtoContext* context, Cell* owner, Cell* target);
+		void triggerGC();
+		void allocThread(ProtoContext* context, ProtoThread* thread);
+		void deallocThread(ProtoContext* context, ProtoThread* thread);
+
+		ProtoSparseList* threads;
+
+		Cell* freeCells;
+		DirtySegment* dirtySegments;
+		int state;
+
+		unsigned int maxAllocatedCellsPerContext;
+		int blocksPerAllocation;
+		int heapSize;
+		int maxHeapSize;
+		int freeCellsCount;
+		unsigned int gcSleepMilliseconds;
+		int blockOnNoMemory;
+
+		std::atomic<TupleDictionary*> tupleRoot;
+		ObjectShape* rootShape;
+		std::atomic<unsigned long> immortalCells;
+		std::atomic<ProtoSparseList*> rememberedCells;     // References out of the region when it was pinned.
+		std::atomic<ProtoSparseList*> rememberedOwners;    // Immortal cells whose fields changed afterwards.
+		std::atomic<MutablePage*> mutablePages[PROTO_MUTABLE_MAX_PAGES];
+		std::atomic<unsigned long> mutableShardCount;
+		// Unused id ranges left by threads that ended; guarded by mutableLock.
+		std::vector<std::pair<unsigned long, unsigned long>> freeMutableBlocks;
+		std::atomic<bool> mutableLock;
+		std::atomic<bool> threadsLock;
+		std::atomic<bool> gcLock;
+		std::thread::id mainThreadId;
+		std::thread* gcThread;
+		std::condition_variable stopTheWorldCV;
+		std::condition_variable restartTheWorldCV;
+		std::condition_variable gcCV;
+		int gcStarted;
+
+		static std::mutex globalMutex;
+	};
+
+}
+
+#endif /* PROTO_H_ */
\ No newline at end of file
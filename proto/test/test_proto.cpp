@@ -11,6 +11,10 @@
 #include <string>
 #include <chrono>
 #include <thread>
+#include <vector>
+#include <deque>
+#include <map>
+#include <algorithm>
 #include "../headers/proto.h"
 
 // --- Simple Assertion Macro ---
@@ -32,6 +36,31 @@ void test_tuple_operations(proto::ProtoContext& c);
 void test_string_operations(proto::ProtoContext& c);
 void test_sparse_list_operations(proto::ProtoContext& c);
 void test_prototypes_and_inheritance(proto::ProtoContext& c);
+void test_attribute_shapes(proto::ProtoContext& c);
+void test_attribute_caches(proto::ProtoContext& c);
+void test_attribute_batches(proto::ProtoContext& c);
+void test_inline_attributes(proto::ProtoContext& c);
+void test_resolution_order(proto::ProtoContext& c);
+void test_instance_checks(proto::ProtoContext& c);
+void test_attribute_view(proto::ProtoContext& c);
+void test_method_dispatch(proto::ProtoContext& c);
+void test_mutable_objects(proto::ProtoContext& c);
+void test_frozen_objects(proto::ProtoContext& c);
+void test_immortal_objects(proto::ProtoContext& c);
+void test_list_chunks(proto::ProtoContext& c);
+void test_transients(proto::ProtoContext& c);
+void test_list_from_array(proto::ProtoContext& c);
+void test_list_join_split(proto::ProtoContext& c);
+void test_cursors(proto::ProtoContext& c);
+void test_sparse_list_cursor(proto::ProtoContext& c);
+void test_sparse_list_ranges(proto::ProtoContext& c);
+void test_sparse_list_set_algebra(proto::ProtoContext& c);
+void test_sparse_hash(proto::ProtoContext& c);
+void test_sparse_array(proto::ProtoContext& c);
+void test_dictionary(proto::ProtoContext& c);
+void test_sorted_map(proto::ProtoContext& c);
+void test_deque(proto::ProtoContext& c);
+void test_priority_queue(proto::ProtoContext& c);
 void test_gc_stress(proto::ProtoContext& c);
 
 
@@ -54,6 +83,31 @@ proto::ProtoObject* main_test_function(
     test_string_operations(*c);
     test_sparse_list_operations(*c);
     test_prototypes_and_inheritance(*c);
+    test_attribute_shapes(*c);
+    test_attribute_caches(*c);
+    test_attribute_batches(*c);
+    test_inline_attributes(*c);
+    test_resolution_order(*c);
+    test_instance_checks(*c);
+    test_attribute_view(*c);
+    test_method_dispatch(*c);
+    test_mutable_objects(*c);
+    test_frozen_objects(*c);
+    test_immortal_objects(*c);
+    test_list_chunks(*c);
+    test_transients(*c);
+    test_list_from_array(*c);
+    test_list_join_split(*c);
+    test_cursors(*c);
+    test_sparse_list_cursor(*c);
+    test_sparse_list_ranges(*c);
+    test_sparse_list_set_algebra(*c);
+    test_sparse_hash(*c);
+    test_sparse_array(*c);
+    test_dictionary(*c);
+    test_sorted_map(*c);
+    test_deque(*c);
+    test_priority_queue(*c);
     test_gc_stress(*c);
 
     printf("\n=======================================\n");
@@ -283,6 +337,104 @@ void test_prototypes_and_inheritance(proto::ProtoContext& c) {
     ASSERT(child3->getAttribute(&c, name_attr)->isCell(&c), "The inherited 'name' attribute is a string cell");
 }
 
+void test_attribute_shapes(proto::ProtoContext& c) {
+    printf("\n--- Testing Attribute Shapes ---\n");
+
+    proto::ProtoString* x_attr = c.fromUTF8String("x");
+    proto::ProtoString* y_attr = c.fromUTF8String("y");
+
+    // Two objects built the same way, with different values.
+    proto::ProtoObject* p1 = c.newObject()->setAttribute(&c, x_attr, c.fromInteger(1));
+    p1 = p1->setAttribute(&c, y_attr, c.fromInteger(2));
+    proto::ProtoObject* p2 = c.newObject()->setAttribute(&c, x_attr, c.fromInteger(10));
+    p2 = p2->setAttribute(&c, y_attr, c.fromInteger(20));
+
+    ASSERT(p1->getAttribute(&c, x_attr)->asInteger(&c) == 1, "First object keeps its 'x' value");
+    ASSERT(p2->getAttribute(&c, y_attr)->asInteger(&c) == 20, "Second object keeps its 'y' value");
+    ASSERT(p1->getOwnAttributes(&c)->getSize(&c) == 2, "Own attributes are materialized from the shape");
+
+    // Overwriting an existing attribute keeps the other slots intact.
+    proto::ProtoObject* p3 = p1->setAttribute(&c, x_attr, c.fromInteger(5));
+    ASSERT(p3->getAttribute(&c, x_attr)->asInteger(&c) == 5, "Overwritten attribute has the new value");
+    ASSERT(p3->getAttribute(&c, y_attr)->asInteger(&c) == 2, "Other attribute is preserved after overwrite");
+    ASSERT(p1->getAttribute(&c, x_attr)->asInteger(&c) == 1, "Original object is immutable after overwrite");
+
+    // Growing past the shape limit switches to the dictionary representation.
+    const int many = 100;
+    proto::ProtoObject* big = c.newObject();
+    for (int i = 0; i < many; ++i) {
+        std::string name = "attr" + std::to_string(i);
+        big = big->setAttribute(&c, c.fromUTF8String(name.c_str()), c.fromInteger(i));
+    }
+    ASSERT(big->getOwnAttributes(&c)->getSize(&c) == many, "Object with many attributes keeps all of them");
+    ASSERT(big->getAttribute(&c, c.fromUTF8String("attr7"))->asInteger(&c) == 7, "Early attribute is readable");
+    ASSERT(big->getAttribute(&c, c.fromUTF8String("attr99"))->asInteger(&c) == 99, "Late attribute is readable");
+
+    // Children of a shaped prototype inherit through the chain.
+    proto::ProtoObject* child = p1->newChild(&c);
+    ASSERT(child->getOwnAttributes(&c)->getSize(&c) == 0, "New child has no own attributes");
+    ASSERT(child->getAttribute(&c, y_attr)->asInteger(&c) == 2, "Child reads attribute stored in the parent's slots");
+    ASSERT(child->getAttributes(&c)->getSize(&c) == 2, "Merged attributes include inherited slots");
+}
+
+void test_attribute_caches(proto::ProtoContext& c) {
+    printf("\n--- Testing Attribute Lookup Caches ---\n");
+
+    proto::ProtoString* kind_attr = c.fromUTF8String("kind");
+    proto::ProtoString* id_attr = c.fromUTF8String("id");
+    proto::ProtoString* extra_attr = c.fromUTF8String("extra");
+    proto::ProtoString* missing_attr = c.fromUTF8String("missing");
+
+    proto::ProtoObject* base = c.newObject()->setAttribute(&c, kind_attr, c.fromInteger(42));
+
+    // Monomorphic site: many receivers with the same shape and parent.
+    proto::ProtoAttributeCache idCache;
+    proto::ProtoAttributeCache kindCache;
+    bool allOk = true;
+    for (int i = 0; i < 50; ++i) {
+        proto::ProtoObject* obj = base->newChild(&c)->setAttribute(&c, id_attr, c.fromInteger(i));
+        if (obj->getAttribute(&c, id_attr, &idCache)->asInteger(&c) != i)
+            allOk = false;
+        if (obj->getAttribute(&c, kind_attr, &kindCache)->asInteger(&c) != 42)
+            allOk = false;
+    }
+    ASSERT(allOk, "Cached lookups return each receiver's own and inherited values");
+    ASSERT(idCache.entries[0].slot >= 0 && idCache.entries[1].shape == nullptr,
+           "Own attributes are cached as a slot index shared by every receiver");
+    ASSERT(kindCache.entries[0].slot < 0 && kindCache.entries[0].value->asInteger(&c) == 42,
+           "Inherited attributes are cached as values");
+
+    // Polymorphic site: alternate between two shapes.
+    proto::ProtoObject* a = base->newChild(&c)->setAttribute(&c, id_attr, c.fromInteger(1));
+    proto::ProtoObject* b = base->newChild(&c)->setAttribute(&c, extra_attr, c.fromInteger(0));
+    b = b->setAttribute(&c, id_attr, c.fromInteger(2));
+    proto::ProtoAttributeCache polyCache;
+    allOk = true;
+    for (int i = 0; i < 10; ++i) {
+        if (a->getAttribute(&c, id_attr, &polyCache)->asInteger(&c) != 1)
+            allOk = false;
+        if (b->getAttribute(&c, id_attr, &polyCache)->asInteger(&c) != 2)
+            allOk = false;
+    }
+    ASSERT(allOk, "Polymorphic cache resolves both shapes");
+
+    // Negative results and name changes on the same cache.
+    proto::ProtoAttributeCache sharedCache;
+    ASSERT(a->getAttribute(&c, missing_attr, &sharedCache) == PROTO_NONE, "Missing attribute is NONE");
+    ASSERT(a->getAttribute(&c, missing_attr, &sharedCache) == PROTO_NONE, "Cached missing attribute is still NONE");
+    ASSERT(a->getAttribute(&c, kind_attr, &sharedCache)->asInteger(&c) == 42, "Cache follows a change of name");
+    ASSERT(!a->hasAttribute(&c, missing_attr, &sharedCache)->asBoolean(&c), "hasAttribute uses the cache too");
+
+    // An own slot holding NONE falls back to the prototype.
+    proto::ProtoObject* shadow = base->newChild(&c)->setAttribute(&c, kind_attr, c.fromInteger(7));
+    proto::ProtoObject* cleared = base->newChild(&c)->setAttribute(&c, kind_attr, PROTO_NONE);
+    proto::ProtoAttributeCache shadowCache;
+    ASSERT(shadow->getAttribute(&c, kind_attr, &shadowCache)->asInteger(&c) == 7, "Own value shadows the prototype");
+    ASSERT(cleared->getAttribute(&c, kind_attr, &shadowCache)->asInteger(&c) == 42,
+           "Cleared own value falls back to the prototype");
+    ASSERT(shadow->getAttribute(&c, kind_attr, &shadowCache)->asInteger(&c) == 7, "Shadowing survives the fallback");
+}
+
 void test_gc_stress(proto::ProtoContext& c) {
     printf("\n--- Testing Garbage Collector (GC Stress Test) ---\n");
 
@@ -321,3 +473,1835 @@ void test_gc_stress(proto::ProtoContext& c) {
     printf("   GC Stress Test completed without failures.\n");
 }
 
+// --- Methods used by test_method_dispatch ---
+
+proto::ProtoObject* describe_method(
+    proto::ProtoContext* c,
+    proto::ProtoObject* self,
+    proto::ParentLink* parentLink,
+    proto::ProtoList* args,
+    proto::ProtoSparseList* kwargs
+) {
+    return c->fromInteger(100 + (int) (args ? args->getSize(c) : 0));
+}
+
+proto::ProtoObject* add_method(
+    proto::ProtoContext* c,
+    proto::ProtoObject* self,
+    proto::ParentLink* parentLink,
+    unsigned int argc,
+    proto::ProtoObject** argv
+) {
+    if (argc != 2)
+        return PROTO_NONE;
+    return c->fromInteger(argv[0]->asInteger(c) + argv[1]->asInteger(c));
+}
+
+// Generic entry of "add": any number of positional arguments, plus 1000 per keyword.
+proto::ProtoObject* add_generic_method(
+    proto::ProtoContext* c,
+    proto::ProtoObject* self,
+    proto::ParentLink* parentLink,
+    proto::ProtoList* args,
+    proto::ProtoSparseList* kwargs
+) {
+    int sum = kwargs ? 1000 * (int) kwargs->getSize(c) : 0;
+    for (unsigned long i = 0; args && i < args->getSize(c); ++i)
+        sum += args->getAt(c, (int) i)->asInteger(c);
+    return c->fromInteger(sum);
+}
+
+proto::ProtoObject* add_override_method(
+    proto::ProtoContext* c,
+    proto::ProtoObject* self,
+    proto::ParentLink* parentLink,
+    unsigned int argc,
+    proto::ProtoObject** argv
+) {
+    // Super call: continue the lookup from the parent of the defining object.
+    proto::ProtoObject* base = self->callFast(c, parentLink, c->fromUTF8String("add"), self, argc, argv);
+    return c->fromInteger(base->asInteger(c) + 1000);
+}
+
+// Cooperative "tag" methods for a diamond: each one appends its digit to the
+// result of the next implementation in the receiver's resolution order.
+proto::ProtoObject* tag_root_method(
+    proto::ProtoContext* c,
+    proto::ProtoObject* self,
+    proto::ParentLink* parentLink,
+    unsigned int argc,
+    proto::ProtoObject** argv
+) {
+    return c->fromInteger(1);
+}
+
+proto::ProtoObject* tag_left_method(
+    proto::ProtoContext* c,
+    proto::ProtoObject* self,
+    proto::ParentLink* parentLink,
+    unsigned int argc,
+    proto::ProtoObject** argv
+) {
+    proto::ProtoObject* next = self->callFast(c, parentLink, c->fromUTF8String("tag"), self, argc, argv);
+    return c->fromInteger(next->asInteger(c) * 10 + 2);
+}
+
+proto::ProtoObject* tag_right_method(
+    proto::ProtoContext* c,
+    proto::ProtoObject* self,
+    proto::ParentLink* parentLink,
+    proto::ProtoList* args,
+    proto::ProtoSparseList* kwargs
+) {
+    proto::ProtoObject* next = self->call(c, parentLink, c->fromUTF8String("tag"), self, args, kwargs);
+    return c->fromInteger(next->asInteger(c) * 10 + 3);
+}
+
+void test_method_dispatch(proto::ProtoContext& c) {
+    printf("\n--- Testing Method Dispatch ---\n");
+
+    proto::ProtoString* describe_name = c.fromUTF8String("describe");
+    proto::ProtoString* add_name = c.fromUTF8String("add");
+    proto::ProtoString* missing_name = c.fromUTF8String("missing");
+
+    proto::ProtoObject* base = c.newObject();
+    base = base->setAttribute(&c, describe_name, c.fromMethod(base, describe_method)->asObject(&c));
+    base = base->setAttribute(&c, add_name, c.fromFastMethod(base, add_method)->asObject(&c));
+
+    proto::ProtoObject* argv[2] = {c.fromInteger(3), c.fromInteger(4)};
+    ASSERT(base->callFast(&c, nullptr, add_name, base, 2, argv)->asInteger(&c) == 7,
+           "callFast invokes a fast method with stack arguments");
+    ASSERT(base->callFast(&c, nullptr, describe_name, base, 2, argv)->asInteger(&c) == 102,
+           "callFast adapts arguments for a classic method");
+
+    proto::ProtoList* args = c.newList()->appendLast(&c, c.fromInteger(5))->appendLast(&c, c.fromInteger(6));
+    ASSERT(base->call(&c, nullptr, add_name, base, args, nullptr)->asInteger(&c) == 11,
+           "call unpacks a list for a fast method");
+    ASSERT(base->call(&c, nullptr, missing_name, base, args, nullptr) == PROTO_NONE,
+           "Calling a missing method returns NONE");
+
+    proto::ProtoObject* child = base->newChild(&c);
+    child = child->setAttribute(&c, add_name, c.fromFastMethod(child, add_override_method)->asObject(&c));
+    ASSERT(child->callFast(&c, nullptr, add_name, child, 2, argv)->asInteger(&c) == 1007,
+           "Overriding method reaches the parent implementation through parentLink");
+
+    // A call site cache keeps dispatching correctly across receivers.
+    proto::ProtoAttributeCache siteCache;
+    bool allOk = true;
+    for (int i = 0; i < 20; ++i) {
+        proto::ProtoObject* receiver = (i % 2 ? base : child)->newChild(&c);
+        int expected = i % 2 ? 7 : 1007;
+        if (receiver->callFast(&c, nullptr, add_name, receiver, 2, argv, &siteCache)->asInteger(&c) != expected)
+            allOk = false;
+    }
+    ASSERT(allOk, "Cached call sites dispatch to the right method");
+
+    // Diamond D(C, B), B(A), C(A): super calls follow D's resolution order,
+    // so the one from C reaches B before the shared ancestor A.
+    proto::ProtoString* tag_name = c.fromUTF8String("tag");
+    proto::ProtoObject* tagA = c.newObject();
+    tagA = tagA->setAttribute(&c, tag_name, c.fromFastMethod(tagA, tag_root_method)->asObject(&c));
+    proto::ProtoObject* tagB = tagA->newChild(&c);
+    tagB = tagB->setAttribute(&c, tag_name, c.fromFastMethod(tagB, tag_left_method)->asObject(&c));
+    proto::ProtoObject* tagC = tagA->newChild(&c);
+    tagC = tagC->setAttribute(&c, tag_name, c.fromMethod(tagC, tag_right_method)->asObject(&c));
+    proto::ProtoObject* tagD = tagB->newChild(&c)->addParent(&c, tagC);
+
+    ASSERT(tagB->callFast(&c, nullptr, tag_name, tagB, 0, nullptr)->asInteger(&c) == 12,
+           "Single inheritance super call reaches the parent");
+    ASSERT(tagD->callFast(&c, nullptr, tag_name, tagD, 0, nullptr)->asInteger(&c) == 123,
+           "callFast: super calls in a diamond visit every branch before the shared ancestor");
+    ASSERT(tagD->call(&c, nullptr, tag_name, tagD, c.newList(), nullptr)->asInteger(&c) == 123,
+           "call: super calls in a diamond visit every branch before the shared ancestor");
+    proto::ProtoAttributeCache tagCache;
+    ASSERT(tagD->callFast(&c, nullptr, tag_name, tagD, 0, nullptr, &tagCache)->asInteger(&c) == 123 &&
+           tagD->callFast(&c, nullptr, tag_name, tagD, 0, nullptr, &tagCache)->asInteger(&c) == 123,
+           "Cached diamond dispatch keeps the cooperative order");
+
+    // Calls that do not fit the fixed-arity convention use the generic entry.
+    proto::ProtoSparseList* kwargs = c.newSparseList()->setAt(&c, add_name->getHash(&c), c.fromInteger(1));
+    ASSERT(base->call(&c, nullptr, add_name, base, args, kwargs) == PROTO_NONE,
+           "A fast method without a generic entry rejects keyword arguments");
+
+    proto::ProtoObject* flexible = c.newObject();
+    flexible = flexible->setAttribute(&c, add_name,
+                                      c.fromFastMethod(flexible, add_method, add_generic_method)->asObject(&c));
+    ASSERT(flexible->callFast(&c, nullptr, add_name, flexible, 2, argv)->asInteger(&c) == 7,
+           "A call that fits uses the fast entry");
+    ASSERT(flexible->call(&c, nullptr, add_name, flexible, args, kwargs)->asInteger(&c) == 1011,
+           "Keyword arguments go to the generic entry");
+
+    proto::ProtoObject* many[PROTO_MAX_FAST_ARGS + 2];
+    for (int i = 0; i < PROTO_MAX_FAST_ARGS + 2; ++i)
+        many[i] = c.fromInteger(i + 1);
+    ASSERT(flexible->callFast(&c, nullptr, add_name, flexible, PROTO_MAX_FAST_ARGS + 2, many)->asInteger(&c) == 55,
+           "Too many arguments for the fast entry go to the generic entry");
+    proto::ProtoList* manyList = c.newList();
+    for (auto* value : many)
+        manyList = manyList->appendLast(&c, value);
+    ASSERT(flexible->call(&c, nullptr, add_name, flexible, manyList, nullptr)->asInteger(&c) == 55,
+           "call with too many arguments uses the generic entry");
+}
+
+void test_mutable_objects(proto::ProtoContext& c) {
+    printf("\n--- Testing Mutable Objects ---\n");
+
+    proto::ProtoString* count_attr = c.fromUTF8String("count");
+    proto::ProtoString* label_attr = c.fromUTF8String("label");
+
+    proto::ProtoObject* counter = c.newObject(true);
+    ASSERT(counter->setAttribute(&c, count_attr, c.fromInteger(1)) == counter,
+           "setAttribute on a mutable object returns the same handle");
+    ASSERT(counter->getAttribute(&c, count_attr)->asInteger(&c) == 1, "Mutable object sees its new attribute");
+
+    counter->setAttribute(&c, count_attr, c.fromInteger(2));
+    counter->setAttribute(&c, label_attr, c.fromInteger(99));
+    ASSERT(counter->getAttribute(&c, count_attr)->asInteger(&c) == 2, "Mutable object keeps the latest value");
+    ASSERT(counter->hasOwnAttribute(&c, label_attr)->asBoolean(&c), "Mutable object accumulates attributes");
+
+    // Children see changes made to a mutable prototype after they were created.
+    proto::ProtoObject* child = counter->newChild(&c);
+    proto::ProtoAttributeCache cache;
+    ASSERT(child->getAttribute(&c, count_attr, &cache)->asInteger(&c) == 2, "Child inherits from a mutable prototype");
+    counter->setAttribute(&c, count_attr, c.fromInteger(3));
+    ASSERT(child->getAttribute(&c, count_attr, &cache)->asInteger(&c) == 3,
+           "Child observes updates to a mutable prototype");
+
+    // Entries depend only on the mutable objects the lookup went through.
+    proto::ProtoObject* unrelated = c.newObject(true);
+    unrelated->setAttribute(&c, count_attr, c.fromInteger(50));
+    proto::ProtoAttributeCache::Entry& entry = cache.entries[1];
+    ASSERT(entry.dependencyCount == 1 && entry.versions[0]->load() == entry.expected[0],
+           "Writing an unrelated mutable object keeps the cache entry valid");
+    ASSERT(child->getAttribute(&c, count_attr, &cache)->asInteger(&c) == 3, "Valid entry still returns the value");
+
+    // A mutable object in the middle of the chain can start shadowing its prototype.
+    proto::ProtoObject* middle = counter->newChild(&c, true);
+    proto::ProtoObject* leaf = middle->newChild(&c);
+    proto::ProtoAttributeCache leafCache;
+    ASSERT(leaf->getAttribute(&c, count_attr, &leafCache)->asInteger(&c) == 3, "Leaf inherits through the middle object");
+    middle->setAttribute(&c, count_attr, c.fromInteger(4));
+    ASSERT(leaf->getAttribute(&c, count_attr, &leafCache)->asInteger(&c) == 4,
+           "A new attribute on a mutable ancestor invalidates entries that went past it");
+
+    // Each mutable object has its own entry in the table.
+    proto::ProtoObject* other = counter->clone(&c, true);
+    other->setAttribute(&c, count_attr, c.fromInteger(10));
+    ASSERT(other->getAttribute(&c, count_attr)->asInteger(&c) == 10, "Mutable clone has its own value");
+    ASSERT(counter->getAttribute(&c, count_attr)->asInteger(&c) == 3, "Original mutable object is not affected");
+    ASSERT(counter->clone(&c, true)->getAttribute(&c, label_attr)->asInteger(&c) == 99 &&
+           counter->clone(&c)->getAttribute(&c, count_attr)->asInteger(&c) == 3,
+           "Clones copy the values written after the object was created");
+
+    // Enough objects to span several blocks of the table.
+    bool allOk = true;
+    const int mutableCount = 2500;
+    std::vector<proto::ProtoObject*> mutables(mutableCount);
+    for (int i = 0; i < mutableCount; ++i) {
+        mutables[i] = c.newObject(true);
+        if (mutables[i] == PROTO_NONE)
+            allOk = false;
+        else
+            mutables[i]->setAttribute(&c, count_attr, c.fromInteger(i));
+    }
+    for (int i = 0; allOk && i < mutableCount; ++i)
+        if (mutables[i]->getAttribute(&c, count_attr)->asInteger(&c) != i)
+            allOk = false;
+    ASSERT(allOk, "Many mutable objects keep independent values");
+
+    // A batch update publishes all attributes at once.
+    proto::ProtoString* names[2] = {count_attr, label_attr};
+    proto::ProtoObject* values[2] = {c.fromInteger(20), c.fromInteger(21)};
+    ASSERT(counter->setAttributes(&c, 2, names, values) == counter, "setAttributes on a mutable object returns the same handle");
+    ASSERT(counter->getAttribute(&c, count_attr)->asInteger(&c) == 20 &&
+           counter->getAttribute(&c, label_attr)->asInteger(&c) == 21,
+           "Mutable object sees every attribute of the batch");
+}
+
+void test_attribute_batches(proto::ProtoContext& c) {
+    printf("\n--- Testing Attribute Batches ---\n");
+
+    proto::ProtoString* names[12];
+    proto::ProtoObject* values[12];
+    for (int i = 0; i < 12; ++i) {
+        std::string name = "batch_" + std::to_string(i);
+        names[i] = c.fromUTF8String(name.c_str());
+        values[i] = c.fromInteger(i * 10);
+    }
+
+    proto::ProtoObject* empty = c.newObject();
+    proto::ProtoObject* obj = empty->setAttributes(&c, 12, names, values);
+    bool allOk = true;
+    for (int i = 0; i < 12; ++i)
+        if (obj->getAttribute(&c, names[i])->asInteger(&c) != i * 10)
+            allOk = false;
+    ASSERT(allOk, "setAttributes sets every attribute of the batch");
+    ASSERT(empty->hasOwnAttribute(&c, names[0]) == PROTO_FALSE, "Original object is immutable after setAttributes");
+
+    // Same shape as setting the attributes one by one.
+    proto::ProtoObject* oneByOne = c.newObject();
+    for (int i = 0; i < 12; ++i)
+        oneByOne = oneByOne->setAttribute(&c, names[i], values[i]);
+    proto::ProtoAttributeCache cache;
+    ASSERT(oneByOne->getAttribute(&c, names[7], &cache)->asInteger(&c) == 70 &&
+           obj->getAttribute(&c, names[7], &cache)->asInteger(&c) == 70,
+           "Batch and single updates resolve through the same cache");
+
+    // Overwrites mixed with new names; later duplicates win.
+    proto::ProtoString* updateNames[3] = {names[3], c.fromUTF8String("batch_new"), names[3]};
+    proto::ProtoObject* updateValues[3] = {c.fromInteger(1), c.fromInteger(2), c.fromInteger(3)};
+    proto::ProtoObject* updated = obj->setAttributes(&c, 3, updateNames, updateValues);
+    ASSERT(updated->getAttribute(&c, names[3])->asInteger(&c) == 3, "Last duplicate in a batch wins");
+    ASSERT(updated->getAttribute(&c, updateNames[1])->asInteger(&c) == 2, "Batch adds new attributes");
+    ASSERT(updated->getAttribute(&c, names[11])->asInteger(&c) == 110, "Batch preserves other attributes");
+    ASSERT(obj->getAttribute(&c, names[3])->asInteger(&c) == 30, "Previous version is unchanged");
+
+    // Batches that exceed the shape limit fall back to dictionary mode.
+    const int manyCount = 80;
+    proto::ProtoString* manyNames[manyCount];
+    proto::ProtoObject* manyValues[manyCount];
+    for (int i = 0; i < manyCount; ++i) {
+        std::string name = "many_batch_" + std::to_string(i);
+        manyNames[i] = c.fromUTF8String(name.c_str());
+        manyValues[i] = c.fromInteger(i);
+    }
+    proto::ProtoObject* big = c.newObject()->setAttributes(&c, manyCount, manyNames, manyValues);
+    allOk = true;
+    for (int i = 0; i < manyCount; ++i)
+        if (big->getAttribute(&c, manyNames[i])->asInteger(&c) != i)
+            allOk = false;
+    ASSERT(allOk, "Large batch keeps every attribute");
+}
+
+void test_resolution_order(proto::ProtoContext& c) {
+    printf("\n--- Testing Prototype Resolution Order ---\n");
+
+    proto::ProtoString* x_attr = c.fromUTF8String("x");
+    proto::ProtoString* y_attr = c.fromUTF8String("y");
+    proto::ProtoString* z_attr = c.fromUTF8String("z");
+
+    // Diamond: D inherits from B and C, which both inherit from A.
+    proto::ProtoObject* a = c.newObject()->setAttribute(&c, x_attr, c.fromInteger(1));
+    a = a->setAttribute(&c, z_attr, c.fromInteger(100));
+    proto::ProtoObject* b = a->newChild(&c)->setAttribute(&c, x_attr, c.fromInteger(2));
+    proto::ProtoObject* cc = a->newChild(&c)->setAttribute(&c, y_attr, c.fromInteger(3));
+    proto::ProtoObject* d = b->newChild(&c)->addParent(&c, cc);
+
+    proto::ProtoList* parents = d->getParents(&c);
+    ASSERT(parents->getSize(&c) == 3, "Diamond linearization lists each ancestor once");
+    ASSERT(parents->getAt(&c, 0) == cc && parents->getAt(&c, 1) == b && parents->getAt(&c, 2) == a,
+           "Diamond linearization puts the shared ancestor last");
+
+    ASSERT(d->getAttribute(&c, x_attr)->asInteger(&c) == 2, "Override in one branch wins over the shared ancestor");
+    ASSERT(d->getAttribute(&c, y_attr)->asInteger(&c) == 3, "Attribute from the added parent is visible");
+    ASSERT(d->getAttribute(&c, z_attr)->asInteger(&c) == 100, "Attribute from the shared ancestor is visible");
+    ASSERT(d->getAttributes(&c)->getSize(&c) == 3, "getAttributes merges the whole resolution order");
+
+    ASSERT(d->isInstanceOf(&c, a)->asBoolean(&c), "isInstanceOf finds the shared ancestor");
+    ASSERT(d->isInstanceOf(&c, b)->asBoolean(&c), "isInstanceOf finds the first branch");
+    ASSERT(!b->isInstanceOf(&c, cc)->asBoolean(&c), "isInstanceOf rejects an unrelated branch");
+
+    // Long single-inheritance chains share their resolution order blocks.
+    proto::ProtoObject* deep = a;
+    for (int i = 0; i < 20; ++i)
+        deep = deep->newChild(&c);
+    ASSERT(deep->getParents(&c)->getSize(&c) == 20, "Deep chain lists every ancestor");
+    ASSERT(deep->isInstanceOf(&c, a)->asBoolean(&c), "Deep chain reaches the root prototype");
+    ASSERT(deep->getAttribute(&c, z_attr)->asInteger(&c) == 100, "Deep chain inherits from the root prototype");
+
+    // Cached lookups distinguish chains that share their first parent.
+    proto::ProtoAttributeCache cache;
+    proto::ProtoObject* plain = b->newChild(&c);
+    ASSERT(d->getAttribute(&c, y_attr, &cache)->asInteger(&c) == 3 &&
+           plain->getAttribute(&c, y_attr, &cache) == PROTO_NONE,
+           "Cache keys on the whole parent chain");
+
+    // Adding a parent to a mutable object changes the object itself.
+    proto::ProtoObject* mixin = c.newObject()->setAttribute(&c, y_attr, c.fromInteger(7));
+    proto::ProtoObject* host = b->newChild(&c, true);
+    proto::ProtoObject* hostChild = host->newChild(&c);
+    proto::ProtoAttributeCache hostCache;
+    ASSERT(host->getAttribute(&c, y_attr, &hostCache) == PROTO_NONE &&
+           hostChild->getAttribute(&c, y_attr) == PROTO_NONE, "The mixin is not visible before addParent");
+    ASSERT(host->addParent(&c, mixin) == host, "addParent on a mutable object returns the same handle");
+    ASSERT(host->isInstanceOf(&c, mixin)->asBoolean(&c) && host->isInstanceOf(&c, b)->asBoolean(&c),
+           "A mutable object is an instance of its added parent");
+    ASSERT(host->getAttribute(&c, y_attr, &hostCache)->asInteger(&c) == 7 &&
+           host->getAttribute(&c, x_attr)->asInteger(&c) == 2,
+           "A mutable object reads through its new resolution order");
+    ASSERT(host->getParents(&c)->getSize(&c) == 3, "getParents reflects the added parent");
+    ASSERT(hostChild->getAttribute(&c, y_attr)->asInteger(&c) == 7,
+           "Children of a mutable object see its added parent");
+}
+
+void test_instance_checks(proto::ProtoContext& c) {
+    printf("\n--- Testing Instance Checks ---\n");
+
+    // A deep single-inheritance hierarchy with a sibling branch at every level.
+    proto::ProtoObject* levels[40];
+    proto::ProtoObject* siblings[40];
+    levels[0] = c.newObject();
+    siblings[0] = c.newObject();
+    for (int i = 1; i < 40; ++i) {
+        levels[i] = levels[i - 1]->newChild(&c);
+        siblings[i] = levels[i - 1]->newChild(&c);
+    }
+    proto::ProtoObject* leaf = levels[39]->newChild(&c);
+
+    bool allOk = true;
+    for (int i = 0; i < 40; ++i)
+        if (!leaf->isInstanceOf(&c, levels[i])->asBoolean(&c))
+            allOk = false;
+    ASSERT(allOk, "Leaf is an instance of every level of its lineage");
+
+    allOk = true;
+    for (int i = 1; i < 40; ++i)
+        if (leaf->isInstanceOf(&c, siblings[i])->asBoolean(&c))
+            allOk = false;
+    ASSERT(allOk, "Leaf is not an instance of sibling branches");
+    ASSERT(!levels[5]->isInstanceOf(&c, levels[20])->asBoolean(&c), "An ancestor is not an instance of its descendant");
+    ASSERT(!leaf->isInstanceOf(&c, leaf)->asBoolean(&c), "An object is not an instance of itself");
+    ASSERT(!leaf->isInstanceOf(&c, PROTO_NONE)->asBoolean(&c), "Nothing is an instance of NONE");
+
+    // Shallow chains keep their ancestors in the parent link itself.
+    allOk = true;
+    for (int depth = 1; depth <= 4; ++depth)
+        for (int i = 0; i < depth; ++i)
+            if (!levels[depth]->isInstanceOf(&c, levels[i])->asBoolean(&c) ||
+                levels[depth]->isInstanceOf(&c, siblings[i + 1])->asBoolean(&c))
+                allOk = false;
+    ASSERT(allOk, "Shallow levels find exactly their own ancestors");
+    proto::ProtoObject* shallowMixed = levels[2]->addParent(&c, siblings[1]);
+    ASSERT(shallowMixed->isInstanceOf(&c, siblings[1])->asBoolean(&c) &&
+           shallowMixed->isInstanceOf(&c, levels[1])->asBoolean(&c) &&
+           !shallowMixed->isInstanceOf(&c, siblings[2])->asBoolean(&c),
+           "A shallow chain with an added parent uses the ancestor mask");
+
+    // With several parents, ancestors outside the main lineage are still found.
+    proto::ProtoObject* mixin = siblings[10]->newChild(&c);
+    proto::ProtoObject* mixed = leaf->addParent(&c, mixin);
+    ASSERT(mixed->isInstanceOf(&c, mixin)->asBoolean(&c), "Added parent is an ancestor");
+    ASSERT(mixed->isInstanceOf(&c, siblings[10])->asBoolean(&c), "Ancestor of the added parent is found");
+    ASSERT(mixed->isInstanceOf(&c, levels[30])->asBoolean(&c), "Original lineage is still found");
+    ASSERT(!mixed->isInstanceOf(&c, siblings[11])->asBoolean(&c), "Unrelated branch is rejected");
+}
+
+// --- Visitor used by test_attribute_view ---
+
+struct AttributeTally {
+    unsigned long xKey;
+    int visits;
+    int xVisits;
+    long xValue;
+};
+
+void tally_attribute(proto::ProtoContext* c, void* self, unsigned long key, proto::ProtoObject* value) {
+    auto* tally = static_cast<AttributeTally*>(self);
+    tally->visits++;
+    if (key == tally->xKey) {
+        tally->xVisits++;
+        tally->xValue = value->asInteger(c);
+    }
+}
+
+void test_attribute_view(proto::ProtoContext& c) {
+    printf("\n--- Testing Attribute View ---\n");
+
+    proto::ProtoString* x_attr = c.fromUTF8String("x");
+    proto::ProtoString* y_attr = c.fromUTF8String("y");
+    proto::ProtoString* z_attr = c.fromUTF8String("z");
+
+    proto::ProtoObject* root = c.newObject()->setAttribute(&c, x_attr, c.fromInteger(1));
+    root = root->setAttribute(&c, y_attr, c.fromInteger(2));
+    proto::ProtoObject* middle = root->newChild(&c)->setAttribute(&c, x_attr, c.fromInteger(10));
+    proto::ProtoObject* leaf = middle->newChild(&c)->setAttribute(&c, z_attr, c.fromInteger(3));
+
+    AttributeTally tally = {x_attr->getHash(&c), 0, 0, 0};
+    leaf->processAttributes(&c, &tally, tally_attribute);
+    ASSERT(tally.visits == 3, "View visits each visible attribute once");
+    ASSERT(tally.xVisits == 1 && tally.xValue == 10, "View reports the closest definition of a shadowed attribute");
+
+    tally = {x_attr->getHash(&c), 0, 0, 0};
+    c.newObject()->processAttributes(&c, &tally, tally_attribute);
+    ASSERT(tally.visits == 0, "View of an object without attributes or parents is empty");
+
+    // An own attribute set to NONE does not hide the inherited one.
+    proto::ProtoObject* cleared = leaf->setAttribute(&c, x_attr, PROTO_NONE);
+    tally = {x_attr->getHash(&c), 0, 0, 0};
+    cleared->processAttributes(&c, &tally, tally_attribute);
+    ASSERT(tally.xVisits == 1 && tally.xValue == 10, "Cleared own attribute falls back to the inherited value");
+
+    proto::ProtoSparseList* copy = leaf->getAttributes(&c);
+    ASSERT(copy->getSize(&c) == 3, "getAttributes materializes the view");
+    ASSERT(copy->getAt(&c, x_attr->getHash(&c))->asInteger(&c) == 10, "Materialized copy keeps the closest value");
+}
+
+void test_inline_attributes(proto::ProtoContext& c) {
+    printf("\n--- Testing Inline Attribute Storage ---\n");
+
+    proto::ProtoString* names[6];
+    for (int i = 0; i < 6; ++i) {
+        std::string name = "inline_" + std::to_string(i);
+        names[i] = c.fromUTF8String(name.c_str());
+    }
+
+    // Grow one attribute at a time across the inline / overflow boundary.
+    proto::ProtoObject* versions[7];
+    versions[0] = c.newObject();
+    for (int i = 0; i < 6; ++i)
+        versions[i + 1] = versions[i]->setAttribute(&c, names[i], c.fromInteger(i + 1));
+
+    bool allOk = true;
+    for (int v = 0; v <= 6; ++v)
+        for (int i = 0; i < 6; ++i) {
+            proto::ProtoObject* value = versions[v]->getAttribute(&c, names[i]);
+            if (i < v ? value->asInteger(&c) != i + 1 : value != PROTO_NONE)
+                allOk = false;
+        }
+    ASSERT(allOk, "Every version sees exactly the attributes set so far");
+
+    // Overwrite an inline value and an overflow value.
+    proto::ProtoObject* updated = versions[6]->setAttribute(&c, names[0], c.fromInteger(100));
+    updated = updated->setAttribute(&c, names[5], c.fromInteger(600));
+    ASSERT(updated->getAttribute(&c, names[0])->asInteger(&c) == 100, "Inline value is overwritten");
+    ASSERT(updated->getAttribute(&c, names[5])->asInteger(&c) == 600, "Overflow value is overwritten");
+    ASSERT(versions[6]->getAttribute(&c, names[0])->asInteger(&c) == 1, "Previous version keeps its inline value");
+    ASSERT(updated->getOwnAttributes(&c)->getSize(&c) == 6, "Own attributes include inline and overflow values");
+
+    // A batch update that takes a fully inline object past the boundary.
+    proto::ProtoObject* batchValues[3] = {c.fromInteger(30), c.fromInteger(40), c.fromInteger(50)};
+    proto::ProtoObject* batch = versions[3]->setAttributes(&c, 3, names + 2, batchValues);
+    ASSERT(batch->getAttribute(&c, names[1])->asInteger(&c) == 2 &&
+           batch->getAttribute(&c, names[2])->asInteger(&c) == 30 &&
+           batch->getAttribute(&c, names[4])->asInteger(&c) == 50, "Batch update moves the last inline value out");
+    ASSERT(versions[3]->getAttribute(&c, names[2])->asInteger(&c) == 3, "Inline version is unchanged by the batch");
+
+    // Children and clones copy the inline values too.
+    proto::ProtoObject* copy = updated->clone(&c);
+    ASSERT(copy->getAttribute(&c, names[1])->asInteger(&c) == 2, "Clone keeps inline values");
+    ASSERT(updated->newChild(&c)->getAttribute(&c, names[0])->asInteger(&c) == 100,
+           "Child inherits an inline value");
+}
+
+void test_frozen_objects(proto::ProtoContext& c) {
+    printf("\n--- Testing Frozen Objects ---\n");
+
+    proto::ProtoString* kind_attr = c.fromUTF8String("kind");
+    proto::ProtoString* size_attr = c.fromUTF8String("size");
+    proto::ProtoString* color_attr = c.fromUTF8String("color");
+
+    proto::ProtoObject* base = c.newObject()->setAttribute(&c, kind_attr, c.fromInteger(1));
+    proto::ProtoObject* shape = base->newChild(&c)->setAttribute(&c, size_attr, c.fromInteger(2));
+
+    unsigned long immortalBefore = c.space->immortalCells.load();
+    proto::ProtoObject* frozen = shape->freeze(&c);
+    ASSERT(frozen != shape, "Freezing an immutable object returns a frozen copy");
+    ASSERT(frozen->isFrozen(&c)->asBoolean(&c), "The copy is frozen");
+    ASSERT(!shape->isFrozen(&c)->asBoolean(&c), "The original cell is not modified");
+    ASSERT(frozen->freeze(&c) == frozen, "Freezing a frozen object returns it unchanged");
+    ASSERT(c.space->immortalCells.load() > immortalBefore, "The frozen cells join the immortal region");
+    ASSERT(frozen->addParent(&c, c.newObject()) == PROTO_NONE, "addParent on a frozen object is rejected");
+
+    ASSERT(frozen->getAttribute(&c, size_attr)->asInteger(&c) == 2, "Frozen object keeps its own attributes");
+    ASSERT(frozen->getAttribute(&c, kind_attr)->asInteger(&c) == 1, "Frozen object reads inherited attributes");
+    ASSERT(frozen->hasOwnAttribute(&c, size_attr)->asBoolean(&c), "Own attribute is still own");
+    ASSERT(!frozen->hasOwnAttribute(&c, kind_attr)->asBoolean(&c), "Inherited attribute is not reported as own");
+    ASSERT(frozen->getOwnAttributes(&c)->getSize(&c) == 1, "Own attributes exclude the flattened ones");
+    ASSERT(frozen->getAttributes(&c)->getSize(&c) == 2, "All visible attributes are available");
+    ASSERT(frozen->isInstanceOf(&c, base)->asBoolean(&c), "Frozen object keeps its parent chain");
+
+    ASSERT(frozen->setAttribute(&c, color_attr, c.fromInteger(3)) == PROTO_NONE, "setAttribute on a frozen object is rejected");
+    ASSERT(frozen->setAttributes(&c, 1, &color_attr, &frozen) == PROTO_NONE, "setAttributes on a frozen object is rejected");
+    ASSERT(frozen->getAttribute(&c, color_attr) == PROTO_NONE, "Frozen object does not gain attributes");
+
+    // Reads through the frozen prototype, with and without a cache.
+    proto::ProtoAttributeCache cache;
+    bool allOk = true;
+    for (int i = 0; i < 10; ++i) {
+        proto::ProtoObject* instance = frozen->newChild(&c)->setAttribute(&c, color_attr, c.fromInteger(i));
+        if (instance->getAttribute(&c, kind_attr, &cache)->asInteger(&c) != 1 ||
+            instance->getAttribute(&c, color_attr)->asInteger(&c) != i)
+            allOk = false;
+    }
+    ASSERT(allOk, "Children of a frozen prototype resolve through its flat table");
+
+    // Freezing a mutable object stops its changes; objects derived from it keep working.
+    proto::ProtoObject* live = c.newObject(true);
+    live->setAttribute(&c, kind_attr, c.fromInteger(5));
+    proto::ProtoObject* liveChild = live->newChild(&c);
+    ASSERT(live->freeze(&c) == live, "A mutable object is frozen in place");
+    ASSERT(live->setAttribute(&c, kind_attr, c.fromInteger(6)) == PROTO_NONE, "setAttribute on a frozen mutable object is rejected");
+    ASSERT(live->getAttribute(&c, kind_attr)->asInteger(&c) == 5, "A frozen mutable object keeps its last state");
+    ASSERT(liveChild->getAttribute(&c, kind_attr)->asInteger(&c) == 5, "Children read the frozen state");
+
+    // Freezing an object also freezes its mutable ancestors, in place.
+    proto::ProtoObject* liveBase = c.newObject(true);
+    liveBase->setAttribute(&c, kind_attr, c.fromInteger(7));
+    proto::ProtoObject* sealed = liveBase->newChild(&c)->freeze(&c);
+    ASSERT(liveBase->isFrozen(&c)->asBoolean(&c), "A mutable ancestor is frozen with its descendant");
+    liveBase->setAttribute(&c, kind_attr, c.fromInteger(8));
+    ASSERT(liveBase->getAttribute(&c, kind_attr)->asInteger(&c) == 7 &&
+           sealed->getAttribute(&c, kind_attr)->asInteger(&c) == 7,
+           "The frozen ancestor no longer changes");
+
+    // Freezing does not take the shared shapes with it: later transitions still work.
+    proto::ProtoString* later_attr = c.fromUTF8String("added-after-freeze");
+    proto::ProtoObject* later = c.newObject()->setAttribute(&c, later_attr, c.fromInteger(11));
+    ASSERT(later->getAttribute(&c, later_attr)->asInteger(&c) == 11, "Unrelated objects keep gaining attributes");
+
+    proto::ProtoAttributeCache frozenCache;
+    ASSERT(frozen->getAttribute(&c, kind_attr, &frozenCache)->asInteger(&c) == 1 &&
+           frozen->getAttribute(&c, kind_attr, &frozenCache)->asInteger(&c) == 1,
+           "Cached reads of a frozen receiver survive mutable-object changes");
+
+    // A clone of a frozen object is an ordinary object with the same own attributes.
+    proto::ProtoObject* thawed = frozen->clone(&c);
+    ASSERT(!thawed->isFrozen(&c)->asBoolean(&c), "Clone of a frozen object is not frozen");
+    ASSERT(!thawed->hasOwnAttribute(&c, kind_attr)->asBoolean(&c) &&
+           thawed->getAttribute(&c, kind_attr)->asInteger(&c) == 1,
+           "Clone inherits instead of copying flattened attributes");
+}
+
+void test_immortal_objects(proto::ProtoContext& c) {
+    printf("\n--- Testing Immortal Objects ---\n");
+
+    proto::ProtoString* name_attr = c.fromUTF8String("name");
+    proto::ProtoString* level_attr = c.fromUTF8String("level");
+
+    ASSERT(c.space->immortalCells.load() > 0, "Bootstrap cells are already immortal");
+
+    proto::ProtoObject* heapValue = c.newObject()->setAttribute(&c, level_attr, c.fromInteger(7));
+    unsigned long rememberedBefore = c.space->rememberedCells.load()->getSize(&c);
+    unsigned long pinnedBefore = c.space->immortalCells.load();
+
+    proto::ProtoObject* configBase;
+    proto::ProtoObject* config;
+    {
+        proto::ProtoContext scope(&c);
+        // Deep enough that the parent link keeps its display in a separate cell.
+        configBase = scope.newObject()->newChild(&scope)->newChild(&scope)->newChild(&scope);
+        config = configBase->newChild(&scope)
+            ->setAttribute(&scope, name_attr, scope.fromUTF8String("config")->asObject(&scope))
+            ->setAttribute(&scope, level_attr, heapValue);
+
+        c.space->makeImmortal(&scope);
+    }
+
+    ASSERT(c.space->immortalCells.load() > pinnedBefore, "The configuration graph is immortal");
+    ASSERT(c.space->rememberedCells.load()->getSize(&c) > rememberedBefore,
+           "References out of the immortal region are remembered");
+
+    // Caches filled in later on immortal cells are remembered, not lost.
+    unsigned long rememberedBeforeDisplay = c.space->rememberedOwners.load()->getSize(&c);
+    ASSERT(config->isInstanceOf(&c, configBase)->asBoolean(&c), "Immortal object knows its prototype");
+    ASSERT(c.space->rememberedOwners.load()->getSize(&c) > rememberedBeforeDisplay,
+           "The display cached on an immortal parent link is remembered");
+    ASSERT(config->getAttribute(&c, level_attr) == heapValue, "Immortal object keeps its references");
+    ASSERT(config->getAttribute(&c, name_attr)->asString(&c)->getSize(&c) == 6, "Immortal object is readable after its context ends");
+
+    proto::ProtoObject* derived = config->newChild(&c)->setAttribute(&c, level_attr, c.fromInteger(8));
+    ASSERT(derived->getAttribute(&c, level_attr)->asInteger(&c) == 8 &&
+           derived->getAttribute(&c, name_attr) == config->getAttribute(&c, name_attr),
+           "Ordinary objects can derive from immortal ones");
+
+    unsigned long rememberedBeforeBarrier = c.space->rememberedOwners.load()->getSize(&c);
+    proto::ProtoString* fresh_attr = c.fromUTF8String("fresh-after-seal");
+    proto::ProtoObject* extended = config->setAttribute(&c, fresh_attr, c.fromInteger(9));
+    ASSERT(c.space->rememberedOwners.load()->getSize(&c) > rememberedBeforeBarrier,
+           "A new transition from an immortal shape is remembered");
+    ASSERT(extended->getAttribute(&c, fresh_attr)->asInteger(&c) == 9, "The new shape is usable");
+
+    // Further writes to the same immortal cell do not grow the remembered sets.
+    unsigned long ownersBeforeRepeat = c.space->rememberedOwners.load()->getSize(&c);
+    unsigned long cellsBeforeRepeat = c.space->rememberedCells.load()->getSize(&c);
+    for (int i = 0; i < 16; i++) {
+        std::string name = "repeat-after-seal-" + std::to_string(i);
+        config->setAttribute(&c, c.fromUTF8String(name.c_str()), c.fromInteger(i));
+    }
+    ASSERT(c.space->rememberedOwners.load()->getSize(&c) == ownersBeforeRepeat &&
+           c.space->rememberedCells.load()->getSize(&c) == cellsBeforeRepeat,
+           "Repeated transitions from one immortal shape remember it once");
+
+    unsigned long pinnedAfter = c.space->immortalCells.load();
+    proto::ProtoContext empty(&c);
+    c.space->makeImmortal(&empty);
+    ASSERT(c.space->immortalCells.load() == pinnedAfter, "An empty context adds nothing");
+}
+
+void test_list_chunks(proto::ProtoContext& c) {
+    printf("\n--- Testing List Chunks ---\n");
+
+    const int count = 500;
+    proto::ProtoList* list = c.newList();
+    for (int i = 0; i < count; ++i)
+        list = list->appendLast(&c, c.fromInteger(i));
+
+    bool allOk = list->getSize(&c) == count;
+    for (int i = 0; i < count; ++i)
+        if (list->getAt(&c, i)->asInteger(&c) != i)
+            allOk = false;
+    ASSERT(allOk, "Appended elements keep their order across chunks");
+    ASSERT(list->getAt(&c, -1)->asInteger(&c) == count - 1, "Negative index reads from the end");
+    ASSERT(list->getAt(&c, count) == PROTO_NONE, "Index past the end is NONE");
+
+    proto::ProtoList* prepended = c.newList();
+    for (int i = 0; i < 100; ++i)
+        prepended = prepended->appendFirst(&c, c.fromInteger(i));
+    allOk = prepended->getSize(&c) == 100;
+    for (int i = 0; i < 100; ++i)
+        if (prepended->getAt(&c, i)->asInteger(&c) != 99 - i)
+            allOk = false;
+    ASSERT(allOk, "Prepended elements keep their order across chunks");
+
+    proto::ProtoList* inserted = list->insertAt(&c, 250, c.fromInteger(-1));
+    ASSERT(inserted->getSize(&c) == count + 1 &&
+           inserted->getAt(&c, 249)->asInteger(&c) == 249 &&
+           inserted->getAt(&c, 250)->asInteger(&c) == -1 &&
+           inserted->getAt(&c, 251)->asInteger(&c) == 250,
+           "insertAt in the middle of a chunk shifts the rest");
+    ASSERT(list->getAt(&c, 250)->asInteger(&c) == 250, "Original list is unchanged by insertAt");
+    ASSERT(list->insertAt(&c, count, c.fromInteger(-2))->getLast(&c)->asInteger(&c) == -2,
+           "insertAt at the size appends");
+
+    proto::ProtoList* updated = list->setAt(&c, 301, c.fromInteger(-3));
+    ASSERT(updated->getAt(&c, 301)->asInteger(&c) == -3 &&
+           updated->getAt(&c, 300)->asInteger(&c) == 300 &&
+           updated->getAt(&c, 302)->asInteger(&c) == 302,
+           "setAt only changes the selected element");
+
+    proto::ProtoList* shrunk = list;
+    for (int i = 0; i < 200; ++i)
+        shrunk = shrunk->removeAt(&c, 100);
+    allOk = shrunk->getSize(&c) == count - 200;
+    for (int i = 0; i < count - 200; ++i)
+        if (shrunk->getAt(&c, i)->asInteger(&c) != (i < 100 ? i : i + 200))
+            allOk = false;
+    ASSERT(allOk, "Repeated removeAt keeps the remaining order");
+
+    proto::ProtoList* emptied = prepended;
+    while (emptied->getSize(&c))
+        emptied = emptied->removeLast(&c);
+    ASSERT(emptied->getSize(&c) == 0 && emptied->getFirst(&c) == PROTO_NONE, "Removing every element gives an empty list");
+
+    proto::ProtoList* slice = list->getSlice(&c, 100, 400);
+    allOk = slice->getSize(&c) == 300;
+    for (int i = 0; i < 300; ++i)
+        if (slice->getAt(&c, i)->asInteger(&c) != i + 100)
+            allOk = false;
+    ASSERT(allOk, "Large slice keeps its elements");
+    ASSERT(list->splitFirst(&c, 10)->getSize(&c) == 10 && list->splitLast(&c, 490)->getFirst(&c)->asInteger(&c) == 490,
+           "splitFirst and splitLast cut at the index");
+
+    proto::ProtoList* removed = list->removeSlice(&c, 10, 490);
+    ASSERT(removed->getSize(&c) == 20 && removed->getAt(&c, 10)->asInteger(&c) == 490, "removeSlice joins both sides");
+
+    proto::ProtoList* joined = slice->extend(&c, prepended);
+    ASSERT(joined->getSize(&c) == 400 &&
+           joined->getAt(&c, 299)->asInteger(&c) == 399 &&
+           joined->getAt(&c, 300)->asInteger(&c) == 99,
+           "extend appends the other list");
+
+    ASSERT(list->has(&c, c.fromInteger(499)) && !list->has(&c, c.fromInteger(500)), "has scans every chunk");
+
+    proto::ProtoList* withNone = c.newList()->appendLast(&c, PROTO_NONE)->appendLast(&c, c.fromInteger(1));
+    ASSERT(withNone->getSize(&c) == 2 && withNone->getAt(&c, 0) == PROTO_NONE, "NONE is stored like any other element");
+}
+
+void test_transients(proto::ProtoContext& c) {
+    printf("\n--- Testing Transients ---\n");
+
+    proto::ProtoListTransient* listEditor = c.newList()->beginTransient(&c);
+    for (int i = 0; i < 200; ++i)
+        listEditor = listEditor->appendLast(&c, c.fromInteger(i));
+    ASSERT(listEditor->getSize(&c) == 200, "List transient counts its appends");
+    proto::ProtoList* list = listEditor->persistent(&c);
+    bool allOk = list->getSize(&c) == 200;
+    for (int i = 0; i < 200; ++i)
+        if (list->getAt(&c, i)->asInteger(&c) != i)
+            allOk = false;
+    ASSERT(allOk, "List built through a transient keeps its order");
+    ASSERT(listEditor->appendLast(&c, c.fromInteger(0)) == nullptr, "A sealed list transient rejects edits");
+    ASSERT(listEditor->persistent(&c) == list, "persistent on a sealed transient returns the same list");
+
+    proto::ProtoListTransient* extender = list->beginTransient(&c);
+    for (int i = 200; i < 250; ++i)
+        extender->appendLast(&c, c.fromInteger(i));
+    proto::ProtoList* extended = extender->persistent(&c);
+    ASSERT(extended->getSize(&c) == 250 &&
+           extended->getAt(&c, 199)->asInteger(&c) == 199 &&
+           extended->getAt(&c, 249)->asInteger(&c) == 249,
+           "A transient over a non-empty list appends after it");
+    ASSERT(list->getSize(&c) == 200, "The base list is unchanged by its transient");
+
+    proto::ProtoSparseList* sparse = c.newSparseList();
+    for (unsigned long i = 0; i < 100; ++i)
+        sparse = sparse->setAt(&c, i * 7, c.fromInteger((int) i));
+
+    proto::ProtoSparseListTransient* small = sparse->beginTransient(&c);
+    small->setAt(&c, 7, c.fromInteger(-1))->setAt(&c, 7, c.fromInteger(-2))->removeAt(&c, 14);
+    proto::ProtoSparseList* smallResult = small->persistent(&c);
+    ASSERT(smallResult->getSize(&c) == 99 &&
+           smallResult->getAt(&c, 7)->asInteger(&c) == -2 &&
+           !smallResult->has(&c, 14) &&
+           smallResult->getAt(&c, 21)->asInteger(&c) == 3,
+           "Small sparse batch keeps the last write per index");
+
+    proto::ProtoSparseListTransient* large = sparse->beginTransient(&c);
+    for (unsigned long i = 0; i < 100; ++i)
+    {
+        if (i % 2)
+            large->removeAt(&c, i * 7);
+        else
+            large->setAt(&c, i * 7 + 1, c.fromInteger((int) i));
+    }
+    proto::ProtoSparseList* largeResult = large->persistent(&c);
+    allOk = largeResult->getSize(&c) == 100;
+    for (unsigned long i = 0; i < 100; ++i)
+    {
+        if (i % 2 ? largeResult->has(&c, i * 7) : largeResult->getAt(&c, i * 7 + 1)->asInteger(&c) != (int) i)
+            allOk = false;
+    }
+    ASSERT(allOk, "Large sparse batch applies every change");
+    ASSERT(sparse->getSize(&c) == 100 && sparse->getAt(&c, 14)->asInteger(&c) == 2, "The base sparse list is unchanged");
+
+    proto::ProtoTupleTransient* tupleEditor = c.newTuple()->beginTransient(&c);
+    for (int i = 0; i < 700; ++i)
+        tupleEditor->appendLast(&c, c.fromInteger(i));
+    proto::ProtoTuple* tuple = tupleEditor->persistent(&c);
+    allOk = tuple->getSize(&c) == 700;
+    for (int i = 0; i < 700; ++i)
+        if (tuple->getAt(&c, i)->asInteger(&c) != i)
+            allOk = false;
+    ASSERT(allOk, "Tuple built through a transient keeps its order");
+    ASSERT(c.newTupleFromList(list)->getAt(&c, 150)->asInteger(&c) == 150, "newTupleFromList goes through the transient");
+}
+
+void test_list_from_array(proto::ProtoContext& c) {
+    printf("\n--- Testing List From Array ---\n");
+
+    ASSERT(c.newListFromArray(nullptr, 0)->getSize(&c) == 0, "An empty array gives an empty list");
+
+    std::vector<proto::ProtoObject*> values;
+    for (int i = 0; i < 1000; ++i)
+        values.push_back(c.fromInteger(i));
+
+    proto::ProtoList* list = c.newListFromArray(values.data(), values.size());
+    bool allOk = list->getSize(&c) == 1000;
+    for (int i = 0; i < 1000; ++i)
+        if (list->getAt(&c, i)->asInteger(&c) != i)
+            allOk = false;
+    ASSERT(allOk, "newListFromArray keeps the array order");
+
+    proto::ProtoList* edited = list->insertAt(&c, 500, c.fromInteger(-1))->removeAt(&c, 0);
+    ASSERT(edited->getSize(&c) == 1000 && edited->getAt(&c, 499)->asInteger(&c) == -1,
+           "A bulk-built list accepts regular edits");
+
+    std::deque<proto::ProtoObject*> queue(values.begin() + 10, values.begin() + 20);
+    proto::ProtoList* fromDeque = c.newListFromRange(queue.begin(), queue.end());
+    proto::ProtoList* fromVector = c.newListFromRange(values.begin() + 10, values.begin() + 20);
+    ASSERT(fromDeque->getSize(&c) == 10 && fromDeque->getAt(&c, 9)->asInteger(&c) == 19 &&
+           fromVector->getSize(&c) == 10 && fromVector->getAt(&c, 0)->asInteger(&c) == 10,
+           "newListFromRange accepts contiguous and non-contiguous ranges");
+
+    // Large enough to go through the parallel construction.
+    const int large = (1 << 20) + 7;
+    std::vector<proto::ProtoObject*> many(large);
+    for (int i = 0; i < large; ++i)
+        many[i] = c.fromInteger(i);
+    proto::ProtoList* big = c.newListFromArray(many.data(), many.size());
+    allOk = big->getSize(&c) == (unsigned long) large;
+    for (int i = 0; i < large; i += 4099)
+        if (big->getAt(&c, i)->asInteger(&c) != i)
+            allOk = false;
+    ASSERT(allOk && big->getLast(&c)->asInteger(&c) == large - 1, "Parallel construction keeps the array order");
+}
+
+void test_list_join_split(proto::ProtoContext& c) {
+    printf("\n--- Testing List Join And Split ---\n");
+
+    // Concatenating many single-element lists keeps every element in place.
+    proto::ProtoList* joined = c.newList();
+    for (int i = 0; i < 300; ++i)
+        joined = joined->extend(&c, c.newList()->appendLast(&c, c.fromInteger(i)));
+    bool allOk = joined->getSize(&c) == 300;
+    for (int i = 0; i < 300; ++i)
+        if (joined->getAt(&c, i)->asInteger(&c) != i)
+            allOk = false;
+    ASSERT(allOk, "Repeated extend keeps the order");
+
+    // Lists of very different sizes, in both orders.
+    proto::ProtoList* small = c.newList()->appendLast(&c, c.fromInteger(-1));
+    proto::ProtoList* left = small->extend(&c, joined);
+    proto::ProtoList* right = joined->extend(&c, small);
+    ASSERT(left->getSize(&c) == 301 && left->getFirst(&c)->asInteger(&c) == -1 && left->getAt(&c, 1)->asInteger(&c) == 0,
+           "A small list extended with a large one");
+    ASSERT(right->getSize(&c) == 301 && right->getLast(&c)->asInteger(&c) == -1 && right->getAt(&c, 299)->asInteger(&c) == 299,
+           "A large list extended with a small one");
+
+    // Slices and removals at every kind of boundary, checked against a plain vector.
+    std::vector<int> model;
+    for (int i = 0; i < 300; ++i)
+        model.push_back(i);
+    allOk = true;
+    unsigned int seed = 12345;
+    for (int round = 0; round < 60 && allOk; ++round)
+    {
+        seed = seed * 1103515245 + 12345;
+        int from = (seed >> 8) % 301;
+        seed = seed * 1103515245 + 12345;
+        int to = (seed >> 8) % 301;
+        if (from > to)
+            std::swap(from, to);
+
+        proto::ProtoList* slice = joined->getSlice(&c, from, to);
+        proto::ProtoList* rest = joined->removeSlice(&c, from, to);
+        if (slice->getSize(&c) != (unsigned long) (to - from) ||
+            rest->getSize(&c) != (unsigned long) (300 - (to - from)))
+            allOk = false;
+        for (int i = from; i < to && allOk; ++i)
+            if (slice->getAt(&c, i - from)->asInteger(&c) != model[i])
+                allOk = false;
+        for (int i = 0; i < 300 - (to - from) && allOk; ++i)
+            if (rest->getAt(&c, i)->asInteger(&c) != model[i < from ? i : i + (to - from)])
+                allOk = false;
+
+        // Putting the pieces back together gives the original list.
+        proto::ProtoList* rebuilt = joined->splitFirst(&c, from)->extend(&c, slice)->extend(&c, joined->splitLast(&c, to));
+        for (int i = 0; i < 300 && allOk; ++i)
+            if (rebuilt->getAt(&c, i)->asInteger(&c) != i)
+                allOk = false;
+    }
+    ASSERT(allOk, "getSlice, removeSlice and extend agree with a vector model");
+    ASSERT(joined->getSlice(&c, 120, 120)->getSize(&c) == 0, "An empty slice gives an empty list");
+    ASSERT(joined->getSize(&c) == 300 && joined->getAt(&c, 150)->asInteger(&c) == 150, "The source list is unchanged");
+}
+
+void test_cursors(proto::ProtoContext& c) {
+    printf("\n--- Testing Cursors ---\n");
+
+    std::vector<proto::ProtoObject*> values;
+    for (int i = 0; i < 1000; ++i)
+        values.push_back(c.fromInteger(i));
+    proto::ProtoList* list = c.newListFromArray(values.data(), values.size());
+
+    proto::ProtoListCursor listCursor(&c, list);
+    bool allOk = true;
+    int seen = 0;
+    while (listCursor.hasNext(&c))
+        if (listCursor.next(&c)->asInteger(&c) != seen++)
+            allOk = false;
+    ASSERT(allOk && seen == 1000, "List cursor visits every element in order");
+    ASSERT(listCursor.next(&c) == PROTO_NONE, "A finished list cursor returns NONE");
+
+    proto::ProtoListCursor emptyCursor(&c, c.newList());
+    ASSERT(!emptyCursor.hasNext(&c), "A cursor over an empty list has nothing to visit");
+
+    // Mixing single steps and chunks of an odd size.
+    proto::ProtoListCursor chunkCursor(&c, list->removeAt(&c, 0));
+    proto::ProtoObject* buffer[7];
+    allOk = chunkCursor.next(&c)->asInteger(&c) == 1;
+    seen = 2;
+    unsigned long n;
+    while ((n = chunkCursor.nextChunk(&c, buffer)) != 0)
+        for (unsigned long i = 0; i < n; ++i)
+            if (buffer[i]->asInteger(&c) != seen++)
+                allOk = false;
+    ASSERT(allOk && seen == 1000, "List cursor nextChunk copies consecutive blocks");
+
+    proto::ProtoTupleTransient* editor = c.newTuple()->beginTransient(&c);
+    for (int i = 0; i < 700; ++i)
+        editor->appendLast(&c, c.fromInteger(i));
+    proto::ProtoTuple* tuple = editor->persistent(&c);
+
+    proto::ProtoTupleCursor tupleCursor(&c, tuple);
+    allOk = true;
+    seen = 0;
+    while (tupleCursor.hasNext(&c))
+        if (tupleCursor.next(&c)->asInteger(&c) != seen++)
+            allOk = false;
+    ASSERT(allOk && seen == 700, "Tuple cursor crosses every level of the tuple");
+
+    proto::ProtoTupleCursor tupleChunks(&c, tuple);
+    allOk = true;
+    seen = 0;
+    while ((n = tupleChunks.nextChunk(&c, buffer)) != 0)
+        for (unsigned long i = 0; i < n; ++i)
+            if (buffer[i]->asInteger(&c) != seen++)
+                allOk = false;
+    ASSERT(allOk && seen == 700, "Tuple cursor nextChunk copies consecutive blocks");
+
+    proto::ProtoString* text = c.fromUTF8String("cursors walk strings too");
+    proto::ProtoStringCursor stringCursor(&c, text);
+    allOk = true;
+    seen = 0;
+    while (stringCursor.hasNext(&c))
+        if (stringCursor.next(&c) != text->getAt(&c, seen++))
+            allOk = false;
+    ASSERT(allOk && (unsigned long) seen == text->getSize(&c), "String cursor visits every character");
+}
+
+void test_sparse_list_cursor(proto::ProtoContext& c) {
+    printf("\n--- Testing Sparse List Cursor ---\n");
+
+    // Keys inserted out of order: multiples of 10 below 5000.
+    proto::ProtoSparseList* sparse = c.newSparseList();
+    for (unsigned long i = 0; i < 500; ++i)
+        sparse = sparse->setAt(&c, (i * 37 % 500) * 10, c.fromInteger((int) (i * 37 % 500)));
+
+    proto::ProtoSparseListCursor cursor(&c, sparse);
+    bool allOk = true;
+    unsigned long seen = 0;
+    while (cursor.hasNext(&c))
+    {
+        if (cursor.nextKey(&c) != seen * 10 || cursor.nextValue(&c)->asInteger(&c) != (int) seen)
+            allOk = false;
+        seen++;
+        cursor.advance(&c);
+    }
+    ASSERT(allOk && seen == 500, "Sparse cursor visits keys in increasing order");
+    ASSERT(cursor.nextValue(&c) == PROTO_NONE, "A finished sparse cursor returns NONE");
+
+    cursor.seek(&c, 1234);
+    ASSERT(cursor.hasNext(&c) && cursor.nextKey(&c) == 1240, "seek stops at the first key not below the target");
+    cursor.seek(&c, 1240);
+    ASSERT(cursor.nextKey(&c) == 1240, "seek to an existing key stops on it");
+
+    unsigned long inRange = 0;
+    for (cursor.seek(&c, 2000); cursor.hasNext(&c) && cursor.nextKey(&c) < 3000; cursor.advance(&c))
+        inRange++;
+    ASSERT(inRange == 100, "seek plus advance scans a key range");
+
+    cursor.seek(&c, 5000);
+    ASSERT(!cursor.hasNext(&c), "seek past the last key finishes the cursor");
+    cursor.seek(&c, 0);
+    ASSERT(cursor.hasNext(&c) && cursor.nextKey(&c) == 0, "seek back to the start restarts the scan");
+
+    proto::ProtoSparseListCursor emptyCursor(&c, c.newSparseList());
+    ASSERT(!emptyCursor.hasNext(&c), "A cursor over an empty sparse list has nothing to visit");
+}
+
+void test_sparse_list_ranges(proto::ProtoContext& c) {
+    printf("\n--- Testing Sparse List Ranges ---\n");
+
+    // Timestamps every 5 units, checked against a std::map.
+    std::map<unsigned long, int> model;
+    proto::ProtoSparseList* sparse = c.newSparseList();
+    for (unsigned long i = 0; i < 400; ++i)
+    {
+        unsigned long key = 1000 + (i * 53 % 400) * 5;
+        sparse = sparse->setAt(&c, key, c.fromInteger((int) key));
+        model[key] = (int) key;
+    }
+
+    unsigned long key = 0;
+    ASSERT(sparse->firstKey(&c, &key) && key == 1000, "firstKey gives the smallest key");
+    ASSERT(sparse->lastKey(&c, &key) && key == 2995, "lastKey gives the largest key");
+    ASSERT(sparse->floor(&c, 1237, &key) && key == 1235, "floor finds the key below");
+    ASSERT(sparse->floor(&c, 1240, &key) && key == 1240, "floor of an existing key is the key");
+    ASSERT(!sparse->floor(&c, 999, &key), "floor below every key finds nothing");
+    ASSERT(sparse->ceiling(&c, 1237, &key) && key == 1240, "ceiling finds the key above");
+    ASSERT(!sparse->ceiling(&c, 2996, &key), "ceiling above every key finds nothing");
+
+    bool allOk = true;
+    unsigned int seed = 777;
+    for (int round = 0; round < 40 && allOk; ++round)
+    {
+        seed = seed * 1103515245 + 12345;
+        unsigned long from = 900 + (seed >> 8) % 2200;
+        seed = seed * 1103515245 + 12345;
+        unsigned long to = 900 + (seed >> 8) % 2200;
+        if (from > to)
+            std::swap(from, to);
+
+        unsigned long expected = 0;
+        for (auto& entry : model)
+            if (entry.first >= from && entry.first < to)
+                expected++;
+
+        proto::ProtoSparseList* slice = sparse->sliceRange(&c, from, to);
+        proto::ProtoSparseList* rest = sparse->removeRange(&c, from, to);
+        if (sparse->countRange(&c, from, to) != expected ||
+            slice->getSize(&c) != expected ||
+            rest->getSize(&c) != model.size() - expected)
+            allOk = false;
+
+        for (auto& entry : model)
+        {
+            bool inside = entry.first >= from && entry.first < to;
+            if (slice->has(&c, entry.first) != inside || rest->has(&c, entry.first) == inside)
+                allOk = false;
+        }
+    }
+    ASSERT(allOk, "countRange, sliceRange and removeRange agree with a std::map");
+
+    ASSERT(sparse->sliceRange(&c, 2000, 2000)->getSize(&c) == 0, "An empty range gives an empty list");
+    ASSERT(sparse->removeRange(&c, 0, 1000) == sparse, "Removing an empty range returns the same list");
+    ASSERT(sparse->removeRange(&c, 0, 5000)->getSize(&c) == 0, "Removing every key gives an empty list");
+    ASSERT(sparse->getSize(&c) == 400, "The source sparse list is unchanged");
+
+    proto::ProtoSparseList* empty = c.newSparseList();
+    ASSERT(!empty->firstKey(&c, &key) && !empty->lastKey(&c, &key) && empty->countRange(&c, 0, 100) == 0,
+           "Key queries on an empty sparse list find nothing");
+}
+
+static proto::ProtoObject* addValues(
+    proto::ProtoContext* context, void* self, unsigned long key,
+    proto::ProtoObject* current, proto::ProtoObject* other)
+{
+    return context->fromInteger(current->asInteger(context) + other->asInteger(context));
+}
+
+void test_sparse_list_set_algebra(proto::ProtoContext& c) {
+    printf("\n--- Testing Sparse List Set Algebra ---\n");
+
+    // a holds multiples of 2 and b multiples of 3, both below 600.
+    std::map<unsigned long, int> modelA, modelB;
+    proto::ProtoSparseList* a = c.newSparseList();
+    proto::ProtoSparseList* b = c.newSparseList();
+    for (unsigned long key = 0; key < 600; key += 2)
+    {
+        a = a->setAt(&c, key, c.fromInteger(1));
+        modelA[key] = 1;
+    }
+    for (unsigned long key = 0; key < 600; key += 3)
+    {
+        b = b->setAt(&c, key, c.fromInteger(10));
+        modelB[key] = 10;
+    }
+
+    proto::ProtoSparseList* both = a->unionWith(&c, b);
+    proto::ProtoSparseList* summed = a->unionWith(&c, b, nullptr, addValues);
+    proto::ProtoSparseList* common = a->intersectionWith(&c, b);
+    proto::ProtoSparseList* commonSummed = a->intersectionWith(&c, b, nullptr, addValues);
+    proto::ProtoSparseList* onlyA = a->differenceWith(&c, b);
+
+    bool allOk = true;
+    for (unsigned long key = 0; key < 600; ++key)
+    {
+        bool inA = modelA.count(key), inB = modelB.count(key);
+        if (both->has(&c, key) != (inA || inB) ||
+            common->has(&c, key) != (inA && inB) ||
+            onlyA->has(&c, key) != (inA && !inB))
+            allOk = false;
+        if (inA && inB)
+        {
+            if (both->getAt(&c, key)->asInteger(&c) != 10 ||
+                summed->getAt(&c, key)->asInteger(&c) != 11 ||
+                common->getAt(&c, key)->asInteger(&c) != 1 ||
+                commonSummed->getAt(&c, key)->asInteger(&c) != 11)
+                allOk = false;
+        }
+    }
+    ASSERT(allOk, "union, intersection and difference agree with the key sets");
+    ASSERT(both->getSize(&c) == 400 && common->getSize(&c) == 100 && onlyA->getSize(&c) == 200,
+           "Set operations report the right sizes");
+
+    proto::ProtoSparseList* empty = c.newSparseList();
+    ASSERT(a->unionWith(&c, empty) == a && empty->unionWith(&c, a) == a, "Union with an empty list shares the operand");
+    ASSERT(a->unionWith(&c, a) == a && a->intersectionWith(&c, a) == a, "Operations with itself return the same list");
+    ASSERT(a->differenceWith(&c, empty) == a, "Removing nothing returns the same list");
+    ASSERT(a->differenceWith(&c, a)->getSize(&c) == 0 && a->intersectionWith(&c, empty)->getSize(&c) == 0,
+           "Operations that remove everything give an empty list");
+
+    proto::ProtoSparseList* extra = c.newSparseList()->setAt(&c, 10001, c.fromInteger(5));
+    proto::ProtoSparseList* grown = a->unionWith(&c, extra);
+    ASSERT(grown->getSize(&c) == a->getSize(&c) + 1 && grown->getAt(&c, 10001)->asInteger(&c) == 5,
+           "Union with a small list adds its keys");
+    ASSERT(a->getSize(&c) == 300 && b->getSize(&c) == 200, "The operands are unchanged");
+}
+
+static void collectSparseKeys(proto::ProtoContext* context, void* self, unsigned long index, proto::ProtoObject* value) {
+    static_cast<std::vector<unsigned long>*>(self)->push_back(index);
+}
+
+void test_sparse_hash(proto::ProtoContext& c) {
+    printf("\n--- Testing Unordered Sparse List ---\n");
+
+    // Keys look like cell addresses: multiples of 64 with identical low bits.
+    std::map<unsigned long, int> model;
+    proto::ProtoSparseList* hashed = c.newUnorderedSparseList();
+    proto::ProtoSparseList* ordered = c.newSparseList();
+    ASSERT(!hashed->isOrdered(&c) && ordered->isOrdered(&c), "Each constructor picks its representation");
+
+    unsigned long seed = 12345;
+    for (int i = 0; i < 3000; ++i)
+    {
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        unsigned long key = 0x7f0000000000UL + ((seed >> 33) % 1000) * 64;
+        if ((seed >> 20) % 4 == 0)
+        {
+            hashed = hashed->removeAt(&c, key);
+            ordered = ordered->removeAt(&c, key);
+            model.erase(key);
+        }
+        else
+        {
+            hashed = hashed->setAt(&c, key, c.fromInteger(i));
+            ordered = ordered->setAt(&c, key, c.fromInteger(i));
+            model[key] = i;
+        }
+    }
+
+    bool allOk = hashed->getSize(&c) == model.size();
+    for (unsigned long k = 0; k < 1000; ++k)
+    {
+        unsigned long key = 0x7f0000000000UL + k * 64;
+        auto it = model.find(key);
+        if (hashed->has(&c, key) != (it != model.end()) ||
+            (it != model.end() && hashed->getAt(&c, key)->asInteger(&c) != it->second))
+            allOk = false;
+    }
+    ASSERT(allOk, "Set, get and remove agree with a reference map");
+    ASSERT(!hashed->has(&c, 0x7f0000000000UL + 1), "Keys outside the set are absent");
+
+    std::vector<unsigned long> visitedKeys;
+    hashed->processElements(&c, &visitedKeys, collectSparseKeys);
+    std::sort(visitedKeys.begin(), visitedKeys.end());
+    allOk = visitedKeys.size() == model.size();
+    auto modelIt = model.begin();
+    for (unsigned long i = 0; allOk && i < visitedKeys.size(); ++i, ++modelIt)
+        allOk = visitedKeys[i] == modelIt->first;
+    ASSERT(allOk, "processElements visits every key once");
+    ASSERT(hashed->getHash(&c) == ordered->getHash(&c), "Same contents give the same hash in both representations");
+
+    proto::ProtoSparseList* same = hashed->setAt(&c, model.begin()->first, hashed->getAt(&c, model.begin()->first));
+    ASSERT(same == hashed, "Storing the value already present returns the same list");
+
+    unsigned long first = 0, last = 0;
+    ASSERT(hashed->firstKey(&c, &first) && first == model.begin()->first &&
+           hashed->lastKey(&c, &last) && last == model.rbegin()->first,
+           "Ordered queries work on an unordered list");
+
+    long visited = 0;
+    proto::ProtoSparseListCursor cursor(&c, hashed);
+    unsigned long previous = 0;
+    bool inOrder = true;
+    while (cursor.hasNext(&c))
+    {
+        if (visited && cursor.nextKey(&c) <= previous)
+            inOrder = false;
+        previous = cursor.nextKey(&c);
+        ++visited;
+        cursor.advance(&c);
+    }
+    ASSERT(inOrder && visited == (long) model.size(), "A cursor walks an unordered list in key order");
+
+    proto::ProtoSparseList* emptied = hashed;
+    for (auto& entry : model)
+        emptied = emptied->removeAt(&c, entry.first);
+    ASSERT(emptied->getSize(&c) == 0 && emptied->getHash(&c) == c.newUnorderedSparseList()->getHash(&c),
+           "Removing every key leaves an empty list");
+}
+
+void test_sparse_array(proto::ProtoContext& c) {
+    printf("\n--- Testing Dense Sparse List ---\n");
+
+    // Dense keys switch to the array form and sparse keys back to the tree;
+    // every step is checked against a reference map.
+    std::map<unsigned long, int> model;
+    proto::ProtoSparseList* list = c.newSparseList();
+    auto matches = [&](proto::ProtoSparseList* l) {
+        if (l->getSize(&c) != model.size())
+            return false;
+        for (unsigned long key = 0; key < 1200; ++key)
+        {
+            auto it = model.find(key);
+            if (l->has(&c, key) != (it != model.end()) ||
+                (it != model.end() && l->getAt(&c, key)->asInteger(&c) != it->second))
+                return false;
+        }
+        return true;
+    };
+
+    for (unsigned long key = 100; key < 1100; ++key)
+    {
+        list = list->setAt(&c, key, c.fromInteger((int) key));
+        model[key] = (int) key;
+    }
+    ASSERT(matches(list) && list->isOrdered(&c), "Contiguous keys are stored and read back");
+
+    proto::ProtoSparseList* same = list->setAt(&c, 500, list->getAt(&c, 500));
+    ASSERT(same == list, "Storing the value already present returns the same list");
+
+    proto::ProtoSparseList* unordered = c.newUnorderedSparseList();
+    for (auto& entry : model)
+        unordered = unordered->setAt(&c, entry.first, c.fromInteger(entry.second));
+    ASSERT(list->getHash(&c) == unordered->getHash(&c), "A dense list hashes like any list with the same contents");
+
+    proto::ProtoSparseList* below = list->setAt(&c, 5, c.fromInteger(5));
+    proto::ProtoSparseList* far = list->setAt(&c, 1UL << 40, c.fromInteger(7));
+    ASSERT(below->getAt(&c, 5)->asInteger(&c) == 5 && below->getSize(&c) == 1001 &&
+           far->getAt(&c, 1UL << 40)->asInteger(&c) == 7 && far->getAt(&c, 1099)->asInteger(&c) == 1099,
+           "Keys outside the dense range are added");
+    ASSERT(matches(list), "The dense list is unchanged");
+
+    for (unsigned long key = 100; key < 1100; key += 3)
+    {
+        list = list->removeAt(&c, key);
+        model.erase(key);
+    }
+    ASSERT(matches(list), "Holes read as absent");
+
+    for (unsigned long key = 1099; key >= 700; --key)
+    {
+        list = list->removeAt(&c, key);
+        model.erase(key);
+    }
+    ASSERT(matches(list), "Removing the top of the range keeps the rest");
+
+    for (unsigned long key = 101; key < 700; key += 3)
+    {
+        list = list->removeAt(&c, key);
+        model.erase(key);
+    }
+    ASSERT(matches(list), "A list that loses density keeps its contents");
+
+    unsigned long first = 0, last = 0;
+    ASSERT(list->firstKey(&c, &first) && first == model.begin()->first &&
+           list->lastKey(&c, &last) && last == model.rbegin()->first,
+           "Ordered queries see the same keys");
+
+    proto::ProtoSparseListTransient* editor = c.newSparseList()->beginTransient(&c);
+    for (unsigned long key = 0; key < 64; ++key)
+        editor = editor->setAt(&c, key, c.fromInteger((int) key * 2));
+    proto::ProtoSparseList* built = editor->persistent(&c);
+    bool builtOk = built->getSize(&c) == 64;
+    for (unsigned long key = 0; key < 64; ++key)
+        builtOk = builtOk && built->getAt(&c, key)->asInteger(&c) == (int) key * 2;
+    ASSERT(builtOk, "A transient build of dense keys reads back");
+
+    long visited = 0;
+    proto::ProtoSparseListCursor cursor(&c, built);
+    while (cursor.hasNext(&c))
+    {
+        if (cursor.nextKey(&c) != (unsigned long) visited)
+            break;
+        ++visited;
+        cursor.advance(&c);
+    }
+    ASSERT(visited == 64, "A cursor walks a dense list in key order");
+    ASSERT(built->unionWith(&c, c.newSparseList()) == built && built->intersectionWith(&c, built) == built,
+           "Set operations that change nothing return the dense operand");
+
+    proto::ProtoSparseList* drained = built;
+    for (unsigned long key = 0; key < 64; ++key)
+        drained = drained->removeAt(&c, key);
+    ASSERT(drained->getSize(&c) == 0 && !drained->has(&c, 0), "Removing every key leaves an empty list");
+
+    // A range wider than one slots node grows several levels; the walk and the
+    // fallback to the tree must see every key.
+    proto::ProtoSparseList* wide = c.newSparseList();
+    for (unsigned long key = 0; key < 700; ++key)
+        wide = wide->setAt(&c, key, c.fromInteger((int) key));
+    std::vector<unsigned long> keys;
+    wide->processElements(&c, &keys, collectSparseKeys);
+    bool wideOk = keys.size() == 700;
+    for (unsigned long i = 0; wideOk && i < keys.size(); ++i)
+        wideOk = keys[i] == i;
+    ASSERT(wideOk, "Walking a wide dense list visits every key in order");
+    proto::ProtoSparseList* spread = wide->setAt(&c, 1UL << 40, c.fromInteger(1));
+    unsigned long top = 0;
+    ASSERT(spread->getSize(&c) == 701 && spread->countRange(&c, 0, 700) == 700 &&
+           spread->getAt(&c, 699)->asInteger(&c) == 699 && spread->lastKey(&c, &top) && top == 1UL << 40,
+           "Falling back to the tree keeps every key");
+}
+
+static void collectDictionaryKeys(proto::ProtoContext* context, void* self, proto::ProtoObject* key, proto::ProtoObject* value) {
+    static_cast<std::vector<int>*>(self)->push_back(key->asInteger(context));
+}
+
+void test_dictionary(proto::ProtoContext& c) {
+    printf("\n--- Testing Dictionary ---\n");
+
+    // Keys built separately with the same content find the same entry.
+    proto::ProtoDictionary* dict = c.newDictionary();
+    dict = dict->setAt(&c, c.fromUTF8String("alpha")->asObject(&c), c.fromInteger(1));
+    dict = dict->setAt(&c, c.fromUTF8String("beta")->asObject(&c), c.fromInteger(2));
+    ASSERT(dict->getAt(&c, c.fromUTF8String("alpha")->asObject(&c))->asInteger(&c) == 1 &&
+           dict->getAt(&c, c.fromUTF8String("beta")->asObject(&c))->asInteger(&c) == 2,
+           "String keys match by content");
+    ASSERT(!dict->has(&c, c.fromUTF8String("alph")->asObject(&c)) && !dict->has(&c, c.fromInteger(1)),
+           "Other keys are absent");
+    proto::ProtoDictionary* replaced = dict->setAt(&c, c.fromUTF8String("alpha")->asObject(&c), c.fromInteger(3));
+    ASSERT(replaced->getSize(&c) == 2 && replaced->getAt(&c, c.fromUTF8String("alpha")->asObject(&c))->asInteger(&c) == 3,
+           "Setting an equal key replaces its value");
+    ASSERT(dict->getAt(&c, c.fromUTF8String("alpha")->asObject(&c))->asInteger(&c) == 1, "The previous version is unchanged");
+
+    proto::ProtoList* listKey = c.newList()->appendLast(&c, c.fromInteger(4))->appendLast(&c, c.fromInteger(5));
+    proto::ProtoList* sameList = c.newList()->appendLast(&c, c.fromInteger(4))->appendLast(&c, c.fromInteger(5));
+    dict = dict->setAt(&c, listKey->asObject(&c), c.fromInteger(45));
+    ASSERT(dict->getAt(&c, sameList->asObject(&c))->asInteger(&c) == 45, "List keys match by content");
+
+    // Both sparse lists hash to 1 (0 ^ 1 and 2 ^ 3) but differ: their entries share a bucket.
+    proto::ProtoObject* x = c.fromInteger(9);
+    proto::ProtoSparseList* first = c.newSparseList()->setAt(&c, 0, x)->setAt(&c, 1, x);
+    proto::ProtoSparseList* second = c.newSparseList()->setAt(&c, 2, x)->setAt(&c, 3, x);
+    ASSERT(first->getHash(&c) == second->getHash(&c), "The two sparse lists collide");
+    proto::ProtoDictionary* colliding = c.newDictionary()
+        ->setAt(&c, first->asObject(&c), c.fromInteger(1))
+        ->setAt(&c, second->asObject(&c), c.fromInteger(2));
+    ASSERT(colliding->getSize(&c) == 2 &&
+           colliding->getAt(&c, first->asObject(&c))->asInteger(&c) == 1 &&
+           colliding->getAt(&c, second->asObject(&c))->asInteger(&c) == 2,
+           "Colliding keys keep separate values");
+    proto::ProtoDictionary* oneLeft = colliding->removeAt(&c, first->asObject(&c));
+    ASSERT(oneLeft->getSize(&c) == 1 && !oneLeft->has(&c, first->asObject(&c)) &&
+           oneLeft->getAt(&c, second->asObject(&c))->asInteger(&c) == 2,
+           "Removing one colliding key keeps the other");
+
+    std::map<int, int> model;
+    proto::ProtoDictionary* numbers = c.newDictionary();
+    for (int i = 0; i < 2000; ++i)
+    {
+        int key = (i * 7919) % 1500;
+        if (i % 5 == 4)
+        {
+            numbers = numbers->removeAt(&c, c.fromInteger(key));
+            model.erase(key);
+        }
+        else
+        {
+            numbers = numbers->setAt(&c, c.fromInteger(key), c.fromInteger(i));
+            model[key] = i;
+        }
+    }
+    bool allOk = numbers->getSize(&c) == model.size();
+    for (int key = 0; key < 1500; ++key)
+    {
+        auto it = model.find(key);
+        proto::ProtoObject* value = numbers->getAt(&c, c.fromInteger(key));
+        if ((it == model.end()) != (value == PROTO_NONE) || (value && value->asInteger(&c) != it->second))
+            allOk = false;
+    }
+    ASSERT(allOk, "Set, get and remove agree with a reference map");
+
+    // Insertion order: overwriting keeps the place, re-adding goes last.
+    proto::ProtoDictionary* ordered = c.newDictionary(true);
+    ASSERT(ordered->keepsInsertionOrder(&c) && !numbers->keepsInsertionOrder(&c), "The order option is kept");
+    for (int key = 20; key > 0; --key)
+        ordered = ordered->setAt(&c, c.fromInteger(key), c.fromInteger(0));
+    ordered = ordered->setAt(&c, c.fromInteger(10), c.fromInteger(1));
+    ordered = ordered->removeAt(&c, c.fromInteger(15));
+    ordered = ordered->removeAt(&c, c.fromInteger(3));
+    ordered = ordered->setAt(&c, c.fromInteger(15), c.fromInteger(2));
+    std::vector<int> expected;
+    for (int key = 20; key > 0; --key)
+        if (key != 15 && key != 3)
+            expected.push_back(key);
+    expected.push_back(15);
+    std::vector<int> visited;
+    ordered->processElements(&c, &visited, collectDictionaryKeys);
+    ASSERT(visited == expected && ordered->getAt(&c, c.fromInteger(10))->asInteger(&c) == 1,
+           "An ordered dictionary visits keys in insertion order");
+
+    // Dictionaries with equal contents are equal keys, whatever the build order.
+    proto::ProtoDictionary* forward = c.newDictionary();
+    proto::ProtoDictionary* backward = c.newDictionary(true);
+    for (int key = 0; key < 50; ++key)
+    {
+        forward = forward->setAt(&c, c.fromInteger(key), x);
+        backward = backward->setAt(&c, c.fromInteger(49 - key), x);
+    }
+    ASSERT(forward->getHash(&c) == backward->getHash(&c), "Equal contents give the same hash");
+    proto::ProtoDictionary* nested = c.newDictionary()->setAt(&c, forward->asObject(&c), c.fromInteger(7));
+    ASSERT(nested->getAt(&c, backward->asObject(&c))->asInteger(&c) == 7, "Dictionaries match by content as keys");
+    ASSERT(forward->asObject(&c)->asDictionary(&c) == forward, "asDictionary returns the dictionary");
+
+    proto::ProtoDictionary* emptied = ordered;
+    for (int key : expected)
+        emptied = emptied->removeAt(&c, c.fromInteger(key));
+    ASSERT(emptied->getSize(&c) == 0 && !emptied->has(&c, c.fromInteger(20)), "Removing every key leaves an empty dictionary");
+
+    // Queue-like use: the oldest key leaves and new ones arrive, with some
+    // removals and overwrites in the middle, over hundreds of cycles.
+    std::vector<int> order;
+    proto::ProtoDictionary* queue = c.newDictionary(true);
+    bool queueOk = true;
+    for (int i = 0; i < 1500; ++i)
+    {
+        int step = (i * 7919) % 10;
+        if (order.size() > 150 || (step == 0 && !order.empty()))
+        {
+            queue = queue->removeAt(&c, c.fromInteger(order.front()));
+            order.erase(order.begin());
+        }
+        else if (step == 1 && order.size() > 2)
+        {
+            int victim = order[order.size() / 2];
+            queue = queue->removeAt(&c, c.fromInteger(victim));
+            order.erase(order.begin() + order.size() / 2);
+        }
+        else if (step == 2 && !order.empty())
+            queue = queue->setAt(&c, c.fromInteger(order[order.size() / 3]), c.fromInteger(-i));
+        else
+        {
+            queue = queue->setAt(&c, c.fromInteger(i), c.fromInteger(i));
+            order.push_back(i);
+        }
+
+        if (i % 100 == 99)
+        {
+            std::vector<int> seen;
+            queue->processElements(&c, &seen, collectDictionaryKeys);
+            queueOk = queueOk && seen == order && queue->getSize(&c) == order.size();
+        }
+    }
+    ASSERT(queueOk, "An ordered dictionary used as a queue keeps its order");
+}
+
+static void collectSortedKeys(proto::ProtoContext* context, void* self, proto::ProtoObject* key, proto::ProtoObject* value) {
+    static_cast<std::vector<int>*>(self)->push_back(key->asInteger(context));
+}
+
+// Orders integers from largest to smallest.
+static int compareDescending(proto::ProtoContext* context, proto::ProtoObject* a, proto::ProtoObject* b) {
+    int x = a->asInteger(context), y = b->asInteger(context);
+    return x > y ? -1 : (x < y ? 1 : 0);
+}
+
+void test_sorted_map(proto::ProtoContext& c) {
+    printf("\n--- Testing Sorted Map ---\n");
+
+    std::map<int, int> model;
+    proto::ProtoSortedMap* map = c.newSortedMap();
+    for (int i = 0; i < 3000; ++i)
+    {
+        int key = (i * 7919) % 1000 - 500;
+        if (i % 3 == 2)
+        {
+            map = map->removeAt(&c, c.fromInteger(key));
+            model.erase(key);
+        }
+        else
+        {
+            map = map->setAt(&c, c.fromInteger(key), c.fromInteger(i));
+            model[key] = i;
+        }
+    }
+    bool allOk = map->getSize(&c) == model.size();
+    for (int key = -500; key < 500; ++key)
+    {
+        auto it = model.find(key);
+        proto::ProtoObject* value = map->getAt(&c, c.fromInteger(key));
+        if ((it == model.end()) != (value == PROTO_NONE) || (value && value->asInteger(&c) != it->second))
+            allOk = false;
+    }
+    ASSERT(allOk, "Set, get and remove agree with a reference map");
+
+    std::vector<int> visited, expected;
+    map->processElements(&c, &visited, collectSortedKeys);
+    for (auto& entry : model)
+        expected.push_back(entry.first);
+    ASSERT(visited == expected, "Keys are visited in order");
+    ASSERT(map->firstKey(&c)->asInteger(&c) == model.begin()->first &&
+           map->lastKey(&c)->asInteger(&c) == model.rbegin()->first, "First and last keys");
+
+    // Rank and select against positions in the reference map.
+    allOk = true;
+    unsigned long position = 0;
+    for (auto& entry : model)
+    {
+        if (map->rank(&c, c.fromInteger(entry.first)) != position ||
+            map->keyAt(&c, position)->asInteger(&c) != entry.first ||
+            map->valueAt(&c, position)->asInteger(&c) != entry.second)
+            allOk = false;
+        position++;
+    }
+    ASSERT(allOk && map->keyAt(&c, model.size()) == PROTO_NONE, "Rank and select agree with positions");
+
+    allOk = true;
+    for (int key = -510; key < 510; key += 7)
+    {
+        auto above = model.lower_bound(key);
+        auto upTo = model.upper_bound(key);
+        proto::ProtoObject* ceiling = map->ceiling(&c, c.fromInteger(key));
+        proto::ProtoObject* floor = map->floor(&c, c.fromInteger(key));
+        if ((above == model.end()) != (ceiling == PROTO_NONE) || (ceiling && ceiling->asInteger(&c) != above->first))
+            allOk = false;
+        if ((upTo == model.begin()) != (floor == PROTO_NONE) || (floor && floor->asInteger(&c) != std::prev(upTo)->first))
+            allOk = false;
+    }
+    ASSERT(allOk, "Floor and ceiling agree with the reference map");
+
+    // Ranges are [from, to); NONE leaves an end open.
+    unsigned long inRange = std::distance(model.lower_bound(-100), model.lower_bound(250));
+    ASSERT(map->countRange(&c, c.fromInteger(-100), c.fromInteger(250)) == inRange, "countRange counts [from, to)");
+    ASSERT(map->countRange(&c, PROTO_NONE, PROTO_NONE) == model.size() &&
+           map->countRange(&c, c.fromInteger(250), c.fromInteger(-100)) == 0, "Open and empty ranges");
+    visited.clear();
+    expected.clear();
+    map->processRange(&c, c.fromInteger(-100), c.fromInteger(250), &visited, collectSortedKeys);
+    for (auto it = model.lower_bound(-100); it != model.lower_bound(250); ++it)
+        expected.push_back(it->first);
+    ASSERT(visited == expected, "processRange visits the range in order");
+
+    // Persistence: removing everything leaves older versions intact.
+    proto::ProtoSortedMap* emptied = map;
+    for (auto& entry : model)
+        emptied = emptied->removeAt(&c, c.fromInteger(entry.first));
+    ASSERT(emptied->getSize(&c) == 0 && emptied->firstKey(&c) == PROTO_NONE && map->getSize(&c) == model.size(),
+           "Removing every key leaves an empty map and the old version unchanged");
+
+    proto::ProtoSortedMap* times = c.newSortedMap();
+    for (unsigned long t : {5000ul, 1000ul, 3000ul})
+        times = times->setAt(&c, c.fromTimestamp(t), c.fromInteger(1));
+    ASSERT(times->firstKey(&c) == c.fromTimestamp(1000) && times->lastKey(&c) == c.fromTimestamp(5000),
+           "Timestamps are ordered chronologically");
+    proto::ProtoSortedMap* dates = c.newSortedMap()
+        ->setAt(&c, c.fromDate(2024, 2, 1), c.fromInteger(1))
+        ->setAt(&c, c.fromDate(2023, 12, 31), c.fromInteger(2));
+    ASSERT(dates->firstKey(&c) == c.fromDate(2023, 12, 31), "Dates are ordered chronologically");
+
+    proto::ProtoSortedMap* words = c.newSortedMap(proto::ProtoSortedMap::compareStrings);
+    for (const char* word : {"pear", "apple", "fig", "app", "banana"})
+        words = words->setAt(&c, c.fromUTF8String(word)->asObject(&c), c.fromInteger(1));
+    ASSERT(words->getSize(&c) == 5 && words->has(&c, c.fromUTF8String("fig")->asObject(&c)), "String keys match by content");
+    ASSERT(words->keyAt(&c, 0)->asString(&c)->getSize(&c) == 3 &&
+           words->keyAt(&c, 1)->asString(&c)->getSize(&c) == 5 &&
+           words->rank(&c, c.fromUTF8String("b")->asObject(&c)) == 2 &&
+           words->rank(&c, c.fromUTF8String("z")->asObject(&c)) == 5, "Strings are ordered by code point");
+
+    // A bulk load matches incremental inserts.
+    std::vector<proto::ProtoObject*> keys, values;
+    for (int i = 0; i < 500; ++i)
+    {
+        keys.push_back(c.fromInteger(i * 2));
+        values.push_back(c.fromInteger(i));
+    }
+    proto::ProtoSortedMap* loaded = c.newSortedMapFromArray(
+        proto::ProtoSortedMap::compareNumbers, keys.data(), values.data(), keys.size());
+    allOk = loaded && loaded->getSize(&c) == 500;
+    for (int i = 0; allOk && i < 500; ++i)
+    {
+        if (loaded->getAt(&c, c.fromInteger(i * 2))->asInteger(&c) != i || loaded->has(&c, c.fromInteger(i * 2 + 1)) ||
+            loaded->rank(&c, c.fromInteger(i * 2)) != (unsigned long) i)
+            allOk = false;
+    }
+    ASSERT(allOk, "A bulk-loaded map finds every key");
+    proto::ProtoSortedMap* grown = loaded->setAt(&c, c.fromInteger(501), c.fromInteger(-1))->removeAt(&c, c.fromInteger(0));
+    ASSERT(grown->getSize(&c) == 500 && grown->keyAt(&c, 250)->asInteger(&c) == 501, "A bulk-loaded map can be updated");
+    std::swap(keys[10], keys[11]);
+    ASSERT(c.newSortedMapFromArray(proto::ProtoSortedMap::compareNumbers, keys.data(), values.data(), keys.size()) == nullptr,
+           "Unsorted keys are rejected");
+
+    proto::ProtoSortedMap* descending = c.newSortedMap(compareDescending);
+    for (int key = 0; key < 20; ++key)
+        descending = descending->setAt(&c, c.fromInteger(key), c.fromInteger(key));
+    ASSERT(descending->firstKey(&c)->asInteger(&c) == 19 && descending->keyAt(&c, 5)->asInteger(&c) == 14,
+           "A custom comparator sets the order");
+    ASSERT(descending->asObject(&c)->asSortedMap(&c) == descending && !map->asObject(&c)->asDictionary(&c),
+           "asSortedMap returns the map");
+}
+
+static void collectDequeValues(proto::ProtoContext* context, void* self, proto::ProtoObject* value) {
+    static_cast<std::vector<int>*>(self)->push_back(value->asInteger(context));
+}
+
+static bool sameDeque(proto::ProtoContext& c, proto::ProtoDeque* deque, const std::deque<int>& model) {
+    if (deque->getSize(&c) != model.size())
+        return false;
+    for (unsigned long i = 0; i < model.size(); ++i)
+        if (deque->getAt(&c, (int) i)->asInteger(&c) != model[i])
+            return false;
+    std::vector<int> visited;
+    deque->processValues(&c, &visited, collectDequeValues);
+    return std::equal(visited.begin(), visited.end(), model.begin(), model.end());
+}
+
+void test_deque(proto::ProtoContext& c) {
+    printf("\n--- Testing Deque ---\n");
+
+    proto::ProtoDeque* empty = c.newDeque();
+    ASSERT(empty->getSize(&c) == 0 && empty->getFirst(&c) == PROTO_NONE && empty->removeLast(&c)->getSize(&c) == 0,
+           "An empty deque has no elements");
+
+    // Pushes and pops at both ends, checked against std::deque.
+    std::deque<int> model;
+    proto::ProtoDeque* deque = empty;
+    bool allOk = true;
+    for (int i = 0; i < 4000; ++i)
+    {
+        switch ((i * 7919) % 7)
+        {
+        case 0: case 1: case 2:
+            deque = deque->appendLast(&c, c.fromInteger(i));
+            model.push_back(i);
+            break;
+        case 3: case 4:
+            deque = deque->appendFirst(&c, c.fromInteger(i));
+            model.push_front(i);
+            break;
+        case 5:
+            deque = deque->removeFirst(&c);
+            if (!model.empty())
+                model.pop_front();
+            break;
+        default:
+            deque = deque->removeLast(&c);
+            if (!model.empty())
+                model.pop_back();
+        }
+        if (i % 500 == 0 && !sameDeque(c, deque, model))
+            allOk = false;
+    }
+    ASSERT(allOk && sameDeque(c, deque, model), "Both ends agree with a std::deque");
+    ASSERT(deque->getFirst(&c)->asInteger(&c) == model.front() && deque->getLast(&c)->asInteger(&c) == model.back() &&
+           deque->getAt(&c, -2)->asInteger(&c) == model[model.size() - 2] &&
+           deque->getAt(&c, (int) model.size()) == PROTO_NONE, "First, last and negative indexes follow ProtoList");
+    ASSERT(deque->has(&c, c.fromInteger(model[model.size() / 2])) && !deque->has(&c, c.fromInteger(-1)), "has finds the values");
+
+    // Draining from the front leaves the older version intact.
+    proto::ProtoDeque* drained = deque;
+    while (drained->getSize(&c))
+        drained = drained->removeFirst(&c);
+    ASSERT(sameDeque(c, deque, model), "Removing every element leaves the old version unchanged");
+
+    // Splits and slices at every kind of position.
+    allOk = true;
+    unsigned long size = model.size();
+    for (unsigned long at : {0ul, 1ul, 2ul, 5ul, size / 3, size / 2, size - 7, size - 1, size})
+    {
+        std::deque<int> front(model.begin(), model.begin() + at), back(model.begin() + at, model.end());
+        if (!sameDeque(c, deque->splitFirst(&c, (int) at), front) || !sameDeque(c, deque->splitLast(&c, (int) at), back))
+            allOk = false;
+    }
+    ASSERT(allOk, "splitFirst and splitLast agree with the reference");
+    std::deque<int> middle(model.begin() + 100, model.end() - 50);
+    ASSERT(sameDeque(c, deque->getSlice(&c, 100, -50), middle) && deque->getSlice(&c, 50, 10)->getSize(&c) == 0,
+           "getSlice takes [from, to)");
+
+    // Concatenation at several sizes, including small and single-element deques.
+    allOk = true;
+    for (unsigned long leftSize : {0ul, 1ul, 3ul, 9ul, 40ul, 700ul})
+    {
+        for (unsigned long rightSize : {0ul, 1ul, 2ul, 13ul, 300ul})
+        {
+            proto::ProtoDeque* left = c.newDeque();
+            proto::ProtoDeque* right = c.newDeque();
+            std::deque<int> joined;
+            for (unsigned long i = 0; i < leftSize; ++i)
+            {
+                left = left->appendLast(&c, c.fromInteger((int) i));
+                joined.push_back((int) i);
+            }
+            for (unsigned long i = 0; i < rightSize; ++i)
+            {
+                right = right->appendFirst(&c, c.fromInteger((int) (10000 + i)));
+                joined.insert(joined.begin() + leftSize, (int) (10000 + i));
+            }
+            if (!sameDeque(c, left->extend(&c, right), joined))
+                allOk = false;
+        }
+    }
+    ASSERT(allOk, "extend concatenates two deques");
+
+    // Splitting and joining back restores the sequence.
+    proto::ProtoDeque* rejoined = deque->splitFirst(&c, 1234)->extend(&c, deque->splitLast(&c, 1234));
+    ASSERT(sameDeque(c, rejoined, model), "Split halves rejoin to the original");
+
+    proto::ProtoList* list = deque->asList(&c);
+    allOk = list->getSize(&c) == model.size();
+    for (unsigned long i = 0; allOk && i < model.size(); ++i)
+        allOk = list->getAt(&c, (int) i)->asInteger(&c) == model[i];
+    ASSERT(allOk, "asList copies the values in order");
+    ASSERT(deque->asObject(&c)->asDeque(&c) == deque && !deque->asObject(&c)->asSortedMap(&c), "asDeque returns the deque");
+}
+
+void test_priority_queue(proto::ProtoContext& c) {
+    printf("\n--- Testing Priority Queue ---\n");
+
+    proto::ProtoPriorityQueue* empty = c.newPriorityQueue();
+    ASSERT(empty->getSize(&c) == 0 && empty->getMin(&c) == PROTO_NONE && empty->removeMin(&c)->getSize(&c) == 0,
+           "An empty queue has no minimum");
+    ASSERT(empty->insert(&c, c.fromUTF8String("late")->asObject(&c), c.fromInteger(1)) == nullptr,
+           "Keys must be embedded values");
+
+    // Inserts and removals interleaved, checked against a std::multimap.
+    std::multimap<int, int> model;
+    proto::ProtoPriorityQueue* queue = empty;
+    bool allOk = true;
+    for (int i = 0; i < 3000; ++i)
+    {
+        if (i % 4 == 3)
+        {
+            if (queue->getMinKey(&c) != PROTO_NONE &&
+                queue->getMinKey(&c)->asInteger(&c) != model.begin()->first)
+                allOk = false;
+            queue = queue->removeMin(&c);
+            if (!model.empty())
+                model.erase(model.begin());
+        }
+        else
+        {
+            int key = (i * 7919) % 1000 - 300;
+            queue = queue->insert(&c, c.fromInteger(key), c.fromInteger(i));
+            model.emplace(key, i);
+        }
+    }
+    ASSERT(allOk && queue->getSize(&c) == model.size(), "The minimum agrees with a reference multimap");
+
+    // Draining yields the keys in order, and each value comes with its key.
+    proto::ProtoPriorityQueue* drained = queue;
+    std::multimap<int, int> remaining = model;
+    allOk = true;
+    int previous = -1000;
+    while (drained->getSize(&c))
+    {
+        int key = drained->getMinKey(&c)->asInteger(&c);
+        int value = drained->getMin(&c)->asInteger(&c);
+        auto range = remaining.equal_range(key);
+        auto found = std::find_if(range.first, range.second, [value](auto& entry) { return entry.second == value; });
+        if (key < previous || found == range.second)
+            allOk = false;
+        else
+            remaining.erase(found);
+        previous = key;
+        drained = drained->removeMin(&c);
+    }
+    ASSERT(allOk && remaining.empty(), "Removing the minimum repeatedly sorts the entries");
+    ASSERT(queue->getSize(&c) == model.size() && queue->getMinKey(&c)->asInteger(&c) == model.begin()->first,
+           "The drained version leaves the original unchanged");
+
+    // Meld keeps both sets of entries and the smaller minimum.
+    proto::ProtoPriorityQueue* other = c.newPriorityQueue();
+    for (int key = 0; key < 200; ++key)
+        other = other->insert(&c, c.fromInteger(-1000 + key * 3), c.fromInteger(key));
+    proto::ProtoPriorityQueue* melded = queue->meld(&c, other);
+    ASSERT(melded->getSize(&c) == model.size() + 200 && melded->getMinKey(&c)->asInteger(&c) == -1000,
+           "meld combines both queues");
+    ASSERT(queue->meld(&c, empty) == queue && empty->meld(&c, other) == other, "Melding with an empty queue shares the other");
+    previous = -2000;
+    allOk = true;
+    for (unsigned long i = 0; i < model.size() + 200; ++i)
+    {
+        int key = melded->getMinKey(&c)->asInteger(&c);
+        if (key < previous)
+            allOk = false;
+        previous = key;
+        melded = melded->removeMin(&c);
+    }
+    ASSERT(allOk && melded->getSize(&c) == 0, "A melded queue drains in order");
+
+    // Bounds are worst case: removing from the same large version again and again stays cheap.
+    proto::ProtoPriorityQueue* big = c.newPriorityQueue();
+    for (int key = 0; key < 20000; ++key)
+        big = big->insert(&c, c.fromInteger(key), c.fromInteger(key));
+    allOk = true;
+    for (int i = 0; i < 500; ++i)
+    {
+        proto::ProtoPriorityQueue* next = big->removeMin(&c);
+        if (next->getMinKey(&c)->asInteger(&c) != 1 || next->getSize(&c) != 19999)
+            allOk = false;
+    }
+    ASSERT(allOk && big->getMinKey(&c)->asInteger(&c) == 0, "Repeated removeMin on one version is correct");
+
+    // Timestamps order chronologically.
+    proto::ProtoPriorityQueue* timers = c.newPriorityQueue()
+        ->insert(&c, c.fromTimestamp(3000), c.fromInteger(3))
+        ->insert(&c, c.fromTimestamp(1000), c.fromInteger(1))
+        ->insert(&c, c.fromTimestamp(2000), c.fromInteger(2));
+    ASSERT(timers->getMin(&c)->asInteger(&c) == 1 && timers->removeMin(&c)->getMin(&c)->asInteger(&c) == 2,
+           "Timestamp keys come out earliest first");
+    ASSERT(timers->asObject(&c)->asPriorityQueue(&c) == timers && !timers->asObject(&c)->asDeque(&c),
+           "asPriorityQueue returns the queue");
+}